@@ -0,0 +1,574 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+#include "batchrunner.h"
+#include "rootdata.h"
+#include "mainwindow.h"
+#include "experiment.h"
+#include "projectobject.h"
+#include "diagnostics.h"
+#include <algorithm>
+
+#define BATCH_COL_NAME 0
+#define BATCH_COL_STATUS 1
+#define BATCH_COL_PROGRESS 2
+#define BATCH_COL_TIME 3
+#define BATCH_COL_FOLDER 4
+
+batchRunner::batchRunner(rootData * data, QWidget *parent) :
+    QWidget(parent, Qt::Window)
+{
+    this->data = data;
+
+    this->setWindowTitle("Batch run");
+    this->resize(720, 480);
+
+    QVBoxLayout * layout = new QVBoxLayout;
+    this->setLayout(layout);
+
+    QFormLayout * options = new QFormLayout;
+    layout->addLayout(options);
+
+    // experiments to run - ignored when sweeping a property
+    this->experimentList = new QListWidget;
+    this->experimentList->setMaximumHeight(100);
+    this->experimentList->setToolTip("Each checked experiment is run once");
+    options->addRow("Experiments", this->experimentList);
+
+    // or a sweep over one of the experiment's changed properties
+    this->sweepProperty = new QComboBox;
+    this->sweepProperty->setToolTip("Run the property's experiment once for each value, instead of the checked experiments");
+    options->addRow("Sweep", this->sweepProperty);
+
+    this->sweepValues = new QLineEdit;
+    this->sweepValues->setToolTip("Values as a list (0.1, 0.2, 0.5) or a range (start:step:end)");
+    options->addRow("Values", this->sweepValues);
+
+    QSettings settings;
+    this->maxConcurrent = new QSpinBox;
+    this->maxConcurrent->setRange(1, 64);
+    this->maxConcurrent->setValue(settings.value("batch/max_concurrent", BATCH_DEFAULT_CONCURRENT_RUNS).toInt());
+    this->maxConcurrent->setToolTip("Number of simulator processes run at once");
+    connect(this->maxConcurrent, SIGNAL(valueChanged(int)), this, SLOT(setMaxConcurrent(int)));
+    options->addRow("Concurrent runs", this->maxConcurrent);
+
+    QHBoxLayout * buttons = new QHBoxLayout;
+    buttons->addStretch();
+    this->startButton = new QPushButton("Start");
+    connect(this->startButton, SIGNAL(clicked()), this, SLOT(start()));
+    buttons->addWidget(this->startButton);
+    this->cancelButton = new QPushButton("Cancel");
+    this->cancelButton->setEnabled(false);
+    connect(this->cancelButton, SIGNAL(clicked()), this, SLOT(cancel()));
+    buttons->addWidget(this->cancelButton);
+    layout->addLayout(buttons);
+
+    // one row per run
+    this->jobTable = new QTableWidget(0, 5);
+    this->jobTable->setHorizontalHeaderLabels(QStringList() << "Run" << "Status" << "Progress" << "Wall clock" << "Folder");
+    this->jobTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    this->jobTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    this->jobTable->setToolTip("Double click a finished run to load its logs");
+    this->jobTable->horizontalHeader()->setStretchLastSection(true);
+    connect(this->jobTable, SIGNAL(cellDoubleClicked(int,int)), this, SLOT(loadLogs(int,int)));
+    layout->addWidget(this->jobTable);
+
+    // updates the wall clock times of running jobs
+    this->clock = new QTimer(this);
+    this->clock->setInterval(1000);
+    connect(this->clock, SIGNAL(timeout()), this, SLOT(updateTimes()));
+
+    refresh();
+}
+
+batchRunner::~batchRunner()
+{
+    // do not leave simulators running when the window goes
+    for (uint i = 0; i < this->jobs.size(); ++i) {
+        if (this->jobs[i]->process != NULL) {
+            this->jobs[i]->process->disconnect(this);
+            this->jobs[i]->process->kill();
+            this->jobs[i]->process->waitForFinished(1000);
+        }
+    }
+    clearJobs();
+}
+
+void batchRunner::refresh()
+{
+    this->experimentList->clear();
+    this->sweepProperty->clear();
+
+    // the items keep what they stand for, so start() can check it is still in the project
+    this->sweepProperty->addItem("None");
+
+    for (uint i = 0; i < this->data->experiments.size(); ++i) {
+        experiment * expt = this->data->experiments[i];
+
+        QListWidgetItem * item = new QListWidgetItem(expt->name);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(expt->selected ? Qt::Checked : Qt::Unchecked);
+        item->setData(Qt::UserRole, qVariantFromValue((void *) expt));
+        this->experimentList->addItem(item);
+
+        // only fixed values can be swept
+        for (uint j = 0; j < expt->changes.size(); ++j) {
+            exptChangeProp * change = expt->changes[j];
+            if (!change->set || change->edit || change->par == NULL || change->par->currType != FixedValue) {
+                continue;
+            }
+            this->sweepProperty->addItem(expt->name + ": " + change->component->getXMLName() + " " + change->par->name);
+            this->sweepProperty->setItemData(this->sweepProperty->count() - 1, qVariantFromValue((void *) change), Qt::UserRole);
+            this->sweepProperty->setItemData(this->sweepProperty->count() - 1, qVariantFromValue((void *) expt), Qt::UserRole + 1);
+        }
+    }
+}
+
+experiment * batchRunner::findExperiment(QVariant item)
+{
+    // the project may have been edited, or another opened, since the lists were made
+    experiment * expt = (experiment *) item.value<void *>();
+    for (uint i = 0; i < this->data->experiments.size(); ++i) {
+        if (this->data->experiments[i] == expt) {
+            return expt;
+        }
+    }
+    return NULL;
+}
+
+bool batchRunner::parseSweepValues(QString text, vector < float > &values)
+{
+    values.clear();
+
+    // start:step:end
+    QStringList range = text.split(":");
+    if (range.size() == 3) {
+        bool ok1, ok2, ok3;
+        float start = range[0].toFloat(&ok1);
+        float step = range[1].toFloat(&ok2);
+        float end = range[2].toFloat(&ok3);
+        if (!ok1 || !ok2 || !ok3 || step == 0 || (end - start) / step < 0) {
+            return false;
+        }
+        int count = floor((end - start) / step + 0.5) + 1;
+        for (int i = 0; i < count; ++i) {
+            values.push_back(start + i * step);
+        }
+        return true;
+    }
+
+    // or a list
+    QStringList list = text.split(QRegExp("[,\\s]+"), QString::SkipEmptyParts);
+    for (int i = 0; i < list.size(); ++i) {
+        bool ok;
+        values.push_back(list[i].toFloat(&ok));
+        if (!ok) {
+            return false;
+        }
+    }
+    return values.size() > 0;
+}
+
+void batchRunner::start()
+{
+    // find what is to be run
+    vector < experiment * > expts;
+    vector < float > values;
+
+    bool stale = false;
+
+    int sweepIndex = qMax(0, this->sweepProperty->currentIndex());
+    exptChangeProp * change = (exptChangeProp *) this->sweepProperty->itemData(sweepIndex, Qt::UserRole).value<void *>();
+    if (change != NULL) {
+        if (!parseSweepValues(this->sweepValues->text(), values)) {
+            QMessageBox msgBox;
+            msgBox.setText("Sweep values should be a list (0.1, 0.2, 0.5) or a range (start:step:end)");
+            msgBox.exec();
+            return;
+        }
+        // the experiment that holds the change, if both are still there
+        experiment * expt = findExperiment(this->sweepProperty->itemData(sweepIndex, Qt::UserRole + 1));
+        if (expt != NULL && std::find(expt->changes.begin(), expt->changes.end(), change) != expt->changes.end()) {
+            expts.push_back(expt);
+        } else {
+            stale = true;
+        }
+    } else {
+        for (int i = 0; i < this->experimentList->count(); ++i) {
+            if (this->experimentList->item(i)->checkState() == Qt::Checked) {
+                experiment * expt = findExperiment(this->experimentList->item(i)->data(Qt::UserRole));
+                if (expt != NULL) {
+                    expts.push_back(expt);
+                } else {
+                    stale = true;
+                }
+            }
+        }
+    }
+
+    if (stale) {
+        QMessageBox msgBox;
+        msgBox.setText("The experiments have changed since the list was made - check the selection and start again");
+        msgBox.exec();
+        refresh();
+        return;
+    }
+
+    if (expts.empty()) {
+        return;
+    }
+
+    clearJobs();
+    this->jobTable->setRowCount(0);
+
+    // each batch has its own folder below the simulator's working directory
+    QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss");
+
+    // export every run now, so the project can be edited while they run
+    if (change != NULL) {
+        float original = change->par->value[0];
+        for (uint i = 0; i < values.size(); ++i) {
+            change->par->value[0] = values[i];
+            addJob(expts[0]->name + " " + change->par->name + "=" + QString::number(values[i]), expts[0], stamp);
+        }
+        change->par->value[0] = original;
+    } else {
+        for (uint i = 0; i < expts.size(); ++i) {
+            addJob(expts[i]->name, expts[i], stamp);
+        }
+    }
+
+    this->startButton->setEnabled(false);
+    this->cancelButton->setEnabled(true);
+    this->clock->start();
+
+    startQueued();
+}
+
+bool batchRunner::addJob(QString name, experiment * expt, QString stamp)
+{
+    QSettings settings;
+
+    batchJob * job = new batchJob;
+    job->name = name;
+    job->process = NULL;
+    job->elapsed = 0;
+    job->state = batchQueued;
+    job->status = "Queued";
+    this->jobs.push_back(job);
+
+    QString simName = expt->setup.simType;
+    settings.beginGroup("simulators/" + simName);
+    job->simulator = settings.value("path").toString();
+    job->simWorkingDir = QDir::toNativeSeparators(settings.value("working_dir").toString());
+    settings.endGroup();
+
+    // a folder for this run's model and logs
+    QString folder = QString("%1-").arg(this->jobs.size(), 3, 10, QChar('0')) + name;
+    folder.replace(QRegExp("[^A-Za-z0-9_.=-]"), "_");
+    QDir wk_dir(job->simWorkingDir);
+    job->dir = QDir::toNativeSeparators(wk_dir.absoluteFilePath("batch/" + stamp + "/" + folder));
+
+    int row = this->jobTable->rowCount();
+    this->jobTable->insertRow(row);
+    this->jobTable->setItem(row, BATCH_COL_NAME, new QTableWidgetItem(job->name));
+    this->jobTable->setItem(row, BATCH_COL_STATUS, new QTableWidgetItem);
+    this->jobTable->setItem(row, BATCH_COL_TIME, new QTableWidgetItem);
+    this->jobTable->setItem(row, BATCH_COL_FOLDER, new QTableWidgetItem(job->dir));
+    QProgressBar * progress = new QProgressBar;
+    progress->setRange(0, 1);
+    progress->setValue(0);
+    progress->setTextVisible(false);
+    this->jobTable->setCellWidget(row, BATCH_COL_PROGRESS, progress);
+
+    // check the simulator can be run
+    QFileInfo script(job->simulator);
+    if (!script.exists() || !script.isExecutable()) {
+        job->state = batchFailed;
+        job->status = "Simulator '" + job->simulator + "' is missing or not executable";
+        updateRow(row);
+        return false;
+    }
+
+    // set up the environment for the spawned process
+    job->env = QProcessEnvironment::systemEnvironment();
+    settings.beginGroup("simulators/" + simName + "/envVar");
+    QStringList keysTemp = settings.childKeys();
+    for (int i = 0; i < keysTemp.size(); ++i) {
+        job->env.insert(keysTemp[i], settings.value(keysTemp[i]).toString());
+    }
+    settings.endGroup();
+
+    QDir runDir(job->dir);
+    runDir.mkpath("model");
+    runDir.mkpath("log");
+
+    settings.setValue("simulator_export_path", QDir::toNativeSeparators(job->dir + "/model/"));
+    settings.setValue("export_binary", settings.value("simulators/" + simName + "/binary").toBool());
+    settings.setValue("export_optimise_maths", settings.value("simulators/" + simName + "/optimise_maths").toBool());
+
+    // the selected experiment is the one exported, so select this one for the export
+    vector < bool > selection;
+    for (uint i = 0; i < this->data->experiments.size(); ++i) {
+        selection.push_back(this->data->experiments[i]->selected);
+        this->data->experiments[i]->selected = (this->data->experiments[i] == expt);
+    }
+
+    // collect the export's issues for the table, rather than a message box for each run
+    diagnostics exportIssues;
+    bool exported;
+    {
+        diagnosticsScope scope(&exportIssues);
+        exported = this->data->currProject->export_for_simulator(QDir::toNativeSeparators(job->dir + "/model/"), this->data);
+    }
+    QList < diagnostic > found = exportIssues.takeErrors();
+    int errorCount = found.size();
+    found += exportIssues.takeWarnings();
+    QStringList issues;
+    for (int i = 0; i < found.size(); ++i) {
+        issues.push_back((i < errorCount ? "Error: " : "Warning: ") + found[i].toString().replace("<br/>", " ").remove(QRegExp("<[^>]*>")));
+    }
+    job->issues = issues.join("\n");
+
+    for (uint i = 0; i < this->data->experiments.size(); ++i) {
+        this->data->experiments[i]->selected = selection[i];
+    }
+
+    settings.remove("simulator_export_path");
+    settings.remove("export_binary");
+    settings.remove("export_optimise_maths");
+
+    if (!exported || errorCount > 0) {
+        job->state = batchFailed;
+        job->status = errorCount > 0 ? "Export failed: " + issues[0].mid(QString("Error: ").size()) : "Export failed";
+        exported = false;
+    }
+    updateRow(row);
+    return exported;
+}
+
+void batchRunner::startQueued()
+{
+    for (uint i = 0; i < this->jobs.size() && runningCount() < this->maxConcurrent->value(); ++i) {
+        batchJob * job = this->jobs[i];
+        if (job->state != batchQueued) {
+            continue;
+        }
+
+        job->process = new QProcess(this);
+        job->process->setWorkingDirectory(job->simWorkingDir);
+        job->process->setProcessEnvironment(job->env);
+        job->process->setProcessChannelMode(QProcess::MergedChannels);
+        job->process->setProperty("job", (int) i);
+
+        connect(job->process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(jobFinished(int,QProcess::ExitStatus)));
+        connect(job->process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(jobError(QProcess::ProcessError)));
+        connect(job->process, SIGNAL(readyReadStandardOutput()), this, SLOT(jobOutput()));
+
+        job->state = batchRunning;
+        job->status = "Running";
+        job->timer.start();
+
+        // the model and output folders are given, so runs sharing a simulator do not collide
+        QStringList args;
+        args << "-w" << job->simWorkingDir;
+        args << "-m" << QDir::toNativeSeparators(job->dir + "/model");
+        args << "-o" << QDir::toNativeSeparators(job->dir + "/log");
+        job->process->start(job->simulator, args);
+
+        updateRow(i);
+    }
+
+    // all done
+    if (runningCount() == 0) {
+        bool queued = false;
+        for (uint i = 0; i < this->jobs.size(); ++i) {
+            queued = queued || this->jobs[i]->state == batchQueued;
+        }
+        if (!queued) {
+            this->startButton->setEnabled(true);
+            this->cancelButton->setEnabled(false);
+            this->clock->stop();
+        }
+    }
+}
+
+void batchRunner::jobFinished(int exitCode, QProcess::ExitStatus status)
+{
+    int i = sender()->property("job").toInt();
+    batchJob * job = this->jobs[i];
+
+    job->elapsed = job->timer.elapsed();
+
+    if (job->state != batchCancelled) {
+        if (status == QProcess::NormalExit && exitCode == 0) {
+            job->state = batchFinished;
+            job->status = "Finished";
+        } else if (status == QProcess::NormalExit) {
+            job->state = batchFailed;
+            job->status = "Exit code " + QString::number(exitCode);
+        } else {
+            job->state = batchFailed;
+            job->status = "Crashed";
+        }
+    }
+
+    // keep the simulator output with the run
+    QFile outputFile(QDir(job->dir).absoluteFilePath("output.txt"));
+    if (outputFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QTextStream outputStream(&outputFile);
+        outputStream << job->output;
+    }
+
+    job->process->deleteLater();
+    job->process = NULL;
+
+    updateRow(i);
+    startQueued();
+}
+
+void batchRunner::jobError(QProcess::ProcessError error)
+{
+    // other errors are followed by finished()
+    if (error != QProcess::FailedToStart) {
+        return;
+    }
+
+    int i = sender()->property("job").toInt();
+    batchJob * job = this->jobs[i];
+
+    job->state = batchFailed;
+    job->status = "Simulator '" + job->simulator + "' failed to start";
+    job->elapsed = job->timer.elapsed();
+
+    job->process->deleteLater();
+    job->process = NULL;
+
+    updateRow(i);
+    startQueued();
+}
+
+void batchRunner::jobOutput()
+{
+    QProcess * process = (QProcess *) sender();
+    this->jobs[process->property("job").toInt()]->output += QString().fromUtf8(process->readAllStandardOutput());
+}
+
+void batchRunner::cancel()
+{
+    for (uint i = 0; i < this->jobs.size(); ++i) {
+        batchJob * job = this->jobs[i];
+        if (job->state == batchQueued || job->state == batchRunning) {
+            job->state = batchCancelled;
+            job->status = "Cancelled";
+            if (job->process != NULL) {
+                job->process->kill();
+            }
+            updateRow(i);
+        }
+    }
+    startQueued();
+}
+
+void batchRunner::updateTimes()
+{
+    for (uint i = 0; i < this->jobs.size(); ++i) {
+        if (this->jobs[i]->process != NULL) {
+            this->jobs[i]->elapsed = this->jobs[i]->timer.elapsed();
+            updateRow(i);
+        }
+    }
+}
+
+void batchRunner::updateRow(int row)
+{
+    batchJob * job = this->jobs[row];
+
+    this->jobTable->item(row, BATCH_COL_STATUS)->setText(job->status);
+    this->jobTable->item(row, BATCH_COL_STATUS)->setToolTip(job->issues.isEmpty() ? job->status : job->issues);
+    if (job->state != batchQueued) {
+        this->jobTable->item(row, BATCH_COL_TIME)->setText(QString::number(job->elapsed / 1000.0, 'f', 1) + " s");
+    }
+
+    // busy while running, full when done
+    QProgressBar * progress = (QProgressBar *) this->jobTable->cellWidget(row, BATCH_COL_PROGRESS);
+    if (job->state == batchRunning) {
+        progress->setRange(0, 0);
+    } else {
+        progress->setRange(0, 1);
+        progress->setValue(job->state == batchQueued ? 0 : 1);
+    }
+}
+
+int batchRunner::runningCount()
+{
+    int count = 0;
+    for (uint i = 0; i < this->jobs.size(); ++i) {
+        if (this->jobs[i]->process != NULL) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void batchRunner::clearJobs()
+{
+    for (uint i = 0; i < this->jobs.size(); ++i) {
+        delete this->jobs[i];
+    }
+    this->jobs.clear();
+}
+
+void batchRunner::loadLogs(int row, int)
+{
+    if (row < 0 || row >= (int) this->jobs.size() || this->jobs[row]->state != batchFinished) {
+        return;
+    }
+
+    // collect logs
+    QDir logs(QDir(this->jobs[row]->dir).absoluteFilePath("log"));
+
+    QStringList filter;
+    filter << "*.xml";
+    logs.setNameFilters(filter);
+
+    // add logs to graphs
+    this->data->main->viewGV.properties->loadDataFiles(logs.entryList(), &logs);
+
+    // and insert logs into visualiser
+    if (this->data->main->viewVZ.OpenGLWidget != NULL) {
+        this->data->main->viewVZ.OpenGLWidget->addLogs(&this->data->main->viewGV.properties->logs);
+    }
+}
+
+void batchRunner::setMaxConcurrent(int value)
+{
+    QSettings settings;
+    settings.setValue("batch/max_concurrent", value);
+
+    // more slots may now be free
+    if (runningCount() > 0) {
+        startQueued();
+    }
+}
@@ -0,0 +1,113 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include "globalHeader.h"
+#include <QElapsedTimer>
+
+class experiment;
+class exptChangeProp;
+
+#define BATCH_DEFAULT_CONCURRENT_RUNS 2
+
+enum batchJobState {
+    batchQueued,
+    batchRunning,
+    batchFinished,
+    batchFailed,
+    batchCancelled
+};
+
+struct batchJob {
+
+    // one simulator run, with its own model, log and output folder
+    QString name;
+    QString dir;
+    QString simulator;
+    QProcessEnvironment env;
+    QString simWorkingDir;
+    QProcess * process;
+    QElapsedTimer timer;
+    qint64 elapsed;
+    batchJobState state;
+    QString status;
+    // errors and warnings from the export, one per line
+    QString issues;
+    QString output;
+
+};
+
+/*!
+ * \brief The batchRunner class runs a list of experiments, or a sweep over the values of one
+ * of an experiment's changed properties, as concurrent simulator processes. Each run is
+ * exported to its own folder up front, so the project can be edited while the batch runs.
+ */
+class batchRunner : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit batchRunner(rootData * data, QWidget *parent = 0);
+    ~batchRunner();
+
+    /*!
+     * \brief refresh the experiment and changed property lists from the current project
+     */
+    void refresh();
+
+private:
+    rootData * data;
+
+    QListWidget * experimentList;
+    QComboBox * sweepProperty;
+    QLineEdit * sweepValues;
+    QSpinBox * maxConcurrent;
+    QPushButton * startButton;
+    QPushButton * cancelButton;
+    QTableWidget * jobTable;
+    QTimer * clock;
+
+    vector < batchJob * > jobs;
+
+    experiment * findExperiment(QVariant);
+    bool addJob(QString name, experiment * expt, QString stamp);
+    bool parseSweepValues(QString, vector < float > &);
+    void startQueued();
+    void updateRow(int);
+    int runningCount();
+    void clearJobs();
+
+public slots:
+    void start();
+    void cancel();
+    void jobFinished(int, QProcess::ExitStatus);
+    void jobError(QProcess::ProcessError);
+    void jobOutput();
+    void updateTimes();
+    void loadLogs(int row, int);
+    void setMaxConcurrent(int);
+};
+
+#endif // BATCHRUNNER_H
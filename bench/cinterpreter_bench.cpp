@@ -0,0 +1,395 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+/*
+ * Standalone harness for the layout maths interpreter.
+ *
+ * Two parts:
+ *  - fuzz: random arithmetic / function expressions are generated as trees,
+ *    printed with the minimum number of brackets and then run through
+ *    createStack() and interpretMaths(). The tree itself is the reference
+ *    evaluator, so precedence, associativity and unary operator handling
+ *    in the parser are all checked.
+ *  - bench: parse and evaluate throughput on the kind of maths found in the
+ *    layout components (grids, spheres, linear layouts).
+ *
+ * Usage: cinterpreter_bench [--seed N] [--cases N] [--iterations N] [--no-fuzz] [--no-bench]
+ *
+ * Exits non-zero if any fuzz case disagrees with the reference.
+ */
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <cmath>
+#include <cstdio>
+
+#include "cinterpreter.h"
+
+// small deterministic generator so a seed gives the same cases on every platform
+class benchRandom {
+
+public:
+    benchRandom(quint32 seed) {state = seed ? seed : 0x9E3779B9u;}
+    quint32 next() {
+        // xorshift32
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    int range(int n) {return int(next() % quint32(n));}
+    float uniform(float lo, float hi) {return lo + (hi - lo) * (float(next() & 0xFFFFFF) / float(0x1000000));}
+
+private:
+    quint32 state;
+};
+
+// precedence as used when printing - higher binds tighter
+#define PREC_ADD 0
+#define PREC_MULT 1
+#define PREC_UNARY 2
+#define PREC_ATOM 3
+
+struct refExpr {
+    QString text;
+    float value;
+    // largest magnitude seen while evaluating, used to scale the tolerance
+    float scale;
+    // false if any intermediate result was not finite - the interpreter uses INFINITY as a
+    // marker for a missing function argument, so those cases are not comparable
+    bool defined;
+    int prec;
+};
+
+static const char * unaryFuncs[] = {"exp", "sin", "cos", "tanh", "sqrt", "atan", "ceil", "floor"};
+static const int numUnaryFuncs = sizeof(unaryFuncs) / sizeof(unaryFuncs[0]);
+static const char * binaryFuncs[] = {"pow", "atan2", "mod"};
+static const int numBinaryFuncs = sizeof(binaryFuncs) / sizeof(binaryFuncs[0]);
+
+static float refUnaryFunc(int f, float x) {
+
+    switch (f) {
+    case 0: return exp(x);
+    case 1: return sin(x);
+    case 2: return cos(x);
+    case 3: return tanh(x);
+    case 4: return sqrt(x);
+    case 5: return atan(x);
+    case 6: return ceil(x);
+    case 7: return floor(x);
+    }
+    return 0;
+}
+
+static float refBinaryFunc(int f, float x, float y) {
+
+    switch (f) {
+    case 0: return pow(x, y);
+    case 1: return atan2(x, y);
+    case 2: return fmod(x, y);
+    }
+    return 0;
+}
+
+static bool isFinite(float val) {
+
+    return val == val && fabs(val) != INFINITY;
+}
+
+static float maxScale(float a, float b, float c) {
+
+    float m = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
+    return m > fabs(c) ? m : fabs(c);
+}
+
+static void finish(refExpr &out, refExpr &arg1, refExpr &arg2) {
+
+    out.defined = arg1.defined && arg2.defined && isFinite(out.value);
+    out.scale = out.defined ? maxScale(arg1.scale, arg2.scale, out.value) : INFINITY;
+}
+
+static QString bracket(refExpr &e, bool needed, benchRandom &rng) {
+
+    // add redundant brackets now and again to exercise the bracket handling
+    if (needed || rng.range(8) == 0) {
+        return "(" + e.text + ")";
+    }
+    return e.text;
+}
+
+static refExpr generateExpr(int depth, vector <lookup> &vars, benchRandom &rng) {
+
+    refExpr out;
+
+    int choice = depth <= 0 ? rng.range(2) : rng.range(9);
+
+    if (choice == 0) {
+        // constant - printed with limited precision and read back so both sides see the same float
+        out.text = QString::number(rng.uniform(0.0f, 10.0f), 'f', rng.range(4));
+        out.value = out.text.toFloat();
+        out.prec = PREC_ATOM;
+    } else if (choice == 1) {
+        int v = rng.range(vars.size());
+        out.text = vars[v].name;
+        out.value = vars[v].value;
+        out.prec = PREC_ATOM;
+    } else if (choice <= 5) {
+        // binary operator
+        refExpr lhs = generateExpr(depth - 1, vars, rng);
+        refExpr rhs = generateExpr(depth - 1, vars, rng);
+        int op = rng.range(4);
+        int prec = (op == ADD || op == SUB) ? PREC_ADD : PREC_MULT;
+        QString opText = QString("+-*/")[op];
+        // left associative: the right hand side needs brackets at equal precedence
+        out.text = bracket(lhs, lhs.prec < prec, rng) + opText + bracket(rhs, rhs.prec <= prec, rng);
+        switch (op) {
+        case ADD: out.value = lhs.value + rhs.value; break;
+        case SUB: out.value = lhs.value - rhs.value; break;
+        case MULT: out.value = lhs.value * rhs.value; break;
+        case DIV: out.value = lhs.value / rhs.value; break;
+        }
+        out.prec = prec;
+        finish(out, lhs, rhs);
+        return out;
+    } else if (choice == 6) {
+        // unary minus or plus
+        refExpr arg = generateExpr(depth - 1, vars, rng);
+        bool neg = rng.range(4) != 0;
+        out.text = QString(neg ? "-" : "+") + bracket(arg, arg.prec < PREC_UNARY, rng);
+        // the interpreter does unary operators as 0 - x, so match its signed zeros
+        out.value = neg ? 0.0f - arg.value : 0.0f + arg.value;
+        out.prec = PREC_UNARY;
+        finish(out, arg, arg);
+        return out;
+    } else if (choice == 7) {
+        int f = rng.range(numUnaryFuncs);
+        refExpr arg = generateExpr(depth - 1, vars, rng);
+        out.text = QString(unaryFuncs[f]) + "(" + arg.text + ")";
+        out.value = refUnaryFunc(f, arg.value);
+        out.prec = PREC_ATOM;
+        finish(out, arg, arg);
+        return out;
+    } else {
+        int f = rng.range(numBinaryFuncs);
+        refExpr arg1 = generateExpr(depth - 1, vars, rng);
+        refExpr arg2 = generateExpr(depth - 1, vars, rng);
+        out.text = QString(binaryFuncs[f]) + "(" + arg1.text + "," + arg2.text + ")";
+        out.value = refBinaryFunc(f, arg1.value, arg2.value);
+        out.prec = PREC_ATOM;
+        finish(out, arg1, arg2);
+        return out;
+    }
+
+    out.scale = fabs(out.value);
+    out.defined = true;
+    return out;
+}
+
+static bool resultsMatch(float got, refExpr &ref) {
+
+    // libm float / double overloads can differ by an ulp or so, which cancellation can amplify
+    return isFinite(got) && fabs(got - ref.value) <= 1e-4f * (ref.scale > 1.0f ? ref.scale : 1.0f);
+}
+
+static int runFuzz(quint32 seed, int cases) {
+
+    benchRandom rng(seed);
+
+    vector <lookup> varList;
+    varList.push_back(lookup("x", 0));
+    varList.push_back(lookup("y", 0));
+    varList.push_back(lookup("count", 0));
+    varList.push_back(lookup("numNeurons", 0));
+    varList.push_back(lookup("spacing", 0));
+    varList.push_back(lookup("r_1", 0));
+
+    int failures = 0;
+    int parseErrors = 0;
+    int skipped = 0;
+
+    for (int i = 0; i < cases; ++i) {
+
+        for (uint v = 0; v < varList.size(); ++v) {
+            varList[v].value = rng.uniform(-5.0f, 5.0f);
+        }
+
+        refExpr ref = generateExpr(1 + rng.range(5), varList, rng);
+
+        vector <valop> stack;
+        QString err = createStack(ref.text, varList, &stack);
+        if (err != "") {
+            ++parseErrors;
+            ++failures;
+            if (parseErrors <= 10) {
+                fprintf(stderr, "PARSE ERROR case %d: %s\n    %s\n", i, qPrintable(ref.text), qPrintable(err));
+            }
+            continue;
+        }
+
+        if (!ref.defined) {
+            ++skipped;
+            continue;
+        }
+
+        float got = interpretMaths(stack);
+        if (!resultsMatch(got, ref)) {
+            ++failures;
+            if (failures - parseErrors <= 10) {
+                fprintf(stderr, "MISMATCH case %d: %s\n    interpreter = %.9g, reference = %.9g\n", i, qPrintable(ref.text), got, ref.value);
+            }
+        }
+    }
+
+    printf("fuzz: seed %u, %d cases (%d not finite, skipped), %d parse errors, %d mismatches\n", seed, cases, skipped, parseErrors, failures - parseErrors);
+
+    return failures;
+}
+
+struct benchEquation {
+    const char * name;
+    const char * maths;
+};
+
+// maths of the shape found in the layout components
+static const benchEquation benchEquations[] = {
+    {"linear x", "x + spacing"},
+    {"grid x", "mod(count, cols) * spacing"},
+    {"grid y", "floor(count / cols) * spacing"},
+    {"grid z", "floor(count / (cols * rows)) * spacing"},
+    {"sphere theta", "acos(1 - 2 * (count + 0.5) / numNeurons)"},
+    {"sphere phi", "pi * (1 + pow(5, 0.5)) * count"},
+    {"sphere x", "radius * sin(theta) * cos(phi)"},
+    {"sphere y", "radius * sin(theta) * sin(phi)"},
+    {"sphere z", "radius * cos(theta)"},
+    {"jittered x", "(mod(count, cols) - cols / 2) * spacing + jitter * -sin(count * 12.9898)"}
+};
+static const int numBenchEquations = sizeof(benchEquations) / sizeof(benchEquations[0]);
+
+static void runBench(int iterations) {
+
+    vector <lookup> varList;
+    varList.push_back(lookup("x", 0));
+    varList.push_back(lookup("y", 0));
+    varList.push_back(lookup("z", 0));
+    varList.push_back(lookup("theta", 0.3f));
+    varList.push_back(lookup("phi", 1.2f));
+    varList.push_back(lookup("count", 0));
+    varList.push_back(lookup("numNeurons", 10000));
+    varList.push_back(lookup("cols", 100));
+    varList.push_back(lookup("rows", 10));
+    varList.push_back(lookup("spacing", 20));
+    varList.push_back(lookup("radius", 500));
+    varList.push_back(lookup("jitter", 2));
+    varList.push_back(lookup("e", M_E));
+    varList.push_back(lookup("pi", M_PI));
+
+    // locate count so the evaluation loop can step it like generateLayout does
+    float * count = getVarPtr("count", varList);
+
+    printf("\n%-14s %14s %14s %14s %14s\n", "equation", "parse/s", "ns/parse", "eval/s", "ns/eval");
+
+    qint64 totalParseNs = 0;
+    qint64 totalEvalNs = 0;
+    // keep the optimiser from discarding the evaluations
+    volatile float sink = 0;
+
+    for (int eq = 0; eq < numBenchEquations; ++eq) {
+
+        QString maths = benchEquations[eq].maths;
+        vector <valop> stack;
+
+        // parse: fewer iterations as this is much slower than evaluation
+        int parseIterations = iterations / 10 > 0 ? iterations / 10 : 1;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < parseIterations; ++i) {
+            QString err = createStack(maths, varList, &stack);
+            if (err != "") {
+                fprintf(stderr, "bench equation '%s' failed to parse: %s\n", benchEquations[eq].maths, qPrintable(err));
+                break;
+            }
+        }
+        qint64 parseNs = timer.nsecsElapsed();
+
+        timer.restart();
+        for (int i = 0; i < iterations; ++i) {
+            *count = float(i);
+            sink = sink + interpretMaths(stack);
+        }
+        qint64 evalNs = timer.nsecsElapsed();
+
+        totalParseNs += parseNs;
+        totalEvalNs += evalNs;
+
+        printf("%-14s %14.0f %14.1f %14.0f %14.1f\n", benchEquations[eq].name,
+               double(parseIterations) * 1e9 / double(parseNs ? parseNs : 1), double(parseNs) / double(parseIterations),
+               double(iterations) * 1e9 / double(evalNs ? evalNs : 1), double(evalNs) / double(iterations));
+    }
+
+    int parseCount = numBenchEquations * (iterations / 10 > 0 ? iterations / 10 : 1);
+    int evalCount = numBenchEquations * iterations;
+    printf("%-14s %14.0f %14.1f %14.0f %14.1f\n", "all",
+           double(parseCount) * 1e9 / double(totalParseNs ? totalParseNs : 1), double(totalParseNs) / double(parseCount),
+           double(evalCount) * 1e9 / double(totalEvalNs ? totalEvalNs : 1), double(totalEvalNs) / double(evalCount));
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    quint32 seed = 12345;
+    int cases = 100000;
+    int iterations = 1000000;
+    bool doFuzz = true;
+    bool doBench = true;
+
+    QStringList args = a.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "--seed" && i + 1 < args.size()) {
+            seed = args[++i].toUInt();
+        } else if (args[i] == "--cases" && i + 1 < args.size()) {
+            cases = args[++i].toInt();
+        } else if (args[i] == "--iterations" && i + 1 < args.size()) {
+            iterations = args[++i].toInt();
+        } else if (args[i] == "--no-fuzz") {
+            doFuzz = false;
+        } else if (args[i] == "--no-bench") {
+            doBench = false;
+        } else {
+            fprintf(stderr, "Usage: %s [--seed N] [--cases N] [--iterations N] [--no-fuzz] [--no-bench]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int failures = 0;
+    if (doFuzz) {
+        failures = runFuzz(seed, cases);
+    }
+    if (doBench) {
+        runBench(iterations);
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# Correctness and throughput harness for the layout
+# maths interpreter (cinterpreter.cpp)
+#
+# qmake cinterpreter_bench.pro && make && ./cinterpreter_bench
+#
+#-------------------------------------------------
+
+VPATH += ..
+INCLUDEPATH += ..
+
+# cinterpreter.h brings in globalHeader.h, which includes the Qt
+# widget, XML, OpenGL and network headers, so those modules are needed
+# to build - but nothing in the harness prints
+QT       += core gui opengl xml network
+
+greaterThan(QT_MAJOR_VERSION, 4) {
+QT       += widgets
+}
+
+TARGET = cinterpreter_bench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += cinterpreter_bench.cpp \
+    cinterpreter.cpp
+
+HEADERS += cinterpreter.h
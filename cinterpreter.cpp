@@ -30,6 +30,8 @@
 #include "globalHeader.h"
 int precedance(valop in) {
 
+    // unary operators bind tighter than any binary operator
+    if (in.isUnary) return 2;
     if (in.val == ADD || in.val == SUB) return 0;
     if (in.val == MULT || in.val == DIV) return 1;
 
@@ -287,6 +289,31 @@ float * getVarPtr(QString in, vector <lookup> &varList) {
 
 }
 
+// each thread has its own random sequence, so that layouts generated at the same
+// time still give the same locations for a given seed
+static QThreadStorage < unsigned int * > mathsRandomState;
+
+void seedMathsRandom(int seed) {
+
+    if (!mathsRandomState.hasLocalData()) {
+        mathsRandomState.setLocalData(new unsigned int);
+    }
+    *mathsRandomState.localData() = (unsigned int) seed;
+}
+
+float mathsRandom() {
+
+    // threads that have not been seeded use the global sequence as before
+    if (!mathsRandomState.hasLocalData()) {
+        return float(rand())/RAND_MAX;
+    }
+
+    // LCG, taking the top 24 bits so the result fits a float exactly
+    unsigned int * state = mathsRandomState.localData();
+    *state = *state * 1664525u + 1013904223u;
+    return float(*state >> 8)/16777215.0f;
+}
+
 float doFunction(float val1, float val2, float opf) {
 
     int op = int(opf);
@@ -315,7 +342,7 @@ float doFunction(float val1, float val2, float opf) {
     if (op == 16) return atan2(val1, val2);
     if (op == 17) return ceil(val1);
     if (op == 18) return floor(val1);
-    if (op == 19) return float(rand())/RAND_MAX;
+    if (op == 19) return mathsRandom();
     if (op == 20) return fmod(val1, val2);
 
     return 0;
@@ -1077,20 +1104,24 @@ QString createStack(QString equation, vector <lookup> &varList, vector <valop> *
             tempStack.push_back(opstack[0]);
         }
         else if (opstack[0].op == COMMA) {
-            while (tempStack.back().op != FUNC && tempStack.size() > 0) {
+            while (tempStack.size() > 0 && tempStack.back().op != FUNC) {
                 calcStack.push_back(tempStack.back());
                 tempStack.pop_back();
             }
             if (tempStack.size() == 0) return "Error - misplaced ',' or mismatched parentheses";
         }
         else if (opstack[0].op == OP) {
-            while (tempStack.size() > 0) {
-                if (tempStack.back().op == OP && precedance(opstack[0]) < precedance(tempStack.back())) {
-                    calcStack.push_back(tempStack.back());
-                    tempStack.pop_back();
+            // unary operators are prefix so they never pop anything, binary operators are
+            // left associative so pop everything of equal or higher precedence
+            if (!opstack[0].isUnary) {
+                while (tempStack.size() > 0) {
+                    if (tempStack.back().op == OP && precedance(opstack[0]) <= precedance(tempStack.back())) {
+                        calcStack.push_back(tempStack.back());
+                        tempStack.pop_back();
+                    }
+                    else
+                        break;
                 }
-                else
-                    break;
             }
             tempStack.push_back(opstack[0]);
         }
@@ -1098,15 +1129,15 @@ QString createStack(QString equation, vector <lookup> &varList, vector <valop> *
             tempStack.push_back(opstack[0]);
         }
         else if (opstack[0].op == RBRACKET) {
-            if (tempStack.size() == 0) return "Error - mismatched parentheses";
-            while (tempStack.back().op != LBRACKET && tempStack.back().op != FUNC) {
+            // the function token carries its own opening bracket, so stop at whichever comes first
+            while (tempStack.size() > 0 && tempStack.back().op != LBRACKET && tempStack.back().op != FUNC) {
                 calcStack.push_back(tempStack.back());
                 tempStack.pop_back();
             }
+            if (tempStack.size() == 0) return "Error - mismatched parentheses";
             if (tempStack.back().op == LBRACKET) {
                 tempStack.pop_back();
-            }
-            if (tempStack.back().op == FUNC) {
+            } else {
                 calcStack.push_back(tempStack.back());
                 tempStack.pop_back();
             }
@@ -121,4 +121,7 @@ float interpretMaths(vector <valop>);
 
 QString createStack(QString equation, vector <lookup> &varList, vector <valop> * returnStack);
 
+// seed the rand() used by the maths in the calling thread only
+void seedMathsRandom(int seed);
+
 #endif // CINTERPRETER_H
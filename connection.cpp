@@ -29,6 +29,11 @@
 #include "generate_dialog.h"
 #include "viewVZlayoutedithandler.h"
 #include "filteroutundoredoevents.h"
+#include "diagnostics.h"
+#include "projectobject.h"
+#include <QBuffer>
+
+QStringList csv_connection::reservedNames;
 
 connection::connection()
 {
@@ -358,6 +363,11 @@ csv_connection::csv_connection() {
 
     type = CSV;
     numRows = 0;
+    dataVersion = 1;
+    savedVersion = 0;
+    exportedVersion = 0;
+    sharedFile = false;
+    mapped = NULL;
     setUniqueName();
     // no connectivity generator in constructor
     generator = NULL;
@@ -386,9 +396,7 @@ csv_connection::csv_connection() {
 
     // open the storage file
     if( !this->file.open( QIODevice::ReadWrite ) ) {
-        QMessageBox msgBox;
-        msgBox.setText("Could not open output file for conversion");
-        msgBox.exec();
+        projectObject::reportError("Could not open output file for conversion");
         return;}
 
 }
@@ -403,10 +411,19 @@ csv_connection::~csv_connection() {
 
     // remove memory usage
 
+    if (this->mapped) {
+        this->file.unmap(this->mapped);
+        this->mapped = NULL;
+    }
     if (this->file.isOpen()) {
         this->file.close();
     }
 
+    // give up the library name if the data was never edited
+    if (this->sharedFile) {
+        reservedNames.removeAll(this->filename);
+    }
+
 }
 
 int csv_connection::getIndex() {
@@ -489,6 +506,11 @@ csv_connection::csv_connection(QString fileName) {
 
     type = CSV;
     numRows = 0;
+    dataVersion = 1;
+    savedVersion = 0;
+    exportedVersion = 0;
+    sharedFile = false;
+    mapped = NULL;
     setUniqueName();
     // no connectivity generator in constructor
     generator = NULL;
@@ -516,9 +538,7 @@ csv_connection::csv_connection(QString fileName) {
 
     // open the storage file
     if( !this->file.open( QIODevice::ReadWrite ) ) {
-        QMessageBox msgBox;
-        msgBox.setText("Could not open output file for conversion");
-        msgBox.exec();
+        projectObject::reportError("Could not open output file for conversion");
         return;}
 
     QStringList list;
@@ -581,6 +601,7 @@ void csv_connection::write_node_xml(QXmlStreamWriter &xmlOut) {
     if (writeBinary && this->getNumRows() > 30) {
 
         QString saveFileName = this->filename + ".bin";
+        QString savePath = saveDir.absoluteFilePath(saveFileName);
 
         // add a tag to the binary file
         xmlOut.writeEmptyElement("BinaryFile");
@@ -588,11 +609,36 @@ void csv_connection::write_node_xml(QXmlStreamWriter &xmlOut) {
         xmlOut.writeAttribute("num_connections", QString::number(float(getNumRows())));
         xmlOut.writeAttribute("explicit_delay_flag", QString::number(float(getNumCols()==3)));
 
-        // copy the file
-        file.copy(saveDir.absoluteFilePath(saveFileName));
+        // copy the file, unless it is already there from the last save or load
+        if (this->savedVersion != this->dataVersion || this->savedPath != savePath || !QFile::exists(savePath)) {
+
+            // copy alongside and then move into place, so a failed save keeps the old data
+            QString tempPath = savePath + ".tmp";
+            QFile::remove(tempPath);
+            if (this->mapped) {
+                file.unmap(this->mapped);
+                this->mapped = NULL;
+            }
+            if (file.copy(tempPath) && projectObject::replaceFile(tempPath, savePath)) {
+                this->savedVersion = this->dataVersion;
+                this->savedPath = savePath;
+                // a shared file now reads from the new copy, as the old one may be cleaned up with the save
+                if (this->sharedFile) {
+                    file.setFileName(savePath);
+                }
+            } else {
+                QFile::remove(tempPath);
+                diagnostics::instance()->addError("Error saving binary connection file '" + saveFileName + "' - is there sufficient disk space?");
+            }
 
-        // reopen the file that copy helpfully closed grrr....
-        file.open(QIODevice::ReadWrite);
+            // reopen the file that copy helpfully closed grrr....
+            if (this->sharedFile) {
+                file.open(QIODevice::ReadOnly);
+                this->mapFile();
+            } else {
+                file.open(QIODevice::ReadWrite);
+            }
+        }
 
     } else if (exportBinary && this->getNumRows() > 30) {
 
@@ -604,47 +650,28 @@ void csv_connection::write_node_xml(QXmlStreamWriter &xmlOut) {
         xmlOut.writeAttribute("num_connections", QString::number(float(getNumRows())));
         xmlOut.writeAttribute("explicit_delay_flag", QString::number(float(getNumCols()==3)));
 
-        // re-write the data
-        if (getNumCols()==3) {
+        // re-write the data, unless this export already holds the current version
+        if (this->exportedVersion != this->dataVersion || this->exportedPath != saveFileName || !QFile::exists(saveFileName)) {
             vector <conn> conns;
             this->getAllData(conns);
 
-            // write out
-            QFile export_file(saveFileName);
-
-            if (!export_file.open( QIODevice::WriteOnly)) {
-                QMessageBox msgBox;
-                msgBox.setText("Error creating file - is there sufficient disk space?");
-                msgBox.exec();
-                return;
-            }
-
-            QDataStream access(&export_file);
+            QByteArray exportData;
+            exportData.reserve(conns.size() * getNumCols() * sizeof(uint));
             for (uint i = 0; i < conns.size(); ++i) {
-                access.writeRawData((char*) &conns[i].src, sizeof(uint));
-                access.writeRawData((char*) &conns[i].dst, sizeof(uint));
-                access.writeRawData((char*) &conns[i].metric, sizeof(float));
+                exportData.append((char*) &conns[i].src, sizeof(uint));
+                exportData.append((char*) &conns[i].dst, sizeof(uint));
+                if (getNumCols()==3) {
+                    exportData.append((char*) &conns[i].metric, sizeof(float));
+                }
             }
-        }
-        if (getNumCols()==2) {
-            vector <conn> conns;
-            this->getAllData(conns);
 
-            // write out
-            QFile export_file(saveFileName);
-
-            if (!export_file.open( QIODevice::WriteOnly)) {
-                QMessageBox msgBox;
-                msgBox.setText("Error creating file - is there sufficient disk space?");
-                msgBox.exec();
+            // write out - a file from an earlier run with the same data is left alone
+            if (!projectObject::updateFile(saveFileName, exportData)) {
+                projectObject::reportError("Error creating file - is there sufficient disk space?");
                 return;
             }
-
-            QDataStream access(&export_file);
-            for (uint i = 0; i < conns.size(); ++i) {
-                access.writeRawData((char*) &conns[i].src, sizeof(uint));
-                access.writeRawData((char*) &conns[i].dst, sizeof(uint));
-            }
+            this->exportedVersion = this->dataVersion;
+            this->exportedPath = saveFileName;
         }
 
 
@@ -733,8 +760,18 @@ void csv_connection::import_parameters_from_xml(QDomNode &e) {
             this->setNumCols(2);
 
         // copy across file and set file name
-        // first remove existing file
-        this->file.remove();
+        // first remove existing file - never the project's own file if we were reading it in place
+        if (this->sharedFile) {
+            if (this->mapped) {
+                this->file.unmap(this->mapped);
+                this->mapped = NULL;
+            }
+            this->file.close();
+            this->sharedFile = false;
+            reservedNames.removeAll(this->filename);
+        } else {
+            this->file.remove();
+        }
 
         // get a handle to the saved file
         QSettings settings;
@@ -765,34 +802,59 @@ void csv_connection::import_parameters_from_xml(QDomNode &e) {
 
         // check that the data file exists!
         if (!savedData.open(QIODevice::ReadOnly)) {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText",  "Error: Binary file referenced in network not found: " + fileName);
-            settings.endArray();
+            diagnostics::instance()->addError("Error: Binary file referenced in network not found: " + fileName);
             return;
         }
         savedData.close();
 
-        savedData.copy(lib_dir.absoluteFilePath(this->filename));
+        if (BinaryFileList.at(0).toElement().attribute("streamed") == "true") {
+            // written as the network was read, and not part of the project, so it can be moved rather than copied
+            if (!savedData.rename(lib_dir.absoluteFilePath(this->filename))) {
+                // the library may be on another drive - copy instead, and the streamed file is removed after loading
+                if (!savedData.copy(lib_dir.absoluteFilePath(this->filename))) {
+                    diagnostics::instance()->addError("Error copying binary connection file '" + fileName + "' into the library - is there sufficient disk space?");
+                }
+            }
+        } else {
+            // take the project file's name where it is free, so the file can stay in place when saved unchanged
+            QFileInfo savedInfo(fileName);
+            if (savedInfo.suffix() == "bin" && !lib_dir.exists(savedInfo.completeBaseName()) && !reservedNames.contains(savedInfo.completeBaseName())) {
+                this->filename = savedInfo.completeBaseName();
+            }
+            this->savedPath = filePath.absoluteFilePath(fileName);
+
+            // read the project's file in place until the data is edited, rather than copying it
+            this->file.setFileName(this->savedPath);
+            if (this->file.open(QIODevice::ReadOnly)) {
+                this->sharedFile = true;
+                this->mapFile();
+                // reserve the name in the library for when the data is edited
+                reservedNames.push_back(this->filename);
+            } else {
+                // fall back to a copy in the library
+                savedData.copy(lib_dir.absoluteFilePath(this->filename));
+            }
+        }
+
+        if (!this->sharedFile) {
+            // restart the file
+            this->file.setFileName(lib_dir.absoluteFilePath(this->filename));
 
-        // restart the file
-        this->file.setFileName(lib_dir.absoluteFilePath(this->filename));
+            // open the storage file
+            if( !this->file.open( QIODevice::ReadWrite ) ) {
+                projectObject::reportError("Could not open temporary file for Explicit Connection");
+                return;}
+        }
 
-        // open the storage file
-        if( !this->file.open( QIODevice::ReadWrite ) ) {
-            QMessageBox msgBox;
-            msgBox.setText("Could not open temporary file for Explicit Connection");
-            msgBox.exec();
-            return;}
+        // the data matches the project's binary file
+        this->savedVersion = this->dataVersion;
 
     }
 
     if (BinaryFileList.count() != 1) {
 
         // load connections from xml
+        this->detachFile(false);
         file.seek(0);
         QDataStream access(&file);
 
@@ -872,15 +934,15 @@ void csv_connection::import_csv(QString fileName) {
     this->changes.clear();
 
     //wipe file;
+    this->detachFile(false);
     file.resize(0);
+    ++this->dataVersion;
 
     // open the input csv file for reading
     QFile fileIn(fileName);
 
     if( !fileIn.open( QIODevice::ReadOnly ) ) {
-        QMessageBox msgBox;
-        msgBox.setText("Could not open the selected file");
-        msgBox.exec();
+        projectObject::reportError("Could not open the selected file");
         return;}
 
     // if no filename already
@@ -923,15 +985,11 @@ void csv_connection::import_csv(QString fileName) {
         QStringList fields = line.split(",");
 
         if (fields.size() > 3) {
-            QMessageBox msgBox;
-            msgBox.setText("CSV file has too many columns");
-            msgBox.exec();
+            projectObject::reportError("CSV file has too many columns");
             return;}
 
         if (fields.size() < 2) {
-            QMessageBox msgBox;
-            msgBox.setText("CSV file has too few columns");
-            msgBox.exec();
+            projectObject::reportError("CSV file has too few columns");
             return;}
 
         if (numFields == -1) {
@@ -972,6 +1030,7 @@ int csv_connection::getNumRows() {
 
 void csv_connection::setNumRows(int num) {
     this->numRows = num;
+    ++this->dataVersion;
 }
 
 int csv_connection::getNumCols() {
@@ -979,6 +1038,7 @@ int csv_connection::getNumCols() {
 }
 
 void csv_connection::setNumCols(int num) {
+    ++this->dataVersion;
     if (num == 2) {
         this->values.clear();
         this->values.push_back("src");
@@ -997,10 +1057,20 @@ void csv_connection::getAllData(vector < conn > &conns) {
 
     //qDebug() << "ALL CONN DATA FETCHED";
 
+    // read from the mapped file where there is one
+    QByteArray mappedData;
+    QBuffer mappedBuffer(&mappedData);
+    QIODevice * source = &file;
+    if (this->mapped) {
+        mappedData = QByteArray::fromRawData((const char *) this->mapped, file.size());
+        mappedBuffer.open(QIODevice::ReadOnly);
+        source = &mappedBuffer;
+    }
+
     // rewind file
-    file.seek(0);
+    source->seek(0);
 
-    QDataStream access(&file);
+    QDataStream access(source);
 
     conns.resize(this->getNumRows());
     int counter = 0;
@@ -1042,10 +1112,20 @@ float csv_connection::getData(int rowV, int col) {
         return -1;
     }
 
-    file.seek(seekTo*4); // seek to location in bytes
+    // read from the mapped file where there is one
+    QByteArray mappedData;
+    QBuffer mappedBuffer(&mappedData);
+    QIODevice * source = &file;
+    if (this->mapped) {
+        mappedData = QByteArray::fromRawData((const char *) this->mapped, file.size());
+        mappedBuffer.open(QIODevice::ReadOnly);
+        source = &mappedBuffer;
+    }
+
+    source->seek(seekTo*4); // seek to location in bytes
 
     // get a datastream to serialise the data
-    QDataStream access(&file);
+    QDataStream access(source);
     if (col < 2) {
         quint32 data;
         access >> data;
@@ -1063,32 +1143,62 @@ float csv_connection::getData(int rowV, int col) {
 
 float csv_connection::getData(QModelIndex &index) {
 
-    int colVal = getNumCols();
-    if (colVal > 2) ++colVal;
-    // we multiply by cols +1 as QT seems to do some padding on the stream
-    int seekTo = index.row()*(colVal)+index.column();
+    return this->getData(index.row(), index.column());
 
-    if (seekTo*4 > file.size()) {
-        return -1;
+}
+
+/*!
+ * \brief csv_connection::mapFile
+ * Maps the storage file into memory for reading, if the platform allows it -
+ * otherwise reads go through the file as before.
+ */
+void csv_connection::mapFile() {
+
+    this->mapped = NULL;
+    if (this->file.isOpen() && this->file.size() > 0) {
+        this->mapped = this->file.map(0, this->file.size());
     }
+}
 
-    file.seek(seekTo*4); // seek to location in bytes
+/*!
+ * \brief csv_connection::detachFile
+ * \param copyData copy the current data across, rather than starting empty
+ * Moves a connection that reads the project's binary file in place over to
+ * its own file in the library, so it can be edited without touching the project.
+ */
+void csv_connection::detachFile(bool copyData) {
 
-    // get a datastream to serialise the data
-    QDataStream access(&file);
-    if (index.column() < 2) {
-        quint32 data;
-        access >> data;
-        return float(data);
+    if (!this->sharedFile) {
+        return;
     }
-    else {
-        float data;
-        access >> data;
-        return data;
+
+    #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    QDir lib_dir = QDir(QDesktopServices::storageLocation(QDesktopServices::DataLocation));
+    #else
+    QDir lib_dir = QDir(QStandardPaths::writableLocation(QStandardPaths::DataLocation));
+    #endif
+    QString libPath = lib_dir.absoluteFilePath(this->filename);
+
+    if (this->mapped) {
+        this->file.unmap(this->mapped);
+        this->mapped = NULL;
     }
+    this->file.close();
+    this->sharedFile = false;
 
-    return -0.1f;
+    // the name was reserved on load and now gets a file of its own
+    reservedNames.removeAll(this->filename);
+    QFile::remove(libPath);
+    if (copyData && !this->file.copy(libPath)) {
+        diagnostics::instance()->addError("Error copying binary connection file '" + this->file.fileName() + "' for editing - is there sufficient disk space?");
+    }
 
+    this->file.setFileName(libPath);
+
+    // open the storage file
+    if( !this->file.open( QIODevice::ReadWrite ) ) {
+        projectObject::reportError("Could not open temporary file for Explicit Connection");
+        return;}
 }
 
 void csv_connection::setUniqueName() {
@@ -1112,6 +1222,8 @@ void csv_connection::setUniqueName() {
     lib_dir.setNameFilters(filters);
 
     QStringList files = lib_dir.entryList();
+    // names held by connections that have no file in the library yet
+    files.append(reservedNames);
 
 
 
@@ -1142,7 +1254,8 @@ QString csv_connection::getHeader(int section) {
 
 void csv_connection::setData(const QModelIndex & index, float value) {
 
-
+    // take a copy of the data before the first edit
+    this->detachFile(true);
 
     // get a datastream to serialise the data
     file.seek(file.size());
@@ -1169,10 +1282,14 @@ void csv_connection::setData(const QModelIndex & index, float value) {
         access << (float) value;
     }
     file.flush();
+    ++this->dataVersion;
 }
 
 void csv_connection::setData(int row, int col, float value) {
 
+    // take a copy of the data before the first edit
+    this->detachFile(true);
+
     // get a datastream to serialise the data
     file.seek(file.size());
 
@@ -1198,15 +1315,16 @@ void csv_connection::setData(int row, int col, float value) {
         access << (float) value;
     }
     file.flush();
+    ++this->dataVersion;
 }
 
 void csv_connection::clearData() {
+    ++this->dataVersion;
+    this->detachFile(false);
     file.remove();
     // open the storage file
     if( !this->file.open( QIODevice::ReadWrite ) ) {
-        QMessageBox msgBox;
-        msgBox.setText("Could not open output file for conversion");
-        msgBox.exec();
+        projectObject::reportError("Could not open output file for conversion");
         return;}
 }
 
@@ -1312,17 +1430,22 @@ void kernel_connection::write_node_xml(QXmlStreamWriter &xmlOut) {
         if (changed()) {
             setUnchanged(true);
             connections.clear();
-            generate_dialog generate(this, this->src, this->dst, connections, connGenerationMutex, (QWidget *)NULL);
-            bool retVal = generate.exec();
-            if (!retVal) {
-                return;
+            if (projectObject::headless) {
+                // no progress dialog without a GUI - generate in place
+                this->conns = &connections;
+                this->mutex = connGenerationMutex;
+                generate_connections();
+            } else {
+                generate_dialog generate(this, this->src, this->dst, connections, connGenerationMutex, (QWidget *)NULL);
+                bool retVal = generate.exec();
+                if (!retVal) {
+                    return;
+                }
             }
         }
 
         if (connections.size() == 0) {
-            QMessageBox msgBox;
-            msgBox.setText("Error: no connections generated for Kernel Connection");
-            msgBox.exec();
+            projectObject::reportError("Error: no connections generated for Kernel Connection");
             return;
         }
 
@@ -1347,11 +1470,15 @@ void kernel_connection::write_node_xml(QXmlStreamWriter &xmlOut) {
 
         } else {
 
-            QUuid uuid = QUuid::createUuid();
-            QString export_filename = uuid.toString();
-            export_filename.chop(1);
-            export_filename[0] = 'C';
-            export_filename += ".bin"; // need to generate a unique filename - preferably a descriptive one... but not for now!
+            QByteArray exportData;
+            exportData.reserve(connections.size() * 2 * sizeof(uint));
+            for (uint i = 0; i < connections.size(); ++i) {
+                exportData.append((char*) &connections[i].src, sizeof(uint));
+                exportData.append((char*) &connections[i].dst, sizeof(uint));
+            }
+
+            // name the file after its content, so repeated exports of the same kernel give the same file
+            QString export_filename = "C" + QString(QCryptographicHash::hash(exportData, QCryptographicHash::Md5).toHex()) + ".bin";
             QString saveFileName = QDir::toNativeSeparators(settings.value("simulator_export_path").toString() + "/" + export_filename);
 
             // add a tag to the binary file
@@ -1360,23 +1487,12 @@ void kernel_connection::write_node_xml(QXmlStreamWriter &xmlOut) {
             xmlOut.writeAttribute("num_connections", QString::number(float(connections.size())));
             xmlOut.writeAttribute("explicit_delay_flag", QString::number(float(0)));
 
-            // re-write the data
-
             // write out
-            QFile export_file(saveFileName);
-            if (!export_file.open( QIODevice::WriteOnly)) {
-                QMessageBox msgBox;
-                msgBox.setText("Error creating file - is there sufficient disk space?");
-                msgBox.exec();
+            if (!QFile::exists(saveFileName) && !projectObject::updateFile(saveFileName, exportData)) {
+                projectObject::reportError("Error creating file - is there sufficient disk space?");
                 return;
             }
 
-            QDataStream access(&export_file);
-            for (uint i = 0; i < connections.size(); ++i) {
-                access.writeRawData((char*) &connections[i].src, sizeof(uint));
-                access.writeRawData((char*) &connections[i].dst, sizeof(uint));
-            }
-
         }
 
         this->writeDelay(xmlOut);
@@ -1980,18 +2096,29 @@ void pythonscript_connection::regenerateConnections() {
     QMutex * connGenerationMutex = new QMutex();
 
     this->connections.clear();
-    generate_dialog generate(this, this->src, this->dst, this->connections, connGenerationMutex, (QWidget *)NULL);
-    bool retVal = generate.exec();
-    if (!retVal) {
-        return;
+    if (projectObject::headless) {
+        // no progress dialog without a GUI - generate in place
+        this->conns = &this->connections;
+        this->mutex = connGenerationMutex;
+        generate_connections();
+        if (!this->errorLog.isEmpty() || !this->pythonErrors.isEmpty()) {
+            diagnostics::instance()->addError("Error generating Python Script Connection: " + this->errorLog + this->pythonErrors);
+            delete connGenerationMutex;
+            return;
+        }
+        applyGeneratedWeights();
+    } else {
+        generate_dialog generate(this, this->src, this->dst, this->connections, connGenerationMutex, (QWidget *)NULL);
+        bool retVal = generate.exec();
+        if (!retVal) {
+            return;
+        }
     }
 
     if (connections.size() == 0) {
         if (this->connection_target) {
             if (this->connection_target->getNumRows() == 0) {
-                QMessageBox msgBox;
-                msgBox.setText("Error: no connections generated for Python Script Connection");
-                msgBox.exec();
+                projectObject::reportError("Error: no connections generated for Python Script Connection");
                 delete connGenerationMutex;
                 return;
             }
@@ -2001,6 +2128,22 @@ void pythonscript_connection::regenerateConnections() {
     delete connGenerationMutex;
 }
 
+void pythonscript_connection::applyGeneratedWeights() {
+
+    // move the weights across
+    ParameterData * par = this->getPropPointer();
+    if (par && this->hasWeight) {
+        par->currType = ExplicitList;
+        par->value = this->weights;
+        // replaces any list still in a binary file
+        par->valuesFile.clear();
+        par->indices.clear();
+        for (uint i = 0; i < this->weights.size(); ++i) {
+            par->indices.push_back(i);
+        }
+    }
+}
+
 void pythonscript_connection::write_node_xml(QXmlStreamWriter &) {
 
     // this should never be called
@@ -2507,9 +2650,7 @@ void csv_connection::flushChangesToDisk() {
 
     //open file for reading
     if( !this->file.open( QIODevice::ReadOnly ) ) {
-        QMessageBox msgBox;
-        msgBox.setText("Error opening internal file - is the drive out of space?");
-        msgBox.exec();
+        projectObject::reportError("Error opening internal file - is the drive out of space?");
         }
 
     // start investigating the library and find a new filename to transfer the file to
@@ -2541,9 +2682,7 @@ void csv_connection::flushChangesToDisk() {
 
     //open new file for writing
     if( !newFile.open( QIODevice::WriteOnly ) ) {
-        QMessageBox msgBox;
-        msgBox.setText("Error opening internal file - is the drive out of space?");
-        msgBox.exec();
+        projectObject::reportError("Error opening internal file - is the drive out of space?");
         }
 
 
@@ -158,6 +158,19 @@ private:
     int numRows;
     vector < change > changes;
     void setUniqueName();
+    // bumped when the data changes, so an up to date binary file in the project is not copied again
+    uint dataVersion;
+    uint savedVersion;
+    QString savedPath;
+    uint exportedVersion;
+    QString exportedPath;
+    // set while the data is read straight from the project's binary file, which is opened read-only
+    bool sharedFile;
+    uchar * mapped;
+    // library names held by connections reading the project's file in place, which have no file of their own yet
+    static QStringList reservedNames;
+    void mapFile();
+    void detachFile(bool copyData);
 
 };
 
@@ -256,6 +269,7 @@ public:
 
     ParameterData *getPropPointer();
     QStringList getPropList();
+    void applyGeneratedWeights();
     QLayout * drawLayout(rootData * data, viewVZLayoutEditHandler * viewVZhandler, rootLayout * rootLay);
 
     // the explicit connection list to copy the generated weights to
@@ -0,0 +1,192 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+#include "diagnostics.h"
+#include <QThreadStorage>
+
+// the collector each thread reports to, if not the shared one
+static QThreadStorage < diagnostics ** > threadCollectors;
+// what the reports made on each thread are about
+static QThreadStorage < diagnosticContext ** > threadContexts;
+
+QString diagnostic::toString() const
+{
+    QString out = this->text;
+    if (!this->object.isEmpty()) {
+        out = this->object + ": " + out;
+    }
+    if (!this->file.isEmpty()) {
+        out += " (" + this->file;
+        if (this->line > 0) {
+            out += " line " + QString::number(this->line);
+        }
+        out += ")";
+    }
+    return out;
+}
+
+diagnostics * diagnostics::instance()
+{
+    static diagnostics shared;
+
+    if (threadCollectors.hasLocalData() && *threadCollectors.localData() != NULL) {
+        return *threadCollectors.localData();
+    }
+    return &shared;
+}
+
+bool diagnostics::isScoped()
+{
+    return threadCollectors.hasLocalData() && *threadCollectors.localData() != NULL;
+}
+
+void diagnostics::addError(QString text, QString file, int line, QString object)
+{
+    diagnostic item;
+    item.severity = diagnosticError;
+    item.text = text;
+    item.file = file;
+    item.line = line;
+    item.object = object;
+    add(item);
+}
+
+void diagnostics::addWarning(QString text, QString file, int line, QString object)
+{
+    diagnostic item;
+    item.severity = diagnosticWarning;
+    item.text = text;
+    item.file = file;
+    item.line = line;
+    item.object = object;
+    add(item);
+}
+
+void diagnostics::add(const diagnostic &item)
+{
+    // fill in where the report came from if the caller didn't say
+    diagnostic located = item;
+    if (threadContexts.hasLocalData() && *threadContexts.localData() != NULL) {
+        diagnosticContext * context = *threadContexts.localData();
+        if (located.file.isEmpty()) {
+            located.file = context->file;
+        }
+        if (located.object.isEmpty()) {
+            located.object = context->object;
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+    if (located.severity == diagnosticError) {
+        errors.push_back(located);
+    } else {
+        warnings.push_back(located);
+    }
+}
+
+void diagnostics::merge(diagnostics * other)
+{
+    QList < diagnostic > otherErrors = other->takeErrors();
+    QList < diagnostic > otherWarnings = other->takeWarnings();
+
+    QMutexLocker locker(&mutex);
+    errors += otherErrors;
+    warnings += otherWarnings;
+}
+
+int diagnostics::errorCount()
+{
+    QMutexLocker locker(&mutex);
+    return errors.size();
+}
+
+int diagnostics::warningCount()
+{
+    QMutexLocker locker(&mutex);
+    return warnings.size();
+}
+
+QList < diagnostic > diagnostics::takeErrors()
+{
+    QMutexLocker locker(&mutex);
+    QList < diagnostic > taken = errors;
+    errors.clear();
+    return taken;
+}
+
+QList < diagnostic > diagnostics::takeWarnings()
+{
+    QMutexLocker locker(&mutex);
+    QList < diagnostic > taken = warnings;
+    warnings.clear();
+    return taken;
+}
+
+void diagnostics::clearErrors()
+{
+    QMutexLocker locker(&mutex);
+    errors.clear();
+}
+
+void diagnostics::clearWarnings()
+{
+    QMutexLocker locker(&mutex);
+    warnings.clear();
+}
+
+diagnosticsScope::diagnosticsScope(diagnostics * collector)
+{
+    if (!threadCollectors.hasLocalData()) {
+        threadCollectors.setLocalData(new diagnostics * (NULL));
+    }
+    previous = *threadCollectors.localData();
+    *threadCollectors.localData() = collector;
+}
+
+diagnosticsScope::~diagnosticsScope()
+{
+    *threadCollectors.localData() = previous;
+}
+
+diagnosticContext::diagnosticContext(QString file, QString object)
+{
+    if (!threadContexts.hasLocalData()) {
+        threadContexts.setLocalData(new diagnosticContext * (NULL));
+    }
+    previous = *threadContexts.localData();
+    *threadContexts.localData() = this;
+
+    this->file = (file.isEmpty() && previous != NULL) ? previous->file : file;
+    this->object = (object.isEmpty() && previous != NULL) ? previous->object : object;
+}
+
+diagnosticContext::~diagnosticContext()
+{
+    *threadContexts.localData() = previous;
+}
+
+void diagnosticContext::setObject(QString object)
+{
+    this->object = object;
+}
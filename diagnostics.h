@@ -0,0 +1,135 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <QString>
+#include <QList>
+#include <QMutex>
+
+enum diagnosticSeverity {
+    diagnosticWarning,
+    diagnosticError
+};
+
+struct diagnostic {
+
+    diagnosticSeverity severity;
+    QString text;
+    // where the problem was found - empty / -1 if not known
+    QString file;
+    int line;
+    QString object;
+
+    QString toString() const;
+
+};
+
+/*!
+ * \brief The diagnostics class collects the errors and warnings found while
+ * loading, saving and exporting, so they can be reported together.
+ *
+ * All methods can be called from any thread. Reports go to the collector
+ * returned by instance(), which is a shared one unless the thread has
+ * installed its own with a diagnosticsScope - so a worker can keep its
+ * reports apart and hand them back to be merged in a fixed order.
+ */
+class diagnostics
+{
+public:
+    diagnostics() {}
+
+    static diagnostics * instance();
+
+    /*!
+     * \brief isScoped returns true while a diagnosticsScope is installed on
+     * the current thread - its owner reports the issues, not the code finding them
+     */
+    static bool isScoped();
+
+    void addError(QString text, QString file = "", int line = -1, QString object = "");
+    void addWarning(QString text, QString file = "", int line = -1, QString object = "");
+    void add(const diagnostic &item);
+    void merge(diagnostics * other);
+
+    int errorCount();
+    int warningCount();
+
+    /*!
+     * \brief takeErrors returns the errors reported so far and clears them
+     */
+    QList < diagnostic > takeErrors();
+    QList < diagnostic > takeWarnings();
+    void clearErrors();
+    void clearWarnings();
+
+private:
+    QMutex mutex;
+    QList < diagnostic > errors;
+    QList < diagnostic > warnings;
+
+    Q_DISABLE_COPY(diagnostics)
+};
+
+/*!
+ * \brief The diagnosticsScope class sends the reports made on the current
+ * thread to the given collector for as long as it exists.
+ */
+class diagnosticsScope
+{
+public:
+    diagnosticsScope(diagnostics * collector);
+    ~diagnosticsScope();
+
+private:
+    diagnostics * previous;
+};
+
+/*!
+ * \brief The diagnosticContext class names the file and object that the
+ * reports made on the current thread are about, for as long as it exists.
+ * Reports that give their own file or object keep them, and an empty file or
+ * object is taken from the context outside this one.
+ */
+class diagnosticContext
+{
+public:
+    diagnosticContext(QString file, QString object = "");
+    ~diagnosticContext();
+
+    /*!
+     * \brief setObject names the object once it is known, for the reports after
+     */
+    void setObject(QString object);
+
+private:
+    diagnosticContext * previous;
+    QString file;
+    QString object;
+
+    friend class diagnostics;
+};
+
+#endif // DIAGNOSTICS_H
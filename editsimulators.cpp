@@ -445,6 +445,7 @@ void editSimulators::getNewSimName()
         this->ui->comboBox->addItem(simName);
         this->ui->comboBox->setCurrentIndex(this->ui->comboBox->count()-1);
         this->ui->useBinary->setChecked(false);
+        this->ui->optimiseMaths->setChecked(false);
         edited = true;
     }
 
@@ -464,6 +465,7 @@ void editSimulators::selectSimulator(QString simName)
     this->path = settings.value("path").toString();
     this->working_dir = settings.value("working_dir").toString();
     ui->useBinary->setChecked(settings.value("binary").toBool());
+    ui->optimiseMaths->setChecked(settings.value("optimise_maths").toBool());
     settings.endGroup();
 
     settings.beginGroup("simulators/" + simName + "/envVar");
@@ -503,6 +505,7 @@ void editSimulators::applyChanges()
     settings.setValue("path", ui->scriptLineEdit->text());
     settings.setValue("working_dir", ui->scriptWDLineEdit->text());
     settings.setValue("binary", ui->useBinary->isChecked());
+    settings.setValue("optimise_maths", ui->optimiseMaths->isChecked());
     settings.endGroup();
 
     settings.beginGroup("simulators/" + ui->comboBox->currentText() + "/envVar");
@@ -25,6 +25,7 @@
 #include "experiment.h"
 #include "rootdata.h"
 #include "projectobject.h"
+#include "diagnostics.h"
 
 experiment::experiment()
 {
@@ -2244,20 +2245,14 @@ void exptOutput::writeXML(QXmlStreamWriter * writer, projectObject * data) {
             if (source->component->type == "neuron_body") {
                 population * pop = (population *) source->owner;
                 if (inds[i].toInt() < 0 || inds[i].toInt() > pop->numNeurons-1) {
-                    QMessageBox msgBox;
-                    msgBox.setIcon(QMessageBox::Critical);
-                    msgBox.setText("Output index out of range - indices must be between 0 and the number of neurons - 1. Output will not be logged.");
-                    msgBox.exec();
+                    projectObject::reportError("Output index out of range - indices must be between 0 and the number of neurons - 1. Output will not be logged.", pop->getName());
                     return;
                 }
             }
             if (source->component->type == "postsynapse") {
                 population * pop = ((projection *) source->owner)->destination;
                 if (inds[i].toInt() < 0 || inds[i].toInt() > pop->numNeurons-1) {
-                    QMessageBox msgBox;
-                    msgBox.setIcon(QMessageBox::Warning);
-                    msgBox.setText("Output index out of range - indices must be between 0 and the number of target neurons - 1. Output will not be logged.");
-                    msgBox.exec();
+                    projectObject::reportError("Output index out of range - indices must be between 0 and the number of target neurons - 1. Output will not be logged.", pop->getName());
                     return;
                 }
             }
@@ -2343,6 +2338,7 @@ void exptChangeProp::writeXML(QXmlStreamWriter * xmlOut, projectObject * data) {
 
       }
       if (this->par->currType == ExplicitList) {
+          this->par->loadValues();
           xmlOut->writeStartElement("UL:ValueList");
           for (uint ind = 0; ind < this->par->value.size(); ++ind) {
               xmlOut->writeEmptyElement("UL:Value");
@@ -2452,26 +2448,14 @@ void experiment::readXML(QXmlStreamReader * reader, projectObject * data) {
                                         SynapseName = reader->attributes().value("target").toString();
                                     else
                                         {
-                                        QSettings settings;
-                                        int num_errs = settings.beginReadArray("errors");
-                                        settings.endArray();
-                                        settings.beginWriteArray("errors");
-                                            settings.setArrayIndex(num_errs + 1);
-                                            settings.setValue("errorText", "Error in Experiment '" + this->name + "'' file - Target field missing");
-                                        settings.endArray();
+                                        diagnostics::instance()->addError("Error in Experiment '" + this->name + "'' file - Target field missing");
                                         } // ERROR - no target
 
                                     component = getTargetFromData(SynapseName, data);
 
                                     if (component == NULL)
                                     {
-                                        QSettings settings;
-                                        int num_errs = settings.beginReadArray("errors");
-                                        settings.endArray();
-                                        settings.beginWriteArray("errors");
-                                            settings.setArrayIndex(num_errs + 1);
-                                            settings.setValue("errorText", "Error in Experiment '" + this->name + "'' - Experiment references missing target");
-                                        settings.endArray();
+                                        diagnostics::instance()->addError("Error in Experiment '" + this->name + "'' - Experiment references missing target");
                                     }
 
                                     while(reader->readNextStartElement()) {
@@ -2590,13 +2574,7 @@ void experiment::readXML(QXmlStreamReader * reader, projectObject * data) {
                 else
                 {
                     {
-                        QSettings settings;
-                        int num_errs = settings.beginReadArray("errors");
-                        settings.endArray();
-                        settings.beginWriteArray("errors");
-                            settings.setArrayIndex(num_errs + 1);
-                            settings.setValue("errorText", "Error in Experiment '" + this->name + "'' - Experiment file badly malformed");
-                        settings.endArray();
+                        diagnostics::instance()->addError("Error in Experiment '" + this->name + "'' - Experiment file badly malformed");
                     }
                 }
             }
@@ -2604,13 +2582,7 @@ void experiment::readXML(QXmlStreamReader * reader, projectObject * data) {
         else
         {
             {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText", "Error in Experiment '" + this->name + "'' - Experiment file badly malformed");
-                settings.endArray();
+                diagnostics::instance()->addError("Error in Experiment '" + this->name + "'' - Experiment file badly malformed");
             }
         }
 
@@ -2626,13 +2598,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
         this->name = reader->attributes().value("name").toString();
     else
     {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText", "XML error in Experiment Input - 'name' attribute missing");
-        settings.endArray();
+        diagnostics::instance()->addError("XML error in Experiment Input - 'name' attribute missing");
     }
 
     // get rate distribution if there
@@ -2651,13 +2617,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
         TargetName = reader->attributes().value("target").toString();
     else
     {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText", "XML error in Experiment Input - 'target' attribute missing");
-        settings.endArray();
+        diagnostics::instance()->addError("XML error in Experiment Input - 'target' attribute missing");
     }
 
     // find Synapse in model
@@ -2666,13 +2626,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
     // handle if not found
     if (target == NULL)
     {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText", "Error in Experiment Input - references missing target " + TargetName);
-        settings.endArray();
+        diagnostics::instance()->addError("Error in Experiment Input - references missing target " + TargetName);
     }
 
     // get port name
@@ -2680,13 +2634,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
         portName = reader->attributes().value("port").toString();
     else
     {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText", "XML error in Experiment Input - 'port' attribute missing");
-        settings.endArray();
+        diagnostics::instance()->addError("XML error in Experiment Input - 'port' attribute missing");
     }
 
     // find port in Synapse
@@ -2707,13 +2655,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
         // handle if not found
         if (port == NULL)
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText", "XML error in Experiment Input - references missing port " + portName);
-            settings.endArray();
+            diagnostics::instance()->addError("XML error in Experiment Input - references missing port " + portName);
         } else {
             portName = port->name;
             portIsAnalog = port->isAnalog();
@@ -2730,13 +2672,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
             this->params.push_back(reader->attributes().value("value").toString().toFloat());
         else
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText", "XML error in Experiment Input - 'value' attribute missing");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error in Experiment Input - 'value' attribute missing");
         }
 
     } else if (reader->name() == "TimeVaryingInput") {
@@ -2753,13 +2689,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
                 {this->params.push_back(reader->attributes().value("time").toString().toFloat());}
                 else
                 {
-                    QSettings settings;
-                    int num_errs = settings.beginReadArray("errors");
-                    settings.endArray();
-                    settings.beginWriteArray("errors");
-                        settings.setArrayIndex(num_errs + 1);
-                        settings.setValue("errorText", "XML error in Experiment Input - 'time' attribute missing");
-                    settings.endArray();
+                    diagnostics::instance()->addError("XML error in Experiment Input - 'time' attribute missing");
                 }
 
                 // get value
@@ -2767,13 +2697,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
                 {this->params.push_back(reader->attributes().value("value").toString().toFloat());}
                 else
                 {
-                    QSettings settings;
-                    int num_errs = settings.beginReadArray("errors");
-                    settings.endArray();
-                    settings.beginWriteArray("errors");
-                        settings.setArrayIndex(num_errs + 1);
-                        settings.setValue("errorText", "XML error in Experiment Input - 'value' attribute missing");
-                    settings.endArray();
+                    diagnostics::instance()->addError("XML error in Experiment Input - 'value' attribute missing");
                 }
 
                 reader->readNextStartElement();
@@ -2793,13 +2717,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
             array_size = reader->attributes().value("array_size").toString().toInt();
         else
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText", "XML error in Experiment Input - 'array_size' attribute missing");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error in Experiment Input - 'array_size' attribute missing");
         }
 
         QString array;
@@ -2807,13 +2725,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
             array = reader->attributes().value("array_value").toString();
         else
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText", "XML error in Experiment Input -  missing array_value tag");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error in Experiment Input -  missing array_value tag");
         }
 
         QStringList arrayValues = array.split(",");
@@ -2824,13 +2736,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
 
         if ((int) params.size() != array_size)
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText", "Error in Experiment Input -  time and value arrays different sizes");
-            settings.endArray();
+            diagnostics::instance()->addError("Error in Experiment Input -  time and value arrays different sizes");
         }
 
     } else if (reader->name() == "TimeVaryingArrayInput") {
@@ -2849,13 +2755,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
                     this->params.push_back(reader->attributes().value("index").toString().toFloat());}
                 else
                 {
-                    QSettings settings;
-                    int num_errs = settings.beginReadArray("errors");
-                    settings.endArray();
-                    settings.beginWriteArray("errors");
-                        settings.setArrayIndex(num_errs + 1);
-                        settings.setValue("errorText", "XML error in Experiment Input - 'index' attribute missing");
-                    settings.endArray();
+                    diagnostics::instance()->addError("XML error in Experiment Input - 'index' attribute missing");
                 }
 
                 // get array_time
@@ -2864,13 +2764,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
                     array_time_string = reader->attributes().value("array_time").toString();
                 else
                 {
-                    QSettings settings;
-                    int num_errs = settings.beginReadArray("errors");
-                    settings.endArray();
-                    settings.beginWriteArray("errors");
-                        settings.setArrayIndex(num_errs + 1);
-                        settings.setValue("errorText", "XML error in Experiment Input - 'array_time' attribute missing");
-                    settings.endArray();
+                    diagnostics::instance()->addError("XML error in Experiment Input - 'array_time' attribute missing");
                 }
 
 
@@ -2881,13 +2775,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
                     array_value_string = reader->attributes().value("array_value").toString();
                 else
                 {
-                    QSettings settings;
-                    int num_errs = settings.beginReadArray("errors");
-                    settings.endArray();
-                    settings.beginWriteArray("errors");
-                        settings.setArrayIndex(num_errs + 1);
-                        settings.setValue("errorText", "XML error in Experiment Input - 'array_value' attribute missing");
-                    settings.endArray();
+                    diagnostics::instance()->addError("XML error in Experiment Input - 'array_value' attribute missing");
                 }
 
                 // unpack
@@ -2916,13 +2804,7 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
             externalInput.port = reader->attributes().value("tcp_port").toString().toInt();
         else
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText", "XML error in Experiment Input - 'tcp_port' attribute missing");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error in Experiment Input - 'tcp_port' attribute missing");
         }
 
         // not required
@@ -2939,26 +2821,14 @@ void exptInput::readXML(QXmlStreamReader * reader, projectObject * data) {
             externalInput.size = reader->attributes().value("size").toString().toInt();
         else
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText", "XML error in Experiment Input - 'size' attribute missing");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error in Experiment Input - 'size' attribute missing");
         }
 
         if (reader->attributes().hasAttribute("command"))
             externalInput.commandline = reader->attributes().value("command").toString();
         else
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText", "XML error in Experiment Input - 'command' attribute missing");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error in Experiment Input - 'command' attribute missing");
         }
 
 
@@ -2976,13 +2846,7 @@ void exptOutput::readXML(QXmlStreamReader * reader, projectObject * data) {
         this->name = reader->attributes().value("name").toString();
     else
     {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText", "Error in Experiment Input -  missing name tag");
-        settings.endArray();
+        diagnostics::instance()->addError("Error in Experiment Input -  missing name tag");
     }
 
     // get Synapse name
@@ -2991,13 +2855,7 @@ void exptOutput::readXML(QXmlStreamReader * reader, projectObject * data) {
         SynapseName = reader->attributes().value("target").toString();
     else
     {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText", "Error in Experiment Output -  missing target tag");
-        settings.endArray();
+        diagnostics::instance()->addError("Error in Experiment Output -  missing target tag");
     }
 
     // find Synapse in model
@@ -3005,13 +2863,7 @@ void exptOutput::readXML(QXmlStreamReader * reader, projectObject * data) {
 
     if (source == NULL)
     {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText", "Error in Experiment Output -  references missing target: " + SynapseName);
-        settings.endArray();
+        diagnostics::instance()->addError("Error in Experiment Output -  references missing target: " + SynapseName);
     }
 
     // get port name
@@ -3020,13 +2872,7 @@ void exptOutput::readXML(QXmlStreamReader * reader, projectObject * data) {
             portName = reader->attributes().value("port").toString();
         else
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText", "Error in Experiment Output -  missing port tag");
-            settings.endArray();
+            diagnostics::instance()->addError("Error in Experiment Output -  missing port tag");
         }
 
         // find port in Synapse
@@ -3035,13 +2881,7 @@ void exptOutput::readXML(QXmlStreamReader * reader, projectObject * data) {
 
         if (port == NULL)
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText", "Error in Experiment Output -  references missing port " + portName);
-            settings.endArray();
+            diagnostics::instance()->addError("Error in Experiment Output -  references missing port " + portName);
         }
         if (port != NULL) {
             // get indices
@@ -3076,26 +2916,14 @@ void exptOutput::readXML(QXmlStreamReader * reader, projectObject * data) {
             externalOutput.size = reader->attributes().value("size").toString().toInt();
         else
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText", "XML error in Experiment Output - 'size' attribute missing");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error in Experiment Output - 'size' attribute missing");
         }
 
         if (reader->attributes().hasAttribute("command"))
             externalOutput.commandline = reader->attributes().value("command").toString();
         else
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText", "XML error in Experiment Output - 'command' attribute missing");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error in Experiment Output - 'command' attribute missing");
         }
     }
 
@@ -3122,13 +2950,7 @@ void exptChangeProp::readXML(QXmlStreamReader * reader) {
     }
     else
     {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText", "Error in Experiment Property Change - missing name tag");
-        settings.endArray();
+        diagnostics::instance()->addError("Error in Experiment Property Change - missing name tag");
     }
 
     while (reader->readNextStartElement()) {
@@ -3142,13 +2964,7 @@ void exptChangeProp::readXML(QXmlStreamReader * reader) {
                 this->par->value[0] = reader->attributes().value("value").toString().toFloat();
             else
             {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText", "Error in Experiment Property Change - missing value tag");
-                settings.endArray();
+                diagnostics::instance()->addError("Error in Experiment Property Change - missing value tag");
             }
             reader->readNextStartElement();
         } else if (reader->name() == "UniformDistribution") {
@@ -3159,37 +2975,19 @@ void exptChangeProp::readXML(QXmlStreamReader * reader) {
                 this->par->value[1] = reader->attributes().value("minimum").toString().toFloat();
             else
             {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText", "Error in Experiment Property Change - missing minimum tag");
-                settings.endArray();
+                diagnostics::instance()->addError("Error in Experiment Property Change - missing minimum tag");
             }
             if (reader->attributes().hasAttribute("maximum"))
                 this->par->value[2] = reader->attributes().value("maximum").toString().toFloat();
             else
             {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText", "Error in Experiment Property Change - missing maximum tag");
-                settings.endArray();
+                diagnostics::instance()->addError("Error in Experiment Property Change - missing maximum tag");
             }
             if (reader->attributes().hasAttribute("seed"))
                 this->par->value[3] = reader->attributes().value("seed").toString().toFloat();
             else
             {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText", "Error in Experiment Property Change - missing seed tag");
-                settings.endArray();
+                diagnostics::instance()->addError("Error in Experiment Property Change - missing seed tag");
             }
             reader->readNextStartElement();
         } else if (reader->name() == "NormalDistribution") {
@@ -3200,37 +2998,19 @@ void exptChangeProp::readXML(QXmlStreamReader * reader) {
                 this->par->value[1] = reader->attributes().value("mean").toString().toFloat();
             else
             {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText", "Error in Experiment Property Change - missing mean tag");
-                settings.endArray();
+                diagnostics::instance()->addError("Error in Experiment Property Change - missing mean tag");
             }
             if (reader->attributes().hasAttribute("variance"))
                 this->par->value[2] = reader->attributes().value("variance").toString().toFloat();
             else
             {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText", "Error in Experiment Property Change - missing variance tag");
-                settings.endArray();
+                diagnostics::instance()->addError("Error in Experiment Property Change - missing variance tag");
             }
             if (reader->attributes().hasAttribute("seed"))
                 this->par->value[3] = reader->attributes().value("seed").toString().toFloat();
             else
             {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText", "Error in Experiment Property Change - missing seed tag");
-                settings.endArray();
+                diagnostics::instance()->addError("Error in Experiment Property Change - missing seed tag");
             }
             reader->readNextStartElement();
         } else if (reader->name() == "ValueList") {
@@ -3244,25 +3024,13 @@ void exptChangeProp::readXML(QXmlStreamReader * reader) {
                         this->par->value.push_back(reader->attributes().value("value").toString().toFloat());
                     else
                     {
-                        QSettings settings;
-                        int num_errs = settings.beginReadArray("errors");
-                        settings.endArray();
-                        settings.beginWriteArray("errors");
-                            settings.setArrayIndex(num_errs + 1);
-                            settings.setValue("errorText", "Error in Experiment Property Change - missing value tag");
-                        settings.endArray();
+                        diagnostics::instance()->addError("Error in Experiment Property Change - missing value tag");
                     }
                     if (reader->attributes().hasAttribute("index"))
                         this->par->indices.push_back(reader->attributes().value("index").toString().toFloat());
                     else
                     {
-                        QSettings settings;
-                        int num_errs = settings.beginReadArray("errors");
-                        settings.endArray();
-                        settings.beginWriteArray("errors");
-                            settings.setArrayIndex(num_errs + 1);
-                            settings.setValue("errorText", "Error in Experiment Property Change - missing index tag");
-                        settings.endArray();
+                        diagnostics::instance()->addError("Error in Experiment Property Change - missing index tag");
                     }
                 }
                 reader->readNextStartElement();
@@ -3270,13 +3038,7 @@ void exptChangeProp::readXML(QXmlStreamReader * reader) {
 
         } else {
             {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText", "Error in Experiment Property Change - type of change not recognised");
-                settings.endArray();
+                diagnostics::instance()->addError("Error in Experiment Property Change - type of change not recognised");
             }
         }
 
@@ -3297,25 +3059,13 @@ void exptLesion::readXML(QXmlStreamReader * reader, projectObject * data) {
         srcName = reader->attributes().value("src_population").toString();
     else
     {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText", "Error in Experiment Lesion - missing src_population tag");
-        settings.endArray();
+        diagnostics::instance()->addError("Error in Experiment Lesion - missing src_population tag");
     }
     if (reader->attributes().hasAttribute("dst_population"))
         dstName = reader->attributes().value("dst_population").toString();
     else
     {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText", "Error in Experiment Lesion - missing dst_population tag");
-        settings.endArray();
+        diagnostics::instance()->addError("Error in Experiment Lesion - missing dst_population tag");
     }
 
     // find projection
@@ -3329,13 +3079,7 @@ void exptLesion::readXML(QXmlStreamReader * reader, projectObject * data) {
 
     if (this->proj == NULL) {
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText", "Error in Experiment Lesion - references missing projection");
-            settings.endArray();
+            diagnostics::instance()->addError("Error in Experiment Lesion - references missing projection");
         }
     }
     this->set = true;
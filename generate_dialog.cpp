@@ -110,16 +110,7 @@ void generate_dialog::doPython() {
     } else if (!((pythonscript_connection *) currConn)->pythonErrors.isEmpty()) {
         ui->errors->setText(((pythonscript_connection *) currConn)->pythonErrors);
     } else {
-        // move the weights across
-        pythonscript_connection * currPyConn = (pythonscript_connection *) currConn;
-        ParameterData * par = currPyConn->getPropPointer();
-        if (par && currPyConn->hasWeight) {
-            par->currType = ExplicitList;
-            par->value = currPyConn->weights;
-            for (uint i = 0; i < currPyConn->weights.size(); ++i) {
-                par->indices.push_back(i);
-            }
-        }
+        ((pythonscript_connection *) currConn)->applyGeneratedWeights();
         this->accept();
     }
 
@@ -156,6 +147,12 @@ void generate_dialog::moveFromThread() {
                                 ParameterData * par = syn->weightUpdateType->ParameterList[k];
                                 par->currType = ExplicitList;
                                 par->value = currPyConn->weights;
+                                // replaces any list still in a binary file
+                                par->valuesFile.clear();
+                                par->indices.resize(par->value.size());
+                                for (uint l = 0; l < par->indices.size(); ++l) {
+                                    par->indices[l] = l;
+                                }
                             }
                         }
                     }
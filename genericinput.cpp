@@ -27,6 +27,8 @@
 #include "connection.h"
 #include "projections.h"
 #include "experiment.h"
+#include "spatialindex.h"
+#include "objectregistry.h"
 
 genericInput::genericInput()
 {
@@ -108,6 +110,8 @@ void genericInput::connect() {
     //if (srcPos == -1 && dstPos == -1) {
         dst->inputs.push_back(this);
         src->outputs.push_back(this);
+        spatialIndex::invalidate();
+        objectRegistry::invalidate();
     /*}
     else
     {
@@ -119,6 +123,9 @@ void genericInput::connect() {
 
 void genericInput::disconnect() {
 
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
+
     for (uint i = 0; i < dst->inputs.size(); ++i) {
         if (dst->inputs[i] == this) {
             dst->inputs.erase(dst->inputs.begin()+i);
@@ -307,18 +314,6 @@ void genericInput::draw(QPainter *painter, float GLscale, float viewX, float vie
                 painter->fillPath(endPoint, QColor(0,210,0,255));
             }
 
-            QPainterPath path;
-
-            // start curve drawing
-            path.moveTo(this->transformPoint(start));
-
-            // draw curves
-            for (unsigned int i = 0; i < this->curves.size(); ++i) {
-                if (this->curves.size()-1 == i)
-                    path.cubicTo(this->transformPoint(this->curves[i].C1), this->transformPoint(this->curves[i].C2), this->transformPoint(end));
-                else
-                    path.cubicTo(this->transformPoint(this->curves[i].C1), this->transformPoint(this->curves[i].C2), this->transformPoint(this->curves[i].end));
-            }
 
             // only draw number of synapses for Projections
             if (this->type == projectionObject) {
@@ -345,8 +340,11 @@ void genericInput::draw(QPainter *painter, float GLscale, float viewX, float vie
 
             }
 
-            // DRAW
-            painter->drawPath(path);
+            // DRAW - the path is cached relative to the GL origin, so panning only moves it
+            QPointF origin = this->transformPoint(QPointF(0,0));
+            painter->translate(origin);
+            painter->drawPath(this->getDrawPath(GLscale));
+            painter->translate(-origin);
             painter->setPen(oldPen);
 
             break;
@@ -359,6 +357,8 @@ void genericInput::draw(QPainter *painter, float GLscale, float viewX, float vie
 
 void genericInput::addCurves() {
 
+    spatialIndex::invalidate();
+
     // add curves for drawing:
     bezierCurve newCurve;
     newCurve.end = dst->owner->currentLocation();
@@ -458,6 +458,8 @@ void genericInput::animate(systemObject * movingObj, QPointF delta) {
 
 void genericInput::moveSelectedControlPoint(float xGL, float yGL) {
 
+    spatialIndex::invalidate();
+
     // convert to QPointF
     QPointF cursor(xGL, yGL);
     // move start
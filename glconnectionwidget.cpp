@@ -27,6 +27,8 @@
 #include "systemmodel.h"
 #include <time.h>
 #include <math.h>
+#include <algorithm>
+#include <QElapsedTimer>
 #ifdef Q_OS_MAC
 #include "glu.h"
 #else
@@ -59,16 +61,24 @@ glConnectionWidget::glConnectionWidget(rootData * data, QWidget *parent) : QGLWi
     popIndicesShown = false;
     clickedPopulation = -1;
     clickedNeuron = -1;
+    hoverPopulation = -1;
+    hoverNeuron = -1;
+    pickMatricesValid = false;
     selectedIndex = -1;
     selectedType = 1;
     connGenerationMutex = new QMutex;
+
+    // for highlighting the neuron under the mouse
+    setMouseTracking(true);
     imageSaveMode = false;
 
 
 
     connect(&timer, SIGNAL(timeout()), this, SLOT(updateLogData()));
 
-    timer.start(50);
+    // fast enough for smooth playback, colour updates are cheap
+    timer.start(30);
+    logPlaybackStep = 0;
 
     newLogTime = 0;
     currentLogTime = 0;
@@ -76,11 +86,37 @@ glConnectionWidget::glConnectionWidget(rootData * data, QWidget *parent) : QGLWi
     orthoView = false;
 
     repaintAllowed = true;
+
+    // shown while layouts are generated in the background
+    layoutProgress = new QProgressBar(this);
+    layoutProgress->setFormat("Generating layouts %v / %m");
+    layoutProgress->hide();
+    layoutsQueued = 0;
+    layoutsDone = 0;
+
+    instancingAvailable = false;
+    neuronDrawing = "display lists";
+    instancingContext = NULL;
+    logGeneration = 0;
+    dlContext = NULL;
+    dlLoD = -1;
+    statsOverlayShown = false;
+    connectionMode = allConnections;
+    connectionQuality = 1;
+    neuronProgram = NULL;
+    sphereBuffer = NULL;
+    drawArraysInstanced = NULL;
+    vertexAttribDivisor = NULL;
 }
 
 void glConnectionWidget::initializeGL()
 {
 
+    // pixmap rendering gets its own context, which uses the display lists
+    if (!imageSaveMode) {
+        setupInstancing();
+    }
+
     createPopulationsDL();
     createConnectionsDL();
 
@@ -101,16 +137,34 @@ void glConnectionWidget::clear() {
     selectedPops.clear();
     popColours.clear();
     popLogs.clear();
+    cancelLogRows();
     selectedConns.clear();
     connections.clear();
     selectedIndex = -1;
     selectedType = 1;
     model = (QAbstractTableModel *)0;
+    clickedPopulation = -1;
+    clickedNeuron = -1;
+    hoverPopulation = -1;
+    hoverNeuron = -1;
+    qDeleteAll(neuronBVHs);
+    neuronBVHs.clear();
+    dirtyPopulations.clear();
+    dirtyConnections.clear();
+    builtPopulations.clear();
+    builtConnections.clear();
+    connectionDLEdges.clear();
+    populationLoDs.clear();
+    populationDLs.clear();
+    populationBoxes.clear();
 
 }
 
 void glConnectionWidget::addLogs(QVector < logData * > * logs) {
 
+    // rows cached or being fetched may be for logs that have gone
+    cancelLogRows();
+
     // for each population
     for (uint i = 0; i < selectedPops.size(); ++i) {
 
@@ -152,6 +206,35 @@ void glConnectionWidget::updateLogData() {
 
     currentLogTime = newLogTime;
 
+    makeCurrent();
+
+    if (updateLogColours() && dirtyPopulations.size() > 0) {
+        createPopulationsDL();
+    }
+
+    // get the next rows ready while this one is drawn
+    prefetchLogRows();
+
+    // redraw!
+    this->repaint();
+
+}
+
+void glConnectionWidget::setLogTime(int index) {
+
+    // jump straight to a time, without drawing - used when rendering frames offscreen
+    newLogTime = index;
+    currentLogTime = index;
+    updateLogColours();
+}
+
+bool glConnectionWidget::updateLogColours() {
+
+    QElapsedTimer timer;
+    timer.start();
+
+    bool changed = false;
+
     // fetch data from logs
     for (uint i = 0; i < popLogs.size(); ++i) {
 
@@ -160,7 +243,7 @@ void glConnectionWidget::updateLogData() {
             continue;
 
         // get a row
-        vector < double > logValues = popLogs[i]->getRow(currentLogTime);
+        vector < double > logValues = getLogRow(popLogs[i], currentLogTime);
 
         // data not usable
         if (logValues.size() == 0)
@@ -186,11 +269,144 @@ void glConnectionWidget::updateLogData() {
                 popColours[i][j] = QColor(val1,val2, val3, 255);
             }
         }
+
+        changed = true;
+
+        // only the colours have changed - display lists have to be rebuilt though
+        if (this->isVisible() && useInstancing() && colourBuffers.contains(selectedPops[i])) {
+            updateColourBuffer(selectedPops[i]);
+        } else {
+            dirtyPopulations.insert(selectedPops[i]);
+        }
     }
 
-    // redraw!
-    this->repaint();
+    currentStats.logFetchMs += timer.nsecsElapsed() / 1000000.0;
+    return changed;
+}
+
+void glConnectionWidget::setLogPlayback(int step) {
+
+    // step is the number of rows moved each frame, or 0 when stopped
+    logPlaybackStep = step;
+    if (step > 0) {
+        prefetchLogRows();
+    }
+}
+
+vector < double > glConnectionWidget::getLogRow(logData * log, int row) {
+
+    QMap < int, vector < double > > &cache = logRowCache[log];
+
+    // forget rows we have moved past
+    QMap < int, vector < double > >::iterator cached = cache.begin();
+    while (cached != cache.end() && cached.key() < row) {
+        cached = cache.erase(cached);
+    }
+
+    if (cache.contains(row)) {
+        return cache.take(row);
+    }
+
+    return log->getRow(row);
+}
+
+static logRowJob * runLogRowJob(logRowJob * job)
+{
+    // a handle of our own, so the GUI thread can keep using the log's file
+    QFile file(job->reader.fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return job;
+    }
+
+    for (uint i = 0; i < job->rows.size(); ++i) {
+        vector < double > row = job->reader.getRow(job->rows[i], file);
+        if (row.size() == 0) {
+            break;
+        }
+        job->data[job->rows[i]] = row;
+    }
+
+    return job;
+}
+
+void glConnectionWidget::prefetchLogRows() {
+
+    if (logPlaybackStep <= 0) {
+        return;
+    }
+
+    for (uint i = 0; i < popLogs.size(); ++i) {
+
+        logData * log = popLogs[i];
+        if (log == NULL || pendingLogRows.contains(log)) {
+            continue;
+        }
+
+        logRowJob * job = new logRowJob;
+        job->log = log;
+        job->reader = log->getRowReader();
+        job->generation = logGeneration;
+        for (int k = 1; k <= LOG_PREFETCH_ROWS; ++k) {
+            int row = currentLogTime + k*logPlaybackStep;
+            if (!logRowCache[log].contains(row)) {
+                job->rows.push_back(row);
+            }
+        }
+
+        if (job->rows.size() == 0) {
+            delete job;
+            continue;
+        }
+
+        QFutureWatcher < logRowJob * > * watcher = new QFutureWatcher < logRowJob * >(this);
+        connect(watcher, SIGNAL(finished()), this, SLOT(logRowsFetched()));
+        pendingLogRows[log] = watcher;
+        watcher->setFuture(QtConcurrent::run(runLogRowJob, job));
+    }
+}
+
+void glConnectionWidget::cancelLogRows() {
+
+    // the workers only hold copies, but wait so their results are not kept for the wrong log
+    while (pendingLogRows.size() > 0) {
+        QFutureWatcher < logRowJob * > * watcher = pendingLogRows.begin().value();
+        watcher->waitForFinished();
+        delete watcher->result();
+        watcher->deleteLater();
+        pendingLogRows.erase(pendingLogRows.begin());
+    }
+    logRowCache.clear();
+    ++logGeneration;
+}
+
+void glConnectionWidget::logRowsFetched() {
+
+    QFutureWatcher < logRowJob * > * watcher = (QFutureWatcher < logRowJob * > *) sender();
+
+    // may already have been collected by clear()
+    if (pendingLogRows.key(watcher, NULL) == NULL) {
+        return;
+    }
+
+    logRowJob * job = watcher->result();
+    pendingLogRows.remove(job->log);
+    watcher->deleteLater();
+
+    // keep the rows if the log is still shown and we haven't passed them
+    if (job->generation == logGeneration && std::find(popLogs.begin(), popLogs.end(), job->log) != popLogs.end()) {
+        QMap < int, vector < double > >::iterator row = job->data.begin();
+        while (row != job->data.end()) {
+            if (row.key() >= currentLogTime) {
+                logRowCache[job->log][row.key()] = row.value();
+            }
+            ++row;
+        }
+    }
 
+    delete job;
+
+    // keep ahead of playback
+    prefetchLogRows();
 }
 
 void glConnectionWidget::resizeGL(int, int)
@@ -210,6 +426,7 @@ void glConnectionWidget::redraw() {
             population * currPop = ((population *) selectedObject);
             currPop->layoutType->locations.clear();
             currPop->layoutType->generateLayout(currPop->numNeurons,&currPop->layoutType->locations,errs);
+            populationChanged(currPop);
         }
     }
 
@@ -232,7 +449,7 @@ void glConnectionWidget::redraw(int)
     loc3Offset.y = ySpin->value();
     loc3Offset.z = zSpin->value();
 
-    createPopulationsDL();
+    // neurons are drawn relative to the population, so only the connections move
     createConnectionsDL();
 
     this->repaint();
@@ -253,9 +470,8 @@ void glConnectionWidget::allowRepaint() {
 
 void glConnectionWidget::paintEvent(QPaintEvent * /*event*/ )
 {
-    //qDebug() << "Paint event Start";
-    double clock1 = clock();
-    double clock2, clock3;
+    QElapsedTimer frameTimer;
+    frameTimer.start();
 
     // avoid repainting too fast
     if (this->repaintAllowed == false) {
@@ -272,6 +488,194 @@ void glConnectionWidget::paintEvent(QPaintEvent * /*event*/ )
     if (!this->isVisible())
         return;
 
+    if (!drawScene()) {
+        // need this as no painter!
+        swapBuffers();
+        return;
+    }
+
+    if (popIndicesShown) {
+        QPainter painter(this);
+        painter.setRenderHint(QPainter::Antialiasing);
+
+        QPen pen = painter.pen();
+        QPen oldPen = pen;
+        pen.setColor(QColor(0,0,0,255));
+        painter.setPen(pen);
+
+        float zoomVal = zoomFactor;
+        if (zoomVal < 0.3)
+            zoomVal = 0.3;
+
+        // draw text
+        for (uint locNum = 0; locNum < selectedPops.size(); ++locNum) {
+            population * currPop = selectedPops[locNum];
+            for (unsigned int i = 0; i < currPop->layoutType->locations.size(); ++i) {
+                glPushMatrix();
+
+                glTranslatef(currPop->layoutType->locations[i].x, currPop->layoutType->locations[i].y, currPop->layoutType->locations[i].z);
+
+                // if currently selected
+                if (currPop == selectedObject) {
+                    // move to pop location denoted by the spinboxes for x, y, z
+                    glTranslatef(loc3Offset.x, loc3Offset.y,loc3Offset.z);
+                } else {
+                    glTranslatef(currPop->loc3.x, currPop->loc3.y,currPop->loc3.z);
+                }
+
+                // print up text:
+                GLdouble modelviewMatrix[16];
+                GLdouble projectionMatrix[16];
+                GLint viewPort[4];
+                GLdouble winX;
+                GLdouble winY;
+                GLdouble winZ;
+                glGetIntegerv(GL_VIEWPORT, viewPort);
+                glGetDoublev(GL_MODELVIEW_MATRIX, modelviewMatrix);
+                glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
+                gluProject(0, 0, 0, modelviewMatrix, projectionMatrix, viewPort, &winX, &winY, &winZ);
+
+                winX /= RETINA_SUPPORT;
+                winY /= RETINA_SUPPORT;
+
+                if (orthoView) {
+                    winX += this->width()/4.0;
+                    winY -= this->height()/4.0;
+                }
+
+                if (imageSaveMode) {}
+                    //painter.drawText(QRect(winX-(1.0-winZ)*220-20,imageSaveHeight-winY-(1.0-winZ)*220-10,40,20),QString::number(float(i)));
+                else
+                    if (orthoView)
+                        painter.drawText(QRect(winX-(1.0-winZ)*220-10.0/zoomVal-10,this->height()-winY-(1.0-winZ)*220-10.0/zoomVal-10,40,20),QString::number(float(i)));
+                    else
+                        painter.drawText(QRect(winX-(1.0-winZ)*300-10.0/zoomVal,this->height()-winY-(1.0-winZ)*300-10.0/zoomVal,40,20),QString::number(float(i)));
+                    //painter.drawText(QRect(winX-(1.0-winZ)*600,this->height()-winY-(1.0-winZ)*600,40,20),QString::number(float(i)));
+                    //painter.drawText(QRect((winX-(1.0-winZ)*220-20),this->height()-(winY-(1.0-winZ)*220+50),40,20),QString::number(float(i)));
+
+                glPopMatrix();
+            }
+        }
+        painter.setPen(oldPen);
+        if (statsOverlayShown) {
+            drawStatsOverlay(&painter);
+        }
+        painter.end();
+    } else {
+        if (statsOverlayShown) {
+            QPainter painter(this);
+            drawStatsOverlay(&painter);
+            painter.end();
+        } else {
+            // if the painter isn't there this doesn't get called!
+            swapBuffers();
+        }
+
+        // Make sure the clicked population exists and is visible
+        if (0 <= clickedPopulation &&  clickedPopulation <= data->populations.size())
+        {
+            if (data->populations[clickedPopulation]->isVisualised)
+            {
+                population * currPop = data->populations[clickedPopulation];
+
+                if (0 <= clickedNeuron && clickedNeuron <= currPop->layoutType->locations.size())
+                {
+                    QPainter painter(this);
+                    painter.setRenderHint(QPainter::Antialiasing);
+
+                    QPen pen = painter.pen();
+                    QPen oldPen = pen;
+                    pen.setColor(QColor(0,0,0,255));
+                    painter.setPen(pen);
+
+                    float zoomVal = zoomFactor;
+                    if (zoomVal < 0.3)
+                        zoomVal = 0.3;
+
+                    // draw text
+
+                    glPushMatrix();
+
+                    glTranslatef(currPop->layoutType->locations[clickedNeuron].x, currPop->layoutType->locations[clickedNeuron].y, currPop->layoutType->locations[clickedNeuron].z);
+
+                    // if currently selected
+                    if (currPop == selectedObject) {
+                        // move to pop location denoted by the spinboxes for x, y, z
+                        glTranslatef(loc3Offset.x, loc3Offset.y,loc3Offset.z);
+                    } else {
+                        glTranslatef(currPop->loc3.x, currPop->loc3.y,currPop->loc3.z);
+                    }
+
+                    // print up text:
+                    GLdouble modelviewMatrix[16];
+                    GLdouble projectionMatrix[16];
+                    GLint viewPort[4];
+                    GLdouble winX;
+                    GLdouble winY;
+                    GLdouble winZ;
+                    glGetIntegerv(GL_VIEWPORT, viewPort);
+                    glGetDoublev(GL_MODELVIEW_MATRIX, modelviewMatrix);
+                    glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
+                    gluProject(0, 0, 0, modelviewMatrix, projectionMatrix, viewPort, &winX, &winY, &winZ);
+
+                    winX /= RETINA_SUPPORT;
+                    winY /= RETINA_SUPPORT;
+
+                    if (orthoView) {
+                        winX += this->width()/4.0;
+                        winY -= this->height()/4.0;
+                    }
+
+
+                    QString neuronInfo = "";
+                    neuronInfo += "Population: " + currPop->getName();
+                    neuronInfo += "\n";
+                    neuronInfo += "Neuron: " + QString::number(float(clickedNeuron));
+                    QRect textRect;
+
+                    if (imageSaveMode) {}
+                        //painter.drawText(QRect(winX-(1.0-winZ)*220-20,imageSaveHeight-winY-(1.0-winZ)*220-10,40,20),QString::number(float(i)));
+                    else {
+                        if (orthoView)
+                            textRect = QRect(winX-(1.0-winZ)*220-10.0/zoomVal-10,this->height()-winY-(1.0-winZ)*220-10.0/zoomVal-10,80,30);
+                        else
+                            textRect = QRect(winX-(1.0-winZ)*300-10.0/zoomVal,this->height()-winY-(1.0-winZ)*300-10.0/zoomVal,80,30);
+
+                        painter.drawText(textRect, Qt::TextDontClip, neuronInfo);
+                        painter.setBrush(Qt::NoBrush);
+                        QFont myFont;
+                        QFontMetrics fm(myFont);
+                        QRect border = fm.boundingRect(textRect, Qt::TextDontClip, neuronInfo);
+                        //Add some padding to make sure you can read
+                        border.adjust (-5, -5, 5, 5);
+                        painter.drawRect(border);
+                    }
+                        //painter.drawText(QRect(winX-(1.0-winZ)*600,this->height()-winY-(1.0-winZ)*600,40,20),QString::number(float(i)));
+                        //painter.drawText(QRect((winX-(1.0-winZ)*220-20),this->height()-(winY-(1.0-winZ)*220+50),40,20),QString::number(float(i)));
+
+                    glPopMatrix();
+
+                    painter.setPen(oldPen);
+                    painter.end();
+                }
+            }
+        }
+    }
+
+
+    glPopMatrix();
+
+    // this frame is done - start counting the next
+    currentStats.frameMs = frameTimer.nsecsElapsed() / 1000000.0;
+    statsHistory.push_back(currentStats);
+    if (statsHistory.size() > RENDER_STATS_HISTORY) {
+        statsHistory.removeFirst();
+    }
+    currentStats = renderStats();
+}
+
+bool glConnectionWidget::drawScene()
+{
     // get rid of old stuff
     if (imageSaveMode) {
         QColor qtCol = QColor::fromRgbF(1.0,1.0,1.0,0.0);
@@ -325,6 +729,14 @@ void glConnectionWidget::paintEvent(QPaintEvent * /*event*/ )
     glPushMatrix();
     glTranslatef(0,0,-5.0);
 
+    // keep the view for picking neurons under the mouse
+    if (!imageSaveMode) {
+        glGetDoublev(GL_MODELVIEW_MATRIX, pickModelview);
+        glGetDoublev(GL_PROJECTION_MATRIX, pickProjection);
+        glGetIntegerv(GL_VIEWPORT, pickViewport);
+        pickMatricesValid = true;
+    }
+
     // if previewing a layout then override normal drawing
     if (locations.size() > 0) {
         qDebug() << "CHECK - Previewing is active, this was not changed";
@@ -344,11 +756,12 @@ void glConnectionWidget::paintEvent(QPaintEvent * /*event*/ )
         }
 
         glPopMatrix();
-        // need this as no painter!
-        swapBuffers();
-        return;
+        return false;
     }
 
+    QElapsedTimer stageTimer;
+    stageTimer.start();
+
     for (uint i = 0; i < data->populations.size(); i++) {
         if (data->populations[i]->isVisualised) {
             glPushMatrix();
@@ -360,14 +773,39 @@ void glConnectionWidget::paintEvent(QPaintEvent * /*event*/ )
                 glTranslatef(data->populations[i]->loc3.x, data->populations[i]->loc3.y,data->populations[i]->loc3.z);
             }
 
-            glCallList(data->populations[i]->dlIndex);
+            // skip populations that are off screen, and draw the rest in as much detail as can be seen
+            float screenRadius = getNeuronScreenRadius(data->populations[i]);
+            if (screenRadius < 0) {
+                ++currentStats.culled;
+            } else {
+                drawPopulation(i, screenRadius);
+                currentStats.neurons += data->populations[i]->layoutType->locations.size();
+            }
+            glPopMatrix();
+        }
+    }
+
+    // highlight the neuron under the mouse
+    if (!imageSaveMode && 0 <= hoverPopulation && hoverPopulation < (int) data->populations.size()) {
+        population * hoverPop = data->populations[hoverPopulation];
+        if (hoverPop->isVisualised && 0 <= hoverNeuron && hoverNeuron < (int) hoverPop->layoutType->locations.size()) {
+            glPushMatrix();
+            if (hoverPop == selectedObject) {
+                glTranslatef(loc3Offset.x, loc3Offset.y,loc3Offset.z);
+            } else {
+                glTranslatef(hoverPop->loc3.x, hoverPop->loc3.y,hoverPop->loc3.z);
+            }
+            glTranslatef(hoverPop->layoutType->locations[hoverNeuron].x, hoverPop->layoutType->locations[hoverNeuron].y, hoverPop->layoutType->locations[hoverNeuron].z);
+            this->drawNeuron(0.6, 16, 16, QColor(255,255,0,120));
+            ++currentStats.glCalls;
             glPopMatrix();
         }
     }
+    currentStats.populationMs += stageTimer.nsecsElapsed() / 1000000.0;
 
 
     // draw synapses
-    clock2 = clock();
+    stageTimer.restart();
     for (uint targNum = 0; targNum < this->selectedConns.size(); ++targNum) {
 
         // draw the connections:
@@ -433,6 +871,10 @@ void glConnectionWidget::paintEvent(QPaintEvent * /*event*/ )
                     // fetch connections back here:
                     connections[targNum].clear();
                     csv_conn->getAllData(connections[targNum]);
+                    // and the index ranges are now out of date
+                    if (connVertices.contains(selectedConns[targNum])) {
+                        clearConnectionVertices(connVertices[selectedConns[targNum]]);
+                    }
                 }
             }
         }
@@ -464,99 +906,113 @@ void glConnectionWidget::paintEvent(QPaintEvent * /*event*/ )
                 aux_strength = currObj->strength;
                 center = currObj->center;
             }
+            ++currentStats.glCalls;
+            currentStats.edges += connectionDLEdges.value(selectedConns[targNum], 0);
 
             // draw selected connections on top
             glDisable(GL_DEPTH_TEST);
             if (selectedConns[targNum] == selectedObject) {
 
-                for (uint i = 0; i < connections[targNum].size(); ++i) {
-
-                    if (connections[targNum][i].src < src->layoutType->locations.size() && connections[targNum][i].dst < dst->layoutType->locations.size()) {
-                        glLineWidth(1.0*lineScaleFactor);
+                connectionVertices * verts = getConnectionVertices(targNum, src, dst, conn, srcX, srcY, srcZ, dstX, dstY, dstZ);
 
-                        glColor4f(0.0, 0.0, 0.0, 0.1);
+                // only visit the connections that are highlighted, using the index ranges
+                // 0 = not highlighted, 1 = table column match, 2 = table row, 3 = selected neuron
+                QMap < uint, int > highlighted;
 
-                        // find if selected
-                        bool isSelected = false;
+                for (uint j = 0; j < (uint) selection.count(); ++j) {
+                    uint row = selection[j].row();
+                    if (row >= connections[targNum].size()) {
+                        continue;
+                    }
+                    if (selection[j].column() == 0 && connections[targNum][row].src < verts->srcStart.size() - 1) {
+                        uint index = connections[targNum][row].src;
+                        for (uint k = verts->srcStart[index]; k < verts->srcStart[index+1]; ++k) {
+                            highlighted[verts->srcOrder[k]] = qMax(highlighted.value(verts->srcOrder[k], 0), 1);
+                        }
+                    }
+                    if (selection[j].column() == 1 && connections[targNum][row].dst < verts->dstStart.size() - 1) {
+                        uint index = connections[targNum][row].dst;
+                        for (uint k = verts->dstStart[index]; k < verts->dstStart[index+1]; ++k) {
+                            highlighted[verts->dstOrder[k]] = qMax(highlighted.value(verts->dstOrder[k], 0), 1);
+                        }
+                    }
+                    highlighted[row] = qMax(highlighted.value(row, 0), 2);
+                }
 
-                        for (uint j = 0; j < (uint) selection.count(); ++j) {
-                            if (i == (uint) selection[j].row())
-                            {
-                                glLineWidth(2.0*lineScaleFactor);
-                                glColor4f(1.0, 0.0, 0.0, 1.0);
-                                isSelected = true;
-                                break;
-                            }
-                            if (connections[targNum][i].src == connections[targNum][selection[j].row()].src && selection[j].column() == 0)
-                            {
-                                glLineWidth(1.5*lineScaleFactor);
-                                glColor4f(0.0, 1.0, 0.0, 0.8);
-                                isSelected = true;
-                            }
-                            if (connections[targNum][i].dst == connections[targNum][selection[j].row()].dst && selection[j].column() == 1)
-                            {
-                                glLineWidth(1.5*lineScaleFactor);
-                                glColor4f(0.0, 1.0, 0.0, 0.8);
-                                isSelected = true;
-                            }
+                if (selectedIndex >= 0) {
+                    vector < GLuint > &start = selectedType == 1 ? verts->srcStart : verts->dstStart;
+                    vector < GLuint > &order = selectedType == 1 ? verts->srcOrder : verts->dstOrder;
+                    if ((uint) selectedIndex < start.size() - 1) {
+                        for (uint k = start[selectedIndex]; k < start[selectedIndex+1]; ++k) {
+                            highlighted[order[k]] = 3;
                         }
+                    }
+                }
 
-                        if (((int) connections[targNum][i].src == selectedIndex && selectedType == 1) \
-                                || ((int) connections[targNum][i].dst == selectedIndex && selectedType == 2))
-                        {
+                for (QMap < uint, int >::iterator it = highlighted.begin(); it != highlighted.end(); ++it) {
+
+                    uint i = it.key();
+
+                    if (connections[targNum][i].src < src->layoutType->locations.size() && connections[targNum][i].dst < dst->layoutType->locations.size()) {
+
+                        if (it.value() == 3) {
                             glLineWidth(1.5*lineScaleFactor);
                             glColor4f(0.0, 1.0, 0.0, 1.0);
-                            isSelected = true;
+                        } else if (it.value() == 2) {
+                            glLineWidth(2.0*lineScaleFactor);
+                            glColor4f(1.0, 0.0, 0.0, 1.0);
+                        } else {
+                            glLineWidth(1.5*lineScaleFactor);
+                            glColor4f(0.0, 1.0, 0.0, 0.8);
                         }
 
-                        if (isSelected) {
-                            // draw in
+                        // draw in
 
-                            // Decide the control points
-                            GLfloat ctrlpoints[aux_strength+2][3];
-                            for (int strenghtIndex = 1; strenghtIndex <= aux_strength; strenghtIndex++) {
-                                ctrlpoints[strenghtIndex][0] = center[0];
-                                ctrlpoints[strenghtIndex][1] = center[1];
-                                ctrlpoints[strenghtIndex][2] = center[2];
-                            }
+                        // Decide the control points
+                        GLfloat ctrlpoints[aux_strength+2][3];
+                        for (int strenghtIndex = 1; strenghtIndex <= aux_strength; strenghtIndex++) {
+                            ctrlpoints[strenghtIndex][0] = center[0];
+                            ctrlpoints[strenghtIndex][1] = center[1];
+                            ctrlpoints[strenghtIndex][2] = center[2];
+                        }
 
-                            if (src->isVisualised && dst->isVisualised) {
-                                ctrlpoints[0][0] = src->layoutType->locations[connections[targNum][i].src].x+srcX;
-                                ctrlpoints[0][1] = src->layoutType->locations[connections[targNum][i].src].y+srcY;
-                                ctrlpoints[0][2] = src->layoutType->locations[connections[targNum][i].src].z+srcZ;
-                                ctrlpoints[aux_strength+1][0] = dst->layoutType->locations[connections[targNum][i].dst].x+dstX;
-                                ctrlpoints[aux_strength+1][1] = dst->layoutType->locations[connections[targNum][i].dst].y+dstY;
-                                ctrlpoints[aux_strength+1][2] = dst->layoutType->locations[connections[targNum][i].dst].z+dstZ;
-                            }
-                            if (src->isVisualised && !dst->isVisualised) {
-                                ctrlpoints[0][0] = src->layoutType->locations[connections[targNum][i].src].x;
-                                ctrlpoints[0][1] = src->layoutType->locations[connections[targNum][i].src].y;
-                                ctrlpoints[0][2] = src->layoutType->locations[connections[targNum][i].src].z;
-                                ctrlpoints[aux_strength+1][0] = dstX;
-                                ctrlpoints[aux_strength+1][1] = dstY;
-                                ctrlpoints[aux_strength+1][2] = dstZ;
-                            }
-                            if (!src->isVisualised && dst->isVisualised) {
-                                ctrlpoints[0][0] = src->loc3.x;
-                                ctrlpoints[0][1] = src->loc3.y;
-                                ctrlpoints[0][2] = src->loc3.z;
-                                ctrlpoints[aux_strength+1][0] = dst->layoutType->locations[connections[targNum][i].dst].x;
-                                ctrlpoints[aux_strength+1][1] = dst->layoutType->locations[connections[targNum][i].dst].y;
-                                ctrlpoints[aux_strength+1][2] = dst->layoutType->locations[connections[targNum][i].dst].z;
-                            }
+                        if (src->isVisualised && dst->isVisualised) {
+                            ctrlpoints[0][0] = src->layoutType->locations[connections[targNum][i].src].x+srcX;
+                            ctrlpoints[0][1] = src->layoutType->locations[connections[targNum][i].src].y+srcY;
+                            ctrlpoints[0][2] = src->layoutType->locations[connections[targNum][i].src].z+srcZ;
+                            ctrlpoints[aux_strength+1][0] = dst->layoutType->locations[connections[targNum][i].dst].x+dstX;
+                            ctrlpoints[aux_strength+1][1] = dst->layoutType->locations[connections[targNum][i].dst].y+dstY;
+                            ctrlpoints[aux_strength+1][2] = dst->layoutType->locations[connections[targNum][i].dst].z+dstZ;
+                        }
+                        if (src->isVisualised && !dst->isVisualised) {
+                            ctrlpoints[0][0] = src->layoutType->locations[connections[targNum][i].src].x;
+                            ctrlpoints[0][1] = src->layoutType->locations[connections[targNum][i].src].y;
+                            ctrlpoints[0][2] = src->layoutType->locations[connections[targNum][i].src].z;
+                            ctrlpoints[aux_strength+1][0] = dstX;
+                            ctrlpoints[aux_strength+1][1] = dstY;
+                            ctrlpoints[aux_strength+1][2] = dstZ;
+                        }
+                        if (!src->isVisualised && dst->isVisualised) {
+                            ctrlpoints[0][0] = src->loc3.x;
+                            ctrlpoints[0][1] = src->loc3.y;
+                            ctrlpoints[0][2] = src->loc3.z;
+                            ctrlpoints[aux_strength+1][0] = dst->layoutType->locations[connections[targNum][i].dst].x;
+                            ctrlpoints[aux_strength+1][1] = dst->layoutType->locations[connections[targNum][i].dst].y;
+                            ctrlpoints[aux_strength+1][2] = dst->layoutType->locations[connections[targNum][i].dst].z;
+                        }
 
 
-                            glMap1f(GL_MAP1_VERTEX_3, 0.0, 1.0, 3, aux_strength+2, &ctrlpoints[0][0]);
-                            glEnable(GL_MAP1_VERTEX_3);
+                        glMap1f(GL_MAP1_VERTEX_3, 0.0, 1.0, 3, aux_strength+2, &ctrlpoints[0][0]);
+                        glEnable(GL_MAP1_VERTEX_3);
 
-                            // Draw the line between the neurons
-                            glBegin(GL_LINE_STRIP);
+                        // Draw the line between the neurons
+                        glBegin(GL_LINE_STRIP);
 
-                            for (int k = 0; k <= 30; k++)
-                                glEvalCoord1f((GLfloat) k/30.0);
+                        for (int k = 0; k <= 30; k++)
+                            glEvalCoord1f((GLfloat) k/30.0);
 
-                            glEnd();
-                        }
+                        glEnd();
+                        ++currentStats.glCalls;
                     } else {
                         // ERR - CONNECTION INDEX OUT OF RANGE
                     }
@@ -567,195 +1023,58 @@ void glConnectionWidget::paintEvent(QPaintEvent * /*event*/ )
 
         }
 
+        // the rest are drawn from vertex buffers that are only rebuilt when something changes
+        if (conn->type == OnetoOne || conn->type == AlltoAll || conn->type == FixedProb) {
 
+            connectionVertices * verts = getConnectionVertices(targNum, src, dst, conn, srcX, srcY, srcZ, dstX, dstY, dstZ);
 
-        if (conn->type == OnetoOne) {
-
-            if (src->numNeurons == dst->numNeurons) {
-
-                if (src->layoutType->locations.size() > 0 && dst->layoutType->locations.size() > 0) {
-
-                    for (uint i = 0; i < src->layoutType->locations.size(); ++i) {
-
-                        glLineWidth(1.5*lineScaleFactor);
-                        glColor4f(0.0, 0.0, 1.0, 0.8);
-
-                         // draw in
-                        glBegin(GL_LINES);
-                        glVertex3f(src->layoutType->locations[i].x+srcX, src->layoutType->locations[i].y+srcY, src->layoutType->locations[i].z+srcZ);
-                        glVertex3f(dst->layoutType->locations[i].x+dstX, dst->layoutType->locations[i].y+dstY, dst->layoutType->locations[i].z+dstZ);
-                        glEnd();
-
-                    }
-                }
-
-                if (src->layoutType->locations.size() > 0 && dst->layoutType->locations.size() == 0) {
-
-                    for (uint i = 0; i < src->layoutType->locations.size(); ++i) {
-
-                        glLineWidth(1.5*lineScaleFactor);
-                        glColor4f(0.0, 0.0, 1.0, 0.8);
-                        // draw in
-                        glBegin(GL_LINES);
-                        glVertex3f(src->layoutType->locations[i].x+srcX, src->layoutType->locations[i].y+srcY, src->layoutType->locations[i].z+srcZ);
-                        glVertex3f(dstX, dstY, dstZ);
-                        glEnd();
-
-                    }
-                }
-
-                if (src->layoutType->locations.size() == 0 && dst->layoutType->locations.size() > 0) {
-
-                    for (uint i = 0; i < dst->layoutType->locations.size(); ++i) {
-
-                        glLineWidth(1.5*lineScaleFactor);
-                        glColor4f(0.0, 0.0, 1.0, 0.8);
-                        // draw in
-                        glBegin(GL_LINES);
-                        glVertex3f(srcX, srcY, srcZ);
-                        glVertex3f(dst->layoutType->locations[i].x+dst->loc3.x, dst->layoutType->locations[i].y+dst->loc3.y, dst->layoutType->locations[i].z+dst->loc3.z);
-                        glEnd();
-
-                    }
-                }
+            QColor colour;
+            if (conn->type == OnetoOne) {
+                glLineWidth(1.5*lineScaleFactor);
+                colour = QColor::fromRgbF(0.0, 0.0, 1.0, 0.8);
             }
-        }
-
-        if (conn->type == AlltoAll) {
-
-            if (src->layoutType->locations.size() > 0 && dst->layoutType->locations.size() > 0) {
-
-                for (uint i = 0; i < src->layoutType->locations.size(); ++i) {
-                    for (uint j = 0; j <  dst->layoutType->locations.size(); ++j) {
-
-                        glLineWidth(1.5*lineScaleFactor);
-                        glColor4f(0.0, 0.0, 1.0, 0.2);
-                        // draw in
-                        glBegin(GL_LINES);
-                        glVertex3f(src->layoutType->locations[i].x+srcX, src->layoutType->locations[i].y+srcY, src->layoutType->locations[i].z+srcZ);
-                        glVertex3f(dst->layoutType->locations[j].x+dstX, dst->layoutType->locations[j].y+dstY, dst->layoutType->locations[j].z+dstZ);
-                        glEnd();
-
-                    }
-                }
+            if (conn->type == AlltoAll) {
+                glLineWidth(1.5*lineScaleFactor);
+                colour = QColor::fromRgbF(0.0, 0.0, 1.0, 0.2);
             }
-            if (src->layoutType->locations.size() > 0 && dst->layoutType->locations.size() == 0) {
-
-                for (uint i = 0; i < src->layoutType->locations.size(); ++i) {
-
-                    glLineWidth(1.5*lineScaleFactor);
-                    glColor4f(0.0, 0.0, 1.0, 0.2);
-                    // draw in
-                    glBegin(GL_LINES);
-                    glVertex3f(src->layoutType->locations[i].x+srcX, src->layoutType->locations[i].y+srcY, src->layoutType->locations[i].z+srcZ);
-                    glVertex3f(dstX, dstY, dstZ);
-                    glEnd();
-                }
+            if (conn->type == FixedProb) {
+                glLineWidth(1.0*lineScaleFactor);
+                colour = QColor::fromRgbF(0.0, 0.0, 0.0, 0.1);
             }
-            if (src->layoutType->locations.size() == 0 && dst->layoutType->locations.size() > 0) {
-
-                 for (uint j = 0; j <  dst->layoutType->locations.size(); ++j) {
-
-                    glLineWidth(1.5*lineScaleFactor);
-                    glColor4f(0.0, 0.0, 1.0, 0.2);
-                    // draw in
-                    glBegin(GL_LINES);
-                    glVertex3f(srcX, srcY, srcZ);
-                    glVertex3f(dst->layoutType->locations[j].x+dstX, dst->layoutType->locations[j].y+dstY, dst->layoutType->locations[j].z+dstZ);
-                    glEnd();
-                }
+            glColor4f(colour.redF(), colour.greenF(), colour.blueF(), colour.alphaF());
+            drawConnectionVertices(verts, 0, verts->vertices.size() / 3, NULL);
+            currentStats.edges += verts->vertices.size() / 6;
+
+            if (verts->bundles.size() > 0) {
+                drawConnectionBundles(verts->bundles, 0, NULL, lineScaleFactor, colour);
+                ++currentStats.glCalls;
+                currentStats.edges += verts->bundles.size();
             }
-        }
-
-        if (conn->type == FixedProb) {
-
-            random.setSeed(((fixedProb_connection *) conn)->seed);
-
-            prob = ((fixedProb_connection *) conn)->p;
-
-            // generate a list of projections to highlight
-            vector < loc > redrawLocs;
-
-            for (uint i = 0; i < src->layoutType->locations.size(); ++i) {
-                for (uint j = 0; j <  dst->layoutType->locations.size(); ++j) {
-                    if (random.value() < this->prob) {
-                        glLineWidth(1.0*lineScaleFactor);
-                        glColor4f(0.0, 0.0, 0.0, 0.1);
 
-                        if (((int) i == selectedIndex && selectedType == 1) \
-                                || ((int) j == selectedIndex && selectedType == 2))
-                        {
-                            // store for redraw of selected connections
-                            loc pstart;
-                            loc pend;
-
-                            if ((src->layoutType->locations.size() > 0 && dst->layoutType->locations.size() > 0) \
-                                    || (src->layoutType->locations.size() > 0 && dst->layoutType->locations.size() == 0)) {
-                                pstart.x = src->layoutType->locations[i].x+srcX;
-                                pstart.y = src->layoutType->locations[i].y+srcY;
-                                pstart.z = src->layoutType->locations[i].z+srcZ;
-                            }
-                            if (src->layoutType->locations.size() == 0 && dst->layoutType->locations.size() > 0) {
-                                pstart.x = srcX;
-                                pstart.y = srcY;
-                                pstart.z = srcZ;
-                            }
-                            if ((src->layoutType->locations.size() > 0 && dst->layoutType->locations.size() > 0) \
-                                    || (src->layoutType->locations.size() == 0 && dst->layoutType->locations.size() > 0)) {
-                                pend.x = dst->layoutType->locations[j].x+dstX;
-                                pend.y = dst->layoutType->locations[j].y+dstY;
-                                pend.z = dst->layoutType->locations[j].z+dstZ;
-                            }
-                            if (src->layoutType->locations.size() > 0 && dst->layoutType->locations.size() == 0) {
-                                pend.x = dstX;
-                                pend.y = dstY;
-                                pend.z = dstZ;
-                            }
-                            redrawLocs.push_back(pstart);
-                            redrawLocs.push_back(pend);
-                        }
-                        else
-                        {
-                            // draw in
-                            glBegin(GL_LINES);
-                            if (src->layoutType->locations.size() > 0 && dst->layoutType->locations.size() > 0) {
-                                glVertex3f(src->layoutType->locations[i].x+srcX, src->layoutType->locations[i].y+srcY, src->layoutType->locations[i].z+srcZ);
-                                glVertex3f(dst->layoutType->locations[j].x+dstX, dst->layoutType->locations[j].y+dstY, dst->layoutType->locations[j].z+dstZ);
-                            }
-                            if (src->layoutType->locations.size() > 0 && dst->layoutType->locations.size() == 0) {
-                                glVertex3f(src->layoutType->locations[i].x+srcX, src->layoutType->locations[i].y+srcY, src->layoutType->locations[i].z+srcZ);
-                                glVertex3f(dstX, dstY, dstZ);
-                            }
-                            if (src->layoutType->locations.size() == 0 && dst->layoutType->locations.size() > 0) {
-                                glVertex3f(srcX, srcY, srcZ);
-                                glVertex3f(dst->layoutType->locations[j].x+dstX, dst->layoutType->locations[j].y+dstY, dst->layoutType->locations[j].z+dstZ);
-                            }
-                            glEnd();
-                        }
-                    }
-                }
-            }
             // redraw selected (over the top of everything else so no depth test):
-            glDisable(GL_DEPTH_TEST);
-
-            for (uint i=0; i < redrawLocs.size(); i+=2) {
+            if (conn->type == FixedProb && selectedIndex >= 0) {
 
-                // redraw
+                glDisable(GL_DEPTH_TEST);
                 glLineWidth(1.5*lineScaleFactor);
                 glColor4f(0.0, 0.0, 1.0, 0.8);
-                glBegin(GL_LINES);
-                glVertex3f(redrawLocs[i].x, redrawLocs[i].y,redrawLocs[i].z);
-                glVertex3f(redrawLocs[i+1].x, redrawLocs[i+1].y,redrawLocs[i+1].z);
-                glEnd();
-            }
-
 
+                if (selectedType == 1 && (uint) selectedIndex < verts->srcStart.size() - 1) {
+                    GLuint first = verts->srcStart[selectedIndex];
+                    GLuint count = verts->srcStart[selectedIndex+1] - first;
+                    drawConnectionVertices(verts, first*2, count*2, NULL);
+                }
+                if (selectedType == 2 && (uint) selectedIndex < verts->dstStart.size() - 1) {
+                    GLuint first = verts->dstStart[selectedIndex];
+                    GLuint count = verts->dstStart[selectedIndex+1] - first;
+                    drawConnectionVertices(verts, first*2, count*2, &verts->dstIndices[0]);
+                }
+            }
         }
 
         glEnable(GL_DEPTH_TEST);
         glEnable(GL_LIGHTING);
     }
-    clock3 = clock();
+    currentStats.connectionMs += stageTimer.nsecsElapsed() / 1000000.0;
 
     glDisable(GL_BLEND);
     glDisable(GL_POLYGON_SMOOTH);
@@ -768,243 +1087,77 @@ void glConnectionWidget::paintEvent(QPaintEvent * /*event*/ )
 
     glMatrixMode(GL_MODELVIEW);
 
+    // the view matrix is left pushed for drawing labels over the scene
+    return true;
+}
 
-    if (popIndicesShown) {
-        QPainter painter(this);
-        painter.setRenderHint(QPainter::Antialiasing);
-
-        QPen pen = painter.pen();
-        QPen oldPen = pen;
-        pen.setColor(QColor(0,0,0,255));
-        painter.setPen(pen);
-
-        float zoomVal = zoomFactor;
-        if (zoomVal < 0.3)
-            zoomVal = 0.3;
+void glConnectionWidget::drawNeuron(GLfloat r, int rings, int segments, QColor col) {
 
-        // draw text
-        for (uint locNum = 0; locNum < selectedPops.size(); ++locNum) {
-            population * currPop = selectedPops[locNum];
-            for (unsigned int i = 0; i < currPop->layoutType->locations.size(); ++i) {
-                glPushMatrix();
+    // draw a sphere to represent a neuron
+    int i, j;
+    for(i = 0; i <= rings; i++) {
+        double rings0 = M_PI * (-0.5 + (double) (i - 1) / rings);
+        double z0  = sin(rings0);
+        double zr0 =  cos(rings0);
 
-                glTranslatef(currPop->layoutType->locations[i].x, currPop->layoutType->locations[i].y, currPop->layoutType->locations[i].z);
+        double rings1 = M_PI * (-0.5 + (double) i / rings);
+        double z1 = sin(rings1);
+        double zr1 = cos(rings1);
 
-                // if currently selected
-                if (currPop == selectedObject) {
-                    // move to pop location denoted by the spinboxes for x, y, z
-                    glTranslatef(loc3Offset.x, loc3Offset.y,loc3Offset.z);
-                } else {
-                    glTranslatef(currPop->loc3.x, currPop->loc3.y,currPop->loc3.z);
-                }
+        glBegin(GL_QUAD_STRIP);
+        for(j = 0; j <= segments; j++) {
+            double segment = 2 * M_PI * (double) (j - 1) / segments;
+            double x = cos(segment);
+            double y = sin(segment);
 
-                // print up text:
-                GLdouble modelviewMatrix[16];
-                GLdouble projectionMatrix[16];
-                GLint viewPort[4];
-                GLdouble winX;
-                GLdouble winY;
-                GLdouble winZ;
-                glGetIntegerv(GL_VIEWPORT, viewPort);
-                glGetDoublev(GL_MODELVIEW_MATRIX, modelviewMatrix);
-                glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
-                gluProject(0, 0, 0, modelviewMatrix, projectionMatrix, viewPort, &winX, &winY, &winZ);
+            glNormal3f(x * zr0, y * zr0, z0);
+            glColor4f(col.redF(), col.greenF(), col.blueF(), col.alphaF());
+            glVertex3f(x * zr0*r, y * zr0*r, z0*r);
+            glNormal3f(x * zr1, y * zr1, z1);
+            glColor4f(col.redF(), col.greenF(), col.blueF(), col.alphaF());
+            glVertex3f(x * zr1*r, y * zr1*r, z1*r);
+        }
+        glEnd();
+    }
 
-                winX /= RETINA_SUPPORT;
-                winY /= RETINA_SUPPORT;
+}
 
-                if (orthoView) {
-                    winX += this->width()/4.0;
-                    winY -= this->height()/4.0;
-                }
+void glConnectionWidget::setupView() {
 
-                if (imageSaveMode) {}
-                    //painter.drawText(QRect(winX-(1.0-winZ)*220-20,imageSaveHeight-winY-(1.0-winZ)*220-10,40,20),QString::number(float(i)));
-                else
-                    if (orthoView)
-                        painter.drawText(QRect(winX-(1.0-winZ)*220-10.0/zoomVal-10,this->height()-winY-(1.0-winZ)*220-10.0/zoomVal-10,40,20),QString::number(float(i)));
-                    else
-                        painter.drawText(QRect(winX-(1.0-winZ)*300-10.0/zoomVal,this->height()-winY-(1.0-winZ)*300-10.0/zoomVal,40,20),QString::number(float(i)));
-                    //painter.drawText(QRect(winX-(1.0-winZ)*600,this->height()-winY-(1.0-winZ)*600,40,20),QString::number(float(i)));
-                    //painter.drawText(QRect((winX-(1.0-winZ)*220-20),this->height()-(winY-(1.0-winZ)*220+50),40,20),QString::number(float(i)));
+    int width;
+    int height;
 
-                glPopMatrix();
-            }
-        }
-        painter.setPen(oldPen);
-        painter.end();
+    if (imageSaveMode) {
+        width = imageSaveWidth;
+        height = imageSaveHeight;
     } else {
-        // if the painter isn't there this doesn't get called!
-        swapBuffers();
+        width = this->width()*RETINA_SUPPORT;
+        height = this->height()*RETINA_SUPPORT;
+    }
 
-        // Make sure the clicked population exists and is visible
-        if (0 <= clickedPopulation &&  clickedPopulation <= data->populations.size())
-        {
-            if (data->populations[clickedPopulation]->isVisualised)
-            {
-                population * currPop = data->populations[clickedPopulation];
+    glViewport(0, 0, width, height);
 
-                if (0 <= clickedNeuron && clickedNeuron <= currPop->layoutType->locations.size())
-                {
-                    QPainter painter(this);
-                    painter.setRenderHint(QPainter::Antialiasing);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
 
-                    QPen pen = painter.pen();
-                    QPen oldPen = pen;
-                    pen.setColor(QColor(0,0,0,255));
-                    painter.setPen(pen);
+    // move view
+    if (!orthoView)
+        gluPerspective(60.0,((GLfloat)width)/((GLfloat)height), 1.0, 100000.0);
+    else {
+        float scale = zoomFactor*10.0;
+        float aspect = ((GLfloat)height)/((GLfloat)width);
+        glOrtho(-scale, scale, -scale*aspect, scale*aspect, -100, 100000.0);
+    }
 
-                    float zoomVal = zoomFactor;
-                    if (zoomVal < 0.3)
-                        zoomVal = 0.3;
 
-                    // draw text
+    // preview mode
+    if (locations.size() > 0) {
 
-                    glPushMatrix();
+        loc maxes;
+        loc mins;
 
-                    glTranslatef(currPop->layoutType->locations[clickedNeuron].x, currPop->layoutType->locations[clickedNeuron].y, currPop->layoutType->locations[clickedNeuron].z);
-
-                    // if currently selected
-                    if (currPop == selectedObject) {
-                        // move to pop location denoted by the spinboxes for x, y, z
-                        glTranslatef(loc3Offset.x, loc3Offset.y,loc3Offset.z);
-                    } else {
-                        glTranslatef(currPop->loc3.x, currPop->loc3.y,currPop->loc3.z);
-                    }
-
-                    // print up text:
-                    GLdouble modelviewMatrix[16];
-                    GLdouble projectionMatrix[16];
-                    GLint viewPort[4];
-                    GLdouble winX;
-                    GLdouble winY;
-                    GLdouble winZ;
-                    glGetIntegerv(GL_VIEWPORT, viewPort);
-                    glGetDoublev(GL_MODELVIEW_MATRIX, modelviewMatrix);
-                    glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
-                    gluProject(0, 0, 0, modelviewMatrix, projectionMatrix, viewPort, &winX, &winY, &winZ);
-
-                    winX /= RETINA_SUPPORT;
-                    winY /= RETINA_SUPPORT;
-
-                    if (orthoView) {
-                        winX += this->width()/4.0;
-                        winY -= this->height()/4.0;
-                    }
-
-
-                    QString neuronInfo = "";
-                    neuronInfo += "Population: " + currPop->getName();
-                    neuronInfo += "\n";
-                    neuronInfo += "Neuron: " + QString::number(float(clickedNeuron));
-                    QRect textRect;
-
-                    if (imageSaveMode) {}
-                        //painter.drawText(QRect(winX-(1.0-winZ)*220-20,imageSaveHeight-winY-(1.0-winZ)*220-10,40,20),QString::number(float(i)));
-                    else {
-                        if (orthoView)
-                            textRect = QRect(winX-(1.0-winZ)*220-10.0/zoomVal-10,this->height()-winY-(1.0-winZ)*220-10.0/zoomVal-10,80,30);
-                        else
-                            textRect = QRect(winX-(1.0-winZ)*300-10.0/zoomVal,this->height()-winY-(1.0-winZ)*300-10.0/zoomVal,80,30);
-
-                        painter.drawText(textRect, Qt::TextDontClip, neuronInfo);
-                        painter.setBrush(Qt::NoBrush);
-                        QFont myFont;
-                        QFontMetrics fm(myFont);
-                        QRect border = fm.boundingRect(textRect, Qt::TextDontClip, neuronInfo);
-                        //Add some padding to make sure you can read
-                        border.adjust (-5, -5, 5, 5);
-                        painter.drawRect(border);
-                    }
-                        //painter.drawText(QRect(winX-(1.0-winZ)*600,this->height()-winY-(1.0-winZ)*600,40,20),QString::number(float(i)));
-                        //painter.drawText(QRect((winX-(1.0-winZ)*220-20),this->height()-(winY-(1.0-winZ)*220+50),40,20),QString::number(float(i)));
-
-                    glPopMatrix();
-
-                    painter.setPen(oldPen);
-                    painter.end();
-                }
-            }
-        }
-    }
-
-
-    glPopMatrix();
-
-    double diffticks=clock()-clock1;
-    double diffms=(diffticks)/(CLOCKS_PER_SEC/1000);
-
-    qDebug() << "Paint event: " << diffms;
-    qDebug() << "Time connections: " << (clock3-clock2)/(CLOCKS_PER_SEC/1000);
-}
-
-void glConnectionWidget::drawNeuron(GLfloat r, int rings, int segments, QColor col) {
-
-    // draw a sphere to represent a neuron
-    int i, j;
-    for(i = 0; i <= rings; i++) {
-        double rings0 = M_PI * (-0.5 + (double) (i - 1) / rings);
-        double z0  = sin(rings0);
-        double zr0 =  cos(rings0);
-
-        double rings1 = M_PI * (-0.5 + (double) i / rings);
-        double z1 = sin(rings1);
-        double zr1 = cos(rings1);
-
-        glBegin(GL_QUAD_STRIP);
-        for(j = 0; j <= segments; j++) {
-            double segment = 2 * M_PI * (double) (j - 1) / segments;
-            double x = cos(segment);
-            double y = sin(segment);
-
-            glNormal3f(x * zr0, y * zr0, z0);
-            glColor4f(col.redF(), col.greenF(), col.blueF(), col.alphaF());
-            glVertex3f(x * zr0*r, y * zr0*r, z0*r);
-            glNormal3f(x * zr1, y * zr1, z1);
-            glColor4f(col.redF(), col.greenF(), col.blueF(), col.alphaF());
-            glVertex3f(x * zr1*r, y * zr1*r, z1*r);
-        }
-        glEnd();
-    }
-
-}
-
-void glConnectionWidget::setupView() {
-
-    int width;
-    int height;
-
-    if (imageSaveMode) {
-        width = imageSaveWidth;
-        height = imageSaveHeight;
-    } else {
-        width = this->width()*RETINA_SUPPORT;
-        height = this->height()*RETINA_SUPPORT;
-    }
-
-    glViewport(0, 0, width, height);
-
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-
-    // move view
-    if (!orthoView)
-        gluPerspective(60.0,((GLfloat)width)/((GLfloat)height), 1.0, 100000.0);
-    else {
-        float scale = zoomFactor*10.0;
-        float aspect = ((GLfloat)height)/((GLfloat)width);
-        glOrtho(-scale, scale, -scale*aspect, scale*aspect, -100, 100000.0);
-    }
-
-
-    // preview mode
-    if (locations.size() > 0) {
-
-        loc maxes;
-        loc mins;
-
-        maxes.x = -INFINITY; maxes.y = -INFINITY; maxes.z = -INFINITY;
-        mins.x = INFINITY; mins.y = INFINITY; mins.z = INFINITY;
+        maxes.x = -INFINITY; maxes.y = -INFINITY; maxes.z = -INFINITY;
+        mins.x = INFINITY; mins.y = INFINITY; mins.z = INFINITY;
 
         for (uint locNum = 0; locNum < locations[0].size(); ++locNum) {
             if (locations[0][locNum].x > maxes.x) {
@@ -1281,6 +1434,8 @@ void glConnectionWidget::parsChangedPopulation(int value) {
             // invalidate logs as size of pop has changed
             popLogs[i] = NULL;
             popColours[i].clear();
+
+            populationChanged(currPop);
         }
     }
 
@@ -1306,6 +1461,8 @@ void glConnectionWidget::parsChangedPopulation(double) {
             if (!errs.isEmpty()) {
                 //this->data->statusBarUpdate(errs,2000);
             }
+
+            populationChanged(currPop);
         }
     }
 
@@ -1332,6 +1489,8 @@ void glConnectionWidget::parsChangedPopulation() {
             if (!errs.isEmpty()) {
                 //this->data->statusBarUpdate(errs,2000);
             }
+
+            populationChanged(currPop);
         }
     }
 
@@ -1366,6 +1525,7 @@ void glConnectionWidget::parsChangedProjections() {
             // refresh the connections
             if (((kernel_connection *) conn)->changed()) {
                 connections[i].clear();
+                dirtyConnections.insert(selectedConns[i]);
                 // launch version increment dialog box:
                 generate_dialog generate(((kernel_connection *) conn), ((kernel_connection *) conn)->src, ((kernel_connection *) conn)->dst, connections[i], connGenerationMutex, this);
                 bool retVal = generate.exec();
@@ -1383,6 +1543,7 @@ void glConnectionWidget::parsChangedProjections() {
             // refresh the connections
             if (((pythonscript_connection *) conn)->changed()) {
                 connections[i].clear();
+                dirtyConnections.insert(selectedConns[i]);
                 // launch version increment dialog box:
                 generate_dialog generate(((pythonscript_connection *) conn), ((pythonscript_connection *) conn)->src, ((pythonscript_connection *) conn)->dst, connections[i], connGenerationMutex, this);
                 bool retVal = generate.exec();
@@ -1397,6 +1558,7 @@ void glConnectionWidget::parsChangedProjections() {
 
     }
 
+    createConnectionsDL();
 
     // redraw:
     repaint();
@@ -1448,6 +1610,7 @@ void glConnectionWidget::parsChangedProjection() {
                     // refresh the connections
                     if (((kernel_connection *) conn)->changed()) {
                         connections[i].clear();
+                        dirtyConnections.insert(selectedConns[i]);
                         // launch version increment dialog box:
                         generate_dialog generate(((kernel_connection *) conn), src, dst, connections[i], connGenerationMutex, this);
                         bool retVal = generate.exec();
@@ -1476,6 +1639,7 @@ void glConnectionWidget::parsChangedProjection() {
                     // refresh the connections
                     if (((pythonscript_connection *) conn)->changed()) {
                         connections[i].clear();
+                        dirtyConnections.insert(selectedConns[i]);
                         // launch version increment dialog box:
                         generate_dialog generate(((pythonscript_connection *) conn), src, dst, connections[i], connGenerationMutex, this);
                         bool retVal = generate.exec();
@@ -1491,6 +1655,7 @@ void glConnectionWidget::parsChangedProjection() {
 
         }
 
+        createConnectionsDL();
 
         // redraw:
         repaint();
@@ -1536,6 +1701,7 @@ void glConnectionWidget::refreshAll() {
             if (!errs.isEmpty()) {
                 this->data->updateStatusBar(errs,2000);
             }
+            populationChanged(currPop);
         }
 
     }
@@ -1546,6 +1712,8 @@ void glConnectionWidget::refreshAll() {
         // check pointer is valid
         if (!data->isValidPointer(selectedConns[i])) {
             // remove
+            builtConnections.remove(selectedConns[i]);
+            dirtyConnections.remove(selectedConns[i]);
             selectedConns.erase(selectedConns.begin()+i);
             connections.erase(connections.begin()+i);
             --i;
@@ -1555,6 +1723,8 @@ void glConnectionWidget::refreshAll() {
         // check it isn't deleted
         if (selectedConns[i]->isDeleted) {
             // remove
+            builtConnections.remove(selectedConns[i]);
+            dirtyConnections.remove(selectedConns[i]);
             selectedConns.erase(selectedConns.begin()+i);
             connections.erase(connections.begin()+i);
             --i;
@@ -1569,6 +1739,44 @@ void glConnectionWidget::refreshAll() {
     createConnectionsDL();
 }
 
+void glConnectionWidget::populationChanged(population * pop) {
+
+    // the neurons need rebuilding, and so does everything connected to them
+    dirtyPopulations.insert(pop);
+    for (uint i = 0; i < selectedConns.size(); ++i) {
+
+        population * src;
+        population * dst;
+        if (selectedConns[i]->type == synapseObject) {
+            synapse * currTarg = (synapse *) selectedConns[i];
+            src = currTarg->proj->source;
+            dst = currTarg->proj->destination;
+        } else {
+            genericInput * currIn = (genericInput *) selectedConns[i];
+            src = (population *) currIn->source;
+            dst = (population *) currIn->destination;
+        }
+
+        if (src == pop || dst == pop) {
+            dirtyConnections.insert(selectedConns[i]);
+        }
+    }
+}
+
+void glConnectionWidget::populationMoved(population * pop) {
+
+    // the neurons are drawn relative to the population, so only the attached connections change
+    if (pop == selectedObject) {
+        loc3Offset.x = pop->loc3.x;
+        loc3Offset.y = pop->loc3.y;
+        loc3Offset.z = pop->loc3.z;
+    }
+
+    makeCurrent();
+    createConnectionsDL();
+    this->repaint();
+}
+
 void glConnectionWidget::setConnType(connectionType cType) {
 
     this->currProjectionType = cType;
@@ -1620,6 +1828,7 @@ void glConnectionWidget::getConnections() {
 
                     // refresh the connections
                     connections[i].clear();
+                    dirtyConnections.insert(selectedConns[i]);
                     ((csv_connection *) currTarg->connectionType)->getAllData(connections[i]);
                     //qDebug() << "FETCHING CONNS";
 
@@ -1628,6 +1837,8 @@ void glConnectionWidget::getConnections() {
         }
     }
 
+    createConnectionsDL();
+
     // force a redraw
     repaint();
 }
@@ -1724,6 +1935,7 @@ void glConnectionWidget::sysSelectionChanged(QModelIndex, QModelIndex) {
                         // remove from list if there
                         for (uint p = 0; p < this->selectedConns.size(); ++p) {
                             if (selectedConns[p] == currIn) {
+                                builtConnections.remove(selectedConns[p]);
                                 selectedConns.erase(selectedConns.begin()+p);
                                 connections.erase(connections.begin()+p);
                             }
@@ -1797,6 +2009,7 @@ void glConnectionWidget::sysSelectionChanged(QModelIndex, QModelIndex) {
                     // if in list then remove from list
                     for (uint p = 0; p < this->selectedConns.size(); ++p) {
                         if (selectedConns[p] == currTarg) {
+                            builtConnections.remove(selectedConns[p]);
                             selectedConns.erase(selectedConns.begin()+p);
                             connections.erase(connections.begin()+p);
                         }
@@ -1846,75 +2059,117 @@ void glConnectionWidget::mousePressEvent(QMouseEvent *event)
     origRot.setY(origRot.y() - rot.y()*2);
 
 
-    // Alg that detectes clicked object
+    // find the clicked neuron
     if (button == Qt::LeftButton)
     {
-        glDisable(GL_LIGHTING);
+        int popIndex;
+        int neuronIndex;
+        if (pickNeuron(event->pos(), popIndex, neuronIndex)) {
+            clickedPopulation = popIndex;
+            clickedNeuron = neuronIndex;
+        } else {
+            clickedPopulation = -1;
+            clickedNeuron = -1;
+        }
+        this->repaint();
+    }
+}
 
-        glPushMatrix();
-        glLoadIdentity();
-        glTranslatef(0,0,-5.0);
-        for (uint i = 0; i < data->populations.size(); i++) {
-            if (data->populations[i]->isVisualised) {
-                glPushMatrix();
-                // if currently selected
-                if (data->populations[i] == selectedObject) {
-                    // move to pop location denoted by the spinboxes for x, y, z
-                    glTranslatef(loc3Offset.x, loc3Offset.y,loc3Offset.z);
-                } else {
-                    glTranslatef(data->populations[i]->loc3.x, data->populations[i]->loc3.y,data->populations[i]->loc3.z);
-                }
+neuronBVH * glConnectionWidget::getNeuronBVH(population * pop)
+{
+    if (neuronBVHs.contains(pop) && neuronBVHs[pop]->size() == pop->layoutType->locations.size()) {
+        return neuronBVHs[pop];
+    }
 
-                glCallList(data->populations[i]->dlIndexCol);
-                glPopMatrix();
-            }
-        }
-        glPopMatrix();
+    if (neuronBVHs.contains(pop)) {
+        delete neuronBVHs[pop];
+    }
+    neuronBVH * bvh = new neuronBVH(pop->layoutType->locations, 0.5);
+    neuronBVHs[pop] = bvh;
+    return bvh;
+}
 
-        // Color picking to detect seleceted neuron
-        unsigned char detectedColor[3];
-        GLint viewport[4];
-        // The the pixel from the GPU
-        glGetIntegerv(GL_VIEWPORT, viewport);
-        glReadPixels(event->x(), this->height() - event->y(),1,1, GL_RGB, GL_UNSIGNED_BYTE, detectedColor);
+bool glConnectionWidget::pickNeuron(QPoint point, int &popIndex, int &neuronIndex)
+{
+    popIndex = -1;
+    neuronIndex = -1;
 
-        // Make sure the population exists and is visible
-        if (0 <= detectedColor[0] &&  detectedColor[0] <= data->populations.size()) {
-            if (data->populations[detectedColor[0]]->isVisualised)
-            {
-                int selectedNeuron = (detectedColor[2] << 8) + detectedColor[1];
+    if (!data || !pickMatricesValid) {
+        return false;
+    }
 
-                population * currPop = data->populations[detectedColor[0]];
+    // ray through the mouse from the near to the far plane
+    GLdouble winX = point.x()*RETINA_SUPPORT;
+    GLdouble winY = pickViewport[3] - point.y()*RETINA_SUPPORT;
+    GLdouble nearX, nearY, nearZ;
+    GLdouble farX, farY, farZ;
+    if (gluUnProject(winX, winY, 0.0, pickModelview, pickProjection, pickViewport, &nearX, &nearY, &nearZ) == GL_FALSE || \
+            gluUnProject(winX, winY, 1.0, pickModelview, pickProjection, pickViewport, &farX, &farY, &farZ) == GL_FALSE) {
+        return false;
+    }
 
-                if (0 <= selectedNeuron && selectedNeuron <= currPop->layoutType->locations.size())
-                {
-                    clickedPopulation = detectedColor[0];
-                    clickedNeuron = selectedNeuron;
-                    this->repaint();
-                }
-                else
-                {
-                    clickedNeuron = -1;
-                }
-            }
-            else
-            {
-                clickedPopulation = -1;
-            }
+    loc dir;
+    dir.x = farX - nearX;
+    dir.y = farY - nearY;
+    dir.z = farZ - nearZ;
+
+    float nearestT = INFINITY;
+
+    for (uint i = 0; i < data->populations.size(); ++i) {
+
+        population * currPop = data->populations[i];
+
+        if (!currPop->isVisualised || currPop->layoutType->locations.size() == 0) {
+            continue;
         }
-        else
-        {
-            clickedPopulation = -1;
+
+        // move the ray into the population's frame
+        loc origin;
+        if (currPop == selectedObject) {
+            origin.x = nearX - loc3Offset.x;
+            origin.y = nearY - loc3Offset.y;
+            origin.z = nearZ - loc3Offset.z;
+        } else {
+            origin.x = nearX - currPop->loc3.x;
+            origin.y = nearY - currPop->loc3.y;
+            origin.z = nearZ - currPop->loc3.z;
+        }
+
+        float t;
+        int hit = getNeuronBVH(currPop)->intersect(origin, dir, t);
+        if (hit != -1 && t < nearestT) {
+            nearestT = t;
+            popIndex = i;
+            neuronIndex = hit;
         }
     }
+
+    return popIndex != -1;
 }
 
 void glConnectionWidget::mouseReleaseEvent(QMouseEvent *){
     setCursor(Qt::ArrowCursor);
+    button = Qt::NoButton;
 }
 
 void glConnectionWidget::mouseMoveEvent(QMouseEvent *event){
 
+    // just hovering
+    if (button == Qt::NoButton) {
+        int popIndex;
+        int neuronIndex;
+        if (!pickNeuron(event->pos(), popIndex, neuronIndex)) {
+            popIndex = -1;
+            neuronIndex = -1;
+        }
+        if (popIndex != hoverPopulation || neuronIndex != hoverNeuron) {
+            hoverPopulation = popIndex;
+            hoverNeuron = neuronIndex;
+            repaint();
+        }
+        return;
+    }
+
     if (button == Qt::LeftButton) {
         pos.setX(-(origPos.x() - event->globalPos().x())*0.01*zoomFactor);
         pos.setY((origPos.y() - event->globalPos().y())*0.01*zoomFactor);
@@ -1925,149 +2180,1172 @@ void glConnectionWidget::mouseMoveEvent(QMouseEvent *event){
         rot.setY(-(origRot.y() - event->globalPos().y())*0.5);
     }
 
-    repaint();
-
+    repaint();
+
+}
+
+void glConnectionWidget::wheelEvent(QWheelEvent *event){
+
+    float val = float(event->delta()) / 320.0;
+    val = pow(2.0f,val);
+    if (event->orientation() == Qt::Vertical) {
+        this->zoomFactor *= (val);
+        if (this->zoomFactor < 0.00001)
+            zoomFactor = 1;
+        repaint();
+    }
+}
+
+void glConnectionWidget::setPopIndicesShown(bool checkState){
+    popIndicesShown = checkState;
+    repaint();
+}
+
+void glConnectionWidget::setStatsOverlayShown(bool checkState){
+    statsOverlayShown = checkState;
+    repaint();
+}
+
+void glConnectionWidget::drawStatsOverlay(QPainter * painter) {
+
+    // show the last complete frame - the current one is still being drawn
+    if (statsHistory.isEmpty())
+        return;
+    const renderStats &stats = statsHistory.last();
+
+    QStringList lines;
+    lines << QString("Frame: %1 ms (%2 fps)").arg(stats.frameMs, 0, 'f', 2).arg(stats.frameMs > 0 ? 1000.0 / stats.frameMs : 0, 0, 'f', 1);
+    lines << QString("Populations: %1 ms").arg(stats.populationMs, 0, 'f', 2);
+    lines << QString("Connections: %1 ms").arg(stats.connectionMs, 0, 'f', 2);
+    lines << QString("Display lists: %1 ms").arg(stats.displayListMs, 0, 'f', 2);
+    lines << QString("Layout: %1 ms").arg(stats.layoutMs, 0, 'f', 2);
+    lines << QString("Log fetch: %1 ms").arg(stats.logFetchMs, 0, 'f', 2);
+    lines << QString("Neurons: %1").arg(stats.neurons);
+    lines << QString("Populations culled: %1").arg(stats.culled);
+    lines << QString("Edges: %1").arg(stats.edges);
+    lines << QString("GL calls: %1").arg(stats.glCalls);
+    lines << QString("Neurons drawn with: %1").arg(neuronDrawing);
+    QString text = lines.join("\n");
+
+    painter->save();
+    QFontMetrics fm(painter->font());
+    QRect textRect = fm.boundingRect(QRect(0, 0, 400, 400), Qt::AlignLeft | Qt::AlignTop, text);
+    textRect.moveTo(15, 15);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(QColor(255,255,255,200));
+    painter->drawRect(textRect.adjusted(-5, -5, 5, 5));
+    painter->setPen(QColor(0,0,0,255));
+    painter->drawText(textRect, Qt::AlignLeft | Qt::AlignTop, text);
+    painter->restore();
+}
+
+void glConnectionWidget::exportRenderStats() {
+
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export render timings"), "", tr("CSV files (*.csv)"));
+    if (fileName.isEmpty())
+        return;
+
+    if (!fileName.endsWith(".csv", Qt::CaseInsensitive))
+        fileName.append(".csv");
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QMessageBox msgBox;
+        msgBox.setText("Could not open file '" + fileName + "' for writing");
+        msgBox.exec();
+        return;
+    }
+
+    QTextStream out(&file);
+    out << "frame,frame_ms,layout_ms,display_list_ms,population_ms,connection_ms,log_fetch_ms,culled,neurons,edges,gl_calls\n";
+    for (int i = 0; i < statsHistory.size(); ++i) {
+        const renderStats &stats = statsHistory[i];
+        out << i << "," << stats.frameMs << "," << stats.layoutMs << "," << stats.displayListMs << ","
+            << stats.populationMs << "," << stats.connectionMs << "," << stats.logFetchMs << ","
+            << stats.culled << "," << stats.neurons << "," << stats.edges << "," << stats.glCalls << "\n";
+    }
+    file.close();
+}
+
+void glConnectionWidget::selectedNrnChanged(int index) {
+
+    QString type = sender()->property("type").toString();
+
+    if (type == "index")
+        selectedIndex = index;
+    else if (type == "from") {
+        selectedType = index+1;
+    }
+
+    repaint();
+
+}
+
+// picks budget of the count indices, the same ones each time, in order
+static void sampleConnectionIndices(quint64 count, uint budget, vector < quint64 > &indices)
+{
+    indices.clear();
+    if (budget >= count) {
+        for (quint64 i = 0; i < count; ++i) {
+            indices.push_back(i);
+        }
+        return;
+    }
+    indices.reserve(budget);
+    RNG sampleRandom;
+    sampleRandom.setSeed(CONNECTION_SAMPLE_SEED);
+    // one index from each of budget equal runs, so only the indices taken are visited
+    quint64 step = count / budget;
+    quint64 remainder = count % budget;
+    for (uint i = 0; i < budget; ++i) {
+        quint64 start = step * i + remainder * i / budget;
+        quint64 end = step * (i + 1) + remainder * (i + 1) / budget;
+        quint64 offset = quint64(sampleRandom.value() * (end - start));
+        indices.push_back(start + qMin(offset, end - start - 1));
+    }
+}
+
+static layoutJob * runLayoutJob(layoutJob * job)
+{
+    QElapsedTimer timer;
+    timer.start();
+    job->layout->generateLayout(job->numNeurons, &job->locations, job->errs);
+    job->ms = timer.nsecsElapsed() / 1000000.0;
+    return job;
+}
+
+int glConnectionWidget::getPopulationLoD()
+{
+    // fetch quality setting
+    QSettings settings;
+    int quality = settings.value("glOptions/detail", 5).toInt();
+
+    // draw with a level of detail dependant on the number on neurons we must draw
+    // sum neurons across all pops we'll draw
+    int totalNeurons = 0;
+    for (uint locNum = 0; locNum < data->populations.size(); ++locNum) {
+        totalNeurons += data->populations[locNum]->numNeurons;
+    }
+    int LoD = round(250.0f/float(totalNeurons)*pow(2,float(quality)));
+
+    // draw with a level of detail dependant on the number on neurons we must draw
+    // put some bounds on
+    if (LoD < 4) LoD = 4; if (LoD > 32) LoD = 32;
+    if (imageSaveMode)
+        LoD = 64;
+
+    // to the power of two below, so it matches one of the sphere meshes
+    int level = MIN_NEURON_LOD;
+    while (level * 2 <= LoD) level *= 2;
+
+    return level;
+}
+
+float glConnectionWidget::getNeuronScreenRadius(population * pop)
+{
+    // returns the radius in pixels of the nearest neuron, or -1 if the population can't be seen
+    if (!populationBoxes.contains(pop)) {
+        return INFINITY;
+    }
+    populationBounds &box = populationBoxes[pop];
+
+    GLdouble modelview[16];
+    GLdouble projection[16];
+    GLint viewport[4];
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // take the corners of the box into clip space - if all are outside one plane the box is off screen
+    int outside[6] = {0,0,0,0,0,0};
+    double nearestW = INFINITY;
+    for (int corner = 0; corner < 8; ++corner) {
+        double point[4] = {corner & 1 ? box.maximum.x : box.minimum.x, corner & 2 ? box.maximum.y : box.minimum.y, corner & 4 ? box.maximum.z : box.minimum.z, 1.0};
+        double eye[4];
+        double clip[4];
+        for (int row = 0; row < 4; ++row) {
+            eye[row] = 0;
+            for (int col = 0; col < 4; ++col) eye[row] += modelview[col*4+row]*point[col];
+        }
+        for (int row = 0; row < 4; ++row) {
+            clip[row] = 0;
+            for (int col = 0; col < 4; ++col) clip[row] += projection[col*4+row]*eye[col];
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            if (clip[axis] < -clip[3]) ++outside[axis*2];
+            if (clip[axis] > clip[3]) ++outside[axis*2+1];
+        }
+        nearestW = qMin(nearestW, clip[3]);
+    }
+    for (int plane = 0; plane < 6; ++plane) {
+        if (outside[plane] == 8) {
+            return -1;
+        }
+    }
+
+    // images are always drawn in full, as is anything that reaches behind the camera
+    if (imageSaveMode || nearestW <= 0) {
+        return INFINITY;
+    }
+
+    // w is 1 for the orthographic view, and the distance from the camera otherwise
+    return 0.5 * projection[5] * viewport[3] / 2.0 / nearestW;
+}
+
+void glConnectionWidget::createPopulationsDL()
+{
+    if (data)
+    {
+        int LoD = getPopulationLoD();
+
+        // display lists belong to a context, and all use the same detail
+        if (dlContext != QGLContext::currentContext() || dlLoD != LoD) {
+            builtPopulations.clear();
+            builtConnections.clear();
+            dlContext = QGLContext::currentContext();
+            dlLoD = LoD;
+        }
+
+        // drop the buffers of populations that have gone
+        QMap < population *, QGLBuffer * >::iterator buffer = instanceBuffers.begin();
+        while (buffer != instanceBuffers.end()) {
+            if (std::find(data->populations.begin(), data->populations.end(), buffer.key()) == data->populations.end()) {
+                delete buffer.value();
+                buffer = instanceBuffers.erase(buffer);
+            } else {
+                ++buffer;
+            }
+        }
+        buffer = colourBuffers.begin();
+        while (buffer != colourBuffers.end()) {
+            if (std::find(data->populations.begin(), data->populations.end(), buffer.key()) == data->populations.end()) {
+                delete buffer.value();
+                buffer = colourBuffers.erase(buffer);
+            } else {
+                ++buffer;
+            }
+        }
+        QMap < population *, neuronBVH * >::iterator bvh = neuronBVHs.begin();
+        while (bvh != neuronBVHs.end()) {
+            if (std::find(data->populations.begin(), data->populations.end(), bvh.key()) == data->populations.end()) {
+                delete bvh.value();
+                bvh = neuronBVHs.erase(bvh);
+            } else {
+                ++bvh;
+            }
+        }
+        QMap < population *, QMap < int, GLuint > >::iterator lists = populationDLs.begin();
+        while (lists != populationDLs.end()) {
+            if (std::find(data->populations.begin(), data->populations.end(), lists.key()) == data->populations.end()) {
+                foreach (GLuint list, lists.value()) {
+                    glDeleteLists(list, 1);
+                }
+                lists = populationDLs.erase(lists);
+            } else {
+                ++lists;
+            }
+        }
+        QMap < population *, uint >::iterator built = builtPopulations.begin();
+        while (built != builtPopulations.end()) {
+            if (std::find(data->populations.begin(), data->populations.end(), built.key()) == data->populations.end()) {
+                dirtyPopulations.remove(built.key());
+                built = builtPopulations.erase(built);
+            } else {
+                ++built;
+            }
+        }
+
+        for(uint locNum = 0; locNum < data->populations.size(); locNum++) {
+            population * currPop = data->populations[locNum];
+
+            // add some neurons!
+
+            // generate data on the thread pool - the display list is made when it is ready
+            if (currPop->layoutType->locations.size() == 0) {
+                if (!pendingLayouts.contains(currPop)) {
+                    layoutJob * job = new layoutJob;
+                    job->pop = currPop;
+                    job->source = currPop->layoutType;
+                    // the thread works on a copy so the layout can be edited meanwhile - including the
+                    // layout class, which the copy would otherwise share with the layout editor
+                    job->layout = new NineMLLayoutData(currPop->layoutType);
+                    job->layout->component = new NineMLLayout(currPop->layoutType->component);
+                    job->numNeurons = currPop->numNeurons;
+
+                    QFutureWatcher < layoutJob * > * watcher = new QFutureWatcher < layoutJob * >(this);
+                    connect(watcher, SIGNAL(finished()), this, SLOT(layoutGenerated()));
+                    pendingLayouts[currPop] = watcher;
+                    watcher->setFuture(QtConcurrent::run(runLayoutJob, job));
+
+                    ++layoutsQueued;
+                }
+            }
+
+            // empty until the layout arrives - only rebuild what has changed since last time
+            if (!dirtyPopulations.contains(currPop) && builtPopulations.contains(currPop) \
+                    && builtPopulations[currPop] == currPop->layoutType->locations.size()) {
+                continue;
+            }
+            QElapsedTimer timer;
+            timer.start();
+            createPopulationDL(locNum, LoD);
+            currentStats.displayListMs += timer.nsecsElapsed() / 1000000.0;
+        }
+
+        // images must have every population in, so wait for them here
+        if (imageSaveMode) {
+            while (pendingLayouts.size() > 0) {
+                QFutureWatcher < layoutJob * > * watcher = pendingLayouts.begin().value();
+                watcher->waitForFinished();
+                finishLayout(watcher);
+            }
+        }
+
+        if (pendingLayouts.size() > 0) {
+            layoutProgress->setRange(0, layoutsQueued);
+            layoutProgress->setValue(layoutsDone);
+            layoutProgress->setGeometry(10, this->height() - 30, 250, 20);
+            layoutProgress->show();
+        }
+    }
+}
+
+void glConnectionWidget::layoutGenerated()
+{
+    QFutureWatcher < layoutJob * > * watcher = (QFutureWatcher < layoutJob * > *) sender();
+
+    // may already have been collected while saving an image
+    if (pendingLayouts.key(watcher, NULL) == NULL) {
+        return;
+    }
+
+    makeCurrent();
+    finishLayout(watcher);
+
+    // connections are drawn between the locations, so update them once all are in
+    if (pendingLayouts.size() == 0) {
+        createConnectionsDL();
+    }
+
+    this->repaint();
+}
+
+void glConnectionWidget::finishLayout(QFutureWatcher < layoutJob * > * watcher)
+{
+    layoutJob * job = watcher->result();
+
+    currentStats.layoutMs += job->ms;
+    pendingLayouts.remove(job->pop);
+    watcher->deleteLater();
+
+    ++layoutsDone;
+    layoutProgress->setValue(layoutsDone);
+    if (pendingLayouts.size() == 0) {
+        layoutProgress->hide();
+        layoutsQueued = 0;
+        layoutsDone = 0;
+    }
+
+    // only use the result if the population is still here and has not been laid out some other way meanwhile
+    for (uint locNum = 0; locNum < data->populations.size(); ++locNum) {
+        population * currPop = data->populations[locNum];
+        if (currPop == job->pop && currPop->layoutType == job->source && currPop->layoutType->locations.size() == 0) {
+            currPop->layoutType->locations = job->locations;
+            // display all errors
+            if (!job->errs.isEmpty()) {
+                //this->data->statusBarUpdate(errs,2000);
+            }
+            QElapsedTimer timer;
+            timer.start();
+            createPopulationDL(locNum, getPopulationLoD());
+            currentStats.displayListMs += timer.nsecsElapsed() / 1000000.0;
+            break;
+        }
+    }
+
+    for (uint i = 0; i < job->layout->StateVariableList.size(); ++i) {
+        delete job->layout->StateVariableList[i];
+    }
+    for (uint i = 0; i < job->layout->ParameterList.size(); ++i) {
+        delete job->layout->ParameterList[i];
+    }
+    delete job->layout->component;
+    delete job->layout;
+    delete job;
+}
+
+void glConnectionWidget::createPopulationDL(uint locNum, int LoD)
+{
+    population * currPop = data->populations[locNum];
+
+    // the layout may have changed - rebuild the picking tree when next needed
+    if (neuronBVHs.contains(currPop)) {
+        delete neuronBVHs[currPop];
+        neuronBVHs.remove(currPop);
+    }
+
+    dirtyPopulations.remove(currPop);
+    builtPopulations[currPop] = currPop->layoutType->locations.size();
+
+    // the box around the neurons, including their radius
+    vector < loc > &locations = currPop->layoutType->locations;
+    if (locations.size() > 0) {
+        populationBounds box;
+        box.minimum = locations[0];
+        box.maximum = locations[0];
+        for (uint i = 1; i < locations.size(); ++i) {
+            box.minimum.x = qMin(box.minimum.x, locations[i].x); box.maximum.x = qMax(box.maximum.x, locations[i].x);
+            box.minimum.y = qMin(box.minimum.y, locations[i].y); box.maximum.y = qMax(box.maximum.y, locations[i].y);
+            box.minimum.z = qMin(box.minimum.z, locations[i].z); box.maximum.z = qMax(box.maximum.z, locations[i].z);
+        }
+        box.minimum.x -= 0.5; box.minimum.y -= 0.5; box.minimum.z -= 0.5;
+        box.maximum.x += 0.5; box.maximum.y += 0.5; box.maximum.z += 0.5;
+        populationBoxes[currPop] = box;
+    } else {
+        populationBoxes.remove(currPop);
+    }
+
+    if (useInstancing()) {
+        createInstanceBuffer(locNum);
+        return;
+    }
+
+    // the lists for the other details are out of date too - they are remade when next drawn,
+    // and this one is made at the detail the population was last drawn at
+    clearPopulationDLs(currPop);
+    compilePopulationDL(currPop, qMin(populationLoDs.value(currPop, LoD), LoD));
+}
+
+void glConnectionWidget::compilePopulationDL(population * currPop, int LoD)
+{
+    QMap < int, GLuint > &lists = populationDLs[currPop];
+    if (lists.contains(LoD)) glDeleteLists(lists[LoD],1);
+
+    // Start the dl to display info
+    // create the index with the display lists
+    lists[LoD] = glGenLists(1);
+    currPop->dlIndex = lists[LoD];
+
+    // start the display list
+    glNewList(lists[LoD], GL_COMPILE);
+
+    int index = getSelectedPopIndex(currPop);
+
+    // check we haven't broken stuff
+    if (index != -1 && popColours[index].size() > currPop->layoutType->locations.size()) {
+
+        popColours[index].clear();
+        popLogs[index] = NULL;
+    }
+
+    for (uint i = 0; i < currPop->layoutType->locations.size(); ++i) {
+
+        glPushMatrix();
+
+        glTranslatef(currPop->layoutType->locations[i].x, currPop->layoutType->locations[i].y, currPop->layoutType->locations[i].z);
+
+        if (index != -1 && i < popColours[index].size()) {
+            this->drawNeuron(0.5, LoD, LoD, popColours[index][i]);
+        } else
+            this->drawNeuron(0.5, LoD, LoD, QColor(100 + 0.5*currPop->colour.red(),100 + 0.5*currPop->colour.green(),100 + 0.5*currPop->colour.blue(),255));
+
+        glPopMatrix();
+    }
+
+    glEndList();
+}
+
+void glConnectionWidget::clearPopulationDLs(population * pop)
+{
+    foreach (GLuint list, populationDLs.value(pop)) {
+        glDeleteLists(list, 1);
+    }
+    populationDLs.remove(pop);
+}
+
+// unit sphere - the normals are the same as the vertices
+static const char * neuronVertexShader =
+        "#version 120\n"
+        "#extension GL_ARB_draw_instanced : require\n"
+        "attribute vec3 vertex;\n"
+        "attribute vec3 offset;\n"
+        "attribute vec4 colour;\n"
+        "uniform float radius;\n"
+        "varying vec4 fragColour;\n"
+        "void main() {\n"
+        "    gl_Position = gl_ModelViewProjectionMatrix * vec4(offset + radius * vertex, 1.0);\n"
+        "    // match the fixed pipeline with GL_COLOR_MATERIAL and one directional light\n"
+        "    vec3 normal = normalize(gl_NormalMatrix * vertex);\n"
+        "    float diffuse = max(dot(normal, normalize(gl_LightSource[0].position.xyz)), 0.0);\n"
+        "    vec3 light = gl_LightModel.ambient.rgb + gl_LightSource[0].ambient.rgb + diffuse * gl_LightSource[0].diffuse.rgb;\n"
+        "    fragColour = vec4(min(colour.rgb * light, 1.0), colour.a);\n"
+        "}\n";
+
+static const char * neuronFragmentShader =
+        "#version 120\n"
+        "varying vec4 fragColour;\n"
+        "void main() {\n"
+        "    gl_FragColor = fragColour;\n"
+        "}\n";
+
+void glConnectionWidget::setupInstancing()
+{
+    if (instancingContext == context()) {
+        return;
+    }
+
+    // the program and buffers belong to the old context, so free them - the populations make new buffers when rebuilt
+    if (neuronProgram) {
+        delete neuronProgram;
+        neuronProgram = NULL;
+    }
+    if (sphereBuffer) {
+        sphereBuffer->destroy();
+        delete sphereBuffer;
+        sphereBuffer = NULL;
+    }
+    for (QMap < population *, QGLBuffer * >::iterator buffer = instanceBuffers.begin(); buffer != instanceBuffers.end(); ++buffer) {
+        buffer.value()->destroy();
+        delete buffer.value();
+    }
+    instanceBuffers.clear();
+    for (QMap < population *, QGLBuffer * >::iterator buffer = colourBuffers.begin(); buffer != colourBuffers.end(); ++buffer) {
+        buffer.value()->destroy();
+        delete buffer.value();
+    }
+    colourBuffers.clear();
+
+    instancingAvailable = false;
+    instancingContext = context();
+
+    if (!QGLShaderProgram::hasOpenGLShaderPrograms(context())) {
+        neuronDrawing = "display lists (no shader support)";
+        return;
+    }
+
+    // core in GL 3.1 / 3.3, otherwise from the ARB extensions
+    drawArraysInstanced = (void (APIENTRY *)(GLenum, GLint, GLsizei, GLsizei)) context()->getProcAddress("glDrawArraysInstanced");
+    if (drawArraysInstanced == NULL) {
+        drawArraysInstanced = (void (APIENTRY *)(GLenum, GLint, GLsizei, GLsizei)) context()->getProcAddress("glDrawArraysInstancedARB");
+    }
+    vertexAttribDivisor = (void (APIENTRY *)(GLuint, GLuint)) context()->getProcAddress("glVertexAttribDivisor");
+    if (vertexAttribDivisor == NULL) {
+        vertexAttribDivisor = (void (APIENTRY *)(GLuint, GLuint)) context()->getProcAddress("glVertexAttribDivisorARB");
+    }
+    if (drawArraysInstanced == NULL || vertexAttribDivisor == NULL) {
+        neuronDrawing = "display lists (no instancing support)";
+        return;
+    }
+
+    neuronProgram = new QGLShaderProgram(context(), this);
+    if (!neuronProgram->addShaderFromSourceCode(QGLShader::Vertex, neuronVertexShader) || \
+            !neuronProgram->addShaderFromSourceCode(QGLShader::Fragment, neuronFragmentShader) || \
+            !neuronProgram->link()) {
+        neuronDrawing = "display lists (neuron shaders failed)";
+        delete neuronProgram;
+        neuronProgram = NULL;
+        return;
+    }
+
+    sphereBuffer = new QGLBuffer(QGLBuffer::VertexBuffer);
+    sphereBuffer->setUsagePattern(QGLBuffer::StaticDraw);
+    if (!sphereBuffer->create()) {
+        delete sphereBuffer;
+        sphereBuffer = NULL;
+        neuronDrawing = "display lists (no vertex buffers)";
+        return;
+    }
+    createSphereMeshes();
+
+    instancingAvailable = true;
+    neuronDrawing = "instanced";
+}
+
+bool glConnectionWidget::useInstancing()
+{
+    return instancingAvailable && QGLContext::currentContext() == instancingContext;
+}
+
+void glConnectionWidget::createSphereMeshes()
+{
+    // the same sphere as drawNeuron, as triangles, tessellated once for each level of detail
+    vector < GLfloat > vertices;
+    sphereFirsts.clear();
+    sphereCounts.clear();
+
+    for (int LoD = MIN_NEURON_LOD; LoD <= MAX_NEURON_LOD; LoD *= 2) {
+
+        sphereFirsts[LoD] = vertices.size() / 3;
+
+        for (int i = 0; i <= LoD; i++) {
+            double rings0 = M_PI * (-0.5 + (double) (i - 1) / LoD);
+            double z0  = sin(rings0);
+            double zr0 =  cos(rings0);
+
+            double rings1 = M_PI * (-0.5 + (double) i / LoD);
+            double z1 = sin(rings1);
+            double zr1 = cos(rings1);
+
+            for (int j = 0; j < LoD; j++) {
+                double segment0 = 2 * M_PI * (double) (j - 1) / LoD;
+                double segment1 = 2 * M_PI * (double) j / LoD;
+                GLfloat quad[4][3] = {{GLfloat(cos(segment0) * zr0), GLfloat(sin(segment0) * zr0), GLfloat(z0)},
+                                      {GLfloat(cos(segment0) * zr1), GLfloat(sin(segment0) * zr1), GLfloat(z1)},
+                                      {GLfloat(cos(segment1) * zr0), GLfloat(sin(segment1) * zr0), GLfloat(z0)},
+                                      {GLfloat(cos(segment1) * zr1), GLfloat(sin(segment1) * zr1), GLfloat(z1)}};
+                int order[6] = {0,1,2,2,1,3};
+                for (int k = 0; k < 6; ++k) {
+                    vertices.push_back(quad[order[k]][0]);
+                    vertices.push_back(quad[order[k]][1]);
+                    vertices.push_back(quad[order[k]][2]);
+                }
+            }
+        }
+
+        sphereCounts[LoD] = vertices.size() / 3 - sphereFirsts[LoD];
+    }
+
+    sphereBuffer->bind();
+    sphereBuffer->allocate(&vertices[0], vertices.size()*sizeof(GLfloat));
+    sphereBuffer->release();
+}
+
+void glConnectionWidget::createInstanceBuffer(uint locNum)
+{
+    population * currPop = data->populations[locNum];
+
+    // x, y, z per neuron
+    vector < GLfloat > instances;
+    instances.reserve(currPop->layoutType->locations.size()*3);
+
+    for (uint i = 0; i < currPop->layoutType->locations.size(); ++i) {
+        instances.push_back(currPop->layoutType->locations[i].x);
+        instances.push_back(currPop->layoutType->locations[i].y);
+        instances.push_back(currPop->layoutType->locations[i].z);
+    }
+
+    if (!instanceBuffers.contains(currPop)) {
+        QGLBuffer * buffer = new QGLBuffer(QGLBuffer::VertexBuffer);
+        buffer->setUsagePattern(QGLBuffer::StaticDraw);
+        buffer->create();
+        instanceBuffers[currPop] = buffer;
+    }
+
+    QGLBuffer * buffer = instanceBuffers[currPop];
+    buffer->bind();
+    buffer->allocate(instances.size() > 0 ? &instances[0] : NULL, instances.size()*sizeof(GLfloat));
+    buffer->release();
+
+    updateColourBuffer(currPop);
+}
+
+void glConnectionWidget::updateColourBuffer(population * pop)
+{
+    int index = getSelectedPopIndex(pop);
+
+    // check we haven't broken stuff
+    if (index != -1 && popColours[index].size() > pop->layoutType->locations.size()) {
+        popColours[index].clear();
+        popLogs[index] = NULL;
+    }
+
+    // r, g, b, a per neuron - as bytes, as this is what changes each frame of log playback
+    QColor defaultCol(100 + 0.5*pop->colour.red(),100 + 0.5*pop->colour.green(),100 + 0.5*pop->colour.blue(),255);
+    vector < GLubyte > colours;
+    colours.reserve(pop->layoutType->locations.size()*4);
+
+    for (uint i = 0; i < pop->layoutType->locations.size(); ++i) {
+        QColor col = (index != -1 && i < popColours[index].size()) ? popColours[index][i] : defaultCol;
+        colours.push_back(col.red());
+        colours.push_back(col.green());
+        colours.push_back(col.blue());
+        colours.push_back(col.alpha());
+    }
+
+    if (!colourBuffers.contains(pop)) {
+        QGLBuffer * buffer = new QGLBuffer(QGLBuffer::VertexBuffer);
+        buffer->setUsagePattern(QGLBuffer::DynamicDraw);
+        buffer->create();
+        colourBuffers[pop] = buffer;
+    }
+
+    QGLBuffer * buffer = colourBuffers[pop];
+    buffer->bind();
+    if (buffer->size() == (int) colours.size()) {
+        buffer->write(0, colours.size() > 0 ? &colours[0] : NULL, colours.size());
+    } else {
+        buffer->allocate(colours.size() > 0 ? &colours[0] : NULL, colours.size());
+    }
+    buffer->release();
+}
+
+int glConnectionWidget::getSelectedPopIndex(population * pop)
+{
+    // popColours and popLogs follow selectedPops, not data->populations
+    for (uint i = 0; i < selectedPops.size(); ++i) {
+        if (selectedPops[i] == pop && i < popColours.size() && i < popLogs.size()) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void glConnectionWidget::drawPopulation(uint locNum, float screenRadius)
+{
+    population * currPop = data->populations[locNum];
+
+    ++currentStats.glCalls;
+
+    // too small to see the shape of
+    if (screenRadius < NEURON_POINT_PIXELS) {
+        drawPopulationPoints(currPop, screenRadius);
+        return;
+    }
+
+    // about a ring for each pixel of radius, up to the detail set for all neurons
+    int LoD = MIN_NEURON_LOD;
+    while (LoD * 2 <= screenRadius && LoD * 2 <= dlLoD) LoD *= 2;
+
+    populationLoDs[currPop] = LoD;
+
+    if (!useInstancing()) {
+        // one display list for each detail - crossing a step only compiles a list the first time, and keeps the picking tree
+        if (builtPopulations.contains(currPop) && !populationDLs.value(currPop).contains(LoD)) {
+            compilePopulationDL(currPop, LoD);
+        }
+        glCallList(populationDLs.value(currPop).value(LoD, currPop->dlIndex));
+        return;
+    }
+
+    if (!instanceBuffers.contains(currPop) || !colourBuffers.contains(currPop) || currPop->layoutType->locations.size() == 0) {
+        return;
+    }
+
+    neuronProgram->bind();
+    neuronProgram->setUniformValue("radius", (GLfloat) 0.5);
+
+    int vertexLoc = neuronProgram->attributeLocation("vertex");
+    int offsetLoc = neuronProgram->attributeLocation("offset");
+    int colourLoc = neuronProgram->attributeLocation("colour");
+
+    sphereBuffer->bind();
+    neuronProgram->enableAttributeArray(vertexLoc);
+    neuronProgram->setAttributeBuffer(vertexLoc, GL_FLOAT, 0, 3);
+
+    instanceBuffers[currPop]->bind();
+    neuronProgram->enableAttributeArray(offsetLoc);
+    neuronProgram->setAttributeBuffer(offsetLoc, GL_FLOAT, 0, 3);
+    vertexAttribDivisor(offsetLoc, 1);
+    instanceBuffers[currPop]->release();
+
+    // bytes are normalised to 0-1
+    colourBuffers[currPop]->bind();
+    neuronProgram->enableAttributeArray(colourLoc);
+    neuronProgram->setAttributeBuffer(colourLoc, GL_UNSIGNED_BYTE, 0, 4);
+    vertexAttribDivisor(colourLoc, 1);
+    colourBuffers[currPop]->release();
+
+    drawArraysInstanced(GL_TRIANGLES, sphereFirsts[LoD], sphereCounts[LoD], currPop->layoutType->locations.size());
+
+    // leave the state as the fixed pipeline expects it
+    vertexAttribDivisor(offsetLoc, 0);
+    vertexAttribDivisor(colourLoc, 0);
+    neuronProgram->disableAttributeArray(vertexLoc);
+    neuronProgram->disableAttributeArray(offsetLoc);
+    neuronProgram->disableAttributeArray(colourLoc);
+    sphereBuffer->release();
+    neuronProgram->release();
 }
 
-void glConnectionWidget::wheelEvent(QWheelEvent *event){
+void glConnectionWidget::drawPopulationPoints(population * pop, float screenRadius)
+{
+    if (pop->layoutType->locations.size() == 0) {
+        return;
+    }
 
-    float val = float(event->delta()) / 320.0;
-    val = pow(2.0f,val);
-    if (event->orientation() == Qt::Vertical) {
-        this->zoomFactor *= (val);
-        if (this->zoomFactor < 0.00001)
-            zoomFactor = 1;
-        repaint();
+    // round points, unlit, the size the spheres would be
+    glPushAttrib(GL_ENABLE_BIT | GL_POINT_BIT);
+    glDisable(GL_LIGHTING);
+    glEnable(GL_POINT_SMOOTH);
+    glPointSize(qMax(1.0f, 2.0f * screenRadius));
+
+    if (useInstancing() && instanceBuffers.contains(pop) && colourBuffers.contains(pop)) {
+        // the instance data is already what the points need
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        instanceBuffers[pop]->bind();
+        glVertexPointer(3, GL_FLOAT, 0, 0);
+        colourBuffers[pop]->bind();
+        glColorPointer(4, GL_UNSIGNED_BYTE, 0, 0);
+        colourBuffers[pop]->release();
+        glDrawArrays(GL_POINTS, 0, pop->layoutType->locations.size());
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+    } else {
+        int index = getSelectedPopIndex(pop);
+        QColor defaultCol(100 + 0.5*pop->colour.red(),100 + 0.5*pop->colour.green(),100 + 0.5*pop->colour.blue(),255);
+        glBegin(GL_POINTS);
+        for (uint i = 0; i < pop->layoutType->locations.size(); ++i) {
+            QColor col = (index != -1 && i < popColours[index].size()) ? popColours[index][i] : defaultCol;
+            glColor4f(col.redF(), col.greenF(), col.blueF(), col.alphaF());
+            glVertex3f(pop->layoutType->locations[i].x, pop->layoutType->locations[i].y, pop->layoutType->locations[i].z);
+        }
+        glEnd();
     }
-}
 
-void glConnectionWidget::setPopIndicesShown(bool checkState){
-    popIndicesShown = checkState;
-    repaint();
+    glPopAttrib();
 }
 
-void glConnectionWidget::selectedNrnChanged(int index) {
-
-    QString type = sender()->property("type").toString();
-
-    if (type == "index")
-        selectedIndex = index;
-    else if (type == "from") {
-        selectedType = index+1;
+connectionVertices * glConnectionWidget::getConnectionVertices(uint targNum, population * src, population * dst, connection * conn, float srcX, float srcY, float srcZ, float dstX, float dstY, float dstZ)
+{
+    float offsets[6] = {srcX, srcY, srcZ, dstX, dstY, dstZ};
+    float p = 0;
+    int seed = 0;
+    if (conn->type == FixedProb) {
+        p = ((fixedProb_connection *) conn)->p;
+        seed = ((fixedProb_connection *) conn)->seed;
     }
 
-    repaint();
-
-}
+    vector < loc > &srcLocs = src->layoutType->locations;
+    vector < loc > &dstLocs = dst->layoutType->locations;
 
-void glConnectionWidget::createPopulationsDL()
-{
-    if (data)
-    {
-        // fetch quality setting
-        QSettings settings;
-        int quality = settings.value("glOptions/detail", 5).toInt();
+    // reuse if nothing has changed
+    connectionVertices * verts = connVertices.value(selectedConns[targNum], NULL);
+    if (verts != NULL) {
+        bool moved = false;
+        for (int i = 0; i < 6; ++i) {
+            if (verts->offsets[i] != offsets[i]) moved = true;
+        }
+        if (!moved && verts->srcSize == srcLocs.size() && verts->dstSize == dstLocs.size() \
+                && verts->numConnections == connections[targNum].size() && verts->type == conn->type && verts->p == p && verts->seed == seed \
+                && verts->mode == connectionMode && verts->budget == getConnectionBudget()) {
+            return verts;
+        }
+        clearConnectionVertices(verts);
+    }
 
-        // draw with a level of detail dependant on the number on neurons we must draw
-        // sum neurons across all pops we'll draw
-        int totalNeurons = 0;
-        for (uint locNum = 0; locNum < data->populations.size(); ++locNum) {
-            totalNeurons += data->populations[locNum]->numNeurons;
+    verts = new connectionVertices;
+    for (int i = 0; i < 6; ++i) {
+        verts->offsets[i] = offsets[i];
+    }
+    verts->srcSize = srcLocs.size();
+    verts->dstSize = dstLocs.size();
+    verts->numConnections = connections[targNum].size();
+    verts->type = conn->type;
+    verts->p = p;
+    verts->seed = seed;
+    verts->mode = connectionMode;
+    verts->budget = getConnectionBudget();
+    verts->buffer = NULL;
+    verts->bufferContext = NULL;
+    connVertices[selectedConns[targNum]] = verts;
+
+    if (conn->type == CSV || conn->type == Kernel || conn->type == Python) {
+
+        // bucket the explicit connections by source and by destination
+        uint maxSrc = 0;
+        uint maxDst = 0;
+        for (uint i = 0; i < connections[targNum].size(); ++i) {
+            maxSrc = qMax(maxSrc, (uint) connections[targNum][i].src + 1);
+            maxDst = qMax(maxDst, (uint) connections[targNum][i].dst + 1);
+        }
+        verts->srcStart.resize(maxSrc + 1, 0);
+        verts->dstStart.resize(maxDst + 1, 0);
+        for (uint i = 0; i < connections[targNum].size(); ++i) {
+            ++verts->srcStart[connections[targNum][i].src + 1];
+            ++verts->dstStart[connections[targNum][i].dst + 1];
+        }
+        for (uint i = 1; i < verts->srcStart.size(); ++i) verts->srcStart[i] += verts->srcStart[i-1];
+        for (uint i = 1; i < verts->dstStart.size(); ++i) verts->dstStart[i] += verts->dstStart[i-1];
+        verts->srcOrder.resize(connections[targNum].size());
+        verts->dstOrder.resize(connections[targNum].size());
+        vector < GLuint > srcNext(verts->srcStart.begin(), verts->srcStart.end() - 1);
+        vector < GLuint > dstNext(verts->dstStart.begin(), verts->dstStart.end() - 1);
+        for (uint i = 0; i < connections[targNum].size(); ++i) {
+            verts->srcOrder[srcNext[connections[targNum][i].src]++] = i;
+            verts->dstOrder[dstNext[connections[targNum][i].dst]++] = i;
         }
-        int LoD = round(250.0f/float(totalNeurons)*pow(2,float(quality)));
+        return verts;
+    }
+
+    // the end points - a population that is not laid out is drawn to its centre
+    vector < loc > srcPoints;
+    vector < loc > dstPoints;
+    for (uint i = 0; i < srcLocs.size(); ++i) {
+        loc point = {srcLocs[i].x+srcX, srcLocs[i].y+srcY, srcLocs[i].z+srcZ};
+        srcPoints.push_back(point);
+    }
+    for (uint i = 0; i < dstLocs.size(); ++i) {
+        loc point = {dstLocs[i].x+dstX, dstLocs[i].y+dstY, dstLocs[i].z+dstZ};
+        dstPoints.push_back(point);
+    }
+    bool drawAny = srcPoints.size() > 0 || dstPoints.size() > 0;
+    if (srcPoints.size() == 0) {
+        loc point = {srcX, srcY, srcZ};
+        srcPoints.push_back(point);
+    }
+    if (dstPoints.size() == 0) {
+        loc point = {dstX, dstY, dstZ};
+        dstPoints.push_back(point);
+    }
 
-        // draw with a level of detail dependant on the number on neurons we must draw
-        // put some bounds on
-        if (LoD < 4) LoD = 4; if (LoD > 32) LoD = 32;
-        if (imageSaveMode)
-            LoD = 64;
+    // which lines to draw, in order of source neuron
+    vector < GLuint > lineSrc;
+    vector < GLuint > lineDst;
 
-        for(uint locNum = 0; locNum < data->populations.size(); locNum++) {
-            population * currPop = data->populations[locNum];
+    // density bundles are counted as the connections are found, rather than listing every pair first
+    bool binning = connectionMode == densityConnections;
+    connectionBinner binner(srcPoints, dstPoints, binning ? verts->budget : 1);
 
-            // add some neurons!
+    if (conn->type == OnetoOne && drawAny && src->numNeurons == dst->numNeurons) {
+        uint count = qMax(srcLocs.size(), dstLocs.size());
+        for (uint i = 0; i < count; ++i) {
+            if ((srcLocs.size() > 0 && i >= srcLocs.size()) || (dstLocs.size() > 0 && i >= dstLocs.size())) {
+                break;
+            }
+            lineSrc.push_back(srcLocs.size() > 0 ? i : 0);
+            lineDst.push_back(dstLocs.size() > 0 ? i : 0);
+        }
+    }
 
-            // generate data:
-            if (currPop->layoutType->locations.size() == 0) {
-                QString errs;
-                currPop->layoutType->generateLayout(currPop->numNeurons,&currPop->layoutType->locations,errs);
-                // display all errors
-                if (!errs.isEmpty()) {
-                    //this->data->statusBarUpdate(errs,2000);
+    if (conn->type == AlltoAll && drawAny) {
+        quint64 total = quint64(srcPoints.size()) * quint64(dstPoints.size());
+        if (binning) {
+            binner.addAll();
+        } else if (connectionMode == sampledConnections && total > verts->budget) {
+            // only make the lines that will be drawn
+            vector < quint64 > sample;
+            sampleConnectionIndices(total, verts->budget, sample);
+            for (uint i = 0; i < sample.size(); ++i) {
+                lineSrc.push_back(sample[i] / dstPoints.size());
+                lineDst.push_back(sample[i] % dstPoints.size());
+            }
+        } else {
+            for (uint i = 0; i < srcPoints.size(); ++i) {
+                for (uint j = 0; j < dstPoints.size(); ++j) {
+                    lineSrc.push_back(i);
+                    lineDst.push_back(j);
                 }
-                popColours.resize(popColours.size()+1);
             }
+        }
+    }
 
-            if (currPop->dlIndex > 0) glDeleteLists(currPop->dlIndex,1);
-            if (currPop->dlIndexCol > 0) glDeleteLists(currPop->dlIndexCol,1);
+    if (conn->type == FixedProb && srcLocs.size() > 0 && dstLocs.size() > 0) {
+        // the same sequence as before, so the same connections are shown
+        random.setSeed(seed);
+        this->prob = p;
+        // when sampling, keep about the budget of the connections as they are found
+        double expected = double(p) * srcLocs.size() * dstLocs.size();
+        float keep = (connectionMode == sampledConnections && expected > verts->budget) ? verts->budget / expected : 1.0f;
+        RNG sampleRandom;
+        sampleRandom.setSeed(CONNECTION_SAMPLE_SEED);
+        for (uint i = 0; i < srcLocs.size(); ++i) {
+            for (uint j = 0; j < dstLocs.size(); ++j) {
+                if (random.value() < this->prob) {
+                    if (binning) {
+                        binner.add(i, j);
+                    } else if (keep >= 1.0f || sampleRandom.value() < keep) {
+                        lineSrc.push_back(i);
+                        lineDst.push_back(j);
+                    }
+                }
+            }
+        }
+    }
 
-            // Start the dl to display info
-            // create the index with the display lists
-            currPop->dlIndex = glGenLists(1);
+    // cut down to the budget, as the sampling above only comes close - the sample is in order, so the lines stay in order of source neuron
+    if (connectionMode == sampledConnections && lineSrc.size() > verts->budget) {
+        vector < quint64 > sample;
+        sampleConnectionIndices(lineSrc.size(), verts->budget, sample);
+        for (uint i = 0; i < sample.size(); ++i) {
+            lineSrc[i] = lineSrc[sample[i]];
+            lineDst[i] = lineDst[sample[i]];
+        }
+        lineSrc.resize(sample.size());
+        lineDst.resize(sample.size());
+    }
 
-            // start the display list
-            glNewList(currPop->dlIndex, GL_COMPILE);
+    // or replace the lines with one bundle for each pair of cells
+    if (binning) {
+        for (uint i = 0; i < lineSrc.size(); ++i) {
+            binner.add(lineSrc[i], lineDst[i]);
+        }
+        binner.getBundles(verts->bundles);
+        lineSrc.clear();
+        lineDst.clear();
+    }
 
-            for (uint i = 0; i < currPop->layoutType->locations.size(); ++i) {
+    verts->vertices.reserve(lineSrc.size()*6);
+    verts->srcStart.resize(srcPoints.size() + 1, 0);
+    verts->dstStart.resize(dstPoints.size() + 1, 0);
+    for (uint i = 0; i < lineSrc.size(); ++i) {
+        loc &start = srcPoints[lineSrc[i]];
+        loc &end = dstPoints[lineDst[i]];
+        verts->vertices.push_back(start.x);
+        verts->vertices.push_back(start.y);
+        verts->vertices.push_back(start.z);
+        verts->vertices.push_back(end.x);
+        verts->vertices.push_back(end.y);
+        verts->vertices.push_back(end.z);
+        ++verts->srcStart[lineSrc[i] + 1];
+        ++verts->dstStart[lineDst[i] + 1];
+    }
+    for (uint i = 1; i < verts->srcStart.size(); ++i) verts->srcStart[i] += verts->srcStart[i-1];
+    for (uint i = 1; i < verts->dstStart.size(); ++i) verts->dstStart[i] += verts->dstStart[i-1];
+
+    verts->dstIndices.resize(lineSrc.size()*2);
+    vector < GLuint > dstNext(verts->dstStart.begin(), verts->dstStart.end() - 1);
+    for (uint i = 0; i < lineDst.size(); ++i) {
+        GLuint slot = dstNext[lineDst[i]]++;
+        verts->dstIndices[slot*2] = i*2;
+        verts->dstIndices[slot*2+1] = i*2+1;
+    }
 
-                glPushMatrix();
+    // upload once - if buffers aren't available the vertices are drawn from memory
+    if (verts->vertices.size() > 0) {
+        QGLBuffer * buffer = new QGLBuffer(QGLBuffer::VertexBuffer);
+        buffer->setUsagePattern(QGLBuffer::StaticDraw);
+        if (buffer->create()) {
+            buffer->bind();
+            buffer->allocate(&verts->vertices[0], verts->vertices.size()*sizeof(GLfloat));
+            buffer->release();
+            verts->buffer = buffer;
+            verts->bufferContext = QGLContext::currentContext();
+        } else {
+            delete buffer;
+        }
+    }
 
-                glTranslatef(currPop->layoutType->locations[i].x, currPop->layoutType->locations[i].y, currPop->layoutType->locations[i].z);
+    return verts;
+}
 
-                // check we haven't broken stuff
-                if (popColours[locNum].size() > currPop->layoutType->locations.size()) {
+void glConnectionWidget::drawConnectionVertices(connectionVertices * verts, GLuint first, GLuint count, GLuint * indices)
+{
+    if (count == 0) {
+        return;
+    }
 
-                    popColours[locNum].clear();
-                    popLogs[locNum] = NULL;
-                }
+    ++currentStats.glCalls;
+    glEnableClientState(GL_VERTEX_ARRAY);
 
-                if (popColours[locNum].size() > 0) {
-                    this->drawNeuron(0.5, LoD, LoD, popColours[locNum][i]);
-                } else
-                    this->drawNeuron(0.5, LoD, LoD, QColor(100 + 0.5*currPop->colour.red(),100 + 0.5*currPop->colour.green(),100 + 0.5*currPop->colour.blue(),255));
+    bool useBuffer = verts->buffer != NULL && verts->bufferContext == QGLContext::currentContext();
+    if (useBuffer) {
+        verts->buffer->bind();
+        glVertexPointer(3, GL_FLOAT, 0, 0);
+    } else {
+        glVertexPointer(3, GL_FLOAT, 0, &verts->vertices[0]);
+    }
 
-                glPopMatrix();
-            }
+    if (indices == NULL) {
+        glDrawArrays(GL_LINES, first, count);
+    } else {
+        glDrawElements(GL_LINES, count, GL_UNSIGNED_INT, indices + first);
+    }
 
-            glEndList();
+    if (useBuffer) {
+        verts->buffer->release();
+    }
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
 
-            //Start the dl to do collision
-            // create the index with the display lists
-            currPop->dlIndexCol = glGenLists(1);
+void glConnectionWidget::drawConnectionBundles(vector < connectionBundle > &bundles, int strength, GLfloat * center, float lineScaleFactor, QColor colour)
+{
+    // the bundle with the most connections is the widest and most solid
+    quint64 maxCount = 1;
+    for (uint i = 0; i < bundles.size(); ++i) {
+        maxCount = qMax(maxCount, bundles[i].count);
+    }
 
-            // start the display list
-            glNewList(currPop->dlIndexCol, GL_COMPILE);
+    for (uint i = 0; i < bundles.size(); ++i) {
 
-            for (uint i = 0; i < currPop->layoutType->locations.size(); ++i) {
+        float weight = log(1.0 + bundles[i].count) / log(1.0 + maxCount);
+        glLineWidth((1.0 + 7.0 * weight) * lineScaleFactor);
+        glColor4f(colour.redF(), colour.greenF(), colour.blueF(), 0.2 + 0.8 * weight);
 
-                glPushMatrix();
+        // curve through the centre like the connections would
+        GLfloat ctrlpoints[strength+2][3];
+        for (int strengthIndex = 1; strengthIndex <= strength; strengthIndex++) {
+            ctrlpoints[strengthIndex][0] = center[0];
+            ctrlpoints[strengthIndex][1] = center[1];
+            ctrlpoints[strengthIndex][2] = center[2];
+        }
+        ctrlpoints[0][0] = bundles[i].start.x;
+        ctrlpoints[0][1] = bundles[i].start.y;
+        ctrlpoints[0][2] = bundles[i].start.z;
+        ctrlpoints[strength+1][0] = bundles[i].end.x;
+        ctrlpoints[strength+1][1] = bundles[i].end.y;
+        ctrlpoints[strength+1][2] = bundles[i].end.z;
+
+        glMap1f(GL_MAP1_VERTEX_3, 0.0, 1.0, 3, strength+2, &ctrlpoints[0][0]);
+
+        int segments = strength > 0 ? 30 : 1;
+        glBegin(GL_LINE_STRIP);
+        for (int j = 0; j <= segments; j++)
+            glEvalCoord1f((GLfloat) j/segments);
+        glEnd();
+    }
+}
 
-                glTranslatef(currPop->layoutType->locations[i].x, currPop->layoutType->locations[i].y, currPop->layoutType->locations[i].z);
+uint glConnectionWidget::getConnectionBudget()
+{
+    // most connections drawn per projection
+    if (connectionMode == sampledConnections) {
+        uint budgets[3] = {CONNECTION_BUDGET_LOW, CONNECTION_BUDGET_MEDIUM, CONNECTION_BUDGET_HIGH};
+        return budgets[connectionQuality];
+    }
+    // cells along each side of the grid a population is binned into
+    if (connectionMode == densityConnections) {
+        return 4 << connectionQuality;
+    }
+    return 0;
+}
 
-                // check we haven't broken stuff
-                if (popColours[locNum].size() > currPop->layoutType->locations.size()) {
+void glConnectionWidget::setConnectionDisplayMode(int mode)
+{
+    connectionMode = (connectionDisplayMode) mode;
 
-                    popColours[locNum].clear();
-                    popLogs[locNum] = NULL;
-                }
+    // the display lists are compared against the new budget, and the vertices rebuilt as they are drawn
+    makeCurrent();
+    createConnectionsDL();
+    repaint();
+}
 
-                //ID code from
-                //http://www.opengl-tutorial.org/miscellaneous/clicking-on-objects/picking-with-an-opengl-hack/#Giving_an_ID_to_every_object
+void glConnectionWidget::setConnectionQuality(int quality)
+{
+    connectionQuality = qBound(0, quality, 2);
 
-                // Creating the IDs as colors.
-                this->drawNeuron(0.5, LoD, LoD, QColor(locNum, i & 0x000000FF, (i & 0x0000FF00) >> 8));
+    // the display lists are compared against the new budget, and the vertices rebuilt as they are drawn
+    makeCurrent();
+    createConnectionsDL();
+    repaint();
+}
 
-                glPopMatrix();
-            }
+void glConnectionWidget::clearConnectionVertices(connectionVertices * verts)
+{
+    connVertices.remove(connVertices.key(verts, NULL));
+    delete verts->buffer;
+    delete verts;
+}
 
-            glEndList();
-        }
+void glConnectionWidget::clearConnectionVertices()
+{
+    while (connVertices.size() > 0) {
+        clearConnectionVertices(connVertices.begin().value());
     }
 }
 
 void glConnectionWidget::createConnectionsDL()
 {
+    // display lists belong to a context - and a new one may be made without populations being rebuilt
+    if (dlContext != QGLContext::currentContext()) {
+        builtPopulations.clear();
+        builtConnections.clear();
+        dlContext = QGLContext::currentContext();
+    }
+
     //qDebug() << "Start creating the display lists for connections";
+    QElapsedTimer timer;
+    timer.start();
 
     // work out scaling for line widths:
     float lineScaleFactor;
@@ -2141,6 +3419,7 @@ void glConnectionWidget::createConnectionsDL()
                     // fetch connections back here:
                     connections[targNum].clear();
                     csv_conn->getAllData(connections[targNum]);
+                    dirtyConnections.insert(selectedConns[targNum]);
                 }
             }
         }
@@ -2153,6 +3432,42 @@ void glConnectionWidget::createConnectionsDL()
                 continue;
             }
 
+            // skip if nothing this display list was built from has changed
+            connectionDLKey key;
+            key.offsets[0] = srcX; key.offsets[1] = srcY; key.offsets[2] = srcZ;
+            key.offsets[3] = dstX; key.offsets[4] = dstY; key.offsets[5] = dstZ;
+            key.srcSize = src->layoutType->locations.size();
+            key.dstSize = dst->layoutType->locations.size();
+            key.numConnections = connections[targNum].size();
+            key.srcVisualised = src->isVisualised;
+            key.dstVisualised = dst->isVisualised;
+            key.lineScaleFactor = lineScaleFactor;
+            key.mode = connectionMode;
+            key.budget = getConnectionBudget();
+            if (this->selectedConns[targNum]->type == synapseObject) {
+                synapse * currObj = (synapse *) this->selectedConns[targNum];
+                key.strength = currObj->strength;
+                key.colourScheme = currObj->colorScheme;
+                for (int i = 0; i < 3; ++i) key.center[i] = currObj->center[i];
+            } else {
+                genericInput * currObj = (genericInput *) this->selectedConns[targNum];
+                key.strength = currObj->strength;
+                key.colourScheme = currObj->colorScheme;
+                for (int i = 0; i < 3; ++i) key.center[i] = currObj->center[i];
+            }
+
+            if (!dirtyConnections.contains(selectedConns[targNum]) && builtConnections.contains(selectedConns[targNum]) \
+                    && builtConnections[selectedConns[targNum]] == key) {
+                continue;
+            }
+            dirtyConnections.remove(selectedConns[targNum]);
+            builtConnections[selectedConns[targNum]] = key;
+
+            // the vertex buffer is rebuilt as it is next drawn
+            if (connVertices.contains(selectedConns[targNum])) {
+                clearConnectionVertices(connVertices[selectedConns[targNum]]);
+            }
+
             connGenerationMutex->lock();
 
             int aux_strength = 0;
@@ -2206,7 +3521,63 @@ void glConnectionWidget::createConnectionsDL()
 
             colourStep = 1/(maxColourValue-minColourValue);
 
-            for (uint i = 0; i < connections[targNum].size(); ++i) {
+            if (connectionMode == densityConnections) {
+
+                // the end points as the connections would be drawn - a population that is not shown is a point
+                vector < loc > srcPoints;
+                vector < loc > dstPoints;
+                if (src->isVisualised) {
+                    for (uint i = 0; i < src->layoutType->locations.size(); ++i) {
+                        loc point = src->layoutType->locations[i];
+                        if (dst->isVisualised) {
+                            point.x += srcX; point.y += srcY; point.z += srcZ;
+                        }
+                        srcPoints.push_back(point);
+                    }
+                } else {
+                    srcPoints.push_back(src->loc3);
+                }
+                if (dst->isVisualised) {
+                    for (uint i = 0; i < dst->layoutType->locations.size(); ++i) {
+                        loc point = dst->layoutType->locations[i];
+                        if (src->isVisualised) {
+                            point.x += dstX; point.y += dstY; point.z += dstZ;
+                        }
+                        dstPoints.push_back(point);
+                    }
+                } else {
+                    loc point = {dstX, dstY, dstZ};
+                    dstPoints.push_back(point);
+                }
+
+                connectionBinner binner(srcPoints, dstPoints, key.budget);
+                for (uint i = 0; i < connections[targNum].size(); ++i) {
+                    if (connections[targNum][i].src < src->layoutType->locations.size() && connections[targNum][i].dst < dst->layoutType->locations.size()) {
+                        binner.add(src->isVisualised ? connections[targNum][i].src : 0, dst->isVisualised ? connections[targNum][i].dst : 0);
+                    }
+                }
+                vector < connectionBundle > bundles;
+                binner.getBundles(bundles);
+                drawConnectionBundles(bundles, aux_strength, center, lineScaleFactor, QColor(0,0,0));
+                connectionDLEdges[selectedConns[targNum]] = bundles.size();
+
+                glEndList();
+                connGenerationMutex->unlock();
+                continue;
+            }
+
+            // only a sample of large projections is drawn
+            vector < quint64 > sample;
+            uint numDrawn = connections[targNum].size();
+            if (connectionMode == sampledConnections && numDrawn > key.budget) {
+                sampleConnectionIndices(numDrawn, key.budget, sample);
+                numDrawn = sample.size();
+            }
+            connectionDLEdges[selectedConns[targNum]] = 0;
+
+            for (uint drawn = 0; drawn < numDrawn; ++drawn) {
+
+                uint i = sample.size() > 0 ? sample[drawn] : drawn;
 
                 if (connections[targNum][i].src < src->layoutType->locations.size() && connections[targNum][i].dst < dst->layoutType->locations.size()) {
                     glLineWidth(1.0 * lineScaleFactor);
@@ -2262,6 +3633,7 @@ void glConnectionWidget::createConnectionsDL()
                         glEvalCoord1f((GLfloat) j/30.0);
 
                     glEnd();
+                    ++connectionDLEdges[selectedConns[targNum]];
 
                 } else {
                     // ERR - CONNECTION INDEX OUT OF RANGE
@@ -2277,11 +3649,163 @@ void glConnectionWidget::createConnectionsDL()
         }
     }
 
+    currentStats.displayListMs += timer.nsecsElapsed() / 1000000.0;
     //qDebug() << "Finish creating the display lists for connections";
 }
 
 
+void glConnectionWidget::drawIndexLabels(QPainter * painter, int width, int height) {
+
+    painter->setRenderHint(QPainter::Antialiasing);
+    QFont font = painter->font();
+    font.setPointSizeF(font.pointSizeF()*((float) width)/((float) this->width()));
+    painter->setFont(font);
+    painter->setPen(QColor(100,100,100));
+
+    setupView();
+
+    glPushMatrix();
+    glTranslatef(0,0,-5.0);
+
+    // draw text
+    for (uint locNum = 0; locNum < selectedPops.size(); ++locNum) {
+        population * currPop = selectedPops[locNum];
+        for (unsigned int i = 0; i < currPop->layoutType->locations.size(); ++i) {
+            glPushMatrix();
+
+            glTranslatef(currPop->layoutType->locations[i].x, currPop->layoutType->locations[i].y, currPop->layoutType->locations[i].z);
+
+            // if currently selected
+            if (currPop == selectedObject) {
+                // move to pop location denoted by the spinboxes for x, y, z
+                glTranslatef(loc3Offset.x, loc3Offset.y,loc3Offset.z);
+            } else {
+                glTranslatef(currPop->loc3.x, currPop->loc3.y,currPop->loc3.z);
+            }
+
+            // print up text:
+            GLdouble modelviewMatrix[16];
+            GLdouble projectionMatrix[16];
+            GLint viewPort[4];
+            GLdouble winX;
+            GLdouble winY;
+            GLdouble winZ;
+            glGetIntegerv(GL_VIEWPORT, viewPort);
+            glGetDoublev(GL_MODELVIEW_MATRIX, modelviewMatrix);
+            glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
+            gluProject(0, 0, 0, modelviewMatrix, projectionMatrix, viewPort, &winX, &winY, &winZ);
+
+            painter->drawText(QRect(winX-(1.0-winZ)*220-(20.0)*(float(width)/500.0),height-winY-(1.0-winZ)*220-10*(float(width)/500.0),40*(float(width)/500.0),20*(float(width)/500.0)),QString::number(float(i)));
+
+            glPopMatrix();
+        }
+    }
+
+    glPopMatrix();
+}
+
 #if QT_VERSION > QT_VERSION_CHECK(5, 0, 0)
+QImage glConnectionWidget::renderOffscreen(int w, int h)
+{
+    // a context and surface of our own, so no window or display is needed
+    QSurfaceFormat surfaceFormat;
+    surfaceFormat.setDepthBufferSize(24);
+    QOffscreenSurface surface;
+    surface.setFormat(surfaceFormat);
+    surface.create();
+    QOpenGLContext context;
+    context.setFormat(surfaceFormat);
+    if (!context.create() || !context.makeCurrent(&surface)) {
+        qDebug() << "No offscreen GL context available";
+        return QImage();
+    }
+
+    QImage img;
+    {
+        QOpenGLFramebufferObjectFormat format;
+        format.setAttachment(QOpenGLFramebufferObject::Depth);
+        QOpenGLFramebufferObject fbo(w, h, format);
+        if (!fbo.isValid()) {
+            context.doneCurrent();
+            return QImage();
+        }
+        fbo.bind();
+
+        // the display lists built here go with the context, so keep the widget's ones to put back
+        QMap < population *, int > popDLs;
+        for (uint i = 0; i < data->populations.size(); ++i) {
+            popDLs[data->populations[i]] = data->populations[i]->dlIndex;
+            data->populations[i]->dlIndex = 0;
+        }
+        QMap < systemObject *, int > connDLs;
+        for (uint i = 0; i < selectedConns.size(); ++i) {
+            if (selectedConns[i]->type == synapseObject) {
+                connDLs[selectedConns[i]] = ((synapse *) selectedConns[i])->dlIndex;
+                ((synapse *) selectedConns[i])->dlIndex = 0;
+            } else {
+                connDLs[selectedConns[i]] = ((genericInput *) selectedConns[i])->dlIndex;
+                ((genericInput *) selectedConns[i])->dlIndex = 0;
+            }
+        }
+        QMap < population *, uint > oldBuiltPopulations = builtPopulations;
+        QMap < population *, int > oldPopulationLoDs = populationLoDs;
+        QMap < population *, QMap < int, GLuint > > oldPopulationDLs = populationDLs;
+        populationDLs.clear();
+        QMap < systemObject *, connectionDLKey > oldBuiltConnections = builtConnections;
+        QMap < systemObject *, uint > oldConnectionDLEdges = connectionDLEdges;
+        QSet < population * > oldDirtyPopulations = dirtyPopulations;
+        QSet < systemObject * > oldDirtyConnections = dirtyConnections;
+        const QGLContext * oldDLContext = dlContext;
+        int oldDLLoD = dlLoD;
+
+        imageSaveHeight = h;
+        imageSaveWidth = w;
+        imageSaveMode = true;
+
+        createPopulationsDL();
+        createConnectionsDL();
+        glEnable(GL_MAP1_VERTEX_3);
+
+        if (drawScene()) {
+            glPopMatrix();
+        }
+        glFinish();
+        img = fbo.toImage();
+
+        if (popIndicesShown) {
+            QPainter painter(&img);
+            drawIndexLabels(&painter, w, h);
+            painter.end();
+        }
+
+        imageSaveMode = false;
+        fbo.release();
+
+        for (uint i = 0; i < data->populations.size(); ++i) {
+            data->populations[i]->dlIndex = popDLs.value(data->populations[i], 0);
+        }
+        for (uint i = 0; i < selectedConns.size(); ++i) {
+            if (selectedConns[i]->type == synapseObject) {
+                ((synapse *) selectedConns[i])->dlIndex = connDLs[selectedConns[i]];
+            } else {
+                ((genericInput *) selectedConns[i])->dlIndex = connDLs[selectedConns[i]];
+            }
+        }
+        builtPopulations = oldBuiltPopulations;
+        populationLoDs = oldPopulationLoDs;
+        populationDLs = oldPopulationDLs;
+        builtConnections = oldBuiltConnections;
+        connectionDLEdges = oldConnectionDLEdges;
+        dirtyPopulations = oldDirtyPopulations;
+        dirtyConnections = oldDirtyConnections;
+        dlContext = oldDLContext;
+        dlLoD = oldDLLoD;
+    }
+
+    context.doneCurrent();
+    return img;
+}
+
 QImage glConnectionWidget:: renderQImage(int w, int h)
 {
     // Set the rendering engine to the size of the image to render
@@ -2303,6 +3827,13 @@ QImage glConnectionWidget:: renderQImage(int w, int h)
 
 QPixmap glConnectionWidget::renderImage(int width, int height) {
 
+#if QT_VERSION > QT_VERSION_CHECK(5, 0, 0)
+    // no window to borrow a context from - e.g. rendering from the command line
+    if (!this->isVisible()) {
+        return QPixmap::fromImage(renderOffscreen(width, height));
+    }
+#endif
+
     QPixmap pix;
     imageSaveHeight = height;
     imageSaveWidth = width;
@@ -2322,58 +3853,18 @@ QPixmap glConnectionWidget::renderImage(int width, int height) {
    pix = this->renderPixmap(width, height);
 #endif
 
-    QPainter painter(&pix);
-    painter.setRenderHint(QPainter::Antialiasing);
-    QFont font = painter.font();
-    font.setPointSizeF(font.pointSizeF()*((float) width)/((float) this->width()));
-    painter.setFont(font);
-    painter.setPen(QColor(100,100,100));
-
-    setupView();
-
-    glPushMatrix();
-    glTranslatef(0,0,-5.0);
-
     if (popIndicesShown) {
-        // draw text
-        for (uint locNum = 0; locNum < selectedPops.size(); ++locNum) {
-            population * currPop = selectedPops[locNum];
-            for (unsigned int i = 0; i < currPop->layoutType->locations.size(); ++i) {
-                glPushMatrix();
-
-                glTranslatef(currPop->layoutType->locations[i].x, currPop->layoutType->locations[i].y, currPop->layoutType->locations[i].z);
-
-                // if currently selected
-                if (currPop == selectedObject) {
-                    // move to pop location denoted by the spinboxes for x, y, z
-                    glTranslatef(loc3Offset.x, loc3Offset.y,loc3Offset.z);
-                } else {
-                    glTranslatef(currPop->loc3.x, currPop->loc3.y,currPop->loc3.z);
-                }
-
-                // print up text:
-                GLdouble modelviewMatrix[16];
-                GLdouble projectionMatrix[16];
-                GLint viewPort[4];
-                GLdouble winX;
-                GLdouble winY;
-                GLdouble winZ;
-                glGetIntegerv(GL_VIEWPORT, viewPort);
-                glGetDoublev(GL_MODELVIEW_MATRIX, modelviewMatrix);
-                glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
-                gluProject(0, 0, 0, modelviewMatrix, projectionMatrix, viewPort, &winX, &winY, &winZ);
-
-                painter.drawText(QRect(winX-(1.0-winZ)*220-(20.0)*(float(width)/500.0),height-winY-(1.0-winZ)*220-10*(float(width)/500.0),40*(float(width)/500.0),20*(float(width)/500.0)),QString::number(float(i)));
-
-                glPopMatrix();
-            }
-        }
+        QPainter painter(&pix);
+        drawIndexLabels(&painter, width, height);
         painter.end();
     }
 
-    glPopMatrix();
-
     imageSaveMode = false;
+
+    // put back anything that was rebuilt for the image
+    makeCurrent();
+    createPopulationsDL();
+    createConnectionsDL();
     //QImage image = pix.toImage();
     return pix;
 
@@ -27,6 +27,36 @@
 
 #include "globalHeader.h"
 #include "logdata.h"
+#include "neuronbvh.h"
+#include <QtConcurrentRun>
+#include <QFutureWatcher>
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+// how many log rows ahead of the current time are read in the background during playback
+#define LOG_PREFETCH_ROWS 16
+// how many frames of render timings are kept for export
+#define RENDER_STATS_HISTORY 10000
+// most connections drawn per projection when sampling, for each quality setting
+#define CONNECTION_BUDGET_LOW 5000
+#define CONNECTION_BUDGET_MEDIUM 50000
+#define CONNECTION_BUDGET_HIGH 500000
+// seed for choosing the sampled connections, so the same ones are shown each time
+#define CONNECTION_SAMPLE_SEED 1234
+// neurons smaller than this radius on screen, in pixels, are drawn as points
+#define NEURON_POINT_PIXELS 1.5
+// sphere detail is kept to powers of two between these, so few versions are made
+#define MIN_NEURON_LOD 4
+#define MAX_NEURON_LOD 64
+
+// how the connections of each projection are shown
+enum connectionDisplayMode {
+    allConnections,
+    sampledConnections,
+    densityConnections
+};
 
 class RNG
 {
@@ -56,6 +86,214 @@ struct popLocs {
 
 };
 
+struct layoutJob {
+
+    population * pop;
+    // the layout the job was started from, and the copy that the thread works on
+    NineMLLayoutData * source;
+    NineMLLayoutData * layout;
+    int numNeurons;
+    vector < loc > locations;
+    QString errs;
+    double ms;
+
+};
+
+struct renderStats {
+
+    renderStats() : layoutMs(0), displayListMs(0), populationMs(0), connectionMs(0), logFetchMs(0), frameMs(0),
+        culled(0), neurons(0), edges(0), glCalls(0) {}
+
+    // milliseconds in each stage - work done between frames is counted in the next frame
+    double layoutMs;
+    double displayListMs;
+    double populationMs;
+    double connectionMs;
+    double logFetchMs;
+    double frameMs;
+    // what was drawn, and the populations that were off screen
+    uint culled;
+    uint neurons;
+    uint edges;
+    uint glCalls;
+
+};
+
+struct logRowJob {
+
+    // only used to find where the rows go - the worker reads with its own copy of the layout
+    logData * log;
+    logRowReader reader;
+    uint generation;
+    vector < int > rows;
+    QMap < int, vector < double > > data;
+
+};
+
+struct populationBounds {
+
+    // the box around a population's neurons, in the population's own frame
+    loc minimum;
+    loc maximum;
+
+};
+
+struct connectionBundle {
+
+    // the mean end points of the connections between two cells, and how many there are
+    loc start;
+    loc end;
+    quint64 count;
+
+};
+
+// bins connections by the grid cells their end points fall in, each population getting its own grid
+class connectionBinner
+{
+public:
+    connectionBinner(const vector < loc > &srcPoints, const vector < loc > &dstPoints, int cells) : srcPoints(srcPoints), dstPoints(dstPoints), cells(cells) {
+        srcCells = getCells(srcPoints);
+        dstCells = getCells(dstPoints);
+    }
+    void add(uint src, uint dst) {
+        quint64 key = ((quint64) srcCells[src] << 32) | dstCells[dst];
+        connectionBundle &bundle = bins[key];
+        bundle.start.x += srcPoints[src].x; bundle.start.y += srcPoints[src].y; bundle.start.z += srcPoints[src].z;
+        bundle.end.x += dstPoints[dst].x; bundle.end.y += dstPoints[dst].y; bundle.end.z += dstPoints[dst].z;
+        ++bundle.count;
+    }
+    // every source to every destination - a pair of cells holds the product of their sizes, so no pairs are visited
+    void addAll() {
+        QHash < uint, connectionBundle > srcSums = sumCells(srcPoints, srcCells);
+        QHash < uint, connectionBundle > dstSums = sumCells(dstPoints, dstCells);
+        for (QHash < uint, connectionBundle >::iterator src = srcSums.begin(); src != srcSums.end(); ++src) {
+            for (QHash < uint, connectionBundle >::iterator dst = dstSums.begin(); dst != dstSums.end(); ++dst) {
+                quint64 key = ((quint64) src.key() << 32) | dst.key();
+                connectionBundle &bundle = bins[key];
+                // each source point starts a line to every destination point, and the other way about
+                bundle.start.x += src.value().start.x * dst.value().count; bundle.start.y += src.value().start.y * dst.value().count; bundle.start.z += src.value().start.z * dst.value().count;
+                bundle.end.x += dst.value().start.x * src.value().count; bundle.end.y += dst.value().start.y * src.value().count; bundle.end.z += dst.value().start.z * src.value().count;
+                bundle.count += src.value().count * dst.value().count;
+            }
+        }
+    }
+    void getBundles(vector < connectionBundle > &bundles) {
+        bundles.clear();
+        for (QHash < quint64, connectionBundle >::iterator bin = bins.begin(); bin != bins.end(); ++bin) {
+            connectionBundle bundle = bin.value();
+            bundle.start.x /= bundle.count; bundle.start.y /= bundle.count; bundle.start.z /= bundle.count;
+            bundle.end.x /= bundle.count; bundle.end.y /= bundle.count; bundle.end.z /= bundle.count;
+            bundles.push_back(bundle);
+        }
+    }
+
+private:
+    // the summed position and number of points in each occupied cell
+    QHash < uint, connectionBundle > sumCells(const vector < loc > &points, const vector < uint > &cellOf) {
+        QHash < uint, connectionBundle > sums;
+        for (uint i = 0; i < points.size(); ++i) {
+            connectionBundle &sum = sums[cellOf[i]];
+            sum.start.x += points[i].x; sum.start.y += points[i].y; sum.start.z += points[i].z;
+            ++sum.count;
+        }
+        return sums;
+    }
+    vector < uint > getCells(const vector < loc > &points) {
+        vector < uint > cellOf(points.size(), 0);
+        if (points.size() == 0) return cellOf;
+        loc minimum = points[0];
+        loc maximum = points[0];
+        for (uint i = 1; i < points.size(); ++i) {
+            minimum.x = qMin(minimum.x, points[i].x); maximum.x = qMax(maximum.x, points[i].x);
+            minimum.y = qMin(minimum.y, points[i].y); maximum.y = qMax(maximum.y, points[i].y);
+            minimum.z = qMin(minimum.z, points[i].z); maximum.z = qMax(maximum.z, points[i].z);
+        }
+        for (uint i = 0; i < points.size(); ++i) {
+            uint x = getCell(points[i].x, minimum.x, maximum.x);
+            uint y = getCell(points[i].y, minimum.y, maximum.y);
+            uint z = getCell(points[i].z, minimum.z, maximum.z);
+            cellOf[i] = (x * cells + y) * cells + z;
+        }
+        return cellOf;
+    }
+    uint getCell(float value, float minimum, float maximum) {
+        if (maximum <= minimum) return 0;
+        return qMin((int) ((value - minimum) / (maximum - minimum) * cells), cells - 1);
+    }
+
+    const vector < loc > &srcPoints;
+    const vector < loc > &dstPoints;
+    int cells;
+    vector < uint > srcCells;
+    vector < uint > dstCells;
+    QHash < quint64, connectionBundle > bins;
+
+};
+
+struct connectionVertices {
+
+    // what the vertices were built from, to tell when they are out of date
+    float offsets[6];
+    uint srcSize;
+    uint dstSize;
+    uint numConnections;
+    connectionType type;
+    float p;
+    int seed;
+    connectionDisplayMode mode;
+    uint budget;
+
+    // pairs of x, y, z for GL_LINES, in order of source neuron
+    vector < GLfloat > vertices;
+    // lines (or explicit connections) from source neuron i are srcStart[i] to srcStart[i+1]
+    vector < GLuint > srcStart;
+    vector < GLuint > dstStart;
+    // vertex indices of the lines, in order of destination neuron
+    vector < GLuint > dstIndices;
+    // explicit connection indices in order of source / destination neuron
+    vector < GLuint > srcOrder;
+    vector < GLuint > dstOrder;
+
+    // in the density mode the connections are drawn as these instead
+    vector < connectionBundle > bundles;
+
+    QGLBuffer * buffer;
+    const QGLContext * bufferContext;
+
+};
+
+struct connectionDLKey {
+
+    // what a connection display list was built from, to tell when it is out of date
+    float offsets[6];
+    uint srcSize;
+    uint dstSize;
+    uint numConnections;
+    int strength;
+    GLfloat center[3];
+    bool colourScheme;
+    bool srcVisualised;
+    bool dstVisualised;
+    float lineScaleFactor;
+    connectionDisplayMode mode;
+    uint budget;
+
+    bool operator==(const connectionDLKey &other) const {
+        for (int i = 0; i < 6; ++i) {
+            if (offsets[i] != other.offsets[i]) return false;
+        }
+        for (int i = 0; i < 3; ++i) {
+            if (center[i] != other.center[i]) return false;
+        }
+        return srcSize == other.srcSize && dstSize == other.dstSize && numConnections == other.numConnections \
+                && strength == other.strength && colourScheme == other.colourScheme && srcVisualised == other.srcVisualised \
+                && dstVisualised == other.dstVisualised && lineScaleFactor == other.lineScaleFactor \
+                && mode == other.mode && budget == other.budget;
+    }
+    bool operator!=(const connectionDLKey &other) const {return !(*this == other);}
+
+};
+
 struct loc3f {
     float x;
     float y;
@@ -84,12 +322,45 @@ public:
     QPixmap renderImage(int, int);
     void addLogs(QVector<logData *> *logs);
     void refreshAll();
+    void populationChanged(population * pop);
+    void populationMoved(population * pop);
+    void setLogPlayback(int step);
+    void setLogTime(int index);
 
 private:
     void drawNeuron(GLfloat, int, int, QColor);
     void setupView();
+    bool drawScene();
+    void drawIndexLabels(QPainter * painter, int width, int height);
+    bool updateLogColours();
+    void drawStatsOverlay(QPainter * painter);
     void createPopulationsDL();
+    void createPopulationDL(uint locNum, int LoD);
+    void compilePopulationDL(population * pop, int LoD);
+    void clearPopulationDLs(population * pop);
+    void drawPopulation(uint locNum, float screenRadius);
+    bool pickNeuron(QPoint point, int &popIndex, int &neuronIndex);
+    neuronBVH * getNeuronBVH(population * pop);
+    void setupInstancing();
+    bool useInstancing();
+    void createSphereMeshes();
+    float getNeuronScreenRadius(population * pop);
+    void drawPopulationPoints(population * pop, float screenRadius);
+    void createInstanceBuffer(uint locNum);
+    void updateColourBuffer(population * pop);
+    int getSelectedPopIndex(population * pop);
+    vector < double > getLogRow(logData * log, int row);
+    void prefetchLogRows();
+    void cancelLogRows();
+    int getPopulationLoD();
+    void finishLayout(QFutureWatcher < layoutJob * > * watcher);
     void createConnectionsDL();
+    connectionVertices * getConnectionVertices(uint targNum, population * src, population * dst, connection * conn, float srcX, float srcY, float srcZ, float dstX, float dstY, float dstZ);
+    void drawConnectionVertices(connectionVertices * verts, GLuint first, GLuint count, GLuint * indices);
+    void drawConnectionBundles(vector < connectionBundle > &bundles, int strength, GLfloat * center, float lineScaleFactor, QColor colour);
+    uint getConnectionBudget();
+    void clearConnectionVertices(connectionVertices * verts);
+    void clearConnectionVertices();
     QString currentObjectName;
     QAbstractTableModel * model;
     QAbstractItemModel * sysModel;
@@ -107,6 +378,8 @@ private:
     systemObject * selectedObject;
     int clickedPopulation;
     int clickedNeuron;
+    int hoverPopulation;
+    int hoverNeuron;
     int selectedIndex;
     int selectedType;
     QString last_distance_based_equation;
@@ -121,8 +394,60 @@ private:
     QTimer timer;
     bool orthoView;
     bool repaintAllowed;
+    QMap < population *, QFutureWatcher < layoutJob * > * > pendingLayouts;
+    QProgressBar * layoutProgress;
+    int layoutsQueued;
+    int layoutsDone;
+    // instanced drawing of neurons - display lists are used where the GL can't do this
+    bool instancingAvailable;
+    // how the neurons are drawn and why, found once per context and shown in the stats overlay
+    QString neuronDrawing;
+    const QGLContext * instancingContext;
+    QGLShaderProgram * neuronProgram;
+    // every level of detail of the sphere, one after another, found by LoD
+    QGLBuffer * sphereBuffer;
+    QMap < int, int > sphereFirsts;
+    QMap < int, int > sphereCounts;
+    QMap < population *, QGLBuffer * > instanceBuffers;
+    // log playback - colours are kept apart from the locations so they can be uploaded alone
+    QMap < population *, QGLBuffer * > colourBuffers;
+    int logPlaybackStep;
+    QMap < logData *, QMap < int, vector < double > > > logRowCache;
+    QMap < logData *, QFutureWatcher < logRowJob * > * > pendingLogRows;
+    // bumped when the logs shown change, so rows fetched for the old ones are dropped
+    uint logGeneration;
+    QMap < systemObject *, connectionVertices * > connVertices;
+    // only geometry that has changed is rebuilt - these record what each display list was built from
+    QSet < population * > dirtyPopulations;
+    QSet < systemObject * > dirtyConnections;
+    QMap < population *, uint > builtPopulations;
+    // detail each population was last drawn at, its display list for each detail used, and the boxes used to cull it
+    QMap < population *, int > populationLoDs;
+    QMap < population *, QMap < int, GLuint > > populationDLs;
+    QMap < population *, populationBounds > populationBoxes;
+    QMap < systemObject *, connectionDLKey > builtConnections;
+    // lines (or bundles in the density mode) in each connection display list, for the stats
+    QMap < systemObject *, uint > connectionDLEdges;
+    const QGLContext * dlContext;
+    int dlLoD;
+    // picking - neurons are found by casting a ray through the view the last frame was drawn with
+    QMap < population *, neuronBVH * > neuronBVHs;
+    GLdouble pickModelview[16];
+    GLdouble pickProjection[16];
+    GLint pickViewport[4];
+    bool pickMatricesValid;
+    // instrumentation - the frame being built, and those that have been drawn
+    renderStats currentStats;
+    QList < renderStats > statsHistory;
+    bool statsOverlayShown;
+    // how connections are shown, and the quality (0-2) that sets how many are drawn
+    connectionDisplayMode connectionMode;
+    int connectionQuality;
+    void (APIENTRY * drawArraysInstanced)(GLenum, GLint, GLsizei, GLsizei);
+    void (APIENTRY * vertexAttribDivisor)(GLuint, GLuint);
 #if QT_VERSION > QT_VERSION_CHECK(5, 0, 0)
     QImage renderQImage(int w, int h);
+    QImage renderOffscreen(int w, int h);
 #endif
 
 signals:
@@ -154,6 +479,12 @@ public slots:
     void updateLogData();
     void toggleOrthoView(bool);
     void allowRepaint();
+    void layoutGenerated();
+    void setStatsOverlayShown(bool);
+    void exportRenderStats();
+    void setConnectionDisplayMode(int);
+    void setConnectionQuality(int);
+    void logRowsFetched();
 
 protected:
     void initializeGL();
@@ -43,6 +43,7 @@ class rootLayout;
 class NineMLComponent;
 class NineMLComponentData;
 class NineMLLayout;
+class NineMLLayoutData;
 class systemObject;
 class valueListDialog;
 class BRAHMS_dialog;
@@ -165,6 +166,11 @@ enum drawStyle {
 
 };
 
+// levels of detail for the network canvas - the GLscale below which each applies
+#define LOD_HIDE_LABELS_SCALE 40.0
+#define LOD_HIDE_HANDLES_SCALE 30.0
+#define LOD_BUNDLE_SCALE 20.0
+
 struct trans {
     float GLscale;
     float viewX;
@@ -42,7 +42,7 @@ GLWidget::GLWidget(QWidget *parent):QWidget(parent)
 #endif
 {
     // variable for making sure we don't redraw the openGL when we don't need to
-    changed = 100;
+    changed = 1;
 
     currSelType = 0;
     currSelInd = 0;
@@ -61,6 +61,8 @@ GLWidget::GLWidget(QWidget *parent):QWidget(parent)
 
     // Nothing is moving to begin with.
     this->itemMoving = false;
+
+    this->gridCacheStep = 0;
 }
 
 
@@ -70,7 +72,25 @@ GLWidget::~GLWidget()
 
 void GLWidget::redrawGLview()
 {
-    changed = 100;
+    changed = 1;
+}
+
+void GLWidget::redrawGLregion(QRectF GLrect)
+{
+#ifdef Q_OS_MAC
+    // the whole frame is drawn to an image and copied over on OS X
+    changed = 1;
+#else
+    // convert to widget co-ordinates
+    QPointF topLeft(((GLrect.left()+viewX)*GLscale+(this->width()*RETINA_SUPPORT))/2, ((-GLrect.top()+viewY)*GLscale+(this->height()*RETINA_SUPPORT))/2);
+    QPointF bottomRight(((GLrect.right()+viewX)*GLscale+(this->width()*RETINA_SUPPORT))/2, ((-GLrect.bottom()+viewY)*GLscale+(this->height()*RETINA_SUPPORT))/2);
+    QRectF screenRect = QRectF(topLeft/RETINA_SUPPORT, bottomRight/RETINA_SUPPORT).normalized();
+
+    // leave room for selection outlines, handles and end markers
+    screenRect.adjust(-20, -20, 20, 20);
+
+    this->dirtyRegion += screenRect.toAlignedRect().intersected(this->rect());
+#endif
 }
 
 
@@ -78,12 +98,24 @@ void GLWidget::animate()
 {
     float animSpeed = 1.0;
 
-    GLscale += (targGLscale - GLscale)*animSpeed;
+    if (GLscale != targGLscale) {
+        GLscale += (targGLscale - GLscale)*animSpeed;
+        if (fabs(targGLscale - GLscale) < 0.001) {
+            GLscale = targGLscale;
+        }
+        changed = 1;
+    }
 
-    // only redraw the openGL when we need to
+    // only redraw the openGL when we need to - all of it if the view or
+    // the selection has changed, or just what has moved otherwise
     if (changed) {
         --changed;
+        this->dirtyRegion = QRegion();
         repaint();
+    } else if (!this->dirtyRegion.isEmpty()) {
+        QRegion region = this->dirtyRegion;
+        this->dirtyRegion = QRegion();
+        repaint(region);
     }
 }
 
@@ -91,6 +123,9 @@ void GLWidget::mousePressEvent(QMouseEvent* event)
 {
     this->button = event->button();
 
+    // the selection will change
+    changed = 1;
+
     // convert the incoming x and y into the openGL coordinates
     float xGL = float((event->x()*RETINA_SUPPORT)-(this->width()*RETINA_SUPPORT)/2)*2.0/(GLscale)-viewX;
     float yGL = -(float((event->y()*RETINA_SUPPORT)-(this->height()*RETINA_SUPPORT)/2)*2.0/(GLscale)-viewY);
@@ -120,7 +155,7 @@ void GLWidget::mousePressEvent(QMouseEvent* event)
 
 void GLWidget::mouseReleaseEvent(QMouseEvent* event)
 {
-    changed = 100;
+    changed = 1;
     this->button = Qt::NoButton;
     setCursor(Qt::ArrowCursor);
     // convert the incoming x and y into the openGL coordinates
@@ -157,7 +192,7 @@ void GLWidget::mouseReleaseEvent(QMouseEvent* event)
 
 void GLWidget::wheelEvent(QWheelEvent* event)
 {
-    changed = 100;
+    changed = 1;
     float val = float(event->delta()) / 320.0;
 
     val = pow(2.0f,val);
@@ -183,7 +218,11 @@ void GLWidget::wheelEvent(QWheelEvent* event)
 
 void GLWidget::mouseMoveEvent(QMouseEvent* event)
 {
-    changed = 100;
+    // objects being dragged ask for their own area to be redrawn, and
+    // panning redraws everything through move()
+    if (this->connectMode || this->button != Qt::LeftButton) {
+        changed = 1;
+    }
 
     // convert mouse event into openGL coordinates
     float xGL = float((event->x()*RETINA_SUPPORT)-(this->width()*RETINA_SUPPORT)/2)*2.0/(GLscale)-viewX;
@@ -209,7 +248,7 @@ void GLWidget::mouseMoveEvent(QMouseEvent* event)
 
 void GLWidget::keyPressEvent(QKeyEvent * event)
 {
-    changed = 100;
+    changed = 1;
 
     if (event->type() == QEvent::KeyPress) {
         if (event->key() == Qt::Key_Control) {
@@ -226,7 +265,7 @@ void GLWidget::keyPressEvent(QKeyEvent * event)
 
 void GLWidget::keyReleaseEvent(QKeyEvent * event)
 {
-    changed = 100;
+    changed = 1;
 
     if (event->type() == QEvent::KeyRelease) {
         if (event->key() == Qt::Key_Control) {
@@ -274,6 +313,11 @@ void GLWidget::paintEvent(QPaintEvent * event)
     painter.setRenderHint( QPainter::TextAntialiasing,true);
     painter.setRenderHint(QPainter::SmoothPixmapTransform,true);
 
+#ifndef Q_OS_MAC
+    // make the repainted area known to the scene so it can skip anything outside it
+    painter.setClipRegion(event->region());
+#endif
+
     QRect fillRectangle(event->rect().x()*RETINA_SUPPORT, event->rect().y()*RETINA_SUPPORT, event->rect().width()*RETINA_SUPPORT, event->rect().height()*RETINA_SUPPORT);
     painter.fillRect(fillRectangle, Qt::white);
     // painter.beginNativePainting();
@@ -293,37 +337,7 @@ void GLWidget::paintEvent(QPaintEvent * event)
     // if grid then draw it up:
 #ifndef Q_OS_MAC
     if (this->gridSelect) {
-        painter.save();
-        painter.translate((this->width()*RETINA_SUPPORT)/2, (this->height()*RETINA_SUPPORT)/2);
-        //painter.scale(,-GLscale/2.0);
-        painter.translate(viewX*(GLscale/2.0), viewY*(GLscale/2.0));
-        // too fine a grid looks bad and is of no use
-        QPen pen = painter.pen();
-        pen.setWidth(1.5*RETINA_SUPPORT);
-        painter.setPen(pen);
-        if (GLscale > 10) {
-            for (float i = round(-viewX/this->gridScale)*this->gridScale*GLscale; i < round(-viewX/this->gridScale)*this->gridScale+(this->width()*RETINA_SUPPORT); i +=this->gridScale*GLscale/2.0) {
-                for (float j =round(viewY/this->gridScale)*this->gridScale*GLscale; j < round(viewY/this->gridScale)*this->gridScale+(this->height()*RETINA_SUPPORT); j +=this->gridScale*GLscale/2.0) {
-                    painter.drawPoint(QPointF(i,j));
-                }
-            }
-            for (float i = round(-viewX/this->gridScale)*this->gridScale*GLscale; i > round(-viewX/this->gridScale)*this->gridScale-(this->width()*RETINA_SUPPORT); i -=this->gridScale*GLscale/2.0) {
-                for (float j =round(viewY/this->gridScale)*this->gridScale*GLscale; j > round(viewY/this->gridScale)*this->gridScale-(this->height()*RETINA_SUPPORT); j -=this->gridScale*GLscale/2.0) {
-                    painter.drawPoint(QPointF(i,j));
-                }
-            }
-            for (float i = round(-viewX/this->gridScale)*this->gridScale*GLscale; i > round(-viewX/this->gridScale)*this->gridScale-(this->width()*RETINA_SUPPORT); i -=this->gridScale*GLscale/2.0) {
-                for (float j =round(viewY/this->gridScale)*this->gridScale*GLscale; j < round(viewY/this->gridScale)*this->gridScale+(this->height()*RETINA_SUPPORT); j +=this->gridScale*GLscale/2.0) {
-                    painter.drawPoint(QPointF(i,j));
-                }
-            }
-            for (float i = round(-viewX/this->gridScale)*this->gridScale*GLscale; i < round(-viewX/this->gridScale)*this->gridScale+(this->width()*RETINA_SUPPORT); i +=this->gridScale*GLscale/2.0) {
-                for (float j =round(viewY/this->gridScale)*this->gridScale*GLscale; j > round(viewY/this->gridScale)*this->gridScale-(this->height()*RETINA_SUPPORT); j -=this->gridScale*GLscale/2.0) {
-                    painter.drawPoint(QPointF(i,j));
-                }
-            }
-        }
-        painter.restore();
+        this->drawGrid(painter);
     }
 #endif
 
@@ -341,8 +355,53 @@ void GLWidget::paintEvent(QPaintEvent * event)
 #endif
 }
 
+void GLWidget::drawGrid(QPainter &painter)
+{
+    // too fine a grid looks bad and is of no use
+    if (GLscale <= 10) {
+        return;
+    }
+
+    float step = this->gridScale*GLscale/2.0;
+    int width = this->width()*RETINA_SUPPORT;
+    int height = this->height()*RETINA_SUPPORT;
+
+    // redraw the dots only when the zoom, grid or widget size changes
+    if (step != this->gridCacheStep || this->gridCache.width() < width+2*step || this->gridCache.height() < height+2*step) {
+        this->gridCache = QPixmap(width+2*ceil(step)+2, height+2*ceil(step)+2);
+        this->gridCache.fill(Qt::transparent);
+
+        QPainter gridPainter(&this->gridCache);
+        gridPainter.setRenderHints(painter.renderHints());
+        QPen pen = painter.pen();
+        pen.setWidth(1.5*RETINA_SUPPORT);
+        gridPainter.setPen(pen);
+        for (float i = 0; i < this->gridCache.width(); i += step) {
+            for (float j = 0; j < this->gridCache.height(); j += step) {
+                gridPainter.drawPoint(QPointF(i,j));
+            }
+        }
+        gridPainter.end();
+
+        this->gridCacheStep = step;
+    }
+
+    // the grid has a dot on the GL origin, so shift the cached dots to line up with it
+    float originX = width/2 + viewX*(GLscale/2.0);
+    float originY = height/2 + viewY*(GLscale/2.0);
+    float offsetX = fmod(originX, step);
+    float offsetY = fmod(originY, step);
+    if (offsetX < 0) offsetX += step;
+    if (offsetY < 0) offsetY += step;
+
+    painter.drawPixmap(QPointF(round(offsetX-step), round(offsetY-step)), this->gridCache);
+}
+
 void GLWidget::move(GLfloat x, GLfloat y)
 {
+    // the whole view moves
+    changed = 1;
+
     this->viewX =x;
     this->viewY =-y;
     //emit reDraw();
@@ -369,7 +428,7 @@ void GLWidget::finishConnect()
     this->connectMode = false;
     this->setMouseTracking(false);
 
-    changed = 100;
+    changed = 1;
 }
 
 void GLWidget::saveImage()
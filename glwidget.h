@@ -76,6 +76,7 @@ public slots:
     void startConnect();
     void finishConnect();
     void redrawGLview();
+    void redrawGLregion(QRectF GLrect);
     void saveImage();
 
 protected:
@@ -102,6 +103,20 @@ private:
      * is only effective when connectMode==false
      */
     bool itemMoving;
+
+    /*!
+     * Area of the widget to repaint on the next frame if nothing
+     * requires the whole widget to be redrawn.
+     */
+    QRegion dirtyRegion;
+
+    /*!
+     * The dot grid for the current zoom, a little larger than the
+     * widget so it can be shifted into place as the view pans.
+     */
+    QPixmap gridCache;
+    float gridCacheStep;
+    void drawGrid(QPainter &painter);
 };
 
 #endif // GLWIDGET_H
@@ -0,0 +1,265 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+#include <Python.h>
+#include "headless.h"
+#include "rootdata.h"
+#include "projectobject.h"
+#include "experiment.h"
+#include "nineML_classes.h"
+
+// exit codes
+#define HEADLESS_OK 0
+#define HEADLESS_USAGE 1
+#define HEADLESS_INVALID 2
+#define HEADLESS_EXPORT_FAILED 3
+#define HEADLESS_RUN_FAILED 4
+
+static void printUsage()
+{
+    cerr << "usage: SpineCreator --headless <project.proj> [--validate] [--export] [--run]" << endl;
+    cerr << "           [--experiment <index|name>] [--simulator <name>] [--out <model dir>]" << endl;
+    cerr << "  --validate    check every component, exit " << HEADLESS_INVALID << " on errors" << endl;
+    cerr << "  --export      write the model and experiment for the simulator (out of date" << endl;
+    cerr << "                script and kernel connectivity is regenerated), exit " << HEADLESS_EXPORT_FAILED << " on errors" << endl;
+    cerr << "  --run         export, then run the simulator, exit " << HEADLESS_RUN_FAILED << " if it fails" << endl;
+}
+
+// print and clear the collected issues, returning the number of errors
+static int printIssues(QString title)
+{
+    QList < diagnostic > errors = diagnostics::instance()->takeErrors();
+    QList < diagnostic > warnings = diagnostics::instance()->takeWarnings();
+    if (errors.size() + warnings.size() > 0) {
+        cerr << title.toStdString() << endl;
+    }
+    for (int i = 0; i < errors.size(); ++i) {
+        cerr << "  error: " << errors[i].toString().remove(QRegExp("<[^>]*>")).toStdString() << endl;
+    }
+    for (int i = 0; i < warnings.size(); ++i) {
+        cerr << "  warning: " << warnings[i].toString().remove(QRegExp("<[^>]*>")).toStdString() << endl;
+    }
+    return errors.size();
+}
+
+int runHeadless(QStringList args)
+{
+    QString projectFile;
+    QString exptName;
+    QString simName;
+    QString outDir;
+    bool validate = false;
+    bool exportModel = false;
+    bool run = false;
+
+    for (int i = 1; i < args.size(); ++i) {
+        QString next = i+1 < args.size() ? args[i+1] : QString();
+        if (args[i] == "--headless") {
+            projectFile = next; ++i;
+        } else if (args[i] == "--validate") {
+            validate = true;
+        } else if (args[i] == "--export") {
+            exportModel = true;
+        } else if (args[i] == "--run") {
+            exportModel = true;
+            run = true;
+        } else if (args[i] == "--experiment") {
+            exptName = next; ++i;
+        } else if (args[i] == "--simulator") {
+            simName = next; ++i;
+        } else if (args[i] == "--out") {
+            outDir = next; ++i;
+        } else {
+            cerr << "unknown option " << args[i].toStdString() << endl;
+            printUsage();
+            return HEADLESS_USAGE;
+        }
+    }
+
+    if (projectFile.isEmpty() || (!validate && !exportModel)) {
+        printUsage();
+        return HEADLESS_USAGE;
+    }
+
+    // the same settings as the GUI, so the simulator configuration is shared
+    QCoreApplication::setOrganizationName("BLANK");
+    QCoreApplication::setOrganizationDomain("BLANK.ac.uk");
+    QCoreApplication::setApplicationName("SpineCreator");
+
+    projectObject::headless = true;
+
+    // connectivity scripts are run in the embedded interpreter
+    Py_Initialize();
+
+    rootData data;
+    data.main = NULL;
+
+    projectObject * project = new projectObject();
+    if (!project->open_project(projectFile)) {
+        cerr << "could not open project " << projectFile.toStdString() << endl;
+        delete project;
+        return HEADLESS_USAGE;
+    }
+    data.projects.push_back(project);
+    data.currProject = project;
+    project->copy_out_data(&data);
+
+    int result = HEADLESS_OK;
+
+    // validate //////////////////////////////////////////////////////////////
+    if (validate) {
+        vector < NineMLComponent * > * catalogs[4] = {&data.catalogNrn, &data.catalogWU, &data.catalogPS, &data.catalogUnsorted};
+        int errors = 0;
+        for (int c = 0; c < 4; ++c) {
+            for (uint i = 1; i < catalogs[c]->size(); ++i) {
+                (*catalogs[c])[i]->validateComponent();
+                errors += printIssues("Component '" + (*catalogs[c])[i]->name + "':");
+            }
+        }
+        if (errors > 0) {
+            cerr << errors << " errors found in components" << endl;
+            result = HEADLESS_INVALID;
+        }
+    }
+
+    // export ////////////////////////////////////////////////////////////////
+    if (exportModel && result == HEADLESS_OK) {
+
+        // pick the experiment - by index or name, else the selected one, else the first
+        experiment * expt = NULL;
+        for (uint i = 0; i < data.experiments.size(); ++i) {
+            if (exptName == QString::number(i) || exptName == data.experiments[i]->name) {
+                expt = data.experiments[i];
+            }
+            if (exptName.isEmpty() && expt == NULL && data.experiments[i]->selected) {
+                expt = data.experiments[i];
+            }
+        }
+        if (expt == NULL && exptName.isEmpty() && data.experiments.size() > 0) {
+            expt = data.experiments[0];
+        }
+        if (expt == NULL) {
+            cerr << "no experiment " << exptName.toStdString() << " in the project" << endl;
+            delete project;
+            return HEADLESS_USAGE;
+        }
+        for (uint i = 0; i < data.experiments.size(); ++i) {
+            data.experiments[i]->selected = (data.experiments[i] == expt);
+        }
+
+        if (simName.isEmpty()) {
+            simName = expt->setup.simType;
+        } else {
+            expt->setup.simType = simName;
+        }
+
+        QSettings settings;
+        settings.beginGroup("simulators/" + simName);
+        QString path = settings.value("path").toString();
+        QString wk_dir_string = QDir::toNativeSeparators(settings.value("working_dir").toString());
+        bool binary = settings.value("binary").toBool();
+        bool optimiseMaths = settings.value("optimise_maths").toBool();
+        settings.endGroup();
+
+        if (outDir.isEmpty()) {
+            if (wk_dir_string.isEmpty()) {
+                cerr << "no working directory set for simulator '" << simName.toStdString() << "' - use --out" << endl;
+                delete project;
+                return HEADLESS_USAGE;
+            }
+            outDir = QDir::toNativeSeparators(wk_dir_string + "/model/");
+        }
+
+        settings.setValue("simulator_export_path", outDir);
+        settings.setValue("export_binary", binary);
+        settings.setValue("export_optimise_maths", optimiseMaths);
+
+        bool exported = project->export_for_simulator(outDir, &data);
+        printIssues("Export:");
+
+        settings.remove("simulator_export_path");
+        settings.remove("export_binary");
+        settings.remove("export_optimise_maths");
+
+        if (!exported) {
+            cerr << "could not export " << projectFile.toStdString() << " to " << outDir.toStdString() << endl;
+            result = HEADLESS_EXPORT_FAILED;
+        }
+
+        // run ///////////////////////////////////////////////////////////////
+        if (run && result == HEADLESS_OK) {
+
+            QFileInfo script(path);
+            if (!script.exists() || !script.isExecutable()) {
+                cerr << "the simulator '" << path.toStdString() << "' does not exist or is not executable" << endl;
+                delete project;
+                return HEADLESS_RUN_FAILED;
+            }
+
+            // set up the environment for the spawned process
+            QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+            settings.beginGroup("simulators/" + simName + "/envVar");
+            QStringList keysTemp = settings.childKeys();
+            for (int i = 0; i < keysTemp.size(); ++i) {
+                env.insert(keysTemp[i], settings.value(keysTemp[i]).toString());
+            }
+            settings.endGroup();
+
+            QDir wk_dir(wk_dir_string);
+            QStringList simArgs;
+            simArgs << "-w" << wk_dir.absolutePath();
+            if (QDir(outDir) != QDir(wk_dir.absoluteFilePath("model"))) {
+                simArgs << "-m" << outDir;
+            }
+
+            QProcess simulator;
+            simulator.setWorkingDirectory(wk_dir.absolutePath());
+            simulator.setProcessEnvironment(env);
+            simulator.setProcessChannelMode(QProcess::ForwardedChannels);
+            simulator.start(path, simArgs);
+
+            if (!simulator.waitForStarted(5000)) {
+                cerr << "the simulator '" << path.toStdString() << "' failed to start" << endl;
+                result = HEADLESS_RUN_FAILED;
+            } else {
+                simulator.waitForFinished(-1);
+                if (simulator.exitStatus() == QProcess::NormalExit) {
+                    // the simulator's own codes would clash with ours, so report it and return ours
+                    if (simulator.exitCode() != 0) {
+                        cerr << "the simulator exited with code " << simulator.exitCode() << endl;
+                        result = HEADLESS_RUN_FAILED;
+                    }
+                } else {
+                    cerr << "the simulator crashed" << endl;
+                    result = HEADLESS_RUN_FAILED;
+                }
+            }
+        }
+    }
+
+    // also removes the project's temporary connection files
+    delete project;
+
+    return result;
+}
@@ -81,25 +81,32 @@ double logData::getMin() {
 
 vector < double > logData::getRow(int rowNum) {
 
+    return getRow(rowNum, logFile);
+}
+
+// reads a row from the given file using only the layout passed in, so rows can be
+// fetched on another thread with its own handle on the log and a copy of its layout
+static vector < double > readLogRow(fileFormat dataFormat, dataClasses dataClass, const vector < column > &columns, bool allLogged, int stride, int rowNum, QFile &file) {
+
 
     vector < double > rowData;
 
     // is not analog return empty
-    if (this->dataClass != ANALOGDATA)
+    if (dataClass != ANALOGDATA)
         return rowData;
 
     // get data
     switch (dataFormat) {
     case BINARY:
     {
-        if (!calculateBinaryDataStride())
+        if (stride == -1)
             return rowData;
 
         // stream data from file
-        QDataStream data(&logFile);
+        QDataStream data(&file);
         data.device()->seek(0);
         // offset into file
-        data.skipRawData(binaryDataStride*rowNum);
+        data.skipRawData(stride*rowNum);
 
         // if we skip to the end of the file
         if (data.atEnd())
@@ -189,6 +196,28 @@ vector < double > logData::getRow(int rowNum) {
     return rowData;
 }
 
+vector < double > logData::getRow(int rowNum, QFile &file) const {
+
+    return readLogRow(dataFormat, dataClass, columns, allLogged, getBinaryDataStride(), rowNum, file);
+}
+
+logRowReader logData::getRowReader() const {
+
+    logRowReader reader;
+    reader.fileName = logFile.fileName();
+    reader.dataFormat = dataFormat;
+    reader.dataClass = dataClass;
+    reader.columns = columns;
+    reader.allLogged = allLogged;
+    reader.stride = getBinaryDataStride();
+    return reader;
+}
+
+vector < double > logRowReader::getRow(int rowNum, QFile &file) const {
+
+    return readLogRow(dataFormat, dataClass, columns, allLogged, stride, rowNum, file);
+}
+
 bool logData::plotLine(QCustomPlot *plot, int colNum, int update) {
 
     // if no plot give up
@@ -521,28 +550,38 @@ bool logData::plotRaster(QCustomPlot * plot, QList < QVariant > indices, int upd
 
 bool logData::calculateBinaryDataStride() {
 
-    binaryDataStride = 0;
+    binaryDataStride = getBinaryDataStride();
+
+    if (binaryDataStride == -1) {
+        binaryDataStride = 0;
+        return false;
+    }
+    return true;
+}
+
+int logData::getBinaryDataStride() const {
+
+    int stride = 0;
 
     for (int i = 0; i < (int) columns.size(); ++i) {
         switch (columns[i].type) {
         case TYPE_DOUBLE:
-            binaryDataStride += sizeof(double);
+            stride += sizeof(double);
             break;
         case TYPE_FLOAT:
-            binaryDataStride += sizeof(float);
+            stride += sizeof(float);
             break;
         case TYPE_INT64:
-            binaryDataStride += sizeof(long int);
+            stride += sizeof(long int);
             break;
         case TYPE_INT32:
-            binaryDataStride += sizeof(int);
+            stride += sizeof(int);
             break;
         case TYPE_STRING:
-            binaryDataStride = 0;
-            return false;
+            return -1;
         }
     }
-    return true;
+    return stride;
 }
 
 int logData::calculateBinaryDataOffset(int colNum) {
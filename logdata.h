@@ -57,6 +57,19 @@ struct column {
     dataType type;
 };
 
+// what is needed to read rows of a log, copied so they can be read on another
+// thread even if the log itself is deleted meanwhile
+struct logRowReader {
+    QString fileName;
+    fileFormat dataFormat;
+    dataClasses dataClass;
+    vector < column > columns;
+    bool allLogged;
+    int stride;
+
+    vector < double > getRow(int rowNum, QFile &file) const;
+};
+
 class logData : public QObject
 {
     Q_OBJECT
@@ -83,9 +96,12 @@ public:
     double getMax();
     double getMin();
     vector < double > getRow(int rowNum);
+    vector < double > getRow(int rowNum, QFile &file) const;
+    logRowReader getRowReader() const;
     bool plotLine(QCustomPlot * plot, int colNum, int update = -1);
     bool plotRaster(QCustomPlot * plot, QList < QVariant > indices, int update = -1);
     bool calculateBinaryDataStride();
+    int getBinaryDataStride() const;
     int calculateBinaryDataOffset(int);
 
 signals:
@@ -24,15 +24,46 @@
 
 #include <QApplication>
 #include "mainwindow.h"
+#include "headless.h"
 
 
 int main(int argc, char *argv[])
 {
     // stop qt 5 salting the hash table and giving undeterministic xml attributes. Grrr...
     qputenv("QT_HASH_SEED", "12345");
+
+    // rendering figures from the command line - no window is shown
+    bool render = false;
+    // validating, exporting and running without the main window at all
+    bool headless = false;
+    for (int i = 1; i < argc; ++i) {
+        if (QString(argv[i]) == "--render") {
+            render = true;
+        }
+        if (QString(argv[i]) == "--headless") {
+            headless = true;
+        }
+    }
+
+    // no gui at all, so no display or platform plugin is needed
+    if (headless) {
+        QCoreApplication a(argc, argv);
+        return runHeadless(a.arguments());
+    }
+
+    // rendering still needs widgets and a GL context, but not a screen (qt 4 has no offscreen platform)
+#if QT_VERSION > QT_VERSION_CHECK(5, 0, 0)
+    if (render && qgetenv("QT_QPA_PLATFORM").isEmpty()) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+#endif
+
     QApplication a(argc, argv);
     a.setAttribute(Qt::AA_DontCreateNativeWidgetSiblings, true);
     MainWindow w;
+    if (render) {
+        return w.renderFigures(a.arguments());
+    }
     w.show();
     // only available on 5.2+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 2, 0)
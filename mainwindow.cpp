@@ -47,6 +47,7 @@
 
 #include "qdebug.h"
 #include "aboutdialog.h"
+#include "diagnostics.h"
 
 
 MainWindow::MainWindow(QWidget *parent) :
@@ -297,6 +298,7 @@ MainWindow::MainWindow(QWidget *parent) :
 
     QObject::connect(&(data), SIGNAL(finishDrawingSynapse()), ui->viewport, SLOT(finishConnect()));
     QObject::connect(&(data), SIGNAL(redrawGLview()), ui->viewport, SLOT(redrawGLview()));
+    QObject::connect(&(data), SIGNAL(redrawGLregion(QRectF)), ui->viewport, SLOT(redrawGLregion(QRectF)));
     //QObject::connect(&(data), SIGNAL(redrawGLview()), viewVZ.OpenGLWidget, SLOT(redraw()));
     QObject::connect(&(data), SIGNAL(setCaption(QString)), this, SLOT(setCaption(QString)));
     QObject::connect(&(data), SIGNAL(setWindowTitle()), this, SLOT(updateTitle()));
@@ -775,6 +777,16 @@ void MainWindow::initViewEL()
     run->setToolTip("Run the selected experiment in the chosen simulator");
     run->setIcon(style.standardIcon(QStyle::SP_MediaPlay));
     toolbar0->layout()->addWidget(run);
+
+    // and one for running several experiments, or a parameter sweep, at once
+    QToolButton * runBatch = new QToolButton();
+    runBatch->setMinimumHeight(27);
+    runBatch->setStyleSheet("QToolButton { color: white; border: 0px; }");
+    runBatch->setText("Batch run");
+    runBatch->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
+    runBatch->setToolTip("Run several experiments, or a sweep of a changed property, as concurrent simulations");
+    runBatch->setIcon(style.standardIcon(QStyle::SP_MediaSeekForward));
+    toolbar0->layout()->addWidget(runBatch);
     ((QHBoxLayout *) toolbar0->layout())->addStretch();
 
     QFrame* line0b = new QFrame();
@@ -788,6 +800,7 @@ void MainWindow::initViewEL()
 
     // internal connections
     connect(run, SIGNAL(clicked()), this->viewELhandler, SLOT(run()));
+    connect(runBatch, SIGNAL(clicked()), this->viewELhandler, SLOT(runBatch()));
     connect(this->viewELhandler, SIGNAL(enableRun(bool)), run, SLOT(setEnabled(bool)));
 }
 
@@ -1240,14 +1253,11 @@ void MainWindow::addComponentsToFileList()
                     component->validateComponent();
                 else
                     component->editedVersion->validateComponent();
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                num_errs += settings.beginReadArray("warnings");
-                settings.endArray();
+                int num_errs = diagnostics::instance()->errorCount();
+                num_errs += diagnostics::instance()->warningCount();
 
-                settings.remove("errors");
-                settings.remove("warnings");
+                diagnostics::instance()->clearErrors();
+                diagnostics::instance()->clearWarnings();
 
                 // red for not valid / green for valid / orange for edited
                 if (num_errs != 0)
@@ -1886,6 +1896,135 @@ void MainWindow::export_layout()
 }
 
 
+int MainWindow::renderFigures(QStringList args)
+{
+    QString projectFile;
+    QString outFile;
+    QString view = "network";
+    QString logDir;
+    int width = 1000;
+    int height = 1000;
+    double scale = 1.0;
+    double border = 1.0;
+    int firstFrame = 0;
+    int frameStep = 1;
+    int lastFrame = -1;
+
+    for (int i = 1; i < args.size(); ++i) {
+        QString next = i+1 < args.size() ? args[i+1] : QString();
+        if (args[i] == "--render") {
+            projectFile = next; ++i;
+        } else if (args[i] == "--out") {
+            outFile = next; ++i;
+        } else if (args[i] == "--view") {
+            view = next; ++i;
+        } else if (args[i] == "--width") {
+            width = next.toInt(); ++i;
+        } else if (args[i] == "--height") {
+            height = next.toInt(); ++i;
+        } else if (args[i] == "--scale") {
+            scale = next.toDouble(); ++i;
+        } else if (args[i] == "--border") {
+            border = next.toDouble(); ++i;
+        } else if (args[i] == "--logs") {
+            logDir = next; ++i;
+        } else if (args[i] == "--frames") {
+            // first:step:last in log rows
+            QStringList frames = next.split(":");
+            if (frames.size() == 3) {
+                firstFrame = frames[0].toInt();
+                frameStep = qMax(1, frames[1].toInt());
+                lastFrame = frames[2].toInt();
+            }
+            ++i;
+        }
+    }
+
+    if (projectFile.isEmpty() || outFile.isEmpty() || (view != "network" && view != "3d") || width <= 0 || height <= 0) {
+        cerr << "usage: SpineCreator --render <project.proj> --out <image.png> [--view network|3d]" << endl;
+        cerr << "           [--scale s] [--border b]                          (network)" << endl;
+        cerr << "           [--width w] [--height h] [--logs <dir> --frames first:step:last] (3d)" << endl;
+        return 1;
+    }
+
+    // nobody can close a dialog here, so problems go to stderr, and any error fails the render
+    projectObject::headless = true;
+
+    uint numProjects = data.projects.size();
+    diagnostics loadIssues;
+    {
+        diagnosticsScope scope(&loadIssues);
+        import_project(projectFile);
+    }
+    QList < diagnostic > loadWarnings = loadIssues.takeWarnings();
+    for (int i = 0; i < loadWarnings.size(); ++i) {
+        cerr << "Warning: " << loadWarnings[i].toString().remove(QRegExp("<[^>]*>")).toStdString() << endl;
+    }
+    QList < diagnostic > loadErrors = loadIssues.takeErrors();
+    for (int i = 0; i < loadErrors.size(); ++i) {
+        cerr << "Error: " << loadErrors[i].toString().remove(QRegExp("<[^>]*>")).toStdString() << endl;
+    }
+    if (loadErrors.size() > 0 || data.projects.size() == numProjects) {
+        cerr << "could not open project " << projectFile.toStdString() << endl;
+        return 1;
+    }
+
+    if (view == "network") {
+        // everything in the network
+        vector < systemObject * > list;
+        for (uint i = 0; i < data.populations.size(); ++i) {
+            list.push_back(data.populations[i]);
+            for (uint j = 0; j < data.populations[i]->projections.size(); ++j) {
+                list.push_back(data.populations[i]->projections[j]);
+            }
+        }
+        QImage image = data.renderNetworkImage(list, scale, border, false);
+        if (!image.save(outFile)) {
+            cerr << "could not write " << outFile.toStdString() << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    glConnectionWidget * gl = viewVZ.OpenGLWidget;
+
+    // show every population
+    for (uint i = 0; i < data.populations.size(); ++i) {
+        data.populations[i]->isVisualised = true;
+    }
+    gl->sysSelectionChanged(QModelIndex(), QModelIndex());
+
+    if (logDir.isEmpty() || lastFrame < firstFrame) {
+        QImage image = gl->renderImage(width, height).toImage();
+        if (image.isNull() || !image.save(outFile)) {
+            cerr << "could not render " << outFile.toStdString() << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // a frame per log row, numbered after the row
+    QDir logs(logDir);
+    QStringList filter;
+    filter << "*.xml";
+    logs.setNameFilters(filter);
+    viewGV.properties->loadDataFiles(logs.entryList(), &logs);
+    gl->addLogs(&viewGV.properties->logs);
+
+    QFileInfo outInfo(outFile);
+    for (int frame = firstFrame; frame <= lastFrame; frame += frameStep) {
+        gl->setLogTime(frame);
+        QString frameFile = outInfo.path() + QDir::separator() + outInfo.completeBaseName() + QString("_%1.").arg(frame, 6, 10, QChar('0')) + outInfo.suffix();
+        QImage image = gl->renderImage(width, height).toImage();
+        if (image.isNull() || !image.save(frameFile)) {
+            cerr << "could not render " << frameFile.toStdString() << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
 void MainWindow::saveImageAction()
 {
     if (viewCL.frame->isVisible()) {
@@ -2404,9 +2543,8 @@ void MainWindow::actionAddAnalogePort_triggered()
         QStringList errs;
         ap->validateAnalogPort(viewCL.root->al, &errs);
         // clear errors
-        QSettings settings;
-        settings.remove("errors");
-        settings.remove("warnings");
+        diagnostics::instance()->clearErrors();
+        diagnostics::instance()->clearWarnings();
         viewCL.root->al->AnalogPortList.push_back(ap);
         pli->addAnalogePortItem(ap);
         viewCL.root->gvlayout->updateLayout();
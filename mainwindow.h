@@ -128,6 +128,7 @@ public:
     void addComponentsToFileList();
     QString toolbarStyleSheet;
     void setProjectMenu();
+    int renderFigures(QStringList args);
 
 private:
     Ui::MainWindow *ui;
@@ -0,0 +1,961 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+#include "mathsoptimiser.h"
+#include <algorithm>
+
+// binding of printed maths - higher binds tighter
+#define PREC_UNARY 5
+#define PREC_ATOM 6
+
+enum mathsNodeType {
+    MathsNumber,
+    MathsSymbol,
+    MathsFunction,
+    MathsUnary,
+    MathsBinary
+};
+
+class mathsNode {
+
+public:
+    mathsNode(mathsNodeType t) {type = t; value = 0;}
+    ~mathsNode() {for (uint i = 0; i < args.size(); ++i) delete args[i];}
+    mathsNodeType type;
+    // symbol, function or operator name
+    QString name;
+    double value;
+    vector < mathsNode * > args;
+};
+
+static mathsNode * makeNumber(double value)
+{
+    mathsNode * node = new mathsNode(MathsNumber);
+    node->value = value;
+    return node;
+}
+
+static mathsNode * makeSymbol(QString name)
+{
+    mathsNode * node = new mathsNode(MathsSymbol);
+    node->name = name;
+    return node;
+}
+
+/////////////////////////////// PARSING
+
+static bool tokenise(QString equation, QStringList &tokens)
+{
+    equation.replace("&gt;", ">");
+    equation.replace("&lt;", "<");
+    equation.replace("&amp;", "&");
+
+    int i = 0;
+    while (i < equation.size()) {
+
+        QChar c = equation[i];
+
+        if (c.isSpace()) {
+            ++i;
+            continue;
+        }
+
+        // numbers, including exponents
+        if (c.isDigit() || (c == '.' && i + 1 < equation.size() && equation[i+1].isDigit())) {
+            int start = i;
+            while (i < equation.size() && (equation[i].isDigit() || equation[i] == '.')) {
+                ++i;
+            }
+            if (i < equation.size() && (equation[i] == 'e' || equation[i] == 'E')) {
+                int j = i + 1;
+                if (j < equation.size() && (equation[j] == '+' || equation[j] == '-')) {
+                    ++j;
+                }
+                if (j < equation.size() && equation[j].isDigit()) {
+                    i = j;
+                    while (i < equation.size() && equation[i].isDigit()) {
+                        ++i;
+                    }
+                }
+            }
+            tokens.push_back(equation.mid(start, i - start));
+            continue;
+        }
+
+        // names of variables and functions
+        if (c.isLetter() || c == '_') {
+            int start = i;
+            while (i < equation.size() && (equation[i].isLetterOrNumber() || equation[i] == '_')) {
+                ++i;
+            }
+            tokens.push_back(equation.mid(start, i - start));
+            continue;
+        }
+
+        QString pair = equation.mid(i, 2);
+        if (pair == "<=" || pair == ">=" || pair == "==" || pair == "!=" || pair == "&&" || pair == "||") {
+            tokens.push_back(pair);
+            i += 2;
+            continue;
+        }
+
+        if (QString("+-*/(),<>!").contains(c)) {
+            tokens.push_back(QString(c));
+            ++i;
+            continue;
+        }
+
+        // something we don't understand - leave this equation alone
+        return false;
+    }
+
+    return true;
+}
+
+static int binaryPrecedence(QString op)
+{
+    if (op == "||") return 0;
+    if (op == "&&") return 1;
+    if (op == "<" || op == ">" || op == "<=" || op == ">=" || op == "==" || op == "!=") return 2;
+    if (op == "+" || op == "-") return 3;
+    if (op == "*" || op == "/") return 4;
+    return -1;
+}
+
+class mathsParser {
+
+public:
+    mathsParser(QStringList t) {tokens = t; pos = 0;}
+    mathsNode * parse();
+
+private:
+    QStringList tokens;
+    int pos;
+    QString peek() {return pos < tokens.size() ? tokens[pos] : QString();}
+    mathsNode * parseBinary(int level);
+    mathsNode * parseUnary();
+    mathsNode * parsePrimary();
+};
+
+mathsNode * mathsParser::parse()
+{
+    mathsNode * node = parseBinary(0);
+    // trailing tokens mean the equation was not understood
+    if (node != NULL && pos != tokens.size()) {
+        delete node;
+        return NULL;
+    }
+    return node;
+}
+
+mathsNode * mathsParser::parseBinary(int level)
+{
+    if (level == PREC_UNARY) {
+        return parseUnary();
+    }
+
+    mathsNode * lhs = parseBinary(level + 1);
+    if (lhs == NULL) {
+        return NULL;
+    }
+
+    // left associative
+    while (binaryPrecedence(peek()) == level) {
+        QString op = tokens[pos++];
+        mathsNode * rhs = parseBinary(level + 1);
+        if (rhs == NULL) {
+            delete lhs;
+            return NULL;
+        }
+        mathsNode * node = new mathsNode(MathsBinary);
+        node->name = op;
+        node->args.push_back(lhs);
+        node->args.push_back(rhs);
+        lhs = node;
+    }
+
+    return lhs;
+}
+
+mathsNode * mathsParser::parseUnary()
+{
+    if (peek() == "-" || peek() == "+" || peek() == "!") {
+        QString op = tokens[pos++];
+        mathsNode * arg = parseUnary();
+        if (arg == NULL) {
+            return NULL;
+        }
+        mathsNode * node = new mathsNode(MathsUnary);
+        node->name = op;
+        node->args.push_back(arg);
+        return node;
+    }
+    return parsePrimary();
+}
+
+mathsNode * mathsParser::parsePrimary()
+{
+    QString token = peek();
+    if (token.isEmpty()) {
+        return NULL;
+    }
+    ++pos;
+
+    if (token == "(") {
+        mathsNode * node = parseBinary(0);
+        if (node == NULL) {
+            return NULL;
+        }
+        if (peek() != ")") {
+            delete node;
+            return NULL;
+        }
+        ++pos;
+        return node;
+    }
+
+    if (token[0].isDigit() || token[0] == '.') {
+        bool ok;
+        double value = token.toDouble(&ok);
+        if (!ok) {
+            return NULL;
+        }
+        return makeNumber(value);
+    }
+
+    if (token[0].isLetter() || token[0] == '_') {
+
+        if (peek() != "(") {
+            return makeSymbol(token);
+        }
+
+        // function call
+        ++pos;
+        mathsNode * node = new mathsNode(MathsFunction);
+        node->name = token;
+        if (peek() == ")") {
+            ++pos;
+            return node;
+        }
+        while (true) {
+            mathsNode * arg = parseBinary(0);
+            if (arg == NULL) {
+                delete node;
+                return NULL;
+            }
+            node->args.push_back(arg);
+            if (peek() == ",") {
+                ++pos;
+                continue;
+            }
+            if (peek() == ")") {
+                ++pos;
+                return node;
+            }
+            delete node;
+            return NULL;
+        }
+    }
+
+    return NULL;
+}
+
+static mathsNode * parseEquation(QString equation)
+{
+    QStringList tokens;
+    if (!tokenise(equation, tokens)) {
+        return NULL;
+    }
+    mathsParser parser(tokens);
+    return parser.parse();
+}
+
+/////////////////////////////// PRINTING
+
+static int nodePrecedence(mathsNode * node)
+{
+    switch (node->type) {
+    case MathsNumber:
+        return node->value < 0 ? PREC_UNARY : PREC_ATOM;
+    case MathsSymbol:
+    case MathsFunction:
+        return PREC_ATOM;
+    case MathsUnary:
+        return PREC_UNARY;
+    case MathsBinary:
+        return binaryPrecedence(node->name);
+    }
+    return PREC_ATOM;
+}
+
+static QString printNumber(double value)
+{
+    return QString::number(value, 'g', 15);
+}
+
+static QString printNode(mathsNode * node)
+{
+    switch (node->type) {
+    case MathsNumber:
+        if (node->value < 0) {
+            return "-" + printNumber(-node->value);
+        }
+        return printNumber(node->value);
+    case MathsSymbol:
+        return node->name;
+    case MathsFunction:
+    {
+        QStringList args;
+        for (uint i = 0; i < node->args.size(); ++i) {
+            args.push_back(printNode(node->args[i]));
+        }
+        return node->name + "(" + args.join(", ") + ")";
+    }
+    case MathsUnary:
+    {
+        QString arg = printNode(node->args[0]);
+        // bracket anything looser, and stop '- -x' being written as '--x'
+        if (nodePrecedence(node->args[0]) < PREC_UNARY || arg.startsWith("-") || arg.startsWith("+") || arg.startsWith("!")) {
+            arg = "(" + arg + ")";
+        }
+        return node->name + arg;
+    }
+    case MathsBinary:
+    {
+        int prec = binaryPrecedence(node->name);
+        QString lhs = printNode(node->args[0]);
+        QString rhs = printNode(node->args[1]);
+        // the order of evaluation is kept, so brackets on the right are needed at equal precedence
+        if (nodePrecedence(node->args[0]) < prec) {
+            lhs = "(" + lhs + ")";
+        }
+        if (nodePrecedence(node->args[1]) <= prec) {
+            rhs = "(" + rhs + ")";
+        }
+        return lhs + " " + node->name + " " + rhs;
+    }
+    }
+    return "";
+}
+
+/////////////////////////////// ANALYSIS
+
+static bool isPureFunction(QString name)
+{
+    // the random functions give a new value on each call, so can't be folded or shared
+    QStringList functions;
+    functions << "pow" << "exp" << "sin" << "cos" << "log" << "log10" << "sinh" << "cosh" << "tanh" << "sqrt"
+              << "atan" << "asin" << "acos" << "asinh" << "acosh" << "atanh" << "atan2" << "ceil" << "floor";
+    return functions.contains(name);
+}
+
+static bool evaluateFunction(QString name, vector < double > &args, double &result)
+{
+    if (args.size() == 2) {
+        if (name == "pow") {result = pow(args[0], args[1]); return true;}
+        if (name == "atan2") {result = atan2(args[0], args[1]); return true;}
+        return false;
+    }
+    if (args.size() != 1) {
+        return false;
+    }
+    double x = args[0];
+    if (name == "exp") {result = exp(x); return true;}
+    if (name == "sin") {result = sin(x); return true;}
+    if (name == "cos") {result = cos(x); return true;}
+    if (name == "log") {result = log(x); return true;}
+    if (name == "log10") {result = log10(x); return true;}
+    if (name == "sinh") {result = sinh(x); return true;}
+    if (name == "cosh") {result = cosh(x); return true;}
+    if (name == "tanh") {result = tanh(x); return true;}
+    if (name == "sqrt") {result = sqrt(x); return true;}
+    if (name == "atan") {result = atan(x); return true;}
+    if (name == "asin") {result = asin(x); return true;}
+    if (name == "acos") {result = acos(x); return true;}
+    if (name == "asinh") {result = asinh(x); return true;}
+    if (name == "acosh") {result = acosh(x); return true;}
+    if (name == "atanh") {result = atanh(x); return true;}
+    if (name == "ceil") {result = ceil(x); return true;}
+    if (name == "floor") {result = floor(x); return true;}
+    return false;
+}
+
+static bool isFinite(double value)
+{
+    return value == value && value != INFINITY && value != -INFINITY;
+}
+
+// leaves are not worth giving a name to
+static bool isLeaf(mathsNode * node)
+{
+    if (node->type == MathsNumber || node->type == MathsSymbol) {
+        return true;
+    }
+    if (node->type == MathsUnary) {
+        return isLeaf(node->args[0]);
+    }
+    return false;
+}
+
+static bool isPure(mathsNode * node)
+{
+    if (node->type == MathsFunction && !isPureFunction(node->name)) {
+        return false;
+    }
+    for (uint i = 0; i < node->args.size(); ++i) {
+        if (!isPure(node->args[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isParameterOnly(mathsNode * node, QSet < QString > &parameterNames)
+{
+    if (node->type == MathsSymbol) {
+        return parameterNames.contains(node->name);
+    }
+    if (node->type == MathsFunction && !isPureFunction(node->name)) {
+        return false;
+    }
+    for (uint i = 0; i < node->args.size(); ++i) {
+        if (!isParameterOnly(node->args[i], parameterNames)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void replaceWithArg(mathsNode * &node, int index)
+{
+    mathsNode * arg = node->args[index];
+    node->args.erase(node->args.begin() + index);
+    delete node;
+    node = arg;
+}
+
+static void replaceWithNumber(mathsNode * &node, double value)
+{
+    delete node;
+    node = makeNumber(value);
+}
+
+static bool isNumber(mathsNode * node, double value)
+{
+    return node->type == MathsNumber && node->value == value;
+}
+
+static void foldConstants(mathsNode * &node, QMap <QString, double> &fixedValues)
+{
+    for (uint i = 0; i < node->args.size(); ++i) {
+        foldConstants(node->args[i], fixedValues);
+    }
+
+    switch (node->type) {
+    case MathsNumber:
+        break;
+    case MathsSymbol:
+        if (fixedValues.contains(node->name)) {
+            replaceWithNumber(node, fixedValues[node->name]);
+        }
+        break;
+    case MathsUnary:
+        if (node->args[0]->type == MathsNumber) {
+            double value = node->args[0]->value;
+            if (node->name == "-") replaceWithNumber(node, -value);
+            else if (node->name == "+") replaceWithNumber(node, value);
+            else if (node->name == "!") replaceWithNumber(node, value == 0 ? 1 : 0);
+        } else if (node->name == "+") {
+            replaceWithArg(node, 0);
+        }
+        break;
+    case MathsFunction:
+    {
+        if (!isPureFunction(node->name)) {
+            break;
+        }
+        vector < double > args;
+        for (uint i = 0; i < node->args.size(); ++i) {
+            if (node->args[i]->type != MathsNumber) {
+                return;
+            }
+            args.push_back(node->args[i]->value);
+        }
+        double result;
+        // domain errors are left for the simulator to report
+        if (evaluateFunction(node->name, args, result) && isFinite(result)) {
+            replaceWithNumber(node, result);
+        }
+        break;
+    }
+    case MathsBinary:
+    {
+        mathsNode * lhs = node->args[0];
+        mathsNode * rhs = node->args[1];
+        if (lhs->type == MathsNumber && rhs->type == MathsNumber) {
+            double a = lhs->value;
+            double b = rhs->value;
+            double result;
+            if (node->name == "+") result = a + b;
+            else if (node->name == "-") result = a - b;
+            else if (node->name == "*") result = a * b;
+            else if (node->name == "/") result = a / b;
+            else if (node->name == "<") result = a < b;
+            else if (node->name == ">") result = a > b;
+            else if (node->name == "<=") result = a <= b;
+            else if (node->name == ">=") result = a >= b;
+            else if (node->name == "==") result = a == b;
+            else if (node->name == "!=") result = a != b;
+            else if (node->name == "&&") result = a && b;
+            else if (node->name == "||") result = a || b;
+            else break;
+            if (isFinite(result)) {
+                replaceWithNumber(node, result);
+            }
+            break;
+        }
+        // identities that hold whatever the value of the other side
+        if (node->name == "*" && isNumber(lhs, 1)) replaceWithArg(node, 1);
+        else if (node->name == "*" && isNumber(rhs, 1)) replaceWithArg(node, 0);
+        else if (node->name == "/" && isNumber(rhs, 1)) replaceWithArg(node, 0);
+        else if (node->name == "+" && isNumber(lhs, 0)) replaceWithArg(node, 1);
+        else if (node->name == "+" && isNumber(rhs, 0)) replaceWithArg(node, 0);
+        else if (node->name == "-" && isNumber(rhs, 0)) replaceWithArg(node, 0);
+        break;
+    }
+    }
+}
+
+static void countSubtrees(mathsNode * node, QMap < QString, int > &counts)
+{
+    if (isLeaf(node)) {
+        return;
+    }
+    if (isPure(node)) {
+        counts[printNode(node)] += 1;
+    }
+    for (uint i = 0; i < node->args.size(); ++i) {
+        countSubtrees(node->args[i], counts);
+    }
+}
+
+static void replaceSubtree(mathsNode * &node, QString text, QString name)
+{
+    if (isLeaf(node)) {
+        return;
+    }
+    if (printNode(node) == text) {
+        delete node;
+        node = makeSymbol(name);
+        return;
+    }
+    for (uint i = 0; i < node->args.size(); ++i) {
+        replaceSubtree(node->args[i], text, name);
+    }
+}
+
+static QSet < QString > getSymbols(QString equation)
+{
+    QSet < QString > symbols;
+    QStringList tokens;
+    tokenise(equation, tokens);
+    for (int i = 0; i < tokens.size(); ++i) {
+        if (tokens[i][0].isLetter() || tokens[i][0] == '_') {
+            symbols.insert(tokens[i]);
+        }
+    }
+    return symbols;
+}
+
+/////////////////////////////// OPTIMISER
+
+mathsOptimiser::mathsOptimiser()
+{
+    this->component = NULL;
+}
+
+mathsOptimiser::~mathsOptimiser()
+{
+    restore();
+}
+
+bool mathsOptimiser::optimise(NineMLComponent * component, QMap <QString, double> fixedValues)
+{
+    // only one Component at a time
+    restore();
+
+    this->component = component;
+    this->originalAliasList = component->AliasList;
+
+    // names that are Parameters (and not being replaced with a value) stay constant during a run
+    for (uint i = 0; i < component->ParameterList.size(); ++i) {
+        if (!fixedValues.contains(component->ParameterList[i]->name)) {
+            this->parameterNames.insert(component->ParameterList[i]->name);
+        }
+    }
+
+    // names we must not use for new Aliases
+    this->usedNames.insert("t");
+    this->usedNames.insert("dt");
+    for (uint i = 0; i < component->ParameterList.size(); ++i) {
+        this->usedNames.insert(component->ParameterList[i]->name);
+    }
+    for (uint i = 0; i < component->StateVariableList.size(); ++i) {
+        this->usedNames.insert(component->StateVariableList[i]->name);
+    }
+    for (uint i = 0; i < component->AliasList.size(); ++i) {
+        this->usedNames.insert(component->AliasList[i]->name);
+    }
+    for (uint i = 0; i < component->AnalogPortList.size(); ++i) {
+        this->usedNames.insert(component->AnalogPortList[i]->name);
+    }
+    for (uint i = 0; i < component->EventPortList.size(); ++i) {
+        this->usedNames.insert(component->EventPortList[i]->name);
+    }
+    for (uint i = 0; i < component->ImpulsePortList.size(); ++i) {
+        this->usedNames.insert(component->ImpulsePortList[i]->name);
+    }
+
+    collectEquations();
+
+    // fold constants
+    for (uint i = 0; i < this->equations.size(); ++i) {
+        foldConstants(this->equations[i].tree, fixedValues);
+    }
+
+    // hoist Parameter-only subexpressions - Aliases that are already Parameter-only can be reused
+    QMap <QString, QString> hoisted;
+    for (uint i = 0; i < this->equations.size(); ++i) {
+        optimiserEquation &eq = this->equations[i];
+        if (eq.alias != NULL && !isLeaf(eq.tree) && isParameterOnly(eq.tree, this->parameterNames)) {
+            hoisted[printNode(eq.tree)] = eq.alias->name;
+        }
+    }
+    for (uint i = 0; i < this->equations.size(); ++i) {
+        optimiserEquation &eq = this->equations[i];
+        if (eq.alias != NULL && isParameterOnly(eq.tree, this->parameterNames)) {
+            continue;
+        }
+        hoistParameters(eq.tree, hoisted);
+    }
+
+    eliminateCommonSubexpressions();
+
+    // write back anything that changed
+    bool changed = this->addedAliases.size() > 0;
+    for (uint i = 0; i < this->equations.size(); ++i) {
+
+        optimiserEquation &eq = this->equations[i];
+        QString text = printNode(eq.tree);
+
+        if (std::find(this->addedAliases.begin(), this->addedAliases.end(), eq.alias) != this->addedAliases.end()) {
+            eq.maths->equation = text;
+            continue;
+        }
+
+        // ignore differences in spacing
+        if (text == eq.originalText) {
+            continue;
+        }
+
+        this->changedMaths.push_back(eq.maths);
+        this->originalEquations.push_back(eq.maths->equation);
+
+        this->report.push_back(component->name + ": " + eq.location);
+        this->report.push_back("    original:  " + eq.maths->equation);
+        this->report.push_back("    rewritten: " + text);
+
+        eq.maths->equation = text;
+        changed = true;
+    }
+
+    for (uint i = 0; i < this->addedAliases.size(); ++i) {
+        this->report.push_back(component->name + ": added Alias " + this->addedAliases[i]->name);
+        this->report.push_back("    rewritten: " + this->addedAliases[i]->maths->equation);
+    }
+
+    sortAliases();
+
+    clearEquations();
+
+    return changed;
+}
+
+void mathsOptimiser::restore()
+{
+    if (this->component == NULL) {
+        return;
+    }
+
+    for (uint i = 0; i < this->changedMaths.size(); ++i) {
+        this->changedMaths[i]->equation = this->originalEquations[i];
+    }
+    this->component->AliasList = this->originalAliasList;
+    for (uint i = 0; i < this->addedAliases.size(); ++i) {
+        delete this->addedAliases[i];
+    }
+
+    this->changedMaths.clear();
+    this->originalEquations.clear();
+    this->originalAliasList.clear();
+    this->addedAliases.clear();
+    this->parameterNames.clear();
+    this->usedNames.clear();
+    clearEquations();
+
+    this->component = NULL;
+}
+
+void mathsOptimiser::collectEquations()
+{
+    vector < MathInLine * > maths;
+    QStringList locations;
+    vector < bool > continuous;
+    vector < Alias * > aliases;
+
+    for (uint i = 0; i < component->AliasList.size(); ++i) {
+        maths.push_back(component->AliasList[i]->maths);
+        locations.push_back("Alias " + component->AliasList[i]->name);
+        continuous.push_back(true);
+        aliases.push_back(component->AliasList[i]);
+    }
+
+    for (uint r = 0; r < component->RegimeList.size(); ++r) {
+
+        Regime * regime = component->RegimeList[r];
+
+        for (uint i = 0; i < regime->TimeDerivativeList.size(); ++i) {
+            maths.push_back(regime->TimeDerivativeList[i]->maths);
+            locations.push_back("Regime " + regime->name + ": d" + regime->TimeDerivativeList[i]->variable_name + "/dt");
+            continuous.push_back(true);
+            aliases.push_back(NULL);
+        }
+        for (uint i = 0; i < regime->OnConditionList.size(); ++i) {
+            for (uint j = 0; j < regime->OnConditionList[i]->StateAssignList.size(); ++j) {
+                maths.push_back(regime->OnConditionList[i]->StateAssignList[j]->maths);
+                locations.push_back("Regime " + regime->name + ": OnCondition assigns " + regime->OnConditionList[i]->StateAssignList[j]->name);
+                continuous.push_back(false);
+                aliases.push_back(NULL);
+            }
+        }
+        for (uint i = 0; i < regime->OnEventList.size(); ++i) {
+            for (uint j = 0; j < regime->OnEventList[i]->StateAssignList.size(); ++j) {
+                maths.push_back(regime->OnEventList[i]->StateAssignList[j]->maths);
+                locations.push_back("Regime " + regime->name + ": OnEvent assigns " + regime->OnEventList[i]->StateAssignList[j]->name);
+                continuous.push_back(false);
+                aliases.push_back(NULL);
+            }
+        }
+        for (uint i = 0; i < regime->OnImpulseList.size(); ++i) {
+            for (uint j = 0; j < regime->OnImpulseList[i]->StateAssignList.size(); ++j) {
+                maths.push_back(regime->OnImpulseList[i]->StateAssignList[j]->maths);
+                locations.push_back("Regime " + regime->name + ": OnImpulse assigns " + regime->OnImpulseList[i]->StateAssignList[j]->name);
+                continuous.push_back(false);
+                aliases.push_back(NULL);
+            }
+        }
+    }
+
+    for (uint i = 0; i < maths.size(); ++i) {
+
+        if (maths[i] == NULL) {
+            continue;
+        }
+
+        // maths we can't parse is exported as it is
+        mathsNode * tree = parseEquation(maths[i]->equation);
+        if (tree == NULL) {
+            continue;
+        }
+
+        optimiserEquation eq;
+        eq.maths = maths[i];
+        eq.tree = tree;
+        eq.location = locations[i];
+        eq.continuous = continuous[i];
+        eq.alias = aliases[i];
+        eq.originalText = printNode(tree);
+        this->equations.push_back(eq);
+    }
+}
+
+void mathsOptimiser::hoistParameters(mathsNode * &node, QMap <QString, QString> &hoisted)
+{
+    if (isLeaf(node)) {
+        return;
+    }
+
+    if (isParameterOnly(node, this->parameterNames)) {
+        QString text = printNode(node);
+        if (!hoisted.contains(text)) {
+            hoisted[text] = getUniqueName("opt_p");
+            addAlias(hoisted[text], text);
+        }
+        QString name = hoisted[text];
+        delete node;
+        node = makeSymbol(name);
+        return;
+    }
+
+    for (uint i = 0; i < node->args.size(); ++i) {
+        hoistParameters(node->args[i], hoisted);
+    }
+}
+
+void mathsOptimiser::eliminateCommonSubexpressions()
+{
+    // StateAssignments are left out as they happen in order during an event, so an
+    // Alias of the State Variables would not see the same values
+    while (true) {
+
+        QMap < QString, int > counts;
+        for (uint i = 0; i < this->equations.size(); ++i) {
+            if (this->equations[i].continuous) {
+                countSubtrees(this->equations[i].tree, counts);
+            }
+        }
+
+        // take the largest repeated subexpression
+        QString best;
+        for (QMap < QString, int >::iterator it = counts.begin(); it != counts.end(); ++it) {
+            if (it.value() > 1 && it.key().size() > best.size()) {
+                best = it.key();
+            }
+        }
+        if (best.isEmpty()) {
+            break;
+        }
+
+        // use an Alias that already computes exactly this if there is one
+        Alias * existing = NULL;
+        for (uint i = 0; i < this->equations.size(); ++i) {
+            if (this->equations[i].alias != NULL && printNode(this->equations[i].tree) == best) {
+                existing = this->equations[i].alias;
+                break;
+            }
+        }
+
+        QString name;
+        if (existing != NULL) {
+            name = existing->name;
+        } else {
+            name = getUniqueName("opt_cse");
+        }
+
+        for (uint i = 0; i < this->equations.size(); ++i) {
+            if (this->equations[i].continuous && this->equations[i].alias != existing) {
+                replaceSubtree(this->equations[i].tree, best, name);
+            }
+        }
+
+        // the new Alias joins the equations so its own subexpressions can be shared too
+        if (existing == NULL) {
+            Alias * alias = addAlias(name, best);
+            optimiserEquation eq;
+            eq.maths = alias->maths;
+            eq.tree = parseEquation(best);
+            eq.location = "Alias " + name;
+            eq.continuous = true;
+            eq.alias = alias;
+            eq.originalText = best;
+            this->equations.push_back(eq);
+        }
+    }
+}
+
+void mathsOptimiser::sortAliases()
+{
+    // Aliases can now refer to Aliases that were later in the list, so put each after
+    // the Aliases it uses while keeping the existing order where possible
+    vector < Alias * > unsorted = this->component->AliasList;
+    vector < Alias * > sorted;
+
+    QSet < QString > aliasNames;
+    for (uint i = 0; i < unsorted.size(); ++i) {
+        aliasNames.insert(unsorted[i]->name);
+    }
+
+    QSet < QString > placed;
+    while (unsorted.size() > 0) {
+
+        bool progress = false;
+
+        for (uint i = 0; i < unsorted.size(); ++i) {
+
+            QSet < QString > symbols = getSymbols(unsorted[i]->maths->equation);
+            bool ready = true;
+            foreach (QString symbol, symbols) {
+                if (aliasNames.contains(symbol) && symbol != unsorted[i]->name && !placed.contains(symbol)) {
+                    ready = false;
+                    break;
+                }
+            }
+
+            if (ready) {
+                sorted.push_back(unsorted[i]);
+                placed.insert(unsorted[i]->name);
+                unsorted.erase(unsorted.begin() + i);
+                progress = true;
+                break;
+            }
+        }
+
+        // a cycle - leave the rest as they were and let validation deal with it
+        if (!progress) {
+            sorted.insert(sorted.end(), unsorted.begin(), unsorted.end());
+            break;
+        }
+    }
+
+    this->component->AliasList = sorted;
+}
+
+QString mathsOptimiser::getUniqueName(QString prefix)
+{
+    int i = 1;
+    while (this->usedNames.contains(prefix + QString::number(i))) {
+        ++i;
+    }
+    QString name = prefix + QString::number(i);
+    this->usedNames.insert(name);
+    return name;
+}
+
+Alias * mathsOptimiser::addAlias(QString name, QString equation)
+{
+    Alias * alias = new Alias();
+    alias->name = name;
+    alias->maths->equation = equation;
+    this->component->AliasList.push_back(alias);
+    this->addedAliases.push_back(alias);
+    return alias;
+}
+
+void mathsOptimiser::clearEquations()
+{
+    for (uint i = 0; i < this->equations.size(); ++i) {
+        delete this->equations[i].tree;
+    }
+    this->equations.clear();
+}
@@ -0,0 +1,102 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+#ifndef MATHSOPTIMISER_H
+#define MATHSOPTIMISER_H
+
+#include "globalHeader.h"
+#include "nineML_classes.h"
+
+class mathsNode;
+
+struct optimiserEquation {
+    MathInLine * maths;
+    mathsNode * tree;
+    // where the equation lives, for the report
+    QString location;
+    // TimeDerivatives and Aliases are evaluated continuously, StateAssignments only on events
+    bool continuous;
+    // set if the equation is the body of an Alias
+    Alias * alias;
+    // the equation as parsed, before any rewriting
+    QString originalText;
+};
+
+/*!
+ * \brief The mathsOptimiser class rewrites the MathInline of a Component before it
+ * is exported for a simulator. It folds constants (including Parameters that have the
+ * same FixedValue everywhere the Component is used), hoists Parameter-only subexpressions
+ * into Aliases and replaces repeated subexpressions with Aliases.
+ *
+ * The Component is edited in place so that it can be written out with the normal code,
+ * and restore() must be called afterwards to put the project back as it was.
+ */
+class mathsOptimiser
+{
+public:
+    mathsOptimiser();
+    ~mathsOptimiser();
+
+    /*!
+     * \brief optimise
+     * \param component The Component to rewrite
+     * \param fixedValues Parameters that can be replaced by their value
+     * \return true if any maths was changed
+     */
+    bool optimise(NineMLComponent * component, QMap <QString, double> fixedValues);
+
+    /*!
+     * \brief restore puts back the original maths and Aliases of the last optimised Component
+     */
+    void restore();
+
+    /*!
+     * \brief report lists each rewritten equation next to the original
+     */
+    QStringList report;
+
+private:
+    NineMLComponent * component;
+
+    // undo information
+    vector < MathInLine * > changedMaths;
+    QStringList originalEquations;
+    vector < Alias * > originalAliasList;
+    vector < Alias * > addedAliases;
+
+    // working state
+    vector < optimiserEquation > equations;
+    QSet < QString > parameterNames;
+    QSet < QString > usedNames;
+
+    void collectEquations();
+    void hoistParameters(mathsNode * &node, QMap <QString, QString> &hoisted);
+    void eliminateCommonSubexpressions();
+    void sortAliases();
+    QString getUniqueName(QString prefix);
+    Alias * addAlias(QString name, QString equation);
+    void clearEquations();
+};
+
+#endif // MATHSOPTIMISER_H
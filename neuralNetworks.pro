@@ -11,7 +11,7 @@ INCLUDEPATH += ../shared
 QT       += core gui opengl xml network
 
 greaterThan(QT_MAJOR_VERSION, 4) {
-QT       += printsupport
+QT       += printsupport concurrent
 }
 
 TARGET = spinecreator
@@ -63,7 +63,14 @@ SOURCES += main.cpp \
     logdata.cpp \
     aboutdialog.cpp \
     projectobject.cpp \
-    filteroutundoredoevents.cpp
+    filteroutundoredoevents.cpp \
+    mathsoptimiser.cpp \
+    spatialindex.cpp \
+    objectregistry.cpp \
+    neuronbvh.cpp \
+    diagnostics.cpp \
+    batchrunner.cpp \
+    headless.cpp
 
 HEADERS  += mainwindow.h \
     glwidget.h \
@@ -112,7 +119,14 @@ HEADERS  += mainwindow.h \
     aboutdialog.h \
     projectobject.h \
     rootlayout.h \
-    filteroutundoredoevents.h
+    filteroutundoredoevents.h \
+    mathsoptimiser.h \
+    spatialindex.h \
+    objectregistry.h \
+    neuronbvh.h \
+    diagnostics.h \
+    batchrunner.h \
+    headless.h
 
 FORMS    += mainwindow.ui \
     ninemlsortingdialog.ui \
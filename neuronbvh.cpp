@@ -0,0 +1,221 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+#include "neuronbvh.h"
+#include <algorithm>
+
+// neurons per leaf
+#define BVH_LEAF_SIZE 4
+
+// orders neuron indices by their position on one axis
+struct neuronAxisLessThan {
+    const vector <loc> * centres;
+    int axis;
+    bool operator()(uint a, uint b) const {
+        const loc &la = (*centres)[a];
+        const loc &lb = (*centres)[b];
+        if (axis == 0) return la.x < lb.x;
+        if (axis == 1) return la.y < lb.y;
+        return la.z < lb.z;
+    }
+};
+
+neuronBVH::neuronBVH(const vector <loc> &locations, float radius)
+{
+    this->centres = locations;
+    this->radius = radius;
+    this->numNeurons = locations.size();
+
+    this->order.resize(this->numNeurons);
+    for (uint i = 0; i < this->numNeurons; ++i) {
+        this->order[i] = i;
+    }
+
+    if (this->numNeurons > 0) {
+        this->nodes.reserve(2*this->numNeurons/BVH_LEAF_SIZE+1);
+        this->build(0, this->numNeurons);
+    }
+}
+
+uint neuronBVH::build(uint first, uint count)
+{
+    uint index = this->nodes.size();
+    this->nodes.push_back(node());
+
+    // bounds of the spheres under this node
+    float min[3] = {INFINITY, INFINITY, INFINITY};
+    float max[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (uint i = first; i < first+count; ++i) {
+        const loc &l = this->centres[this->order[i]];
+        float p[3] = {l.x, l.y, l.z};
+        for (int a = 0; a < 3; ++a) {
+            min[a] = qMin(min[a], p[a] - this->radius);
+            max[a] = qMax(max[a], p[a] + this->radius);
+        }
+    }
+
+    for (int a = 0; a < 3; ++a) {
+        this->nodes[index].min[a] = min[a];
+        this->nodes[index].max[a] = max[a];
+    }
+
+    if (count <= BVH_LEAF_SIZE) {
+        this->nodes[index].first = first;
+        this->nodes[index].count = count;
+        this->nodes[index].right = 0;
+        return index;
+    }
+
+    // split at the median of the longest axis
+    int axis = 0;
+    for (int a = 1; a < 3; ++a) {
+        if (max[a] - min[a] > max[axis] - min[axis]) {
+            axis = a;
+        }
+    }
+    neuronAxisLessThan lessThan;
+    lessThan.centres = &this->centres;
+    lessThan.axis = axis;
+    uint half = count / 2;
+    std::nth_element(this->order.begin()+first, this->order.begin()+first+half, this->order.begin()+first+count, lessThan);
+
+    // the left child always follows its parent
+    this->build(first, half);
+    uint right = this->build(first+half, count-half);
+
+    // nodes may have moved as the vector grew, so index again
+    this->nodes[index].first = first;
+    this->nodes[index].count = 0;
+    this->nodes[index].right = right - index;
+    return index;
+}
+
+bool neuronBVH::hitBox(const node &n, const float origin[3], const float invDir[3], float maxT, float &tNear) const
+{
+    // slab test
+    float tMin = 0;
+    float tMax = maxT;
+    for (int a = 0; a < 3; ++a) {
+        float t0 = (n.min[a] - origin[a]) * invDir[a];
+        float t1 = (n.max[a] - origin[a]) * invDir[a];
+        if (t0 > t1) {
+            float temp = t0; t0 = t1; t1 = temp;
+        }
+        tMin = t0 > tMin ? t0 : tMin;
+        tMax = t1 < tMax ? t1 : tMax;
+        if (tMin > tMax) {
+            return false;
+        }
+    }
+    tNear = tMin;
+    return true;
+}
+
+int neuronBVH::intersect(const loc &originLoc, const loc &dirLoc, float &t) const
+{
+    if (this->nodes.size() == 0) {
+        return -1;
+    }
+
+    float origin[3] = {originLoc.x, originLoc.y, originLoc.z};
+    float dir[3] = {dirLoc.x, dirLoc.y, dirLoc.z};
+
+    // normalise so t is a distance and the sphere test is simpler
+    float len = sqrt(dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2]);
+    if (len == 0) {
+        return -1;
+    }
+    float invDir[3];
+    for (int a = 0; a < 3; ++a) {
+        dir[a] /= len;
+        // keep the slab test finite for rays along an axis
+        invDir[a] = dir[a] != 0 ? 1.0f / dir[a] : 1e30f;
+    }
+
+    int best = -1;
+    float bestT = INFINITY;
+
+    vector <uint> stack;
+    stack.push_back(0);
+
+    while (stack.size() > 0) {
+        uint index = stack.back();
+        stack.pop_back();
+
+        const node &n = this->nodes[index];
+        float tNear;
+        if (!this->hitBox(n, origin, invDir, bestT, tNear)) {
+            continue;
+        }
+
+        if (n.count > 0) {
+            // ray against each sphere
+            for (uint i = n.first; i < n.first+n.count; ++i) {
+                const loc &c = this->centres[this->order[i]];
+                float oc[3] = {origin[0]-c.x, origin[1]-c.y, origin[2]-c.z};
+                float b = oc[0]*dir[0] + oc[1]*dir[1] + oc[2]*dir[2];
+                float cc = oc[0]*oc[0] + oc[1]*oc[1] + oc[2]*oc[2] - this->radius*this->radius;
+                float disc = b*b - cc;
+                if (disc < 0) {
+                    continue;
+                }
+                float root = sqrt(disc);
+                float hit = -b - root;
+                // inside the sphere
+                if (hit < 0) {
+                    hit = -b + root;
+                }
+                if (hit >= 0 && hit < bestT) {
+                    bestT = hit;
+                    best = this->order[i];
+                }
+            }
+        } else {
+            // visit the nearer child first, so further boxes are more likely to be skipped
+            uint left = index + 1;
+            uint right = index + n.right;
+            float tLeft, tRight;
+            bool hitLeft = this->hitBox(this->nodes[left], origin, invDir, bestT, tLeft);
+            bool hitRight = this->hitBox(this->nodes[right], origin, invDir, bestT, tRight);
+            if (hitLeft && hitRight) {
+                if (tLeft < tRight) {
+                    stack.push_back(right);
+                    stack.push_back(left);
+                } else {
+                    stack.push_back(left);
+                    stack.push_back(right);
+                }
+            } else if (hitLeft) {
+                stack.push_back(left);
+            } else if (hitRight) {
+                stack.push_back(right);
+            }
+        }
+    }
+
+    if (best != -1) {
+        t = bestT;
+    }
+    return best;
+}
@@ -0,0 +1,73 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+#ifndef NEURONBVH_H
+#define NEURONBVH_H
+
+#include "globalHeader.h"
+
+/*!
+ * \brief The neuronBVH class is a bounding volume hierarchy over the
+ * neuron spheres of one population, used to find the neuron under the
+ * mouse in the 3D view by casting a ray on the CPU.
+ *
+ * Locations are in the population's own frame - callers move the ray
+ * into that frame rather than rebuilding when a population is moved.
+ */
+class neuronBVH
+{
+public:
+    neuronBVH(const vector <loc> &locations, float radius);
+
+    /*!
+     * \brief intersect returns the index of the nearest neuron hit by
+     * the ray origin + t*dir (t >= 0), or -1 if there is none. If a
+     * neuron is hit, t is set to the distance along the ray.
+     */
+    int intersect(const loc &origin, const loc &dir, float &t) const;
+
+    uint size() const {return this->numNeurons;}
+
+private:
+    struct node {
+        float min[3];
+        float max[3];
+        // children are node+1 and node+right for inner nodes, count is 0
+        uint right;
+        // for leaves, neurons order[first]...order[first+count-1]
+        uint first;
+        uint count;
+    };
+
+    uint build(uint first, uint count);
+    bool hitBox(const node &n, const float origin[3], const float invDir[3], float maxT, float &tNear) const;
+
+    vector <node> nodes;
+    vector <uint> order;
+    vector <loc> centres;
+    float radius;
+    uint numNeurons;
+};
+
+#endif // NEURONBVH_H
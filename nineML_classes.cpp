@@ -28,6 +28,14 @@
 #include "nineml_layout_classes.h"
 #include "genericinput.h"
 #include "population.h"
+#include "diagnostics.h"
+#include "objectregistry.h"
+#include "projectobject.h"
+
+// explicit lists with fewer values than this are always written into the xml
+#define BINARY_VALUE_LIST_MIN_SIZE 1000
+// each value in a binary list is a 32 bit index followed by a double
+#define BINARY_VALUE_RECORD_SIZE 12
 
 QString dim::toString() {
     // do stuff
@@ -314,13 +322,7 @@ void NineMLComponent::load(QDomDocument *doc)
             this->name = e.attribute("name","");
 
             if (this->name =="") {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText",  "XML error: expected 'name' attribute'");
-                settings.endArray();
+                diagnostics::instance()->addError("XML error: expected 'name' attribute'");
             }
 
             // default to unsorted if no type found
@@ -360,13 +362,7 @@ void NineMLComponent::load(QDomDocument *doc)
                             tempAlias->readIn(e3);
                             this->AliasList.push_back(tempAlias);
                         }  else {
-                            QSettings settings;
-                            int num_errs = settings.beginReadArray("errors");
-                            settings.endArray();
-                            settings.beginWriteArray("errors");
-                                settings.setArrayIndex(num_errs + 1);
-                                settings.setValue("errorText",  "XML error: misplaced or unknown tag '" + e3.tagName() + "'");
-                            settings.endArray();
+                            diagnostics::instance()->addError("XML error: misplaced or unknown tag '" + e3.tagName() + "'");
                         }
 
                         n3 = n3.nextSibling();
@@ -392,33 +388,19 @@ void NineMLComponent::load(QDomDocument *doc)
                     this->ImpulsePortList.push_back(tempIP);
 
                 } else {
-                    QSettings settings;
-                    int num_errs = settings.beginReadArray("errors");
-                    settings.endArray();
-                    settings.beginWriteArray("errors");
-                        settings.setArrayIndex(num_errs + 1);
-                        settings.setValue("errorText",  "XML error: misplaced or unknown tag '" + e2.tagName() + "'");
-                    settings.endArray();
+                    diagnostics::instance()->addError("XML error: misplaced or unknown tag '" + e2.tagName() + "'");
                 }
                 n2 = n2.nextSibling();
             }
 
         } else {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText",  "XML error: expected 'ComponentClass' tag'");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error: expected 'ComponentClass' tag'");
         }
         n = n.nextSibling();
     }
 
     // check for errors - no point validating if we have XML errors!
-    QSettings settings;
-    int num_errs = settings.beginReadArray("errors");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->errorCount();
     if (num_errs > 0)
         return;
 
@@ -443,12 +425,9 @@ void NineMLComponent::write(QDomDocument *doc)
     QStringList validated = validateComponent();
 
     // check for errors:
-    QSettings settings;
-    int num_errs = settings.beginReadArray("errors");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->errorCount();
 
-    num_errs += settings.beginReadArray("warnings");
-    settings.endArray();
+    num_errs += diagnostics::instance()->warningCount();
 
     QString errors;
 
@@ -456,36 +435,19 @@ void NineMLComponent::write(QDomDocument *doc)
 
         errors = errors + "<b>Errors found in current component:</b><br/><br/>";
 
-        // list errors
-        settings.beginReadArray("errors");
-        for (int j = 1; j < num_errs; ++j) {
-            settings.setArrayIndex(j);
-            errors = errors + settings.value("errorText", "").toString();
-            errors = errors + "<br/>";
-        }
-        settings.endArray();
-        settings.beginReadArray("warnings");
-        for (int j = 1; j < num_errs; ++j) {
-            settings.setArrayIndex(j);
-            errors = errors + settings.value("warnText", "").toString();
+        // list errors, and clear them
+        QList < diagnostic > found = diagnostics::instance()->takeErrors();
+        found += diagnostics::instance()->takeWarnings();
+        for (int j = 0; j < found.size(); ++j) {
+            errors = errors + found[j].toString();
             errors = errors + "<br/>";
         }
-        settings.endArray();
-
-        // clear errors
-        settings.remove("errors");
-        settings.remove("warnings");
 
     }
 
     if (!errors.isEmpty()) {
         // display errors
-        QMessageBox msgBox;
-        msgBox.setText("<P><b>" + this->name + ":Component validation failed</b></P>" + errors);
-        msgBox.setIcon(QMessageBox::Warning);
-        msgBox.setTextFormat(Qt::RichText);
-        msgBox.setModal(false);
-        msgBox.exec();
+        projectObject::reportError("Component validation failed<br/>" + errors, this->name);
         return;
     }
 
@@ -538,6 +500,107 @@ void NineMLComponent::write(QDomDocument *doc)
 
 }
 
+/*!
+ * \brief writeValueListBinary
+ * \param xmlOut the network being written
+ * \param par an ExplicitList property
+ * \return true if the list was written as a BinaryFile, false if it should go into the xml
+ *
+ * Large explicit lists are written to a binary file, in the same way as explicit
+ * connection lists. Files are named after their content, so an unchanged list is
+ * not written again, and a list that was never loaded is only copied if needed.
+ */
+static bool writeValueListBinary(QXmlStreamWriter &xmlOut, ParameterData * par)
+{
+    QSettings settings;
+
+    // fetch the option
+    bool writeBinary;
+    QString dirPath;
+    if (settings.value("export_for_simulation", "false").toBool()) {
+        writeBinary = settings.value("export_binary").toBool();
+        dirPath = settings.value("simulator_export_path").toString();
+    } else {
+        writeBinary = settings.value("fileOptions/saveBinaryConnections", "error").toBool();
+        dirPath = settings.value("files/currentFileName", "error").toString();
+    }
+
+    int count = par->valuesFile.isEmpty() ? (int) par->value.size() : par->valuesCount;
+    if (!writeBinary || count < BINARY_VALUE_LIST_MIN_SIZE || dirPath == "error") {
+        return false;
+    }
+    QDir saveDir(dirPath);
+    QString saveFileName;
+
+    if (!par->valuesFile.isEmpty()) {
+
+        // not loaded, so the data is unchanged - copy the file across if it is not already there
+        saveFileName = QFileInfo(par->valuesFile).fileName();
+        QString savePath = saveDir.absoluteFilePath(saveFileName);
+        if (QFileInfo(savePath).absoluteFilePath() != QFileInfo(par->valuesFile).absoluteFilePath() && !QFile::exists(savePath)) {
+            if (!QFile::copy(par->valuesFile, savePath)) {
+                return false;
+            }
+        }
+        // keep reading from the project just saved
+        if (!settings.value("export_for_simulation", "false").toBool()) {
+            par->valuesFile = savePath;
+        }
+
+    } else {
+
+        if (par->indices.size() < par->value.size()) {
+            return false;
+        }
+
+        QByteArray data;
+        data.reserve(count * BINARY_VALUE_RECORD_SIZE);
+        for (int i = 0; i < count; ++i) {
+            qint32 index = par->indices[i];
+            double val = par->value[i];
+            data.append((char *) &index, sizeof(qint32));
+            data.append((char *) &val, sizeof(double));
+        }
+
+        saveFileName = "P" + QString(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex()) + ".bin";
+        QString savePath = saveDir.absoluteFilePath(saveFileName);
+        if (!QFile::exists(savePath) && !projectObject::updateFile(savePath, data)) {
+            diagnostics::instance()->addError("Error saving binary file for property '" + par->name + "' - is there sufficient disk space?");
+            return false;
+        }
+    }
+
+    // add a tag to the binary file
+    xmlOut.writeEmptyElement("BinaryFile");
+    xmlOut.writeAttribute("file_name", saveFileName);
+    xmlOut.writeAttribute("num_elements", QString::number(count));
+
+    return true;
+}
+
+/*!
+ * \brief readValueListBinary
+ * \param par the property to fill
+ * \param binaryFile the BinaryFile element of its ValueList
+ * Notes the binary file of a large explicit list, which is read when the values are first needed.
+ */
+static void readValueListBinary(ParameterData * par, QDomElement binaryFile)
+{
+    QSettings settings;
+    QDir filePath(settings.value("files/currentFileName", "error").toString());
+
+    par->value.clear();
+    par->indices.clear();
+    par->valuesFile = filePath.absoluteFilePath(binaryFile.attribute("file_name"));
+    par->valuesCount = binaryFile.attribute("num_elements").toInt();
+
+    // check that the data file exists!
+    if (!QFile::exists(par->valuesFile)) {
+        diagnostics::instance()->addError("Error: Binary file referenced in network not found: " + binaryFile.attribute("file_name"));
+        par->valuesFile.clear();
+    }
+}
+
 void NineMLData::write_node_xml(QXmlStreamWriter &xmlOut) {
 
     // definition
@@ -567,13 +630,7 @@ void NineMLData::write_node_xml(QXmlStreamWriter &xmlOut) {
 
                     // check we have ports
                     if (((NineMLComponentData *) this)->inputs[i]->srcPort.size() == 0 || ((NineMLComponentData *) this)->inputs[i]->dstPort.size() == 0) {
-                        QSettings settings;
-                        int num_errs = settings.beginReadArray("warnings");
-                        settings.endArray();
-                        settings.beginWriteArray("warnings");
-                            settings.setArrayIndex(num_errs + 1);
-                            settings.setValue("warnText",  "No matched ports between '" + ((NineMLComponentData *) this)->inputs[i]->src->getXMLName() + "' and '" + ((NineMLComponentData *) this)->inputs[i]->dst->getXMLName() + "'");
-                        settings.endArray();
+                        diagnostics::instance()->addWarning("No matched ports between '" + ((NineMLComponentData *) this)->inputs[i]->src->getXMLName() + "' and '" + ((NineMLComponentData *) this)->inputs[i]->dst->getXMLName() + "'");
                     }
 
                     xmlOut.writeAttribute("input_src_port", ((NineMLComponentData *) this)->inputs[i]->srcPort);
@@ -586,13 +643,7 @@ void NineMLData::write_node_xml(QXmlStreamWriter &xmlOut) {
 
                     // check we have ports
                     if (((NineMLComponentData *) this)->inputs[i]->srcPort.size() == 0 || ((NineMLComponentData *) this)->inputs[i]->dstPort.size() == 0) {
-                        QSettings settings;
-                        int num_errs = settings.beginReadArray("warnings");
-                        settings.endArray();
-                        settings.beginWriteArray("warnings");
-                            settings.setArrayIndex(num_errs + 1);
-                            settings.setValue("warnText",  "No matched ports between '" + ((NineMLComponentData *) this)->inputs[i]->src->getXMLName() + "' and '" + ((NineMLComponentData *) this)->inputs[i]->dst->getXMLName() + "'");
-                        settings.endArray();
+                        diagnostics::instance()->addWarning("No matched ports between '" + ((NineMLComponentData *) this)->inputs[i]->src->getXMLName() + "' and '" + ((NineMLComponentData *) this)->inputs[i]->dst->getXMLName() + "'");
                     }
 
 
@@ -614,13 +665,7 @@ void NineMLData::write_node_xml(QXmlStreamWriter &xmlOut) {
 
                     // check we have ports
                     if (((projection *) ((NineMLComponentData *) this)->owner)->destination->neuronType->inputs[i]->srcPort.size() == 0 || ((projection *) ((NineMLComponentData *) this)->owner)->destination->neuronType->inputs[i]->dstPort.size() == 0) {
-                        QSettings settings;
-                        int num_errs = settings.beginReadArray("warnings");
-                        settings.endArray();
-                        settings.beginWriteArray("warnings");
-                            settings.setArrayIndex(num_errs + 1);
-                            settings.setValue("warnText",  "No matched ports between '" + ((projection *) ((NineMLComponentData *) this)->owner)->destination->neuronType->inputs[i]->src->getXMLName() + "' and '" + ((projection *) ((NineMLComponentData *) this)->owner)->destination->neuronType->inputs[i]->dst->getXMLName() + "'");
-                        settings.endArray();
+                        diagnostics::instance()->addWarning("No matched ports between '" + ((projection *) ((NineMLComponentData *) this)->owner)->destination->neuronType->inputs[i]->src->getXMLName() + "' and '" + ((projection *) ((NineMLComponentData *) this)->owner)->destination->neuronType->inputs[i]->dst->getXMLName() + "'");
                     }
 
 
@@ -670,10 +715,13 @@ void NineMLData::write_node_xml(QXmlStreamWriter &xmlOut) {
               }
               if (this->ParameterList[i]->currType == ExplicitList) {
                   xmlOut.writeStartElement("ValueList");
-                  for (uint ind = 0; ind < this->ParameterList[i]->value.size(); ++ind) {
-                      xmlOut.writeEmptyElement("Value");
-                      xmlOut.writeAttribute("index", QString::number(float(this->ParameterList[i]->indices[ind])));
-                      xmlOut.writeAttribute("value", QString::number(float(this->ParameterList[i]->value[ind])));
+                  if (!writeValueListBinary(xmlOut, this->ParameterList[i])) {
+                      this->ParameterList[i]->loadValues();
+                      for (uint ind = 0; ind < this->ParameterList[i]->value.size(); ++ind) {
+                          xmlOut.writeEmptyElement("Value");
+                          xmlOut.writeAttribute("index", QString::number(float(this->ParameterList[i]->indices[ind])));
+                          xmlOut.writeAttribute("value", QString::number(float(this->ParameterList[i]->value[ind])));
+                      }
                   }
                  xmlOut.writeEndElement(); // valueList
               }
@@ -715,10 +763,13 @@ void NineMLData::write_node_xml(QXmlStreamWriter &xmlOut) {
               }
               if (this->StateVariableList[i]->currType == ExplicitList) {
                   xmlOut.writeStartElement("ValueList");
-                  for (uint ind = 0; ind < this->StateVariableList[i]->value.size(); ++ind) {
-                      xmlOut.writeEmptyElement("Value");
-                      xmlOut.writeAttribute("index", QString::number(float(this->StateVariableList[i]->indices[ind])));
-                      xmlOut.writeAttribute("value", QString::number(float(this->StateVariableList[i]->value[ind])));
+                  if (!writeValueListBinary(xmlOut, this->StateVariableList[i])) {
+                      this->StateVariableList[i]->loadValues();
+                      for (uint ind = 0; ind < this->StateVariableList[i]->value.size(); ++ind) {
+                          xmlOut.writeEmptyElement("Value");
+                          xmlOut.writeAttribute("index", QString::number(float(this->StateVariableList[i]->indices[ind])));
+                          xmlOut.writeAttribute("value", QString::number(float(this->StateVariableList[i]->value[ind])));
+                      }
                   }
                  xmlOut.writeEndElement(); // valueList
               }
@@ -745,13 +796,7 @@ void NineMLData::write_node_xml(QXmlStreamWriter &xmlOut) {
 
                    // check we have ports
                    if (((NineMLComponentData *) this)->inputs[i]->srcPort.size() == 0 || ((NineMLComponentData *) this)->inputs[i]->dstPort.size() == 0) {
-                       QSettings settings;
-                       int num_errs = settings.beginReadArray("warnings");
-                       settings.endArray();
-                       settings.beginWriteArray("warnings");
-                           settings.setArrayIndex(num_errs + 1);
-                           settings.setValue("warnText",  "No matched ports between '" + ((NineMLComponentData *) this)->inputs[i]->src->getXMLName() + "' and '" + ((NineMLComponentData *) this)->inputs[i]->dst->getXMLName() + "'");
-                       settings.endArray();
+                       diagnostics::instance()->addWarning("No matched ports between '" + ((NineMLComponentData *) this)->inputs[i]->src->getXMLName() + "' and '" + ((NineMLComponentData *) this)->inputs[i]->dst->getXMLName() + "'");
                    }
 
                   xmlOut.writeStartElement("LL:Input");
@@ -782,13 +827,7 @@ void Parameter::readIn(QDomElement e)
 {
     this->name = e.attribute("name","");
     if (this->name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing Parameter attribute 'name'");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing Parameter attribute 'name'");
     }
     // we need dims in here too eventually
     //delete dims;
@@ -822,13 +861,7 @@ void StateAssignment::readIn(QDomElement e) {
     // we need to handle the statevariable stuff here... how?
     this->name = e.attribute("variable","");
     if (this->name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing StateAssignment attribute 'variable'");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing StateAssignment attribute 'variable'");
     }
     QDomNode n = e.firstChild();
     QDomElement e2 = n.toElement();
@@ -837,13 +870,7 @@ void StateAssignment::readIn(QDomElement e) {
         this->maths = new MathInLine;
         this->maths->readIn(e2);
     } else {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing StateAssignment 'MathInLine' tag'");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing StateAssignment 'MathInLine' tag'");
     }
 }
 
@@ -861,23 +888,11 @@ void StateAssignment::writeOut(QDomDocument * doc, QDomElement &parent)
 void OnEvent::readIn(QDomElement e) {
     this->target_regime_name = e.attribute("target_regime","");
     if (this->target_regime_name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing OnEvent 'target_regime' attribute'");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing OnEvent 'target_regime' attribute'");
     }
     this->src_port_name = e.attribute("src_port","");
     if (this->target_regime_name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing OnEvent 'src_port' attribute'");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing OnEvent 'src_port' attribute'");
     }
     QDomNode n = e.firstChild();
     while( !n.isNull() )
@@ -901,13 +916,7 @@ void OnEvent::readIn(QDomElement e) {
             tempIO->readIn(e2);
             this->impulseOutList.push_back(tempIO);
         } else {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText",  "XML error: misplaced or unknown tag - '" + e2.tagName() + "'");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error: misplaced or unknown tag - '" + e2.tagName() + "'");
         }
         n = n.nextSibling();
     }
@@ -942,23 +951,11 @@ void OnEvent::writeOut(QDomDocument * doc, QDomElement &parent)
 void OnImpulse::readIn(QDomElement e) {
     this->target_regime_name = e.attribute("target_regime","");
     if (this->target_regime_name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing OnImpulse 'target_regime' attribute'");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing OnImpulse 'target_regime' attribute'");
     }
     this->src_port_name = e.attribute("src_port","");
     if (this->target_regime_name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing OnImpulse 'src_port' attribute'");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing OnImpulse 'src_port' attribute'");
     }
     QDomNode n = e.firstChild();
     while( !n.isNull() )
@@ -982,13 +979,7 @@ void OnImpulse::readIn(QDomElement e) {
             tempIO->readIn(e2);
             this->impulseOutList.push_back(tempIO);
         } else {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText",  "XML error: misplaced or unknown tag - '" + e2.tagName() + "'");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error: misplaced or unknown tag - '" + e2.tagName() + "'");
         }
         n = n.nextSibling();
     }
@@ -1028,13 +1019,7 @@ void Trigger::readIn(QDomElement e) {
         this->maths = new MathInLine;
         this->maths->readIn(e2);
     } else {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",  "XML error: missing Trigger 'MathInLine' tag'");
-        settings.endArray();
+        diagnostics::instance()->addError("XML error: missing Trigger 'MathInLine' tag'");
       }
 }
 
@@ -1050,13 +1035,7 @@ void Trigger::writeOut(QDomDocument * doc, QDomElement &parent)
 void OnCondition::readIn(QDomElement e) {
     this->target_regime_name = e.attribute("target_regime","");
     if (this->target_regime_name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing OnCondition 'target_regime' attribute'");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing OnCondition 'target_regime' attribute'");
     }
     QDomNode n = e.firstChild();
     while( !n.isNull() )
@@ -1085,13 +1064,7 @@ void OnCondition::readIn(QDomElement e) {
             tempIO->readIn(e2);
             this->impulseOutList.push_back(tempIO);
         } else {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText",  "XML error: misplaced or unknown tag - '" + e2.tagName() + "'");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error: misplaced or unknown tag - '" + e2.tagName() + "'");
         }
         n = n.nextSibling();
     }
@@ -1123,13 +1096,7 @@ void OnCondition::writeOut(QDomDocument * doc, QDomElement &parent)
 void Alias::readIn(QDomElement e) {
     this->name = e.attribute("name","");
     if (this->name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing Alias 'name' attribute'");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing Alias 'name' attribute'");
     }
     QDomNode n = e.firstChild();
     QDomElement e2 = n.toElement();
@@ -1138,13 +1105,7 @@ void Alias::readIn(QDomElement e) {
         this->maths = new MathInLine;
         this->maths->readIn(e2);
     } else {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",  "XML error: missing Alias 'MathInLine' tag'");
-        settings.endArray();
+        diagnostics::instance()->addError("XML error: missing Alias 'MathInLine' tag'");
     }
     //delete dims;
     this->dims->fromString(e.attribute("dimension",""));
@@ -1163,13 +1124,7 @@ void Alias::writeOut(QDomDocument * doc, QDomElement &parent)
 void StateVariable::readIn(QDomElement e) {
     this->name = e.attribute("name","");
     if (this->name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing StateVariable 'name' attribute'");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing StateVariable 'name' attribute'");
     }
     //delete dims;
     this->dims->fromString(e.attribute("dimension",""));
@@ -1187,13 +1142,7 @@ void StateVariable::writeOut(QDomDocument * doc, QDomElement &parent)
 void TimeDerivative::readIn(QDomElement e) {
     this->variable_name = e.attribute("variable","");
     if (this->variable_name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing TimeDerivative 'variable' attribute'");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing TimeDerivative 'variable' attribute'");
     }
     QDomNode n = e.firstChild();
     QDomElement e2 = n.toElement();
@@ -1202,13 +1151,7 @@ void TimeDerivative::readIn(QDomElement e) {
         this->maths = new MathInLine;
         this->maths->readIn(e2);
     } else {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",  "XML error: missing TimeDerivative 'MathInLine' tag'");
-        settings.endArray();
+        diagnostics::instance()->addError("XML error: missing TimeDerivative 'MathInLine' tag'");
     }
 }
 
@@ -1228,13 +1171,7 @@ void MathInLine::readIn(QDomElement e) {
     this->equation = e.text();
     // it is not fatal if equation is blank - but validation should flag it up
     /*if (this->equation == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing MathInLine equation'");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing MathInLine equation'");
     }*/
 }
 
@@ -1253,13 +1190,7 @@ void MathInLine::writeOut(QDomDocument * doc, QDomElement &parent)
 void EventOut::readIn(QDomElement e) {
     this->port_name = e.attribute("port","");
     if (this->port_name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing EventOut 'port' attribute");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing EventOut 'port' attribute");
     }
 }
 
@@ -1277,13 +1208,7 @@ void EventOut::writeOut(QDomDocument * doc, QDomElement &parent)
 void ImpulseOut::readIn(QDomElement e) {
     this->port_name = e.attribute("port","");
     if (this->port_name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing ImpulseOut 'port' attribute");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing ImpulseOut 'port' attribute");
     }
 }
 
@@ -1311,13 +1236,7 @@ void ImpulseOut::writeOut(QDomDocument * doc, QDomElement &parent)
 void AnalogPort::readIn(QDomElement e) {
     this->name = e.attribute("name","");
     if (this->name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing AnalogPort 'name' attribute");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing AnalogPort 'name' attribute");
     }
     if (e.tagName()=="AnalogReceivePort") {
         this->mode=AnalogRecvPort;
@@ -1333,13 +1252,7 @@ void AnalogPort::readIn(QDomElement e) {
             this->op = ReduceOperationNone;
         }
     } else {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",  "XML error: misplaced or unknown tag - '" + e.tagName() + "'");
-        settings.endArray();
+        diagnostics::instance()->addError("XML error: misplaced or unknown tag - '" + e.tagName() + "'");
     }
 }
 
@@ -1375,26 +1288,14 @@ void AnalogPort::writeOut(QDomDocument * doc, QDomElement &parent)
 void EventPort::readIn(QDomElement e) {
     this->name = e.attribute("name","");
     if (this->name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing EventPort 'name' attribute");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing EventPort 'name' attribute");
     }
     if (e.tagName()=="EventReceivePort") {
         this->mode=EventRecvPort;
     } else if (e.tagName()=="EventSendPort") {
         this->mode=EventSendPort;
     }  else {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",  "XML error: misplaced or unknown tag - '" + e.tagName() + "'");
-        settings.endArray();
+        diagnostics::instance()->addError("XML error: misplaced or unknown tag - '" + e.tagName() + "'");
     }
 }
 
@@ -1418,13 +1319,7 @@ void EventPort::writeOut(QDomDocument * doc, QDomElement &parent)
 void ImpulsePort::readIn(QDomElement e) {
     this->name = e.attribute("name","");
     if (this->name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing ImpulsePort 'name' attribute");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing ImpulsePort 'name' attribute");
     }
     if (e.tagName()=="ImpulseReceivePort") {
         this->mode=ImpulseRecvPort;
@@ -1432,13 +1327,7 @@ void ImpulsePort::readIn(QDomElement e) {
     } else if (e.tagName()=="ImpulseSendPort") {
         this->mode=ImpulseSendPort;
     }  else {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",  "XML error: misplaced or unknown tag - '" + e.tagName() + "'");
-        settings.endArray();
+        diagnostics::instance()->addError("XML error: misplaced or unknown tag - '" + e.tagName() + "'");
     }
 }
 
@@ -1468,13 +1357,7 @@ void Regime::readIn(QDomElement e)
 
     this->name = e.attribute("name","");
     if (this->name == "") {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "XML error: missing Regime 'name' attribute");
-      settings.endArray();
+      diagnostics::instance()->addError("XML error: missing Regime 'name' attribute");
     }
     QDomNode n = e.firstChild();
     while( !n.isNull() )
@@ -1544,15 +1427,59 @@ ParameterData::ParameterData(Parameter *data)
     name = data->name;
     dims = new dim(data->dims->toString());
     currType = Undefined;
+    valuesCount = 0;
 }
 
 ParameterData::ParameterData(ParameterData *data)
 {
+    // the copy may outlive the binary file, so read it now
+    data->loadValues();
     value = data->value;
     indices = data->indices;
     name = data->name;
     dims = new dim(data->dims->toString());
     currType = data->currType;
+    valuesCount = 0;
+}
+
+/*!
+ * \brief ParameterData::loadValues
+ * Reads an explicit list that was left in its binary file when the network was loaded.
+ * Anything that uses value or indices of an ExplicitList should call this first.
+ */
+void ParameterData::loadValues()
+{
+    if (this->valuesFile.isEmpty()) {
+        return;
+    }
+
+    QFile file(this->valuesFile);
+    this->valuesFile.clear();
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        diagnostics::instance()->addError("Error: Binary file for property '" + this->name + "' could not be read: " + file.fileName());
+        return;
+    }
+    QByteArray data = file.readAll();
+    file.close();
+
+    int count = qMin(this->valuesCount, data.size() / BINARY_VALUE_RECORD_SIZE);
+    if (count < this->valuesCount) {
+        diagnostics::instance()->addError("Error: Binary file for property '" + this->name + "' is too short: " + file.fileName());
+    }
+
+    this->value.resize(count);
+    this->indices.resize(count);
+    const char * record = data.constData();
+    for (int i = 0; i < count; ++i) {
+        qint32 index;
+        double val;
+        memcpy(&index, record, sizeof(qint32));
+        memcpy(&val, record + sizeof(qint32), sizeof(double));
+        this->indices[i] = index;
+        this->value[i] = val;
+        record += BINARY_VALUE_RECORD_SIZE;
+    }
 }
 
 Port::Port(Port *data)
@@ -1612,13 +1539,7 @@ int AnalogPort::validateAnalogPort(NineMLComponent *component, QStringList * )
         }
         if (!match)
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText",   "Error: AnalogPort references missing StateVariable or Alias " + name);
-            settings.endArray();
+            diagnostics::instance()->addError("Error: AnalogPort references missing StateVariable or Alias " + name);
         }
     }
     else
@@ -1679,13 +1600,7 @@ int ImpulsePort::validateImpulsePort(NineMLComponent *component, QStringList * )
 
         if (!match)
         {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText",   "Error: ImpulsePort references missing StateVariable or Alias " + name);
-            settings.endArray();
+            diagnostics::instance()->addError("Error: ImpulsePort references missing StateVariable or Alias " + name);
         }
     }
     else
@@ -2016,12 +1931,9 @@ NineMLComponent::NineMLComponent(NineMLComponent *data)
     //validate this
     QStringList errs = validateComponent();
     // check for errors:
-    QSettings settings;
-    int num_errs = settings.beginReadArray("errors");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->errorCount();
 
-    num_errs += settings.beginReadArray("warnings");
-    settings.endArray();
+    num_errs += diagnostics::instance()->warningCount();
 
     QString errors;
 
@@ -2029,25 +1941,13 @@ NineMLComponent::NineMLComponent(NineMLComponent *data)
 
         errors = errors + "<b>Errors found in current component:</b><br/><br/>";
 
-        // list errors
-        settings.beginReadArray("errors");
-        for (int j = 1; j < num_errs; ++j) {
-            settings.setArrayIndex(j);
-            errors = errors + settings.value("errorText", "").toString();
+        // list errors, and clear them
+        QList < diagnostic > found = diagnostics::instance()->takeErrors();
+        found += diagnostics::instance()->takeWarnings();
+        for (int j = 0; j < found.size(); ++j) {
+            errors = errors + found[j].toString();
             errors = errors + "<br/>";
         }
-        settings.endArray();
-        settings.beginReadArray("warnings");
-        for (int j = 1; j < num_errs; ++j) {
-            settings.setArrayIndex(j);
-            errors = errors + settings.value("warnText", "").toString();
-            errors = errors + "<br/>";
-        }
-        settings.endArray();
-
-        // clear errors
-        settings.remove("errors");
-        settings.remove("warnings");
 
     }
 
@@ -2153,12 +2053,9 @@ NineMLComponent& NineMLComponent::operator=(const NineMLComponent& data)
     }
     QStringList validated = validateComponent();
     // check for errors:
-    QSettings settings;
-    int num_errs = settings.beginReadArray("errors");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->errorCount();
 
-    num_errs += settings.beginReadArray("warnings");
-    settings.endArray();
+    num_errs += diagnostics::instance()->warningCount();
 
     QString errors;
 
@@ -2166,36 +2063,19 @@ NineMLComponent& NineMLComponent::operator=(const NineMLComponent& data)
 
         errors = errors + "<b>Errors found in current component:</b><br/><br/>";
 
-        // list errors
-        settings.beginReadArray("errors");
-        for (int j = 1; j < num_errs; ++j) {
-            settings.setArrayIndex(j);
-            errors = errors + settings.value("errorText", "").toString();
-            errors = errors + "<br/>";
-        }
-        settings.endArray();
-        settings.beginReadArray("warnings");
-        for (int j = 1; j < num_errs; ++j) {
-            settings.setArrayIndex(j);
-            errors = errors + settings.value("warnText", "").toString();
+        // list errors, and clear them
+        QList < diagnostic > found = diagnostics::instance()->takeErrors();
+        found += diagnostics::instance()->takeWarnings();
+        for (int j = 0; j < found.size(); ++j) {
+            errors = errors + found[j].toString();
             errors = errors + "<br/>";
         }
-        settings.endArray();
-
-        // clear errors
-        settings.remove("errors");
-        settings.remove("warnings");
 
     }
 
     if (!errors.isEmpty()) {
         // display errors
-        QMessageBox msgBox;
-        msgBox.setText("<P><b>Component validation failed</b></P>" + errors);
-        msgBox.setIcon(QMessageBox::Warning);
-        msgBox.setTextFormat(Qt::RichText);
-        msgBox.setModal(false);
-        msgBox.exec();
+        projectObject::reportError("Component validation failed<br/>" + errors, this->name);
     }
 
     return *this;
@@ -2289,16 +2169,13 @@ void NineMLComponent::updateFrom(NineMLComponent* data)
     // validate to fill in blanks
     QStringList validated = validateComponent();
     // check for errors:
-    QSettings settings;
-    int num_errs = settings.beginReadArray("errors");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->errorCount();
 
-    num_errs += settings.beginReadArray("warnings");
-    settings.endArray();
+    num_errs += diagnostics::instance()->warningCount();
 
     // clear errors if any
-    settings.remove("errors");
-    settings.remove("warnings");
+    diagnostics::instance()->clearErrors();
+    diagnostics::instance()->clearWarnings();
 }
 
 // copy constructor required for the base class
@@ -2317,11 +2194,13 @@ NineMLComponentData::NineMLComponentData(NineMLComponent *data)
         ParameterList[i] = new ParameterData(data->ParameterList[i]);
     }
     this->component = data;
+    objectRegistry::invalidate();
 }
 
 // duplicate
 NineMLComponentData::NineMLComponentData(NineMLComponentData *data)
 {
+    objectRegistry::invalidate();
 
     type = NineMLComponentType;
     StateVariableList = vector<StateVariableData*>(data->StateVariableList.size());
@@ -2343,6 +2222,7 @@ NineMLComponentData::NineMLComponentData(NineMLComponentData *data)
 
 NineMLComponentData::NineMLComponentData(NineMLComponentData *src, NineMLComponent *data)
 {
+    objectRegistry::invalidate();
 
     // copy owner
     owner = src->owner;
@@ -2518,24 +2398,12 @@ int MathInLine::validateMathInLine(NineMLComponent* component, QStringList * )
 
         // if a token is not recognised, then let the user know - this may be better done elsewhere...
         if (!recognised) {
-          QSettings settings;
-          int num_errs = settings.beginReadArray("warnings");
-          settings.endArray();
-          settings.beginWriteArray("warnings");
-              settings.setArrayIndex(num_errs + 1);
-              settings.setValue("warnText",  "Warning: MathInLine contains unrecognised token " + splitTest[i]);
-          settings.endArray();
+          diagnostics::instance()->addWarning("Warning: MathInLine contains unrecognised token " + splitTest[i]);
         }
     }
 
     if (equation.count("(") != equation.count(")")) {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("warnings");
-        settings.endArray();
-        settings.beginWriteArray("warnings");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("warnText",  "Warning: MathInLine contains mis-matched brackets");
-        settings.endArray();
+        diagnostics::instance()->addWarning("Warning: MathInLine contains mis-matched brackets");
     }
 
     return 0;
@@ -2583,13 +2451,7 @@ int TimeDerivative::validateTimeDerivative(NineMLComponent *component, QStringLi
 
     }
     if (!match) {
-      QSettings settings;
-      int num_errs = settings.beginReadArray("errors");
-      settings.endArray();
-      settings.beginWriteArray("errors");
-          settings.setArrayIndex(num_errs + 1);
-          settings.setValue("errorText",  "Error: TimeDerivative references missing StateVariable " + variable_name);
-      settings.endArray();
+      diagnostics::instance()->addError("Error: TimeDerivative references missing StateVariable " + variable_name);
     }
     return failures;
 }
@@ -2602,13 +2464,7 @@ int StateAssignment::validateStateAssignment(NineMLComponent *component, QString
         failures += maths->validateMathInLine(component, errs);
     } else {
         // should never get here - is a major error
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",   "Error: MathInline missing from State Assignment");
-        settings.endArray();
+        diagnostics::instance()->addError("Error: MathInline missing from State Assignment");
     }
     bool match = false;
     for(uint i=0; i<component->StateVariableList.size(); i++)
@@ -2619,13 +2475,7 @@ int StateAssignment::validateStateAssignment(NineMLComponent *component, QString
 
     }
     if (!match) {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",   "Error: StateAssignment references missing StateVariable " + name);
-        settings.endArray();
+        diagnostics::instance()->addError("Error: StateAssignment references missing StateVariable " + name);
       }
     return failures;
 }
@@ -2641,13 +2491,7 @@ int EventOut::validateEventOut(NineMLComponent *component, QStringList * )
             match = true;}
     }
     if (!match) {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",   "Error: EventOut references missing EventPort " + port_name);
-        settings.endArray();
+        diagnostics::instance()->addError("Error: EventOut references missing EventPort " + port_name);
       }
     return failures;
 }
@@ -2668,13 +2512,7 @@ int ImpulseOut::validateImpulseOut(NineMLComponent *component, QStringList * )
         }
     }
     if (!match) {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",   "Error: ImpulseOut references missing ImpulsePort " + port_name);
-        settings.endArray();
+        diagnostics::instance()->addError("Error: ImpulseOut references missing ImpulsePort " + port_name);
       }
     failures += !match;
     return failures;
@@ -2691,13 +2529,7 @@ int OnCondition::validateOnCondition(NineMLComponent *component, QStringList * e
             match = true;}
     }
     if (!match) {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",   "Error: OnCondition references missing Regime " + target_regime_name);
-        settings.endArray();
+        diagnostics::instance()->addError("Error: OnCondition references missing Regime " + target_regime_name);
       }
     failures += !match;
     for(uint i=0; i<StateAssignList.size(); i++)
@@ -2726,13 +2558,7 @@ int OnEvent::validateOnEvent(NineMLComponent *component, QStringList * errs)
             match = true;}
     }
     if (!match) {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",   "Error: OnEvent references missing Regime " + target_regime_name);
-        settings.endArray();
+        diagnostics::instance()->addError("Error: OnEvent references missing Regime " + target_regime_name);
       }
     failures += !match;
     match = false;
@@ -2743,13 +2569,7 @@ int OnEvent::validateOnEvent(NineMLComponent *component, QStringList * errs)
             match = true;}
     }
     if (!match) {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",   "Error: OnEvent references missing EventPort " + src_port_name);
-        settings.endArray();
+        diagnostics::instance()->addError("Error: OnEvent references missing EventPort " + src_port_name);
       }
     failures += !match;
     for(uint i=0; i<StateAssignList.size(); i++)
@@ -2779,13 +2599,7 @@ int OnImpulse::validateOnImpulse(NineMLComponent *component, QStringList * errs)
             match = true;}
     }
     if (!match) {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",   "Error: OnImpulse references missing Regime " + target_regime_name);
-        settings.endArray();
+        diagnostics::instance()->addError("Error: OnImpulse references missing Regime " + target_regime_name);
       }
     failures += !match;
     match = false;
@@ -2796,13 +2610,7 @@ int OnImpulse::validateOnImpulse(NineMLComponent *component, QStringList * errs)
             match = true;}
     }
     if (!match) {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",   "Error: OnImpulse references missing Regime " + src_port_name);
-        settings.endArray();
+        diagnostics::instance()->addError("Error: OnImpulse references missing Regime " + src_port_name);
       }
     for(uint i=0; i<StateAssignList.size(); i++)
     {
@@ -2919,7 +2727,10 @@ void NineMLComponentData::import_parameters_from_xml(QDomNode &n)
                 }
 
                 propVal = n.toElement().elementsByTagName("ValueList");
-                if (propVal.size() == 1) {
+                if (propVal.size() == 1 && propVal.item(0).toElement().elementsByTagName("BinaryFile").size() == 1) {
+                    this->ParameterList[i]->currType = ExplicitList;
+                    readValueListBinary(this->ParameterList[i], propVal.item(0).toElement().elementsByTagName("BinaryFile").item(0).toElement());
+                } else if (propVal.size() == 1) {
                     this->ParameterList[i]->currType = ExplicitList;
                     QDomNodeList propValInst = n.toElement().elementsByTagName("Value");
                     for (uint ind = 0; ind < (uint) propValInst.count(); ++ind) {
@@ -2961,7 +2772,10 @@ void NineMLComponentData::import_parameters_from_xml(QDomNode &n)
                 }
 
                 propVal = n.toElement().elementsByTagName("ValueList");
-                if (propVal.size() == 1) {
+                if (propVal.size() == 1 && propVal.item(0).toElement().elementsByTagName("BinaryFile").size() == 1) {
+                    this->StateVariableList[i]->currType = ExplicitList;
+                    readValueListBinary(this->StateVariableList[i], propVal.item(0).toElement().elementsByTagName("BinaryFile").item(0).toElement());
+                } else if (propVal.size() == 1) {
                     this->StateVariableList[i]->currType = ExplicitList;
                     QDomNodeList propValInst = n.toElement().elementsByTagName("Value");
                     for (uint ind = 0; ind < (uint) propValInst.count(); ++ind) {
@@ -3043,6 +2857,9 @@ void NineMLComponentData::addInput(NineMLComponentData *, bool) {
 
 NineMLComponentData::~NineMLComponentData() {
 
+    // may be part of a network
+    objectRegistry::invalidate();
+
     // not needed anymore
     //this->removeReferences();
 
@@ -191,10 +191,14 @@ public:
     vector < int > indices;
     ParameterType currType;
     int seed;
+    // a large explicit list kept in a binary file beside the network, read when first needed
+    QString valuesFile;
+    int valuesCount;
+    void loadValues();
 
     ParameterData(Parameter *data);
     ParameterData(ParameterData *data);
-    ParameterData(QString dimString){dims = new dim(dimString);}
+    ParameterData(QString dimString){dims = new dim(dimString); valuesCount = 0;}
     ~ParameterData(){delete dims;}
     void readIn(QDomElement e);
     void writeOut(QDomDocument *doc, QDomElement &parent);
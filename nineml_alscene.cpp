@@ -27,6 +27,7 @@
 #include <typeinfo>
 #include <algorithm>
 #include "undocommands.h"
+#include "diagnostics.h"
 
 NineMLALScene::NineMLALScene(RootComponentItem *r) :
     QGraphicsScene()
@@ -1153,9 +1154,8 @@ void NineMLALScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *mouseEvent)
                                 QStringList errs;
                                 oc->validateOnCondition(root->al, &errs);
                                 // clear errors
-                                QSettings settings;
-                                settings.remove("errors");
-                                settings.remove("warnings");
+                                diagnostics::instance()->clearErrors();
+                                diagnostics::instance()->clearWarnings();
                                 transition_origin->regime->OnConditionList.push_back(oc);
                                 OnConditionGraphicsItem *ocg = addOnConditionItem(transition_origin->regime, oc);
                                 root->requestLayoutUpdate();
@@ -1171,9 +1171,8 @@ void NineMLALScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *mouseEvent)
                                 QStringList errs;
                                 oe->validateOnEvent(root->al, &errs);
                                 // clear errors
-                                QSettings settings;
-                                settings.remove("errors");
-                                settings.remove("warnings");
+                                diagnostics::instance()->clearErrors();
+                                diagnostics::instance()->clearWarnings();
                                 transition_origin->regime->OnEventList.push_back(oe);
                                 OnEventGraphicsItem * oei = addOnEventItem(transition_origin->regime, oe);
                                 root->requestLayoutUpdate();
@@ -1190,9 +1189,8 @@ void NineMLALScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *mouseEvent)
                                 QStringList errs;
                                 oi->validateOnImpulse(root->al, &errs);
                                 // clear errors
-                                QSettings settings;
-                                settings.remove("errors");
-                                settings.remove("warnings");
+                                diagnostics::instance()->clearErrors();
+                                diagnostics::instance()->clearWarnings();
                                 transition_origin->regime->OnImpulseList.push_back(oi);
                                 OnImpulseGraphicsItem * oii = addOnImpulseItem(transition_origin->regime, oi);
                                 root->requestLayoutUpdate();
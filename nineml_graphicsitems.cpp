@@ -30,6 +30,7 @@
 #include "nineml_alscene.h"
 #include "propertiesmanager.h"
 #include "undocommands.h"
+#include "diagnostics.h"
 
 
 
@@ -403,9 +404,7 @@ void TimeDerivativeTextItem::setMaths(QString m)
     time_derivative->maths->validateMathInLine(root->al, &errs);
 
     // sort out errors
-    QSettings settings;
-    int num_errs = settings.beginReadArray("warnings");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->warningCount();
 
     if (num_errs != 0 && source) {
 
@@ -415,7 +414,7 @@ void TimeDerivativeTextItem::setMaths(QString m)
         source->setPalette(p);
 
         // clear errors
-        settings.remove("warnings");
+        diagnostics::instance()->clearWarnings();
 
     }
     if (num_errs == 0 && source) {
@@ -426,7 +425,7 @@ void TimeDerivativeTextItem::setMaths(QString m)
         source->setPalette(p);
 
         // clear errors
-        settings.remove("errors");
+        diagnostics::instance()->clearErrors();
     }
 
     updateContent();
@@ -516,9 +515,7 @@ void OnConditionGraphicsItem::setTriggerMaths(QString m)
     trigger_item->setMaths(m);
 
     // sort out errors
-    QSettings settings;
-    int num_errs = settings.beginReadArray("warnings");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->warningCount();
 
     if (num_errs != 0 && source) {
 
@@ -528,7 +525,7 @@ void OnConditionGraphicsItem::setTriggerMaths(QString m)
         source->setPalette(p);
 
         // clear errors
-        settings.remove("warnings");
+        diagnostics::instance()->clearWarnings();
 
     }
     if (num_errs == 0 && source) {
@@ -539,7 +536,7 @@ void OnConditionGraphicsItem::setTriggerMaths(QString m)
         source->setPalette(p);
 
         // clear errors
-        settings.remove("errors");
+        diagnostics::instance()->clearErrors();
     }
     root->notifyDataChange();
     if (qobject_cast < QLineEdit *> (sender()))
@@ -709,9 +706,7 @@ void StateAssignmentTextItem::setMaths(QString m)
     assignment->maths->validateMathInLine(root->al, &errs);
 
     // sort out errors
-    QSettings settings;
-    int num_errs = settings.beginReadArray("warnings");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->warningCount();
 
     if (num_errs != 0 && source) {
 
@@ -721,7 +716,7 @@ void StateAssignmentTextItem::setMaths(QString m)
         source->setPalette(p);
 
         // clear errors
-        settings.remove("warnings");
+        diagnostics::instance()->clearWarnings();
 
     }
     if (num_errs == 0 && source) {
@@ -732,7 +727,7 @@ void StateAssignmentTextItem::setMaths(QString m)
         source->setPalette(p);
 
         // clear errors
-        settings.remove("errors");
+        diagnostics::instance()->clearErrors();
     }
 
     updateContent();
@@ -1164,9 +1159,7 @@ void AliasTextItem::setMaths(QString m)
     alias->maths->validateMathInLine(root->al, &errs);
 
     // sort out errors
-    QSettings settings;
-    int num_errs = settings.beginReadArray("warnings");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->warningCount();
 
     if (num_errs != 0 && source) {
 
@@ -1176,7 +1169,7 @@ void AliasTextItem::setMaths(QString m)
         source->setPalette(p);
 
         // clear errors
-        settings.remove("warnings");
+        diagnostics::instance()->clearWarnings();
 
     }
     if (num_errs == 0 && source) {
@@ -1187,7 +1180,7 @@ void AliasTextItem::setMaths(QString m)
         source->setPalette(p);
 
         // clear errors
-        settings.remove("errors");
+        diagnostics::instance()->clearErrors();
     }
 
 
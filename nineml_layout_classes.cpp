@@ -23,6 +23,8 @@
 ****************************************************************************/
 
 #include "nineml_layout_classes.h"
+#include "diagnostics.h"
+#include "projectobject.h"
 
 NineMLLayout::NineMLLayout(NineMLLayout *data)
 {
@@ -100,13 +102,11 @@ NineMLLayout& NineMLLayout::operator=(const NineMLLayout& data)
     }
     QStringList validated = validateComponent();
     if (validated.size() > 1) {
-        QMessageBox msgBox;
         QString message;
         for (uint i = 0; i < (uint) validated.size(); ++i) {
             message += validated[i] + "\n";
         }
-        msgBox.setText(message);
-        msgBox.exec();
+        projectObject::reportError(message, this->name);
     }
 
     return *this;
@@ -136,6 +136,27 @@ NineMLLayoutData::NineMLLayoutData(NineMLLayout *data)
     this->component = data;
 }
 
+NineMLLayoutData::NineMLLayoutData(NineMLLayoutData *data)
+{
+    seed = data->seed;
+    minimumDistance = data->minimumDistance;
+    type = NineMLLayoutType;
+    StateVariableList.resize(data->StateVariableList.size());
+    ParameterList.resize(data->ParameterList.size());
+
+    for (uint i=0; i<data->StateVariableList.size(); i++)
+    {
+        StateVariableList[i] = new StateVariableData(data->StateVariableList[i]);
+    }
+    for (uint i=0; i<data->ParameterList.size(); i++)
+    {
+        ParameterList[i] = new ParameterData(data->ParameterList[i]);
+    }
+
+    // we don't copy the locations
+    this->component = data->component;
+}
+
 QString NineMLLayout::getXMLName() {
     return this->name + ".xml";
 }
@@ -199,13 +220,11 @@ void NineMLLayout::load(QDomDocument *doc)
     // validate this
     QStringList validated = validateComponent();
     if (validated.size() > 1) {
-        QMessageBox msgBox;
         QString message;
         for (uint i = 0; i < (uint) validated.size(); ++i) {
             message += validated[i] + "\n";
         }
-        msgBox.setText(message);
-        msgBox.exec();
+        projectObject::reportError(message, this->name);
     }
 }
 
@@ -214,13 +233,11 @@ void NineMLLayout::write(QDomDocument *doc)
     // validate this
     QStringList validated = validateComponent();
     if (validated.size() > 1) {
-        QMessageBox msgBox;
         QString message;
         for (uint i = 0; i < (uint) validated.size(); ++i) {
             message += validated[i] + "\n";
         }
-        msgBox.setText(message);
-        msgBox.exec();
+        projectObject::reportError(message, this->name);
     }
 
     // write out:
@@ -293,13 +310,7 @@ void NineMLLayoutData::import_parameters_from_xml(QDomNode &nIn)
         QString propName = n.toElement().attribute("name","");
         if (propName == "") {
             // error
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText",  "XML error: attribute 'name' not found in tag 'Property'");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error: attribute 'name' not found in tag 'Property'");
         }
 
         bool parFound = false;
@@ -329,13 +340,7 @@ void NineMLLayoutData::import_parameters_from_xml(QDomNode &nIn)
 
         if (!parFound) {
             // error
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText",  "Error: property '" + propName + "' not found in Layout");
-            settings.endArray();
+            diagnostics::instance()->addError("Error: property '" + propName + "' not found in Layout");
         }
     }
 }
@@ -504,7 +509,7 @@ void NineMLLayoutData::generateLayout(int numNeurons, vector<loc> *locations, QS
            }
         }
 
-        srand(this->seed);
+        seedMathsRandom(this->seed);
 
         int loop = 0;
 
@@ -122,6 +122,7 @@ public:
     double minimumDistance;
     NineMLLayout * component;
     NineMLLayoutData(NineMLLayout *data);
+    NineMLLayoutData(NineMLLayoutData *data);
     NineMLLayoutData& operator=(const NineMLLayoutData& data);
     NineMLLayoutData(){}
     ~NineMLLayoutData(){}
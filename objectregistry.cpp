@@ -0,0 +1,99 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+#include "objectregistry.h"
+#include "population.h"
+#include "projections.h"
+#include "genericinput.h"
+#include "nineML_classes.h"
+
+int objectRegistry::generation = 0;
+
+objectRegistry::objectRegistry()
+{
+    // start out of date
+    this->builtGeneration = objectRegistry::generation - 1;
+}
+
+void objectRegistry::rebuild(vector <population *> &network)
+{
+    this->objects.clear();
+    this->componentData.clear();
+    this->objectNames.clear();
+    this->componentDataNames.clear();
+
+    for (uint i = 0; i < network.size(); ++i) {
+
+        population * pop = network[i];
+
+        this->objects.insert(pop);
+        if (!this->objectNames.contains(pop->getName())) {
+            this->objectNames.insert(pop->getName(), pop);
+        }
+
+        this->componentData.insert(pop->neuronType);
+        if (!this->componentDataNames.contains(pop->neuronType->getXMLName())) {
+            this->componentDataNames.insert(pop->neuronType->getXMLName(), pop->neuronType);
+        }
+
+        for (uint j = 0; j < pop->neuronType->inputs.size(); ++j) {
+            this->objects.insert(pop->neuronType->inputs[j]);
+        }
+
+        for (uint j = 0; j < pop->projections.size(); ++j) {
+
+            projection * proj = pop->projections[j];
+
+            this->objects.insert(proj);
+            if (!this->objectNames.contains(proj->getName())) {
+                this->objectNames.insert(proj->getName(), proj);
+            }
+
+            for (uint k = 0; k < proj->synapses.size(); ++k) {
+
+                synapse * syn = proj->synapses[k];
+
+                this->objects.insert(syn);
+
+                this->componentData.insert(syn->weightUpdateType);
+                if (!this->componentDataNames.contains(syn->weightUpdateType->getXMLName())) {
+                    this->componentDataNames.insert(syn->weightUpdateType->getXMLName(), syn->weightUpdateType);
+                }
+                this->componentData.insert(syn->postsynapseType);
+                if (!this->componentDataNames.contains(syn->postsynapseType->getXMLName())) {
+                    this->componentDataNames.insert(syn->postsynapseType->getXMLName(), syn->postsynapseType);
+                }
+
+                for (uint l = 0; l < syn->weightUpdateType->inputs.size(); ++l) {
+                    this->objects.insert(syn->weightUpdateType->inputs[l]);
+                }
+                for (uint l = 0; l < syn->postsynapseType->inputs.size(); ++l) {
+                    this->objects.insert(syn->postsynapseType->inputs[l]);
+                }
+            }
+        }
+    }
+
+    this->builtGeneration = objectRegistry::generation;
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+#ifndef OBJECTREGISTRY_H
+#define OBJECTREGISTRY_H
+
+#include "globalHeader.h"
+
+/*!
+ * \brief The objectRegistry class holds the objects that make up a
+ * network in hash sets, so that checking a pointer is still part of
+ * the model, or finding an object by name, does not walk every
+ * population, projection, synapse and input.
+ *
+ * As with the spatialIndex, the registry does not follow the objects
+ * itself - constructors, destructors and anything that adds an object
+ * to or removes one from a network (the undo commands, connect and
+ * disconnect, swapping projects) call the static invalidate() and the
+ * owner rebuilds the registry the next time it is queried.
+ */
+class objectRegistry
+{
+public:
+    objectRegistry();
+
+    /*!
+     * \brief invalidate marks all registries as out of date.
+     */
+    static void invalidate() {++objectRegistry::generation;}
+
+    /*!
+     * \brief isValid returns false if invalidate() has been called
+     * since the registry was last built.
+     */
+    bool isValid() const {return this->builtGeneration == objectRegistry::generation;}
+
+    /*!
+     * \brief rebuild registers every object reachable from the network.
+     */
+    void rebuild(vector <population *> &network);
+
+    bool contains(systemObject * obj) const {return this->objects.contains(obj);}
+    bool contains(NineMLComponentData * data) const {return this->componentData.contains(data);}
+
+    /*!
+     * \brief objectNamed returns the first population or projection
+     * registered under name, or NULL. Names are taken when the registry
+     * is built, so callers should check the name still matches.
+     */
+    systemObject * objectNamed(QString name) const {return this->objectNames.value(name, NULL);}
+
+    /*!
+     * \brief componentDataNamed returns the first ComponentData
+     * registered under its XML name, or NULL.
+     */
+    NineMLComponentData * componentDataNamed(QString name) const {return this->componentDataNames.value(name, NULL);}
+
+private:
+    QSet <systemObject *> objects;
+    QSet <NineMLComponentData *> componentData;
+    QHash <QString, systemObject *> objectNames;
+    QHash <QString, NineMLComponentData *> componentDataNames;
+    int builtGeneration;
+
+    static int generation;
+};
+
+#endif // OBJECTREGISTRY_H
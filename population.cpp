@@ -25,6 +25,8 @@
 #include "population.h"
 #include "experiment.h"
 #include "projectobject.h"
+#include "spatialindex.h"
+#include "diagnostics.h"
 
 population::population(float x, float y, float size, float aspect_ratio, QString name)
 {
@@ -48,7 +50,6 @@ population::population(float x, float y, float size, float aspect_ratio, QString
     this->numNeurons = 1;
     this->colour = QColor(0,0,0,255);
     this->dlIndex = -1;
-    this->dlIndexCol = -1;
     this->type = populationObject;
     this->isVisualised = false;
     loc3.x = 0;
@@ -77,7 +78,6 @@ population::population(population * data)
     this->numNeurons = data->numNeurons;
     this->colour = data->colour;
     this->dlIndex = -1;
-    this->dlIndexCol = -1;
     this->type = populationObject;
     this->isVisualised = false;
     loc3.x = data->loc3.x;
@@ -114,7 +114,6 @@ population::population(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
     this->numNeurons = 1;
     this->colour = QColor(0,0,0,255);
     this->dlIndex = -1;
-    this->dlIndexCol = -1;
     this->type = populationObject;
     this->isVisualised = false;
     loc3.x = 0;
@@ -138,34 +137,16 @@ population::population(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
             // get attributes
             this->name = n.toElement().attribute("name");
             if (this->name == "") {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText",  "XML error: missing Neuron attribute 'name'");
-                settings.endArray();
+                diagnostics::instance()->addError("XML error: missing Neuron attribute 'name'");
             }
             this->numNeurons = n.toElement().attribute("size").toInt();
             if (this->numNeurons == 0) {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText",  "XML error: missing Neuron attribute 'size', or 'size' is zero");
-                settings.endArray();
+                diagnostics::instance()->addError("XML error: missing Neuron attribute 'size', or 'size' is zero");
             }
             this->neuronTypeName = n.toElement().attribute("url");
             QString real_url = this->neuronTypeName;
             if (this->neuronTypeName == "") {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText",  "XML error: missing Neuron attribute 'url'");
-                settings.endArray();
+                diagnostics::instance()->addError("XML error: missing Neuron attribute 'url'");
             }
 
             QStringList tempName = this->neuronTypeName.split('.');
@@ -176,9 +157,7 @@ population::population(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
 
             // do we have errors - if so abort here
             {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
+                int num_errs = diagnostics::instance()->errorCount();
                 if (num_errs > 0)
                     return;
             }
@@ -210,13 +189,7 @@ population::population(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
             if (this->neuronType == NULL) {
                 this->neuronType = new NineMLComponentData(data->catalogNB[0]);
                 this->neuronType->owner = this;
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("warning");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("warnText",  "Network references component '" + this->neuronTypeName + "' which is not found");
-                settings.endArray();
+                diagnostics::instance()->addWarning("Network references component '" + this->neuronTypeName + "' which is not found");
             }
 
         } else if (n.toElement().tagName() == "LL:Projection") {
@@ -228,13 +201,7 @@ population::population(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
             this->layoutName = n.toElement().attribute("url");
             QString real_url = this->layoutName;
             if (this->layoutName == "") {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText",  "XML error: missing Layout attribute 'url'");
-                settings.endArray();
+                diagnostics::instance()->addError("XML error: missing Layout attribute 'url'");
             }
             this->layoutName.chop(4);
             //this->layoutName.replace('_', ' ');
@@ -257,24 +224,12 @@ population::population(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
             if (!layFound) {
                 delete this->layoutType;
                 this->layoutType = new NineMLLayoutData(data->catalogLAY[0]);
-                QSettings settings;
-                int num_errs = settings.beginReadArray("warnings");
-                settings.endArray();
-                settings.beginWriteArray("warnings");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("warnText",  "Network references missing Layout '" + layoutName + "'");
-                settings.endArray();
+                diagnostics::instance()->addWarning("Network references missing Layout '" + layoutName + "'");
             }
 
 
         } else {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText",  "XML error: misplaced or unknown tag '" + n.toElement().tagName() + "'");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error: misplaced or unknown tag '" + n.toElement().tagName() + "'");
         }
 
 
@@ -575,8 +530,22 @@ void population::animate() {
     delta[HORIZ] = this->animspeed*(this->targx - this->x);
     delta[VERT] = this->animspeed*(this->targy - this->y);
 
-    this->x = this->x + delta[HORIZ];
-    this->y = this->y + delta[VERT];
+    float oldX = this->x;
+    float oldY = this->y;
+    // land once the remaining move is too small to see, so that redrawing can stop
+    if (fabs(this->targx - this->x) < 0.001 && fabs(this->targy - this->y) < 0.001) {
+        delta[HORIZ] = this->targx - this->x;
+        delta[VERT] = this->targy - this->y;
+        this->x = this->targx;
+        this->y = this->targy;
+    } else {
+        this->x = this->x + delta[HORIZ];
+        this->y = this->y + delta[VERT];
+    }
+    // the population and everything attached to it has moved
+    if (this->x != oldX || this->y != oldY) {
+        spatialIndex::invalidate();
+    }
     this->left = this->x-this->size/(2.0)*this->aspect_ratio;
     this->right = this->x+this->size/(2.0)*this->aspect_ratio;
     this->top = this->y+this->size/2.0;
@@ -701,19 +670,8 @@ void population::draw(QPainter *painter, float GLscale, float viewX, float viewY
     float top = ((-this->top+viewY)*GLscale+float(height))/2;
     float bottom = ((-this->bottom+viewY)*GLscale+float(height))/2;
 
-    QRectF rectangle(left, top, right-left, bottom-top);
-
-    QRectF rectangleInner(left+2, top+2, right-left-4, bottom-top-4);
-
     QColor col(this->colour);
     col.setAlpha(100);
-    painter->fillRect(rectangle, col);
-
-    painter->drawImage(rectangle, image);
-
-    painter->setPen(QColor(200,200,200,255));
-    painter->drawRect(rectangle);
-    painter->setPen(QColor(0,0,0,255));
 
     QString displayed_name = this->name;
 
@@ -730,8 +688,78 @@ void population::draw(QPainter *painter, float GLscale, float viewX, float viewY
     }
 
     QString text = displayed_name + "\n" + QString::number(this->numNeurons) + "\n" + displayed_comp_name;
-    painter->drawText(rectangleInner, Qt::AlignRight, text);
 
+    // too small to read when zoomed out
+    if (GLscale < LOD_HIDE_LABELS_SCALE) {
+        text = "";
+    }
+
+    // the box only changes with the zoom or the population's details, so
+    // it is drawn once into a pixmap which is reused until one changes
+    QString cacheKey = QString::number(right-left) + "," + QString::number(bottom-top) + "," + col.name() + "," \
+            + QString::number(image.cacheKey()) + "," + painter->font().toString() + "," + text;
+
+    if (cacheKey != this->drawCacheKey) {
+        // leave a pixel around the box for the border
+        this->drawCache = QPixmap(ceil(right-left)+2, ceil(bottom-top)+2);
+        this->drawCache.fill(Qt::transparent);
+
+        QPainter cachePainter(&this->drawCache);
+        cachePainter.setRenderHints(painter->renderHints());
+        cachePainter.setFont(painter->font());
+
+        QRectF rectangle(1, 1, right-left, bottom-top);
+        QRectF rectangleInner(3, 3, right-left-4, bottom-top-4);
+
+        cachePainter.fillRect(rectangle, col);
+
+        cachePainter.drawImage(rectangle, image);
+
+        cachePainter.setPen(QColor(200,200,200,255));
+        cachePainter.drawRect(rectangle);
+        cachePainter.setPen(QColor(0,0,0,255));
+
+        cachePainter.drawText(rectangleInner, Qt::AlignRight, text);
+        cachePainter.end();
+
+        this->drawCacheKey = cacheKey;
+    }
+
+    painter->drawPixmap(QPointF(round(left)-1, round(top)-1), this->drawCache);
+    painter->setPen(QColor(0,0,0,255));
+
+}
+
+QRectF population::getAttachedBounds() {
+
+    // the box, or the circle drawn for a spike source
+    QRectF bounds = QRectF(QPointF(this->left, this->bottom), QPointF(this->right, this->top));
+    bounds = bounds.united(QRectF(this->x-0.5, this->y-0.5, 1.0, 1.0));
+
+    // everything drawn from or to the population moves with it
+    vector <projection *> attached = this->projections;
+    attached.insert(attached.end(), this->reverseProjections.begin(), this->reverseProjections.end());
+
+    for (uint i = 0; i < attached.size(); ++i) {
+        bounds = bounds.united(attached[i]->getBounds());
+        for (uint j = 0; j < attached[i]->synapses.size(); ++j) {
+            synapse * syn = attached[i]->synapses[j];
+            for (uint k = 0; k < syn->weightUpdateType->inputs.size(); ++k) {
+                bounds = bounds.united(syn->weightUpdateType->inputs[k]->getBounds());
+            }
+            for (uint k = 0; k < syn->postsynapseType->inputs.size(); ++k) {
+                bounds = bounds.united(syn->postsynapseType->inputs[k]->getBounds());
+            }
+        }
+    }
+    for (uint i = 0; i < this->neuronType->inputs.size(); ++i) {
+        bounds = bounds.united(this->neuronType->inputs[i]->getBounds());
+    }
+    for (uint i = 0; i < this->neuronType->outputs.size(); ++i) {
+        bounds = bounds.united(this->neuronType->outputs[i]->getBounds());
+    }
+
+    return bounds;
 }
 
 void population::drawSynapses(QPainter *painter, float GLscale, float viewX, float viewY, int width, int height, drawStyle style) {
@@ -849,6 +877,7 @@ void population::move(float x, float y)
 {
     this->targx = x + this->locationOffset.x();
     this->targy = y + this->locationOffset.y();
+    spatialIndex::invalidate();
 }
 
 void population::write_population_xml(QXmlStreamWriter &xmlOut) {
@@ -886,6 +915,7 @@ void population::write_population_xml(QXmlStreamWriter &xmlOut) {
         for (unsigned int i = 0; i < this->projections.size(); ++i) {
 
             projection * projection = this->projections[i];
+            diagnosticContext context("", projection->getName());
 
             // locate the src and dst so we can easily access information from them:
             //population * src = this;
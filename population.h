@@ -84,10 +84,11 @@ public:
     void print();
     void setupBounds();
     void makeSpikeSource();
+    bool isMoving() {return this->x != this->targx || this->y != this->targy;}
+    QRectF getAttachedBounds();
 
     QColor colour;
     int dlIndex;
-    int dlIndexCol;
 
 //private:
     float x;
@@ -111,6 +112,10 @@ private:
     trans tempTrans;
     void setupTrans(float GLscale, float viewX, float viewY, int width, int height);
     QPointF transformPoint(QPointF point);
+
+    // the box as last drawn in standardDrawStyle, and what it was drawn with
+    QPixmap drawCache;
+    QString drawCacheKey;
 };
 
 #endif // POPULATION_H
@@ -27,6 +27,9 @@
 #include "connection.h"
 #include "experiment.h"
 #include "projectobject.h"
+#include "spatialindex.h"
+#include "objectregistry.h"
+#include "diagnostics.h"
 
 synapse::synapse(projection * proj, projectObject * data, bool dontAddInputs) {
 
@@ -151,6 +154,8 @@ projection::projection()
     currTarg = 0;
     this->start = QPointF(0,0);
 
+    this->drawPathScale = -1;
+
     this->tempTrans.GLscale = 100;
     this->tempTrans.height = 1;
     this->tempTrans.width = 1;
@@ -187,6 +192,8 @@ void projection::connect() {
 
     destination->reverseProjections.push_back(this);
     source->projections.push_back(this);
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
 
     // connect inputs
     /*for (uint i = 0; i < this->disconnectedInputs.size(); ++i) {
@@ -199,6 +206,9 @@ void projection::connect() {
 
 void projection::disconnect() {
 
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
+
     if (destination != NULL) {
         // remove projection
         for (uint i = 0; i < destination->reverseProjections.size(); ++i) {
@@ -296,6 +306,8 @@ QPointF projection::selectedControlPointLocation()
 
 void projection::move(float x, float y) {
 
+    spatialIndex::invalidate();
+
     if (curves.size() > 1) {
 
         // move mid points:
@@ -505,18 +517,6 @@ void projection::draw(QPainter *painter, float GLscale, float viewX, float viewY
                 painter->fillPath(endPoint, QColor(0,210,0,255));
             }
 
-            QPainterPath path;
-
-            // start curve drawing
-            path.moveTo(this->transformPoint(start));
-
-            // draw curves
-            for (unsigned int i = 0; i < this->curves.size(); ++i) {
-                if (this->curves.size()-1 == i)
-                    path.cubicTo(this->transformPoint(this->curves[i].C1), this->transformPoint(this->curves[i].C2), this->transformPoint(end));
-                else
-                    path.cubicTo(this->transformPoint(this->curves[i].C1), this->transformPoint(this->curves[i].C2), this->transformPoint(this->curves[i].end));
-            }
 
             // only draw number of synapses for Projections
             if (this->type == projectionObject) {
@@ -543,8 +543,11 @@ void projection::draw(QPainter *painter, float GLscale, float viewX, float viewY
 
             }
 
-            // DRAW
-            painter->drawPath(path);
+            // DRAW - the path is cached relative to the GL origin, so panning only moves it
+            QPointF origin = this->transformPoint(QPointF(0,0));
+            painter->translate(origin);
+            painter->drawPath(this->getDrawPath(GLscale));
+            painter->translate(-origin);
             painter->setPen(oldPen);
 
             break;
@@ -651,6 +654,35 @@ void projection::drawHandles(QPainter *painter, float GLscale, float viewX, floa
 
 }
 
+const QPainterPath &projection::getDrawPath(float GLscale) {
+
+    // only rebuild the path if the zoom or the control points have changed
+    bool valid = this->drawPathScale == GLscale && this->drawPathStart == this->start && this->drawPathCurves.size() == this->curves.size();
+    for (uint i = 0; valid && i < this->curves.size(); ++i) {
+        valid = this->drawPathCurves[i].C1 == this->curves[i].C1 && this->drawPathCurves[i].C2 == this->curves[i].C2 \
+                && this->drawPathCurves[i].end == this->curves[i].end;
+    }
+
+    if (!valid) {
+        // same as transformPoint(), less the translation for the view
+        float scale = GLscale/2.0;
+
+        this->drawPath = QPainterPath();
+        this->drawPath.moveTo(this->start.x()*scale, -this->start.y()*scale);
+        for (uint i = 0; i < this->curves.size(); ++i) {
+            this->drawPath.cubicTo(this->curves[i].C1.x()*scale, -this->curves[i].C1.y()*scale, \
+                                   this->curves[i].C2.x()*scale, -this->curves[i].C2.y()*scale, \
+                                   this->curves[i].end.x()*scale, -this->curves[i].end.y()*scale);
+        }
+
+        this->drawPathScale = GLscale;
+        this->drawPathStart = this->start;
+        this->drawPathCurves = this->curves;
+    }
+
+    return this->drawPath;
+}
+
 QPainterPath projection::makeIntersectionLine(int first, int last) {
 
     // draw the path to a QPainterPath
@@ -694,13 +726,45 @@ QPainterPath projection::makeIntersectionLine(int first, int last) {
 
 }
 
+QRectF projection::getBounds() {
+
+    // a bezier curve lies inside the hull of its control points, so
+    // the box around them all bounds the whole projection
+    float minX = this->start.x();
+    float maxX = this->start.x();
+    float minY = this->start.y();
+    float maxY = this->start.y();
+
+    for (uint i = 0; i < this->curves.size(); ++i) {
+        QPointF points[3] = {this->curves[i].C1, this->curves[i].C2, this->curves[i].end};
+        for (uint j = 0; j < 3; ++j) {
+            minX = qMin(minX, (float) points[j].x());
+            maxX = qMax(maxX, (float) points[j].x());
+            minY = qMin(minY, (float) points[j].y());
+            maxY = qMax(maxY, (float) points[j].y());
+        }
+    }
+
+    // pad for the width of the intersection line
+    return QRectF(QPointF(minX-0.01, minY-0.01), QPointF(maxX+0.01, maxY+0.01));
+}
+
 bool projection::is_clicked(float xGL, float yGL, float GLscale) {
 
+    QRectF cursorRect(xGL-10.0/GLscale, yGL-10.0/GLscale, 20.0/GLscale, 20.0/GLscale);
+
+    // cheap rejection before building the path
+    QRectF bounds = this->getBounds();
+    if (bounds.left() > cursorRect.right() || bounds.right() < cursorRect.left() \
+            || bounds.top() > cursorRect.bottom() || bounds.bottom() < cursorRect.top()) {
+        return false;
+    }
+
     // do an intersection using a QPainterPath to see if we meet:
     QPainterPath colPath = this->makeIntersectionLine(0, this->curves.size());
 
     // intersect with the cursor
-    if (colPath.intersects(QRectF(xGL-10.0/GLscale, yGL-10.0/GLscale, 20.0/GLscale, 20.0/GLscale))) {
+    if (colPath.intersects(cursorRect)) {
         return true;
     }
 
@@ -715,35 +779,36 @@ bool projection::selectControlPoint(float xGL, float yGL, float GLscale) {
     QSettings settings;
     float dpi_ratio = settings.value("dpi", 1.0).toFloat();
 
+    // handles are circles of this radius around each control point
+    float radius = 10.0/GLscale*dpi_ratio;
+
+    // no handle can be hit if the cursor is outside the bounds
+    QRectF bounds = this->getBounds().adjusted(-radius, -radius, radius, radius);
+    if (!bounds.contains(cursor)) {
+        return false;
+    }
+
     // test start:
-    QPainterPath test;
-    test.addEllipse(this->start, 10.0/GLscale*dpi_ratio, 10.0/GLscale*dpi_ratio);
-    if (test.contains(cursor)) {
+    if (this->withinRadius(this->start, cursor, radius)) {
         this->selectedControlPoint.start = true;
         return true;
     }
 
     // now check all the bezierCurves in turn:
     for (unsigned int i = 0; i < this->curves.size(); ++i) {
-        QPainterPath testEnd;
-        testEnd.addEllipse(this->curves[i].end, 10.0/GLscale*dpi_ratio, 10.0/GLscale*dpi_ratio);
-        if (testEnd.contains(cursor)) {
+        if (this->withinRadius(this->curves[i].end, cursor, radius)) {
             this->selectedControlPoint.start = false;
             this->selectedControlPoint.type = p_end;
             this->selectedControlPoint.ind = i;
             return true;
         }
-        QPainterPath testC1;
-        testC1.addEllipse(this->curves[i].C1, 10.0/GLscale*dpi_ratio, 10.0/GLscale*dpi_ratio);
-        if (testC1.contains(cursor)) {
+        if (this->withinRadius(this->curves[i].C1, cursor, radius)) {
             this->selectedControlPoint.start = false;
             this->selectedControlPoint.type = C1;
             this->selectedControlPoint.ind = i;
             return true;
         }
-        QPainterPath testC2;
-        testC2.addEllipse(this->curves[i].C2, 10.0/GLscale*dpi_ratio, 10.0/GLscale*dpi_ratio);
-        if (testC2.contains(cursor)) {
+        if (this->withinRadius(this->curves[i].C2, cursor, radius)) {
             this->selectedControlPoint.start = false;
             this->selectedControlPoint.type = C2;
             this->selectedControlPoint.ind = i;
@@ -767,6 +832,7 @@ bool projection::deleteControlPoint(float xGL, float yGL, float GLscale) {
 
             // the remove:
             this->curves.erase(this->curves.begin()+this->selectedControlPoint.ind);
+            spatialIndex::invalidate();
 
             // deleted!
             return true;
@@ -781,6 +847,8 @@ bool projection::deleteControlPoint(float xGL, float yGL, float GLscale) {
 
 void projection::moveSelectedControlPoint(float xGL, float yGL) {
 
+    spatialIndex::invalidate();
+
     // convert to QPointF
     QPointF cursor(xGL, yGL);
 
@@ -881,6 +949,8 @@ void projection::moveSelectedControlPoint(float xGL, float yGL) {
 
 void projection::insertControlPoint(float xGL, float yGL, float GLscale) {
 
+    spatialIndex::invalidate();
+
     // convert to QPointF
     QPointF cursor(xGL, yGL);
 
@@ -1075,6 +1145,8 @@ projection::projection(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
 
     this->type = projectionObject;
 
+    this->drawPathScale = -1;
+
     this->selectedControlPoint.ind = -1;
     this->selectedControlPoint.start = false;
 
@@ -1093,13 +1165,7 @@ projection::projection(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
     if (nrn.size() == 1) {
         destName = e.attribute("dst_population");
         if (destName == "") {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-                settings.setArrayIndex(num_errs + 1);
-                settings.setValue("errorText",  "XML error: missing Projection attribute 'dst_population'");
-            settings.endArray();
+            diagnostics::instance()->addError("XML error: missing Projection attribute 'dst_population'");
         }
     }
 
@@ -1116,13 +1182,7 @@ projection::projection(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
         }
     }
     if (!linked) {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",  "Error: Projection references missing source '" + srcName + "'");
-        settings.endArray();
+        diagnostics::instance()->addError("Error: Projection references missing source '" + srcName + "'");
         return;
     }
 
@@ -1134,13 +1194,7 @@ projection::projection(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
         }
     }
     if (!linked) {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",  "Error: Projection references missing destination '" + destName + "'");
-        settings.endArray();
+        diagnostics::instance()->addError("Error: Projection references missing destination '" + destName + "'");
         return;
     }
 
@@ -1155,13 +1209,7 @@ projection::projection(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
     QDomNodeList colList = e.elementsByTagName("LL:Synapse");
 
     if (colList.count() == 0) {
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
-        settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText",  "XML error: Projection contains no Synapse tags");
-        settings.endArray();
+        diagnostics::instance()->addError("XML error: Projection contains no Synapse tags");
         return;
     }
 
@@ -1209,13 +1257,7 @@ projection::projection(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
                 pspName = n.toElement().attribute("url");
                 QString real_url = pspName;
                 if (pspName == "") {
-                    QSettings settings;
-                    int num_errs = settings.beginReadArray("errors");
-                    settings.endArray();
-                    settings.beginWriteArray("errors");
-                        settings.setArrayIndex(num_errs + 1);
-                        settings.setValue("errorText",  "XML error: Missing PostSynapse 'url' attribute");
-                    settings.endArray();
+                    diagnostics::instance()->addError("XML error: Missing PostSynapse 'url' attribute");
                     return;
                 }
                 QStringList tempName = pspName.split('.');
@@ -1240,13 +1282,7 @@ projection::projection(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
                 if (newSynapse->postsynapseType == NULL) {
                     newSynapse->postsynapseType = new NineMLComponentData(data->catalogPS[0]);
                     newSynapse->postsynapseType->owner = this;
-                    QSettings settings;
-                    int num_errs = settings.beginReadArray("warnings");
-                    settings.endArray();
-                    settings.beginWriteArray("warnings");
-                        settings.setArrayIndex(num_errs + 1);
-                        settings.setValue("warnText",  "Network references missing Component '" + pspName + "'");
-                    settings.endArray();
+                    diagnostics::instance()->addWarning("Network references missing Component '" + pspName + "'");
                 }
 
             }
@@ -1256,13 +1292,7 @@ projection::projection(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
                 synName = n.toElement().attribute("url");
                 QString real_url = synName;
                 if (synName == "") {
-                    QSettings settings;
-                    int num_errs = settings.beginReadArray("errors");
-                    settings.endArray();
-                    settings.beginWriteArray("errors");
-                        settings.setArrayIndex(num_errs + 1);
-                        settings.setValue("errorText",  "XML error: Missing WeightUpdate 'url' attribute");
-                    settings.endArray();
+                    diagnostics::instance()->addError("XML error: Missing WeightUpdate 'url' attribute");
                     return;
                 }
                 QStringList tempName = synName.split('.');
@@ -1287,23 +1317,11 @@ projection::projection(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
                 if (newSynapse->weightUpdateType == NULL) {
                     newSynapse->weightUpdateType = new NineMLComponentData(data->catalogWU[0]);
                     newSynapse->weightUpdateType->owner = this;
-                    QSettings settings;
-                    int num_errs = settings.beginReadArray("warnings");
-                    settings.endArray();
-                    settings.beginWriteArray("warnings");
-                        settings.setArrayIndex(num_errs + 1);
-                        settings.setValue("warnText",  "Network references missing Component '" + synName + "'");
-                    settings.endArray();
+                    diagnostics::instance()->addWarning("Network references missing Component '" + synName + "'");
                 }
 
             } else {
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText",  "XML error: misplaced or unknown tag '" + n.toElement().tagName() + "'");
-                settings.endArray();
+                diagnostics::instance()->addError("XML error: misplaced or unknown tag '" + n.toElement().tagName() + "'");
             }
         n = n.nextSibling();
         }
@@ -1392,6 +1410,8 @@ projection::projection(QDomElement  &e, QDomDocument *, QDomDocument * meta, pro
 
 void projection::add_curves() {
 
+    spatialIndex::invalidate();
+
     // add sensible curves
     // add curves for drawing:
     bezierCurve newCurve;
@@ -130,12 +130,24 @@ public:
     void setupTrans(float GLscale, float viewX, float viewY, int width, int height);
     QPointF transformPoint(QPointF point);
     QPainterPath makeIntersectionLine(int first, int last);
+    QRectF getBounds();
+    const QPainterPath &getDrawPath(float GLscale);
+    bool withinRadius(QPointF point, QPointF cursor, float radius) {
+        QPointF diff = cursor - point;
+        return diff.x()*diff.x() + diff.y()*diff.y() < radius*radius;
+    }
 
     vector < genericInput * > disconnectedInputs;
 
 protected:
     cPoint selectedControlPoint;
 
+    // the curves as last drawn in standardDrawStyle, see getDrawPath()
+    QPainterPath drawPath;
+    QPointF drawPathStart;
+    vector < bezierCurve > drawPathCurves;
+    float drawPathScale;
+
 private:
     int srcPos;
     int dstPos;
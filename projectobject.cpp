@@ -6,6 +6,14 @@
 #include "versioncontrol.h"
 #include "experiment.h"
 #include "systemmodel.h"
+#include "mathsoptimiser.h"
+#include "spatialindex.h"
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+#include <QStandardPaths>
+#endif
+#include <cstdio>
+
+bool projectObject::headless = false;
 
 projectObject::projectObject(QObject *parent) :
     QObject(parent)
@@ -20,6 +28,8 @@ projectObject::projectObject(QObject *parent) :
     this->networkFile = "model.xml";
     this->metaFile = "metaData.xml";
 
+    this->exporting = false;
+
     // create the catalog blank entries:
     this->catalogGC.push_back((new NineMLComponent()));
     this->catalogGC[0]->name = "none";
@@ -99,15 +109,23 @@ bool projectObject::open_project(QString fileName)
         return false;
     }
 
+    // read all the component and layout files at once - they are added to the catalogs in the listed order
+    QList < QFuture < xmlFileJob * > > componentJobs = startXmlFileJobs(this->components, project_dir);
+    QList < QFuture < xmlFileJob * > > layoutJobs = startXmlFileJobs(this->layouts, project_dir);
+
     // then load in all the components listed in the project file ///////////
-    for (int i = 0; i < this->components.size(); ++i) {
-        loadComponent(this->components[i], project_dir);
+    for (int i = 0; i < componentJobs.size(); ++i) {
+        xmlFileJob * job = componentJobs[i].result();
+        loadComponent(job);
+        delete job;
     }
     printErrors("Errors found loading project Components:");
 
     // then load in all the layouts listed in the project file //////////////
-    for (int i = 0; i < this->layouts.size(); ++i) {
-        loadLayout(this->layouts[i], project_dir);
+    for (int i = 0; i < layoutJobs.size(); ++i) {
+        xmlFileJob * job = layoutJobs[i].result();
+        loadLayout(job);
+        delete job;
     }
     printErrors("Errors found loading project Layouts:");
 
@@ -135,9 +153,7 @@ bool projectObject::open_project(QString fileName)
 bool projectObject::save_project(QString fileName, rootData * data)
 {
     if (!fileName.contains(".")) {
-        QMessageBox msgBox;
-        msgBox.setText("Project file needs .proj suffix.");
-        msgBox.exec();
+        reportError("Project file needs .proj suffix.");
         return false;
     }
 
@@ -152,18 +168,6 @@ bool projectObject::save_project(QString fileName, rootData * data)
     // check for version control
     this->version.setupVersion();
 
-    // remove old binary files
-    project_dir.setNameFilters(QStringList() << "*.bin");
-    QStringList files = project_dir.entryList(QDir::Files);
-    for (int i = 0; i < files.size(); ++i) {
-        // delete
-        project_dir.remove(files[i]);
-        // and remove from version control
-        if (this->version.isModelUnderVersion()) {
-            this->version.removeFromVersion(files[i]);
-        }
-    }
-
     // sync project
     copy_back_data(data);
 
@@ -191,8 +195,10 @@ bool projectObject::save_project(QString fileName, rootData * data)
         saveLayout(this->catalogLAY[i]->getXMLName(), project_dir, this->catalogLAY[i]);
     }
 
-    // write network
-    saveNetwork(this->networkFile, project_dir);
+    // write network - unchanged binary connection files are left in place, and any no longer used are removed
+    if (saveNetwork(this->networkFile, project_dir)) {
+        removeUnusedBinaries(project_dir);
+    }
 
     // saveMetaData
     saveMetaData(this->metaFile, project_dir);
@@ -255,41 +261,39 @@ bool projectObject::export_for_simulator(QString fileName, rootData * data)
         }
     }
 
-    // remove old files
-    project_dir.setNameFilters(QStringList() << "*");
-    QStringList files = project_dir.entryList(QDir::Files);
-    for (int i = 0; i < files.size(); ++i) {
-        // delete
-        project_dir.remove(files[i]);
-        // and remove from version control
-        if (this->version.isModelUnderVersion()) {
-            this->version.removeFromVersion(files[i]);
-        }
-    }
+    // files are only rewritten if their content has changed, so note which ones this export produces
+    this->writtenFiles.clear();
+    this->exporting = true;
 
     // sync project
     copy_back_data(data);
 
+    // the maths is only rewritten if the simulator has asked for it
+    mathsOptimiser * optimiser = NULL;
+    if (settings.value("export_optimise_maths", false).toBool()) {
+        optimiser = new mathsOptimiser;
+    }
+
     // write components
     for (uint i = 1; i < this->catalogNB.size(); ++i) {
         QString fileName = this->catalogNB[i]->getXMLName();
         fileName.replace(" ", "_");
-        saveComponent(fileName, project_dir, this->catalogNB[i]);
+        exportComponent(fileName, project_dir, this->catalogNB[i], currentExperiment, optimiser);
     }
     for (uint i = 1; i < this->catalogWU.size(); ++i) {
         QString fileName = this->catalogWU[i]->getXMLName();
         fileName.replace(" ", "_");
-        saveComponent(fileName, project_dir, this->catalogWU[i]);
+        exportComponent(fileName, project_dir, this->catalogWU[i], currentExperiment, optimiser);
     }
     for (uint i = 1; i < this->catalogPS.size(); ++i) {
         QString fileName = this->catalogPS[i]->getXMLName();
         fileName.replace(" ", "_");
-        saveComponent(fileName, project_dir, this->catalogPS[i]);
+        exportComponent(fileName, project_dir, this->catalogPS[i], currentExperiment, optimiser);
     }
     for (uint i = 1; i < this->catalogGC.size(); ++i) {
         QString fileName = this->catalogGC[i]->getXMLName();
         fileName.replace(" ", "_");
-        saveComponent(fileName, project_dir, this->catalogGC[i]);
+        exportComponent(fileName, project_dir, this->catalogGC[i], currentExperiment, optimiser);
     }
 
     // write layouts
@@ -303,6 +307,40 @@ bool projectObject::export_for_simulator(QString fileName, rootData * data)
     // write experiment
     saveExperiment("experiment.xml", project_dir, currentExperiment);
 
+    // write out what the optimiser changed, so the rewritten maths can be checked against the original
+    if (optimiser != NULL) {
+        if (optimiser->report.size() > 0) {
+            QByteArray report;
+            QTextStream reportStream(&report, QIODevice::WriteOnly | QIODevice::Text);
+            reportStream << optimiser->report.join("\n") << "\n";
+            reportStream.flush();
+            if (!writeFileIfChanged(project_dir.absoluteFilePath("maths_optimisation.txt"), report)) {
+                addWarning("export_for_simulator: could not write maths_optimisation.txt");
+            }
+        }
+        delete optimiser;
+    }
+
+    // remove files left from earlier exports - unchanged ones were left in place so the simulator can reuse its build
+    QStringList files = project_dir.entryList(QDir::Files);
+    for (int i = 0; i < files.size(); ++i) {
+        if (this->writtenFiles.contains(project_dir.absoluteFilePath(files[i])) || this->networkBinaryFiles.contains(files[i])) {
+            continue;
+        }
+        project_dir.remove(files[i]);
+    }
+    this->writtenFiles.clear();
+    this->exporting = false;
+
+    // the export folder is not the project, so forget the digests of its files - a later
+    // export still compares against what is on disk before rewriting
+    QString exportPrefix = project_dir.absolutePath() + "/";
+    QStringList digestNames = this->fileDigests.keys();
+    for (int i = 0; i < digestNames.size(); ++i) {
+        if (digestNames[i].startsWith(exportPrefix)) {
+            this->fileDigests.remove(digestNames[i]);
+        }
+    }
 
     if (printErrors("Errors found")) {
         settings.remove("export_for_simulation");
@@ -318,6 +356,83 @@ bool projectObject::export_for_simulator(QString fileName, rootData * data)
     return true;
 }
 
+void projectObject::exportComponent(QString fileName, QDir dir, NineMLComponent * component, experiment * expt, mathsOptimiser * optimiser)
+{
+    diagnosticContext context(dir.absoluteFilePath(fileName), component->name);
+
+    if (optimiser == NULL) {
+        saveComponent(fileName, dir, component);
+        return;
+    }
+
+    // the Component is edited in place for the save, and put back straight after
+    optimiser->optimise(component, getFixedParameters(component, expt));
+    saveComponent(fileName, dir, component);
+    optimiser->restore();
+}
+
+QMap <QString, double> projectObject::getFixedParameters(NineMLComponent * component, experiment * expt)
+{
+    // a Parameter can be replaced by its value only if every instance of the Component
+    // has the same FixedValue for it, and the experiment does not change it
+    QMap <QString, double> fixedValues;
+    QSet <QString> varying;
+    bool found = false;
+
+    vector < NineMLComponentData * > instances;
+    for (uint i = 0; i < this->network.size(); ++i) {
+        instances.push_back(this->network[i]->neuronType);
+        for (uint j = 0; j < this->network[i]->projections.size(); ++j) {
+            for (uint k = 0; k < this->network[i]->projections[j]->synapses.size(); ++k) {
+                instances.push_back(this->network[i]->projections[j]->synapses[k]->weightUpdateType);
+                instances.push_back(this->network[i]->projections[j]->synapses[k]->postsynapseType);
+            }
+        }
+    }
+
+    for (uint i = 0; i < instances.size(); ++i) {
+
+        if (instances[i] == NULL || instances[i]->component != component) {
+            continue;
+        }
+        found = true;
+
+        for (uint j = 0; j < instances[i]->ParameterList.size(); ++j) {
+
+            ParameterData * par = instances[i]->ParameterList[j];
+
+            if (par->currType != FixedValue || par->value.size() != 1) {
+                varying.insert(par->name);
+                continue;
+            }
+
+            // use the value as it is written out, so the result matches the unoptimised model
+            double value = QString::number(par->value[0]).toDouble();
+
+            if (fixedValues.contains(par->name) && fixedValues[par->name] != value) {
+                varying.insert(par->name);
+            }
+            fixedValues[par->name] = value;
+        }
+
+        for (uint j = 0; j < expt->changes.size(); ++j) {
+            if (expt->changes[j]->component == instances[i] && expt->changes[j]->par != NULL) {
+                varying.insert(expt->changes[j]->par->name);
+            }
+        }
+    }
+
+    if (!found) {
+        return QMap <QString, double> ();
+    }
+
+    foreach (QString name, varying) {
+        fixedValues.remove(name);
+    }
+
+    return fixedValues;
+}
+
 bool projectObject::import_network(QString fileName)
 {
     QDir project_dir(fileName);
@@ -328,19 +443,33 @@ bool projectObject::import_network(QString fileName)
     // get a list of the files in the directory
     QStringList files = project_dir.entryList();
 
-    // load all the components in the list
+    // find the components and layouts in the list
+    QStringList componentFiles;
+    QStringList layoutFiles;
     for (int i = 0; i < files.size(); ++i) {
         if (isComponent(project_dir.absoluteFilePath(files[i])))
-            loadComponent(files[i], project_dir);
+            componentFiles.push_back(files[i]);
     }
-
-    // load all the layouts in the list
     for (int i = 0; i < files.size(); ++i) {
         if (isLayout(project_dir.absoluteFilePath(files[i]))) {
-            loadLayout(files[i], project_dir);
+            layoutFiles.push_back(files[i]);
         }
     }
 
+    // and read them all at once, loading them in order
+    QList < QFuture < xmlFileJob * > > componentJobs = startXmlFileJobs(componentFiles, project_dir);
+    QList < QFuture < xmlFileJob * > > layoutJobs = startXmlFileJobs(layoutFiles, project_dir);
+    for (int i = 0; i < componentJobs.size(); ++i) {
+        xmlFileJob * job = componentJobs[i].result();
+        loadComponent(job);
+        delete job;
+    }
+    for (int i = 0; i < layoutJobs.size(); ++i) {
+        xmlFileJob * job = layoutJobs[i].result();
+        loadLayout(job);
+        delete job;
+    }
+
     // load the network
     loadNetwork(fileName, project_dir, false);
     if (printErrors("Errors prevented importing the Network:")) {
@@ -408,9 +537,7 @@ bool projectObject::load_project_file(QString fileName)
 
     QFile file(fileName);
     if (!file.open(QIODevice::ReadOnly)) {
-        QMessageBox msgBox;
-        msgBox.setText("Could not open the project file");
-        msgBox.exec();
+        reportError("Could not open the project file", fileName);
         return false;
     }
 
@@ -436,35 +563,17 @@ bool projectObject::load_project_file(QString fileName)
                             if (reader->attributes().hasAttribute("name")) {
                                 this->networkFile = reader->attributes().value("name").toString();
                             } else {
-                                QSettings settings;
-                                int num_errs = settings.beginReadArray("errors");
-                                settings.endArray();
-                                settings.beginWriteArray("errors");
-                                settings.setArrayIndex(num_errs + 1);
-                                settings.setValue("errorText", "XML Error in Project File - missing attribute 'name'");
-                                settings.endArray();
+                                diagnostics::instance()->addError("XML Error in Project File - missing attribute 'name'", fileName, reader->lineNumber());
                             }
                             if (reader->attributes().hasAttribute("metaFile")) {
                                 this->metaFile = reader->attributes().value("metaFile").toString();
                             } else {
-                                QSettings settings;
-                                int num_errs = settings.beginReadArray("errors");
-                                settings.endArray();
-                                settings.beginWriteArray("errors");
-                                settings.setArrayIndex(num_errs + 1);
-                                settings.setValue("errorText", "XML Error in Project File - missing attribute 'metaFile'");
-                                settings.endArray();
+                                diagnostics::instance()->addError("XML Error in Project File - missing attribute 'metaFile'", fileName, reader->lineNumber());
                             }
                             reader->skipCurrentElement();
 
                         } else {
-                            QSettings settings;
-                            int num_errs = settings.beginReadArray("errors");
-                            settings.endArray();
-                            settings.beginWriteArray("errors");
-                            settings.setArrayIndex(num_errs + 1);
-                            settings.setValue("errorText", "XML Error in Project File - unknown tag '" + reader->name().toString() + "'");
-                            settings.endArray();
+                            diagnostics::instance()->addError("XML Error in Project File - unknown tag '" + reader->name().toString() + "'", fileName, reader->lineNumber());
                         }
 
                     }
@@ -478,24 +587,12 @@ bool projectObject::load_project_file(QString fileName)
                             if (reader->attributes().hasAttribute("name")) {
                                 this->components.push_back(reader->attributes().value("name").toString());
                             } else {
-                                QSettings settings;
-                                int num_errs = settings.beginReadArray("errors");
-                                settings.endArray();
-                                settings.beginWriteArray("errors");
-                                settings.setArrayIndex(num_errs + 1);
-                                settings.setValue("errorText", "XML Error in Project File - missing attribute 'name'");
-                                settings.endArray();
+                                diagnostics::instance()->addError("XML Error in Project File - missing attribute 'name'", fileName, reader->lineNumber());
                             }
                             reader->skipCurrentElement();
 
                         } else {
-                            QSettings settings;
-                            int num_errs = settings.beginReadArray("errors");
-                            settings.endArray();
-                            settings.beginWriteArray("errors");
-                            settings.setArrayIndex(num_errs + 1);
-                            settings.setValue("errorText", "XML Error in Project File - unknown tag '" + reader->name().toString() + "'");
-                            settings.endArray();
+                            diagnostics::instance()->addError("XML Error in Project File - unknown tag '" + reader->name().toString() + "'", fileName, reader->lineNumber());
                         }
 
                     }
@@ -509,24 +606,12 @@ bool projectObject::load_project_file(QString fileName)
                             if (reader->attributes().hasAttribute("name")) {
                                 this->layouts.push_back(reader->attributes().value("name").toString());
                             } else {
-                                QSettings settings;
-                                int num_errs = settings.beginReadArray("errors");
-                                settings.endArray();
-                                settings.beginWriteArray("errors");
-                                settings.setArrayIndex(num_errs + 1);
-                                settings.setValue("errorText", "XML Error in Project File - missing attribute 'name'");
-                                settings.endArray();
+                                diagnostics::instance()->addError("XML Error in Project File - missing attribute 'name'", fileName, reader->lineNumber());
                             }
                             reader->skipCurrentElement();
 
                         } else {
-                            QSettings settings;
-                            int num_errs = settings.beginReadArray("errors");
-                            settings.endArray();
-                            settings.beginWriteArray("errors");
-                            settings.setArrayIndex(num_errs + 1);
-                            settings.setValue("errorText", "XML Error in Project File - unknown tag '" + reader->name().toString() + "'");
-                            settings.endArray();
+                            diagnostics::instance()->addError("XML Error in Project File - unknown tag '" + reader->name().toString() + "'", fileName, reader->lineNumber());
                         }
 
                     }
@@ -540,48 +625,24 @@ bool projectObject::load_project_file(QString fileName)
                             if (reader->attributes().hasAttribute("name")) {
                                 this->experiments.push_back(reader->attributes().value("name").toString());
                             } else {
-                                QSettings settings;
-                                int num_errs = settings.beginReadArray("errors");
-                                settings.endArray();
-                                settings.beginWriteArray("errors");
-                                settings.setArrayIndex(num_errs + 1);
-                                settings.setValue("errorText", "XML Error in Project File - missing attribute 'name'");
-                                settings.endArray();
+                                diagnostics::instance()->addError("XML Error in Project File - missing attribute 'name'", fileName, reader->lineNumber());
                             }
                             reader->skipCurrentElement();
 
                         } else {
-                            QSettings settings;
-                            int num_errs = settings.beginReadArray("errors");
-                            settings.endArray();
-                            settings.beginWriteArray("errors");
-                            settings.setArrayIndex(num_errs + 1);
-                            settings.setValue("errorText", "XML Error in Project File - unknown tag '" + reader->name().toString() + "'");
-                            settings.endArray();
+                            diagnostics::instance()->addError("XML Error in Project File - unknown tag '" + reader->name().toString() + "'", fileName, reader->lineNumber());
                         }
 
                     }
 
                 }  else {
-                    QSettings settings;
-                    int num_errs = settings.beginReadArray("errors");
-                    settings.endArray();
-                    settings.beginWriteArray("errors");
-                    settings.setArrayIndex(num_errs + 1);
-                    settings.setValue("errorText", "XML Error in Project File - unknown tag '" + reader->name().toString() + "'");
-                    settings.endArray();
+                    diagnostics::instance()->addError("XML Error in Project File - unknown tag '" + reader->name().toString() + "'", fileName, reader->lineNumber());
                 }
 
             }
 
         } else {
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-            settings.beginWriteArray("errors");
-            settings.setArrayIndex(num_errs + 1);
-            settings.setValue("errorText", "XML Error in Project File - incorrect start tag");
-            settings.endArray();
+            diagnostics::instance()->addError("XML Error in Project File - incorrect start tag", fileName, reader->lineNumber());
         }
     }
 
@@ -592,25 +653,13 @@ bool projectObject::save_project_file(QString fileName)
 {
     // complain if there's no extension (client code should correctly set fileName)
     if (!fileName.contains(".")) {
-        QMessageBox msgBox;
-        msgBox.setText("Project file needs .proj suffix.");
-        msgBox.exec();
-        return false;
-    }
-
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly)) {
-        QMessageBox msgBox;
-        msgBox.setText("Could not create the project file");
-        msgBox.exec();
+        reportError("Project file needs .proj suffix.");
         return false;
     }
 
     // get a streamwriter
-    QXmlStreamWriter * writer = new QXmlStreamWriter;
-
-    // set the stream reader device to the file
-    writer->setDevice(&file);
+    QByteArray content;
+    QXmlStreamWriter * writer = new QXmlStreamWriter(&content);
 
     // write elements
     writer->writeStartDocument();
@@ -665,9 +714,11 @@ bool projectObject::save_project_file(QString fileName)
 
     writer->writeEndElement(); // SpineCreatorProject
 
-    // add to version control
-    if (this->version.isModelUnderVersion()) {
-        this->version.addToVersion(file.fileName());
+    delete writer;
+
+    if (!writeFileIfChanged(QFileInfo(fileName).absoluteFilePath(), content)) {
+        reportError("Could not create the project file", fileName);
+        return false;
     }
 
     return true;
@@ -740,54 +791,119 @@ bool projectObject::isLayout(QString fileName)
     return true;
 }
 
-void projectObject::loadComponent(QString fileName, QDir project_dir)
+static xmlFileJob * runXmlFileJob(xmlFileJob * job)
 {
-    if (fileName == "none.xml") {
-        return;
+    // placeholder - there is no file
+    if (job->fileName == "none.xml") {
+        return job;
     }
 
+    // problems are kept with the job, and reported in order when it is loaded
+    diagnosticsScope scope(&job->issues);
+    diagnosticContext context(job->path);
+
     // try opening the file and loading the XML
-    QFile file(project_dir.absoluteFilePath(fileName));
+    QFile file(job->path);
     if (!file.open(QIODevice::ReadOnly)) {
-        addError("Cannot open required file '" + fileName + "'");
-        return;
+        diagnostics::instance()->addError("Cannot open required file '" + job->fileName + "'");
+        return job;
     }
-    if (!this->doc.setContent(&file)) {
-        addError("Cannot read required file '" + fileName + "'");
-        return;
+    QByteArray content = file.readAll();
+    job->digest = QCryptographicHash::hash(content, QCryptographicHash::Md5);
+    QString errorText;
+    int errorLine;
+    if (!job->doc.setContent(content, &errorText, &errorLine)) {
+        diagnostics::instance()->addError("Cannot read required file - " + errorText, job->fileName, errorLine);
+        return job;
     }
 
     // confirm root tag is correct
-    QDomElement root = this->doc.documentElement();
-    if (root.tagName() != "SpineML" ) {
-        addError("Missing or incorrect root tag in required file '" + fileName + "'");
-        return;
+    if (job->doc.documentElement().tagName() != "SpineML" ) {
+        diagnostics::instance()->addError("Missing or incorrect root tag in required file '" + job->fileName + "'");
+        return job;
     }
 
-    // if a componentclass
-    QDomElement classType = root.firstChildElement();
-
+    // build and validate the component or layout here too - only adding it to a catalog waits for the calling thread
+    QDomElement classType = job->doc.documentElement().firstChildElement();
+    context.setObject(classType.attribute("name"));
     if (classType.tagName() == "ComponentClass") {
+        job->component = new NineMLComponent();
+        job->component->load(&job->doc);
+        if (diagnostics::instance()->errorCount() != 0) {
+            delete job->component;
+            job->component = NULL;
+            // write tail for errors:
+            diagnostics::instance()->addError("<b>IN COMPONENT FILE '" + job->fileName + "'</b>");
+        }
+    } else if (classType.tagName() == "LayoutClass") {
+        job->layout = new NineMLLayout();
+        job->layout->load(&job->doc);
+        if (diagnostics::instance()->errorCount() != 0) {
+            delete job->layout;
+            job->layout = NULL;
+            // write tail for errors:
+            diagnostics::instance()->addError("<b>IN LAYOUT FILE '" + job->fileName + "'</b>");
+        }
+    }
 
-        // HANDLE SPINEML COMPONENTS ////////////////
+    // the document is not needed once the object is built
+    job->doc.clear();
+    return job;
+}
 
-        // create a new AL class instance and populate it from the data
-        NineMLComponent *tempALobject = new NineMLComponent();
+xmlFileJob::~xmlFileJob()
+{
+    // anything not taken into a catalog
+    delete this->component;
+    delete this->layout;
+}
+
+QList < QFuture < xmlFileJob * > > projectObject::startXmlFileJobs(QStringList fileNames, QDir project_dir)
+{
+    // the files are read on the thread pool, and the results are fetched in the same order
+    QList < QFuture < xmlFileJob * > > jobs;
+    for (int i = 0; i < fileNames.size(); ++i) {
+        xmlFileJob * job = new xmlFileJob;
+        job->fileName = fileNames[i];
+        job->path = project_dir.absoluteFilePath(fileNames[i]);
+        jobs.push_back(QtConcurrent::run(runXmlFileJob, job));
+    }
+    return jobs;
+}
 
-        tempALobject->load(&this->doc);
+void projectObject::loadComponent(QString fileName, QDir project_dir)
+{
+    xmlFileJob job;
+    job.fileName = fileName;
+    job.path = project_dir.absoluteFilePath(fileName);
+    runXmlFileJob(&job);
+    loadComponent(&job);
+}
 
-        // check for errors:
-        QSettings settings;
-        int num_errs = settings.beginReadArray("errors");
-        settings.endArray();
+void projectObject::loadComponent(xmlFileJob * job)
+{
+    QString fileName = job->fileName;
+    if (fileName == "none.xml") {
+        return;
+    }
 
-        // if there are errors then clean up and leave
-        if (num_errs != 0) {
-            delete tempALobject;
-            // write tail for errors:
-            addError("<b>IN COMPONENT FILE '" + fileName + "'</b>");
-            return;
-        }
+    // problems found while reading, building and validating, in file order
+    bool failed = job->issues.errorCount() > 0;
+    diagnostics::instance()->merge(&job->issues);
+    if (failed) {
+        return;
+    }
+
+    diagnosticContext context(job->path);
+
+    if (job->component) {
+
+        // HANDLE SPINEML COMPONENTS ////////////////
+
+        // built and validated by the job - take it over
+        NineMLComponent *tempALobject = job->component;
+        job->component = NULL;
+        context.setObject(tempALobject->name);
 
         // get lib to add component to
         vector < NineMLComponent * > * curr_lib;
@@ -815,6 +931,7 @@ void projectObject::loadComponent(QString fileName, QDir project_dir)
 
         // add to the correct catalog
         curr_lib->push_back(tempALobject);
+        recordFile(job->path, job->digest);
 
     } else {
         addError("Unknown XML tag found in required file '" + fileName + "'");
@@ -829,11 +946,7 @@ void projectObject::saveComponent(QString fileName, QDir project_dir, NineMLComp
     }
 
     QString fname = project_dir.absoluteFilePath(fileName);
-    QFile file(fname);
-    if (!file.open(QIODevice::WriteOnly)) {
-        addError("saveComponent: Error creating file for '" + fname + "' - is there sufficient disk space?");
-        return;
-    }
+    diagnosticContext context(fname, component->name);
 
     this->doc.setContent(QString(""));
 
@@ -841,17 +954,17 @@ void projectObject::saveComponent(QString fileName, QDir project_dir, NineMLComp
     component->write(&this->doc);
 
     // write out to file
-    QTextStream tsFromFile(&file );
+    QByteArray content;
+    QTextStream tsFromFile(&content, QIODevice::WriteOnly);
     tsFromFile << this->doc.toString();
     tsFromFile.flush();
 
-    // add to version control
-    if (this->version.isModelUnderVersion()) {
-        this->version.addToVersion(file.fileName());
+    if (!writeFileIfChanged(fname, content)) {
+        addError("saveComponent: Error creating file for '" + fname + "' - is there sufficient disk space?");
+        this->doc.clear();
+        return;
     }
 
-    file.close();
-
     // store path for easy access
     component->filePath = project_dir.absoluteFilePath(fileName);
 
@@ -861,51 +974,37 @@ void projectObject::saveComponent(QString fileName, QDir project_dir, NineMLComp
 
 void projectObject::loadLayout(QString fileName, QDir project_dir)
 {
-    if (fileName == "none.xml") {
-        return;
-    }
+    xmlFileJob job;
+    job.fileName = fileName;
+    job.path = project_dir.absoluteFilePath(fileName);
+    runXmlFileJob(&job);
+    loadLayout(&job);
+}
 
-    // try opening the file and loading the XML
-    QFile file(project_dir.absoluteFilePath(fileName));
-    if (!file.open(QIODevice::ReadOnly)) {
-        addError("Cannot open required file '" + fileName + "'");
-        return;
-    }
-    if (!this->doc.setContent(&file)) {
-        addError("Cannot read required file '" + fileName + "'");
+void projectObject::loadLayout(xmlFileJob * job)
+{
+    QString fileName = job->fileName;
+    if (fileName == "none.xml") {
         return;
     }
 
-    // confirm root tag is correct
-    QDomElement root = this->doc.documentElement();
-    if (root.tagName() != "SpineML" ) {
-        addError("Missing or incorrect root tag in required file '" + fileName + "'");
+    // problems found while reading, building and validating, in file order
+    bool failed = job->issues.errorCount() > 0;
+    diagnostics::instance()->merge(&job->issues);
+    if (failed) {
         return;
     }
 
-    // if a componentclass
-    QDomElement classType = root.firstChildElement();
+    diagnosticContext context(job->path);
 
-    if (classType.tagName() == "LayoutClass") {
+    if (job->layout) {
 
             // HANDLE LAYOUTS ////////////////////
 
-            // create a new AL class instance and populate it from the data
-            NineMLLayout *tempALobject = new NineMLLayout();
-
-            tempALobject->load(&this->doc);
-
-            // check for errors:
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
-
-            if (num_errs != 0) {
-                delete tempALobject;
-                // write tail for errors:
-                addError("<b>IN LAYOUT FILE '" + fileName + "'</b>");
-                return;
-            }
+            // built and validated by the job - take it over
+            NineMLLayout *tempALobject = job->layout;
+            job->layout = NULL;
+            context.setObject(tempALobject->name);
 
             for (unsigned int i = 0; i < this->catalogLAY.size(); ++i) {
                 if (this->catalogLAY[i]->name.compare(tempALobject->name) == 0 && tempALobject->name != "none") {
@@ -918,6 +1017,7 @@ void projectObject::loadLayout(QString fileName, QDir project_dir)
 
             // all good - add layout to catalog
             this->catalogLAY.push_back(tempALobject);
+            recordFile(job->path, job->digest);
 
         } else {
             addError("Unknown XML tag found in required file '" + fileName + "'");
@@ -932,11 +1032,7 @@ void projectObject::saveLayout(QString fileName, QDir project_dir, NineMLLayout
         fileName.append(".xml");
     }
 
-    QFile file(project_dir.absoluteFilePath(fileName));
-    if (!file.open(QIODevice::WriteOnly)) {
-        addError("Error creating file for '" + fileName + "' - is there sufficient disk space?");
-        return;
-    }
+    diagnosticContext context(project_dir.absoluteFilePath(fileName), layout->name);
 
     this->doc.setContent(QString(""));
 
@@ -944,17 +1040,17 @@ void projectObject::saveLayout(QString fileName, QDir project_dir, NineMLLayout
     layout->write(&this->doc);
 
     // write out to file
-    QTextStream tsFromFile(&file);
+    QByteArray content;
+    QTextStream tsFromFile(&content, QIODevice::WriteOnly);
     tsFromFile << this->doc.toString();
     tsFromFile.flush();
 
-    // add to version control
-    if (this->version.isModelUnderVersion()) {
-        this->version.addToVersion(file.fileName());
+    if (!writeFileIfChanged(project_dir.absoluteFilePath(fileName), content)) {
+        addError("Error creating file for '" + fileName + "' - is there sufficient disk space?");
+        this->doc.clear();
+        return;
     }
 
-    file.close();
-
     // store path for easy access
     layout->filePath = project_dir.absoluteFilePath(fileName);
 
@@ -965,14 +1061,29 @@ void projectObject::saveLayout(QString fileName, QDir project_dir, NineMLLayout
 
 void projectObject::loadNetwork(QString fileName, QDir project_dir, bool isProject)
 {
+    diagnosticContext context(project_dir.absoluteFilePath(fileName));
+
     // load up the file and check it is valid XML
     QFile file(project_dir.absoluteFilePath(fileName));
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         addError("Could not open the Network file for reading");
         return;
     }
-    if (!this->doc.setContent(&file)) {
-        addError("Could not parse the Network file XML - is the selected file correctly formed XML?");
+
+    // read in one pass - explicit connections are streamed to binary files instead of being kept in the document
+    removeStreamedConnections();
+    this->doc.clear();
+    QXmlStreamReader reader(&file);
+    reader.setNamespaceProcessing(false);
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isStartElement() && !readNetworkElement(reader, this->doc)) {
+            break;
+        }
+    }
+    if (reader.hasError() || this->doc.documentElement().isNull()) {
+        diagnostics::instance()->addError("Could not parse the Network file XML - is the selected file correctly formed XML?", fileName, reader.lineNumber());
+        removeStreamedConnections();
         return;
     }
 
@@ -1000,14 +1111,14 @@ void projectObject::loadNetwork(QString fileName, QDir project_dir, bool isProje
     if (!fileMeta.open(QIODevice::ReadOnly)) {
         // if is not a project we don't expect a metaData file
         if (isProject) {
-            addError("Could not open the MetaData file for reading");
+            diagnostics::instance()->addError("Could not open the MetaData file for reading", metaFilePath);
             return;
         } else {
             this->metaFile = "not found";
         }
     } else {
         if (!this->meta.setContent(&fileMeta)) {
-            addError("Could not parse the MetaData file XML - is the selected file correctly formed XML?");
+            diagnostics::instance()->addError("Could not parse the MetaData file XML - is the selected file correctly formed XML?", metaFilePath);
             return;
         }
         // we have loaded the XML file - discard the file handle
@@ -1016,7 +1127,7 @@ void projectObject::loadNetwork(QString fileName, QDir project_dir, bool isProje
         // confirm root tag is correct
         root = this->meta.documentElement();
         if (root.tagName() != "modelMetaData") {
-            addError("MetaData file is not valid");
+            diagnostics::instance()->addError("MetaData file is not valid", metaFilePath);
             return;
         }
     }
@@ -1027,6 +1138,8 @@ void projectObject::loadNetwork(QString fileName, QDir project_dir, bool isProje
 
         QDomElement e = n.toElement();
         if (e.tagName() == "LL:Population") {
+            diagnosticContext popContext("", e.firstChildElement("LL:Neuron").attribute("name"));
+
             // add population from population xml:
             this->network.push_back(new population(e, &this->doc, &this->meta, this));
 
@@ -1034,14 +1147,13 @@ void projectObject::loadNetwork(QString fileName, QDir project_dir, bool isProje
             for (uint i = 0; i < this->network.size() - 1; ++i) {
                 if (this->network[i]->name == this->network.back()->name) {
                     this->network[i]->name = getUniquePopName(this->network[i]->name);
+                    objectRegistry::invalidate();
                     addWarning("Duplicate Population name found: renamed existing Population to '" + this->network[i]->name + "'");
                 }
             }
 
             // check for errors:
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
+            int num_errs = diagnostics::instance()->errorCount();
 
             if (num_errs != 0) {
                 // no dice - give up!
@@ -1060,12 +1172,11 @@ void projectObject::loadNetwork(QString fileName, QDir project_dir, bool isProje
         QDomElement e = n.toElement();
         if (e.tagName() == "LL:Population" ) {
             // with all the populations added, add the projections and join them up:
+            diagnosticContext popContext("", this->network[counter]->getName());
             this->network[counter]->load_projections_from_xml(e, &this->doc, &this->meta, this);
 
             // check for errors:
-            QSettings settings;
-            int num_errs = settings.beginReadArray("errors");
-            settings.endArray();
+            int num_errs = diagnostics::instance()->errorCount();
 
             if (num_errs != 0) {
                 // no dice - give up!
@@ -1085,13 +1196,14 @@ void projectObject::loadNetwork(QString fileName, QDir project_dir, bool isProje
         QDomElement e = n.toElement();
         if (e.tagName() == "LL:Population" ) {
             // add inputs
+            diagnosticContext popContext("", this->network[counter]->getName());
             this->network[counter]->read_inputs_from_xml(e, &this->meta, this);
 
+            // projections are children of the population
             int projCount = 0;
-            QDomNodeList n2 = n.toElement().elementsByTagName("LL:Projection");
-            for (uint i = 0; i < (uint) n2.size(); ++i) {
-                QDomElement e = n2.item(i).toElement();
-                this->network[counter]->projections[projCount]->read_inputs_from_xml(e, &this->meta, this);
+            for (QDomElement e2 = e.firstChildElement("LL:Projection"); !e2.isNull(); e2 = e2.nextSiblingElement("LL:Projection")) {
+                diagnosticContext projContext("", this->network[counter]->projections[projCount]->getName());
+                this->network[counter]->projections[projCount]->read_inputs_from_xml(e2, &this->meta, this);
                 ++projCount;
             }
             ++counter;
@@ -1101,23 +1213,124 @@ void projectObject::loadNetwork(QString fileName, QDir project_dir, bool isProje
 
     this->meta.clear();
     this->doc.clear();
+    removeStreamedConnections();
 }
 
-void projectObject::saveNetwork(QString fileName, QDir projectDir)
+bool projectObject::readNetworkElement(QXmlStreamReader &reader, QDomNode parent)
 {
-    QFile fileModel(projectDir.absoluteFilePath(fileName));
-    if (!fileModel.open(QIODevice::WriteOnly)) {
-        addError("Error creating Network file - is there sufficient disk space?");
-        return;
+    // the reader is at a start element - copy it and its contents into the document
+    QDomElement element = this->doc.createElement(reader.qualifiedName().toString());
+    QXmlStreamAttributes attributes = reader.attributes();
+    for (int i = 0; i < attributes.size(); ++i) {
+        element.setAttribute(attributes[i].qualifiedName().toString(), attributes[i].value().toString());
+    }
+    parent.appendChild(element);
+
+    // explicit connections can be millions of elements, so go straight into the binary store
+    bool isConnectionList = element.tagName() == "ConnectionList";
+    QTemporaryFile connectionFile;
+    QDataStream access;
+    uint numConnections = 0;
+    bool explicitDelay = false;
+    bool delayMismatch = false;
+
+    while (!reader.atEnd()) {
+        reader.readNext();
+
+        if (reader.isEndElement()) {
+            break;
+        }
+
+        if (reader.isStartElement()) {
+            if (isConnectionList && reader.qualifiedName() == "Connection") {
+                QXmlStreamAttributes connAttributes = reader.attributes();
+                if (numConnections == 0) {
+                    // next to the connection stores, so it can be moved into one rather than copied
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+                    QDir lib_dir = QDir(QDesktopServices::storageLocation(QDesktopServices::DataLocation));
+#else
+                    QDir lib_dir = QDir(QStandardPaths::writableLocation(QStandardPaths::DataLocation));
+#endif
+                    if (!lib_dir.exists()) {
+                        lib_dir.mkpath(lib_dir.absolutePath());
+                    }
+                    connectionFile.setFileTemplate(lib_dir.absoluteFilePath("streamedXXXXXX"));
+                    connectionFile.setAutoRemove(false);
+                    if (!connectionFile.open()) {
+                        addError("Could not create a file for the connections in the Network file - is there sufficient disk space?");
+                        return false;
+                    }
+                    streamedConnectionFiles.push_back(connectionFile.fileName());
+                    access.setDevice(&connectionFile);
+                    explicitDelay = connAttributes.hasAttribute("delay");
+                }
+
+                // every row must have the same layout, so the delays must be given for all connections or none
+                if (connAttributes.hasAttribute("delay") != explicitDelay && !delayMismatch) {
+                    delayMismatch = true;
+                    addError("Connection " + QString::number(numConnections) + " in a ConnectionList in the Network file " +
+                             QString(explicitDelay ? "has no delay" : "has a delay") + " but the first connection " +
+                             QString(explicitDelay ? "has one" : "does not") + " - " +
+                             QString(explicitDelay ? "missing delays are set to 0" : "the delays are ignored"));
+                }
+
+                // the same layout as the connections imported from XML
+                quint32 val = connAttributes.value("src_neuron").toString().toUInt();
+                access << val;
+                val = connAttributes.value("dst_neuron").toString().toUInt();
+                access << val;
+                if (explicitDelay) {
+                    float val_f = connAttributes.value("delay").toString().toFloat();
+                    access << val_f;
+                }
+                ++numConnections;
+
+                reader.skipCurrentElement();
+            } else if (!readNetworkElement(reader, element)) {
+                return false;
+            }
+        } else if (reader.isCharacters() && !reader.isWhitespace()) {
+            if (reader.isCDATA()) {
+                element.appendChild(this->doc.createCDATASection(reader.text().toString()));
+            } else {
+                element.appendChild(this->doc.createTextNode(reader.text().toString()));
+            }
+        }
+    }
+
+    // the connection list now points at the streamed file, as a saved binary file would
+    if (numConnections > 0) {
+        connectionFile.close();
+        QDomElement binary = this->doc.createElement("BinaryFile");
+        binary.setAttribute("file_name", connectionFile.fileName());
+        binary.setAttribute("num_connections", QString::number(numConnections));
+        binary.setAttribute("explicit_delay_flag", QString::number(explicitDelay ? 1 : 0));
+        binary.setAttribute("streamed", "true");
+        element.appendChild(binary);
+    }
+
+    return !reader.hasError();
+}
+
+void projectObject::removeStreamedConnections()
+{
+    // streamed files are moved into place when the connections are loaded - remove any that were not
+    for (int i = 0; i < streamedConnectionFiles.size(); ++i) {
+        QFile::remove(streamedConnectionFiles[i]);
     }
+    streamedConnectionFiles.clear();
+}
+
+bool projectObject::saveNetwork(QString fileName, QDir projectDir)
+{
+    diagnosticContext context(projectDir.absoluteFilePath(fileName));
 
     // use stream writing for model UL file
-    QXmlStreamWriter xmlOut;
+    QByteArray content;
+    QXmlStreamWriter xmlOut(&content);
 
     xmlOut.setAutoFormatting(true);
 
-    xmlOut.setDevice(&(fileModel));
-
     // create the root of the file:
     xmlOut.writeStartDocument();
     xmlOut.writeStartElement("LL:SpineML");
@@ -1130,25 +1343,48 @@ void projectObject::saveNetwork(QString fileName, QDir projectDir)
     // create a node for each population with the variables set
     for (unsigned int pop = 0; pop < this->network.size(); ++pop) {
         //// WE NEED TO HAVE A PROPER MODEL NAME!
+        diagnosticContext popContext("", this->network[pop]->getName());
         this->network[pop]->write_population_xml(xmlOut);
     }
 
     xmlOut.writeEndDocument();
 
-    // add to version control
-    if (this->version.isModelUnderVersion()) {
-        this->version.addToVersion(fileModel.fileName());
+    if (!writeFileIfChanged(projectDir.absoluteFilePath(fileName), content)) {
+        addError("Error creating Network file - is there sufficient disk space?");
+        return false;
+    }
+
+    // note the binary connection files the network refers to
+    this->networkBinaryFiles.clear();
+    QXmlStreamReader reader(content);
+    while (!reader.atEnd()) {
+        if (reader.readNext() == QXmlStreamReader::StartElement && reader.name() == "BinaryFile") {
+            this->networkBinaryFiles.push_back(reader.attributes().value("file_name").toString());
+        }
     }
+
+    return true;
 }
 
-void projectObject::saveMetaData(QString fileName, QDir projectDir)
+void projectObject::removeUnusedBinaries(QDir projectDir)
 {
-    QFile fileMeta(projectDir.absoluteFilePath(fileName));
-    if (!fileMeta.open(QIODevice::WriteOnly)) {
-        addError("Error creating MetaData file - is there sufficient disk space?");
-        return;
+    projectDir.setNameFilters(QStringList() << "*.bin");
+    QStringList files = projectDir.entryList(QDir::Files);
+    for (int i = 0; i < files.size(); ++i) {
+        if (this->networkBinaryFiles.contains(files[i])) {
+            continue;
+        }
+        // delete
+        projectDir.remove(files[i]);
+        // and remove from version control
+        if (this->version.isModelUnderVersion()) {
+            this->version.removeFromVersion(files[i]);
+        }
     }
+}
 
+void projectObject::saveMetaData(QString fileName, QDir projectDir)
+{
     this->meta.setContent(QString(""));
 
     // create the root of the file:
@@ -1160,17 +1396,20 @@ void projectObject::saveMetaData(QString fileName, QDir projectDir)
         this->network[i]->write_model_meta_xml(this->meta, root);
     }
 
-    QTextStream tsFromFileMeta(&fileMeta);
+    QByteArray content;
+    QTextStream tsFromFileMeta(&content, QIODevice::WriteOnly);
     tsFromFileMeta << this->meta.toString();
+    tsFromFileMeta.flush();
 
-    // add to version control
-    if (this->version.isModelUnderVersion()) {
-        this->version.addToVersion(fileMeta.fileName());
+    if (!writeFileIfChanged(projectDir.absoluteFilePath(fileName), content)) {
+        addError("Error creating MetaData file - is there sufficient disk space?");
     }
 }
 
 void projectObject::loadExperiment(QString fileName, QDir project_dir, bool skipFileError)
 {
+    diagnosticContext context(project_dir.absoluteFilePath(fileName));
+
     QFile file(project_dir.absoluteFilePath(fileName));
     if (!file.open(QIODevice::ReadOnly)) {
         if (!skipFileError) {
@@ -1193,6 +1432,7 @@ void projectObject::loadExperiment(QString fileName, QDir project_dir, bool skip
         }
         return;
     }
+    context.setObject(reader->attributes().value("name").toString());
 
     // reset
     delete reader;
@@ -1208,9 +1448,7 @@ void projectObject::loadExperiment(QString fileName, QDir project_dir, bool skip
     newExperiment->readXML(reader, this);
 
     // check for errors:
-    QSettings settings;
-    int num_errs = settings.beginReadArray("errors");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->errorCount();
 
     if (num_errs == 0) {
         this->experimentList.push_back(newExperiment);
@@ -1228,32 +1466,120 @@ void projectObject::loadExperiment(QString fileName, QDir project_dir, bool skip
 
 void projectObject::saveExperiment(QString fileName, QDir project_dir, experiment * expt)
 {
-    QFile file (project_dir.absoluteFilePath(fileName));
-    if (!file.open(QIODevice::WriteOnly)) {
-        addError("Error creating file - is there sufficient disk space?");
-        return;
-    }
+    diagnosticContext context(project_dir.absoluteFilePath(fileName), expt->name);
 
     // use stream writer
-    QXmlStreamWriter * xmlOutExpt = new QXmlStreamWriter;
-    xmlOutExpt->setDevice(&(file));
+    QByteArray content;
+    QXmlStreamWriter * xmlOutExpt = new QXmlStreamWriter(&content);
 
     expt->writeXML(xmlOutExpt, this);
 
     delete xmlOutExpt;
 
-    file.close();
+    if (!writeFileIfChanged(project_dir.absoluteFilePath(fileName), content)) {
+        addError("Error creating file - is there sufficient disk space?");
+    }
+}
+
+void projectObject::recordFile(QString fileName, const QByteArray &digest)
+{
+    QFileInfo info(fileName);
+
+    savedFile saved;
+    saved.digest = digest;
+    saved.size = info.size();
+    saved.modified = info.lastModified();
+    this->fileDigests[fileName] = saved;
+}
+
+bool projectObject::writeFileIfChanged(QString fileName, const QByteArray &content)
+{
+    if (this->exporting) {
+        this->writtenFiles.push_back(fileName);
+    }
+
+    // leave the file alone if it already holds this content, unless something else has touched it since
+    QByteArray digest = QCryptographicHash::hash(content, QCryptographicHash::Md5);
+    if (this->fileDigests.contains(fileName)) {
+        savedFile saved = this->fileDigests.value(fileName);
+        QFileInfo info(fileName);
+        if (saved.digest == digest && info.exists() && info.size() == saved.size && info.lastModified() == saved.modified) {
+            return true;
+        }
+    }
+
+    bool written;
+    if (!updateFile(fileName, content, &written)) {
+        this->fileDigests.remove(fileName);
+        return false;
+    }
+    recordFile(fileName, digest);
 
     // add to version control
-    if (this->version.isModelUnderVersion()) {
+    if (written && this->version.isModelUnderVersion()) {
         this->version.addToVersion(fileName);
     }
+
+    return true;
+}
+
+bool projectObject::updateFile(QString fileName, const QByteArray &content, bool * written)
+{
+    if (written != NULL) {
+        *written = false;
+    }
+
+    // a file from an earlier session may already hold this content
+    QFile existing(fileName);
+    if (existing.size() == content.size() && existing.open(QIODevice::ReadOnly)) {
+        bool same = (existing.readAll() == content);
+        existing.close();
+        if (same) {
+            return true;
+        }
+    }
+
+    // write alongside and then move into place, so a failed write never leaves a partial file
+    QString tempName = fileName + ".tmp";
+    QFile file(tempName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    if (file.write(content) != content.size() || !file.flush()) {
+        file.close();
+        file.remove();
+        return false;
+    }
+    file.close();
+
+    if (!replaceFile(tempName, fileName)) {
+        QFile::remove(tempName);
+        return false;
+    }
+
+    if (written != NULL) {
+        *written = true;
+    }
+    return true;
+}
+
+bool projectObject::replaceFile(QString tempName, QString fileName)
+{
+#ifdef Q_OS_WIN
+    // rename will not overwrite an existing file on windows
+    QFile::remove(fileName);
+    return QFile::rename(tempName, fileName);
+#else
+    // rename replaces the old file in one step
+    return ::rename(QFile::encodeName(tempName).constData(), QFile::encodeName(fileName).constData()) == 0;
+#endif
 }
 
 void projectObject::copy_back_data(rootData * data)
 {
     // copy data from rootData to project
     this->network = data->populations;
+    objectRegistry::invalidate();
     this->catalogNB = data->catalogNrn;
     this->catalogWU = data->catalogWU;
     this->catalogPS = data->catalogPS;
@@ -1266,6 +1592,8 @@ void projectObject::copy_out_data(rootData * data)
 {
     // copy from project to rootData
     data->populations = this->network;
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
     data->catalogNrn = this->catalogNB;
     data->catalogWU = this->catalogWU;
     data->catalogPS = this->catalogPS;
@@ -1335,33 +1663,32 @@ void projectObject::printIssues(QString title)
 
 bool projectObject::printWarnings(QString title)
 {
+    // warnings collected in a scope are left for its owner to report, and do not stop it
+    if (diagnostics::isScoped()) {
+        return false;
+    }
+
     QString warns;
 
-    // collate warnings:
-    QSettings settings;
-    int num_warn = settings.beginReadArray("warnings");
-    settings.endArray();
+    // collate warnings, clearing them:
+    QList < diagnostic > found = diagnostics::instance()->takeWarnings();
 
-    if (num_warn != 0) {
+    if (found.size() != 0) {
 
-        // list errors
-        settings.beginReadArray("warnings");
-        for (int j = 1; j < num_warn; ++j) {
-            settings.setArrayIndex(j);
-            warns = warns + settings.value("warnText", "").toString();
+        // list warnings
+        for (int j = 0; j < found.size(); ++j) {
+            warns = warns + found[j].toString();
             warns = warns + "<br/>";
         }
-        settings.endArray();
-
-        // clear warnings
-        settings.remove("warnings");
 
     } else {
         return false;
     }
 
     // display warnings:
-    if (!warns.isEmpty()) {
+    if (headless) {
+        cerr << title.toStdString() << endl << warns.replace("<br/>", "\n").remove(QRegExp("<[^>]*>")).toStdString();
+    } else if (!warns.isEmpty()) {
         // display warnings
         QMessageBox msgBox;
         msgBox.setText("<P><b>" + title + "</b></P>" + warns);
@@ -1375,33 +1702,32 @@ bool projectObject::printWarnings(QString title)
 
 bool projectObject::printErrors(QString title)
 {
+    // errors collected in a scope are left for its owner to report
+    if (diagnostics::isScoped()) {
+        return diagnostics::instance()->errorCount() > 0;
+    }
+
     QString errors;
 
-    // collate errors:
-    QSettings settings;
-    int num_errs = settings.beginReadArray("errors");
-    settings.endArray();
+    // collate errors, clearing them:
+    QList < diagnostic > found = diagnostics::instance()->takeErrors();
 
-    if (num_errs != 0) {
+    if (found.size() != 0) {
 
         // list errors
-        settings.beginReadArray("errors");
-        for (int j = 1; j < num_errs; ++j) {
-            settings.setArrayIndex(j);
-            errors = errors + settings.value("errorText", "").toString();
+        for (int j = 0; j < found.size(); ++j) {
+            errors = errors + found[j].toString();
             errors = errors + "<br/>";
         }
-        settings.endArray();
-
-        // clear errors
-        settings.remove("errors");
 
     } else {
         return false;
     }
 
     // display errors:
-    if (!errors.isEmpty()) {
+    if (headless) {
+        cerr << title.toStdString() << endl << errors.replace("<br/>", "\n").remove(QRegExp("<[^>]*>")).toStdString();
+    } else if (!errors.isEmpty()) {
         // display errors
         QMessageBox msgBox;
         msgBox.setText("<P><b>" + title + "</b></P>" + errors);
@@ -1413,26 +1739,26 @@ bool projectObject::printErrors(QString title)
     return true;
 }
 
+void projectObject::reportError(QString text, QString object)
+{
+    if (headless || diagnostics::isScoped()) {
+        diagnostics::instance()->addError(text, "", -1, object);
+        return;
+    }
+
+    QMessageBox msgBox;
+    msgBox.setText(object.isEmpty() ? text : "<P><b>" + object + "</b></P>" + text);
+    msgBox.exec();
+}
+
 void projectObject::addError(QString text)
 {
-    QSettings settings;
-    int num_errs = settings.beginReadArray("errors");
-    settings.endArray();
-    settings.beginWriteArray("errors");
-    settings.setArrayIndex(num_errs + 1);
-    settings.setValue("errorText",  text);
-    settings.endArray();
+    diagnostics::instance()->addError(text);
 }
 
 void projectObject::addWarning(QString text) 
 {
-    QSettings settings;
-    int num_errs = settings.beginReadArray("warnings");
-    settings.endArray();
-    settings.beginWriteArray("warnings");
-    settings.setArrayIndex(num_errs + 1);
-    settings.setValue("warnText",  text);
-    settings.endArray();
+    diagnostics::instance()->addWarning(text);
 }
 
 bool projectObject::isChanged(rootData * data)
@@ -1465,79 +1791,23 @@ bool projectObject::isChanged(rootData * data)
 // allow safe usage of systemObject pointers
 bool projectObject::isValidPointer(systemObject * ptr)
 {
-    // find the pop / projection / input reference
-    for (uint i = 0; i < this->network.size(); ++i) {
-
-        if (this->network[i] == ptr) {
-            return true;
-        }
-
-        for (uint j = 0; j < this->network[i]->neuronType->inputs.size(); ++j) {
-            if (this->network[i]->neuronType->inputs[j] == ptr) {
-                return true;
-            }
-        }
-
-        for (uint j = 0; j < this->network[i]->projections.size(); ++j) {
-
-            if (this->network[i]->projections[j] == ptr) {
-                return true;
-            }
-
-            for (uint k = 0; k < this->network[i]->projections[j]->synapses.size(); ++k) {
-
-                if (this->network[i]->projections[j]->synapses[k] == ptr) {
-                    return true;
-                }
-
-                for (uint l = 0; l < this->network[i]->projections[j]->synapses[k]->weightUpdateType->inputs.size(); ++l) {
-
-                    if (this->network[i]->projections[j]->synapses[k]->weightUpdateType->inputs[l] == ptr) {
-                        return true;
-                    }
-                }
-
-                for (uint l = 0; l < this->network[i]->projections[j]->synapses[k]->postsynapseType->inputs.size(); ++l) {
-
-                    if (this->network[i]->projections[j]->synapses[k]->postsynapseType->inputs[l] == ptr) {
-                        return true;
-                    }
-                }
-            }
-        }
+    // the registry is only rebuilt after the network has changed
+    if (!this->networkRegistry.isValid()) {
+        this->networkRegistry.rebuild(this->network);
     }
 
-    // not found
-    return false;
+    return this->networkRegistry.contains(ptr);
 }
 
 // allow safe usage of NineMLComponentData pointers
 bool projectObject::isValidPointer(NineMLComponentData * ptr)
 {
-    // find the reference
-    for (uint i = 0; i < this->network.size(); ++i) {
-
-        if (this->network[i]->neuronType == ptr) {
-            return true;
-        }
-
-        for (uint j = 0; j < this->network[i]->projections.size(); ++j) {
-
-            for (uint k = 0; k < this->network[i]->projections[j]->synapses.size(); ++k) {
-
-                if (this->network[i]->projections[j]->synapses[k]->weightUpdateType == ptr) {
-                    return true;
-                }
-
-                if (this->network[i]->projections[j]->synapses[k]->postsynapseType == ptr) {
-                        return true;
-                }
-            }
-        }
+    // the registry is only rebuilt after the network has changed
+    if (!this->networkRegistry.isValid()) {
+        this->networkRegistry.rebuild(this->network);
     }
 
-    // not found
-    return false;
+    return this->networkRegistry.contains(ptr);
 }
 
 // allow safe usage of NineMLComponent pointers
@@ -1570,7 +1840,17 @@ bool projectObject::isValidPointer(NineMLComponent * ptr)
 
 NineMLComponentData * projectObject::getComponentDataFromName(QString name)
 {
-    // find the ComponentData requested
+    if (!this->networkRegistry.isValid()) {
+        this->networkRegistry.rebuild(this->network);
+    }
+
+    // names can change without the network changing, so check the name still matches
+    NineMLComponentData * found = this->networkRegistry.componentDataNamed(name);
+    if (found && found->getXMLName() == name) {
+        return found;
+    }
+
+    // not registered under that name - find the ComponentData requested
     for (uint i = 0; i < this->network.size(); ++i) {
         if (this->network[i]->neuronType->getXMLName() == name) {
             // found - return the ComponentData
@@ -4,6 +4,36 @@
 #include <QObject>
 #include "globalHeader.h"
 #include "versioncontrol.h"
+#include "diagnostics.h"
+#include "objectregistry.h"
+#include <QtConcurrentRun>
+#include <QFuture>
+
+class mathsOptimiser;
+
+struct xmlFileJob {
+
+    // a component or layout file, parsed, built and validated on the thread pool
+    xmlFileJob() : component(NULL), layout(NULL) {}
+    ~xmlFileJob();
+    QString fileName;
+    QString path;
+    QDomDocument doc;
+    QByteArray digest;
+    diagnostics issues;
+    NineMLComponent * component;
+    NineMLLayout * layout;
+
+};
+
+struct savedFile {
+
+    // a project file as last read or written, to tell if it needs writing again
+    QByteArray digest;
+    qint64 size;
+    QDateTime modified;
+
+};
 
 class projectObject : public QObject
 {
@@ -30,6 +60,14 @@ public:
     bool load_project_file(QString fileName);
     bool save_project_file(QString fileName);
 
+    // report issues on stderr rather than in message boxes, and never wait on a dialog
+    static bool headless;
+    // show a message box, or collect the error when there is nobody to dismiss one
+    static void reportError(QString text, QString object = "");
+
+    static bool replaceFile(QString, QString);
+    static bool updateFile(QString, const QByteArray &, bool * written = NULL);
+
     void copy_back_data(rootData *);
     void copy_out_data(rootData *);
     void deselect_project(rootData *);
@@ -85,15 +123,27 @@ private:
     // load helpers
     bool isComponent(QString);
     bool isLayout(QString);
+    QList < QFuture < xmlFileJob * > > startXmlFileJobs(QStringList, QDir);
     void loadComponent(QString, QDir);
+    void loadComponent(xmlFileJob *);
     void saveComponent(QString, QDir, NineMLComponent *);
     void loadLayout(QString, QDir);
+    void loadLayout(xmlFileJob *);
     void saveLayout(QString, QDir, NineMLLayout *);
     void loadNetwork(QString, QDir, bool isProject = true);
-    void saveNetwork(QString, QDir);
+    bool readNetworkElement(QXmlStreamReader &, QDomNode);
+    void removeStreamedConnections();
+    bool saveNetwork(QString, QDir);
+    void removeUnusedBinaries(QDir);
     void saveMetaData(QString, QDir);
     void loadExperiment(QString, QDir, bool skipFileError = false);
     void saveExperiment(QString, QDir, experiment *);
+    bool writeFileIfChanged(QString, const QByteArray &);
+    void recordFile(QString, const QByteArray &);
+
+    // export helpers
+    void exportComponent(QString, QDir, NineMLComponent *, experiment *, mathsOptimiser *);
+    QMap <QString, double> getFixedParameters(NineMLComponent *, experiment *);
 
     // error handling
     bool printWarnings(QString);
@@ -106,6 +156,17 @@ private:
 
     QDomDocument doc;
     QDomDocument meta;
+    // binary files written for explicit connections while the network is read
+    QStringList streamedConnectionFiles;
+    // the files as last read or written, so unchanged files are not rewritten on save
+    QHash <QString, savedFile> fileDigests;
+    // binary connection files named in the last network written
+    QStringList networkBinaryFiles;
+    // every file written or left unchanged by the export that is running
+    QStringList writtenFiles;
+    bool exporting;
+    // objects in the network, for pointer checks and lookups by name
+    objectRegistry networkRegistry;
 
 
 signals:
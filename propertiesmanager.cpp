@@ -26,6 +26,7 @@
 #include "propertiesmanager.h"
 #include "nineml_graphicsitems.h"
 #include "nineml_rootcomponentitem.h"
+#include "diagnostics.h"
 
 bool FilterObject::eventFilter(QObject *, QEvent *event)
 {
@@ -279,9 +280,7 @@ void PropertiesManager::createTimeDerivativeProperties(TimeDerivativeTextItem *t
     td->time_derivative->maths->validateMathInLine(root->al, &errs);
 
     // sort out errors
-    QSettings settings;
-    int num_errs = settings.beginReadArray("warnings");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->warningCount();
 
     if (num_errs != 0) {
 
@@ -291,7 +290,7 @@ void PropertiesManager::createTimeDerivativeProperties(TimeDerivativeTextItem *t
         maths->setPalette(p);
 
         // clear errors
-        settings.remove("warnings");
+        diagnostics::instance()->clearWarnings();
 
     }
     if (num_errs == 0) {
@@ -302,7 +301,7 @@ void PropertiesManager::createTimeDerivativeProperties(TimeDerivativeTextItem *t
         maths->setPalette(p);
 
         // clear errors
-        settings.remove("warnings");
+        diagnostics::instance()->clearWarnings();
     }
 }
 
@@ -399,9 +398,7 @@ void PropertiesManager::createAliasProperties(AliasTextItem *ati)
     ati->getMaths()->validateMathInLine(root->al, &errs);
 
     // sort out errors
-    QSettings settings;
-    int num_errs = settings.beginReadArray("warnings");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->warningCount();
 
     if (num_errs != 0) {
 
@@ -411,7 +408,7 @@ void PropertiesManager::createAliasProperties(AliasTextItem *ati)
         maths->setPalette(p);
 
         // clear errors
-        settings.remove("warnings");
+        diagnostics::instance()->clearWarnings();
 
     }
     if (num_errs == 0) {
@@ -422,7 +419,7 @@ void PropertiesManager::createAliasProperties(AliasTextItem *ati)
         maths->setPalette(p);
 
         // clear errors
-        settings.remove("warnings");
+        diagnostics::instance()->clearWarnings();
     }
 }
 
@@ -455,9 +452,7 @@ void PropertiesManager::createOnConditionProperties(OnConditionGraphicsItem *oci
     oci->getTriggerMaths()->validateMathInLine(root->al, &errs);
 
     // sort out errors
-    QSettings settings;
-    int num_errs = settings.beginReadArray("warnings");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->warningCount();
 
     if (num_errs != 0) {
 
@@ -467,7 +462,7 @@ void PropertiesManager::createOnConditionProperties(OnConditionGraphicsItem *oci
         maths->setPalette(p);
 
         // clear errors
-        settings.remove("warnings");
+        diagnostics::instance()->clearWarnings();
 
     }
     if (num_errs == 0) {
@@ -478,7 +473,7 @@ void PropertiesManager::createOnConditionProperties(OnConditionGraphicsItem *oci
         maths->setPalette(p);
 
         // clear errors
-        settings.remove("warnings");
+        diagnostics::instance()->clearWarnings();
     }
 
     //edit Synapse regime??
@@ -589,9 +584,7 @@ void PropertiesManager::createStateAssignmentProperties(StateAssignmentTextItem
     sa->getMaths()->validateMathInLine(root->al, &errs);
 
     // sort out errors
-    QSettings settings;
-    int num_errs = settings.beginReadArray("warnings");
-    settings.endArray();
+    int num_errs = diagnostics::instance()->warningCount();
 
     if (num_errs != 0) {
 
@@ -601,7 +594,7 @@ void PropertiesManager::createStateAssignmentProperties(StateAssignmentTextItem
         maths->setPalette(p);
 
         // clear errors
-        settings.remove("warnings");
+        diagnostics::instance()->clearWarnings();
 
     }
     if (num_errs == 0) {
@@ -612,7 +605,7 @@ void PropertiesManager::createStateAssignmentProperties(StateAssignmentTextItem
         maths->setPalette(p);
 
         // clear errors
-        settings.remove("warnings");
+        diagnostics::instance()->clearWarnings();
     }
 }
 
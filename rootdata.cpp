@@ -31,6 +31,7 @@
 #include "projectobject.h"
 #include "systemmodel.h"
 #include "nineml_rootcomponentitem.h"
+#include <algorithm>
 
 /*
  Alex Cope 2012
@@ -310,6 +311,96 @@ void rootData::saveImage(QString fileName)
     }
 }
 
+QImage rootData::renderNetworkImage(const vector <systemObject *> &list, float scale, float border, bool transparent) {
+
+    QRectF bounds = QRectF(100000,100000,-200000,-200000);
+
+    // work out bounding box
+    for (uint p = 0; p < list.size(); ++p) {
+
+        if (list[p]->type == populationObject) {
+            population * pop = (population * ) list[p];
+            if (-pop->bottomBound(pop->targy)> bounds.bottom())
+                bounds.setBottom(-pop->bottomBound(pop->targy));
+            if (-pop->topBound(pop->targy)< bounds.top())
+                bounds.setTop(-pop->topBound(pop->targy));
+            if (pop->leftBound(pop->targx)< bounds.left())
+                bounds.setLeft(pop->leftBound(pop->targx));
+            if (pop->rightBound(pop->targx)> bounds.right())
+                bounds.setRight(pop->rightBound(pop->targx));
+        }
+
+
+        if (list[p]->type == projectionObject) {
+
+            projection * proj = (projection * ) list[p];
+            for (uint c = 0; c < proj->curves.size(); ++c) {
+                bezierCurve * bz = &proj->curves[c];
+                if (-bz->C1.y() > bounds.bottom())
+                    bounds.setBottom(-bz->C1.y());
+                if (-bz->C1.y() < bounds.top())
+                    bounds.setTop(-bz->C1.y());
+                if (bz->C1.x() < bounds.left())
+                    bounds.setLeft(bz->C1.x());
+                if (bz->C1.x() > bounds.right())
+                    bounds.setRight(bz->C1.x());
+
+                if (-bz->C2.y() > bounds.bottom())
+                    bounds.setBottom(-bz->C2.y());
+                if (-bz->C2.y() < bounds.top())
+                    bounds.setTop(-bz->C2.y());
+                if (bz->C2.x() < bounds.left())
+                    bounds.setLeft(bz->C2.x());
+                if (bz->C2.x() > bounds.right())
+                    bounds.setRight(bz->C2.x());
+            }
+
+        }
+
+    }
+
+    bounds.setTopLeft(bounds.topLeft() - QPointF(border,border));
+    bounds.setBottomRight(bounds.bottomRight() + QPointF(border,border));
+
+    // an image rather than a pixmap, so this works without a display
+    QImage outImage(bounds.width()*100*scale, bounds.height()*100*scale, QImage::Format_ARGB32_Premultiplied);
+
+    if (transparent) {
+        outImage.fill(Qt::transparent);
+    } else {
+        outImage.fill(Qt::white);
+    }
+
+    QPainter *painter = new QPainter(&outImage);
+
+    painter->setRenderHint(QPainter::HighQualityAntialiasing, true);
+    painter->setRenderHint(QPainter::Antialiasing,true);
+    painter->setRenderHint( QPainter::TextAntialiasing,true);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform,true);
+
+    // setup the painter
+    QFont font("Monospace", 5.0f);
+    font.setStyleHint(QFont::TypeWriter);
+    painter->setFont(font);
+
+
+
+    // Just render selection:
+    for (unsigned int i = 0; i < list.size(); ++i) {
+
+            list[i]->draw(painter, 200.0*scale, -bounds.center().x(), -bounds.center().y(), bounds.width()*100*scale, bounds.height()*100*scale, this->popImage, microcircuitDrawStyle);
+
+    }
+
+    //QImage outIm = outImage->toImage();
+    //outIm.save("/home/alex/test_image.png","png");
+
+    painter->end();
+
+    delete painter;
+    return outImage;
+}
+
 void rootData::reDrawAll()
 {
     // update panel - we don't always want to do this as it loses focus from widgets
@@ -350,18 +441,68 @@ void rootData::reDrawAll(QPainter *painter, float GLscale, float viewX, float vi
         }
     }
 
-    // populations
-    for (unsigned int i = 0; i < this->populations.size(); ++i) {
-        this->populations[i]->draw(painter, GLscale, viewX, viewY, width, height, this->popImage, style);
+    // only draw what is on screen - or in the area being repainted if the painter is clipped
+    QRectF visible(0, 0, width, height);
+    if (painter->hasClipping()) {
+        visible = visible.intersected(painter->clipBoundingRect());
     }
-    for (unsigned int i = 0; i < this->populations.size(); ++i) {
-        this->populations[i]->drawSynapses(painter, GLscale, viewX, viewY, width, height, style);
+    // leave room for outlines and end markers, and for spike sources which are drawn larger than their bounds
+    float margin = 40.0/GLscale + 0.5;
+    QRectF visibleGL(QPointF((2.0*visible.left()-width)/GLscale-viewX-margin, viewY-(2.0*visible.bottom()-height)/GLscale-margin), \
+                     QPointF((2.0*visible.right()-width)/GLscale-viewX+margin, viewY-(2.0*visible.top()-height)/GLscale+margin));
+
+    this->updateSpatialIndex();
+    vector <spatialIndex::entry *> onScreen = this->canvasIndex.query(visibleGL);
+
+    // query returns the objects in model order, so split them up keeping that order
+    vector <population *> visiblePops;
+    vector <projection *> visibleProjections;
+    vector <genericInput *> visibleInputs;
+    for (uint i = 0; i < onScreen.size(); ++i) {
+        switch (onScreen[i]->obj->type) {
+        case populationObject:
+            visiblePops.push_back((population *) onScreen[i]->obj);
+            break;
+        case projectionObject:
+            visibleProjections.push_back((projection *) onScreen[i]->obj);
+            break;
+        case inputObject:
+            visibleInputs.push_back((genericInput *) onScreen[i]->obj);
+            break;
+        default:
+            break;
+        }
     }
-    for (unsigned int i = 0; i < this->populations.size(); ++i) {
-        QPen pen(QColor(100,0,0,100));
-        pen.setWidthF(float(1));
-        painter->setPen(pen);
-        this->populations[i]->drawInputs(painter, GLscale, viewX, viewY, width, height, style);
+
+    // zoomed right out the detail of the curves is lost, so draw the connections between each pair of populations as one line
+    bool bundled = style == standardDrawStyle && GLscale < LOD_BUNDLE_SCALE;
+
+    if (bundled) {
+        this->drawBundles(painter, visibleProjections, visibleInputs, GLscale, viewX, viewY, width, height);
+    }
+
+    // populations
+    for (unsigned int i = 0; i < visiblePops.size(); ++i) {
+        visiblePops[i]->draw(painter, GLscale, viewX, viewY, width, height, this->popImage, style);
+    }
+
+    if (!bundled) {
+        // projections
+        QPen oldPen = painter->pen();
+        QPen pen(QColor(0,0,255,255));
+        pen.setWidthF(1.5);
+        for (unsigned int i = 0; i < visibleProjections.size(); ++i) {
+            painter->setPen(pen);
+            visibleProjections[i]->draw(painter, GLscale, viewX, viewY, width, height, QImage(), style);
+        }
+        painter->setPen(oldPen);
+
+        // inputs
+        painter->setPen(QColor(0,210,0,255));
+        for (unsigned int i = 0; i < visibleInputs.size(); ++i) {
+            visibleInputs[i]->draw(painter, GLscale, viewX, viewY, width, height, QImage(), style);
+        }
+        painter->setPen(QColor(0,0,0,255));
     }
 
     // selected object
@@ -377,8 +518,8 @@ void rootData::reDrawAll(QPainter *painter, float GLscale, float viewX, float vi
                     pen.setWidthF(float(i*2));
                     painter->setPen(pen);
                     col->draw(painter, GLscale, viewX, viewY, width, height, this->popImage, standardDrawStyle);
-                    // only draw handles if we aren't using multiple selection
-                    if (selList.size() == 1) {
+                    // only draw handles if we aren't using multiple selection, or are too far out to use them
+                    if (selList.size() == 1 && GLscale >= LOD_HIDE_HANDLES_SCALE) {
                         col->drawHandles(painter, GLscale, viewX, viewY, width, height);
                     }
                 }
@@ -393,8 +534,8 @@ void rootData::reDrawAll(QPainter *painter, float GLscale, float viewX, float vi
                     pen.setWidthF(float(i*2));
                     painter->setPen(pen);
                     input->draw(painter, GLscale, viewX, viewY, width, height, this->popImage, standardDrawStyle);
-                    // only draw handles if we aren't using multiple selection
-                    if (selList.size() == 1) {
+                    // only draw handles if we aren't using multiple selection, or are too far out to use them
+                    if (selList.size() == 1 && GLscale >= LOD_HIDE_HANDLES_SCALE) {
                         input->drawHandles(painter, GLscale, viewX, viewY, width, height);
                     }
                 }
@@ -413,9 +554,14 @@ void rootData::reDrawAll(QPainter *painter, float GLscale, float viewX, float vi
     painter->drawLine(QLineF(x, y-14.0f, x, y+14.0f));
     painter->drawLine(QLineF(x-14.0f, y, x+14.0f, y));
 
-    // update positions
+    // update positions - anything still moving is redrawn over where it was and where it is now
     for (unsigned int i = 0; i < this->populations.size(); ++i) {
-        this->populations[i]->animate();
+        population * pop = this->populations[i];
+        if (pop->isMoving()) {
+            QRectF moved = pop->getAttachedBounds();
+            pop->animate();
+            emit redrawGLregion(moved.united(pop->getAttachedBounds()));
+        }
     }
 
     // draw dragselect if present
@@ -444,6 +590,54 @@ void rootData::reDrawAll(QPainter *painter, float GLscale, float viewX, float vi
     }
 }
 
+void rootData::drawBundles(QPainter *painter, vector <projection *> &projections, vector <genericInput *> &inputs, float GLscale, float viewX, float viewY, int width, int height)
+{
+    // count the projections between each pair of populations
+    QMap < QPair <population *, population *>, int > bundles;
+    for (uint i = 0; i < projections.size(); ++i) {
+        if (projections[i]->source != NULL && projections[i]->destination != NULL) {
+            ++bundles[qMakePair(projections[i]->source, projections[i]->destination)];
+        }
+    }
+
+    QPen oldPen = painter->pen();
+
+    // centre to centre, thicker the more projections there are
+    QMap < QPair <population *, population *>, int >::const_iterator bundle;
+    for (bundle = bundles.constBegin(); bundle != bundles.constEnd(); ++bundle) {
+        population * src = bundle.key().first;
+        population * dst = bundle.key().second;
+        QPen pen(QColor(0,0,255,255));
+        pen.setWidthF(1.5*(1.0+log(float(bundle.value()))/log(2.0)));
+        painter->setPen(pen);
+        if (src == dst) {
+            // a population onto itself is a small loop on its top right corner, which the population then covers half of
+            QPointF corner(((src->getRight()+viewX)*GLscale+width)/2, ((-src->getTop()+viewY)*GLscale+height)/2);
+            float radius = qMax(0.25f*GLscale/2.0f, 3.0f);
+            QBrush oldBrush = painter->brush();
+            painter->setBrush(Qt::NoBrush);
+            painter->drawEllipse(corner, radius, radius);
+            painter->setBrush(oldBrush);
+            continue;
+        }
+        painter->drawLine(QPointF(((src->x+viewX)*GLscale+width)/2, ((-src->y+viewY)*GLscale+height)/2), \
+                          QPointF(((dst->x+viewX)*GLscale+width)/2, ((-dst->y+viewY)*GLscale+height)/2));
+    }
+
+    // inputs just join their ends
+    painter->setPen(QColor(0,210,0,255));
+    for (uint i = 0; i < inputs.size(); ++i) {
+        if (inputs[i]->curves.size() > 0) {
+            QPointF start = inputs[i]->start;
+            QPointF end = inputs[i]->curves.back().end;
+            painter->drawLine(QPointF(((start.x()+viewX)*GLscale+width)/2, ((-start.y()+viewY)*GLscale+height)/2), \
+                              QPointF(((end.x()+viewX)*GLscale+width)/2, ((-end.y()+viewY)*GLscale+height)/2));
+        }
+    }
+
+    painter->setPen(oldPen);
+}
+
 void destroyDom(QDomNode &node)
 {
     QDomNodeList childList = node.childNodes();
@@ -471,6 +665,19 @@ void rootData::onRightMouseDown(float xGL, float yGL, float GLscale)
     this->dragListStart = QPointF(xGL, yGL);
 }
 
+static bool dragSelectionLessThan(const spatialIndex::entry * a, const spatialIndex::entry * b)
+{
+    if (a->group != b->group) {
+        return a->group < b->group;
+    }
+    bool aIsPop = a->obj->type == populationObject;
+    bool bIsPop = b->obj->type == populationObject;
+    if (aIsPop != bIsPop) {
+        return aIsPop;
+    }
+    return a->sequence < b->sequence;
+}
+
 void rootData::dragSelect(float xGL, float yGL)
 {
     bool addSelection = (QApplication::keyboardModifiers() & Qt::ShiftModifier);
@@ -485,105 +692,32 @@ void rootData::dragSelect(float xGL, float yGL)
         selList.clear();
     }
 
-    // add selected objects to list
-    for (uint i = 0; i < this->populations.size(); ++i) {
-        population * pop = populations[i];
-
-        if (dragSelection.contains(pop->x, pop->y)) {
-            // if not already selected
-            bool alreadySelected = false;
-            for (uint s = 0; s < this->selList.size(); ++s) {
-                if (selList[s] == pop) {
-                    alreadySelected = true;
-                }
-            }
-            if (!alreadySelected) {
-                selList.push_back(pop);
-            }
-        }
+    // add selected objects to list - only objects whose bounds overlap the box can be inside it
+    this->updateSpatialIndex();
+    vector <spatialIndex::entry *> candidates = this->canvasIndex.query(this->dragSelection);
+    // keep the order of the model walk, with each population ahead of its projections and inputs
+    std::stable_sort(candidates.begin(), candidates.end(), dragSelectionLessThan);
 
-        for (uint j = 0; j < pop->neuronType->inputs.size(); ++j) {
-            genericInput * in = pop->neuronType->inputs[j];
+    for (uint i = 0; i < candidates.size(); ++i) {
 
-            if (in->curves.size() > 0) {
-                if (dragSelection.contains(in->start) && dragSelection.contains(in->curves.back().end)) {
-                    // if not already selected
-                    bool alreadySelected = false;
-                    for (uint s = 0; s < this->selList.size(); ++s) {
-                        if (selList[s] == in) {
-                            alreadySelected = true;
-                        }
-                    }
-                    if (!alreadySelected) {
-                        selList.push_back(in);
-                    }
-                }
-            }
-        }
+        systemObject * obj = candidates[i]->obj;
 
-        for (uint j = 0; j < pop->projections.size(); ++j) {
-            projection * proj = pop->projections[j];
+        // if already selected
+        if (this->selList.contains(obj)) {
+            continue;
+        }
 
+        if (obj->type == populationObject) {
+            population * pop = (population *) obj;
+            if (dragSelection.contains(pop->x, pop->y)) {
+                selList.push_back(pop);
+            }
+        } else {
+            // inputs are projections too
+            projection * proj = (projection *) obj;
             if (proj->curves.size() > 0) {
                 if (dragSelection.contains(proj->start) && dragSelection.contains(proj->curves.back().end)) {
-                    // if not already selected
-                    bool alreadySelected = false;
-                    for (uint s = 0; s < this->selList.size(); ++s) {
-                        if (selList[s] == proj) {
-                            alreadySelected = true;
-                        }
-                    }
-                    if (!alreadySelected) {
-                        selList.push_back(proj);
-                    }
-                }
-            }
-
-            for (uint pt = 0; pt < proj->synapses.size(); ++pt) {
-
-                synapse * projT = proj->synapses[pt];
-
-
-                // select generic inputs for weightupdate
-                for (uint c = 0; c < projT->weightUpdateType->inputs.size(); ++c) {
-
-                    genericInput * in = projT->weightUpdateType->inputs[c];
-
-                    if (in->curves.size() > 0) {
-                        if (dragSelection.contains(in->start) && dragSelection.contains(in->curves.back().end)) {
-                            // if not already selected
-                            bool alreadySelected = false;
-                            for (uint s = 0; s < this->selList.size(); ++s) {
-                                if (selList[s] == in) {
-                                    alreadySelected = true;
-                                }
-                            }
-                            if (!alreadySelected) {
-                                selList.push_back(in);
-                            }
-                        }
-                    }
-                }
-
-                // select generic inputs for postsynapse
-                for (uint c = 0; c < projT->postsynapseType->inputs.size(); ++c) {
-
-                    genericInput * in = projT->postsynapseType->inputs[c];
-
-                    if (in->curves.size() > 0) {
-                        if (dragSelection.contains(in->start) && dragSelection.contains(in->curves.back().end)) {
-                            // if not already selected
-                            bool alreadySelected = false;
-                            for (uint s = 0; s < this->selList.size(); ++s) {
-                                if (selList[s] == in) {
-                                    alreadySelected = true;
-                                }
-                            }
-                            if (!alreadySelected) {
-                                selList.push_back(in);
-                            }
-                        }
-                    }
+                    selList.push_back(proj);
                 }
             }
         }
@@ -705,7 +839,7 @@ bool rootData::selListContains (const vector<systemObject*>& objectList)
 {
     vector<systemObject*>::const_iterator i = objectList.begin();
     while (i != objectList.end()) {
-        if (std::find (this->selList.begin(), this->selList.end(), *i) != this->selList.end()) {
+        if (this->selList.contains (*i)) {
             return true;
         }
         ++i;
@@ -717,6 +851,10 @@ void rootData::deleteFromSelList (const vector<systemObject*>& objectList)
 {
     vector<systemObject*>::const_iterator i = objectList.begin();
     while (i != objectList.end()) {
+        if (!this->selList.contains (*i)) {
+            ++i;
+            continue;
+        }
         vector<systemObject*>::iterator j = this->selList.begin();
         while (j != this->selList.end()) {
             if (*i == *j) { // That is, selList contains a member of objectList
@@ -840,69 +978,71 @@ void rootData::onLeftMouseDown(float xGL, float yGL, float GLscale, bool shiftDo
     }
 }
 
-void rootData::findSelection (float xGL, float yGL, float GLscale, vector<systemObject*>& newlySelectedList)
+void rootData::updateSpatialIndex()
 {
-    // Now look at populations and their inputs.
+    if (this->canvasIndex.isValid()) {
+        return;
+    }
+
+    this->canvasIndex.clear();
+
+    // the sequence is the order findSelection() has always tested objects
+    // in, so that overlapping objects resolve the same way as before
+    int sequence = 0;
     for (unsigned int i = 0; i < this->populations.size(); ++i) {
 
-        // check population inputs:
-        for (unsigned int j = 0; j < this->populations[i]->neuronType->inputs.size(); ++j) {
-            // find if an edge of the input is hit
-            if (this->populations[i]->neuronType->inputs[j]->is_clicked(xGL, yGL, GLscale)) {
-                // add the input to the selection list
-                newlySelectedList.push_back(this->populations[i]->neuronType->inputs[j]);
-                // selection complete, move on
-                return;
-            }
-        } // for loop checking population inputs
+        population * pop = this->populations[i];
 
-        // check projections
-        for (unsigned int j = 0; j < this->populations[i]->projections.size(); ++j) {
+        for (unsigned int j = 0; j < pop->neuronType->inputs.size(); ++j) {
+            genericInput * in = pop->neuronType->inputs[j];
+            this->canvasIndex.insert(in, in->getBounds(), i, sequence++);
+        }
 
-            // find if an edge of the projection is hit
-            if (this->populations[i]->projections[j]->is_clicked(xGL, yGL, GLscale)) {
-                // add to selection list
-                newlySelectedList.push_back(this->populations[i]->projections[j]);
-                // selection complete, move on
-                return;
-            }
+        for (unsigned int j = 0; j < pop->projections.size(); ++j) {
 
-            // check proj inputs:
-            for (unsigned int k = 0; k < this->populations[i]->projections[j]->synapses.size(); ++k) {
+            projection * proj = pop->projections[j];
+            this->canvasIndex.insert(proj, proj->getBounds(), i, sequence++);
 
-                synapse * col = this->populations[i]->projections[j]->synapses[k];
+            for (unsigned int k = 0; k < proj->synapses.size(); ++k) {
 
-                for (unsigned int l = 0; l < col->weightUpdateType->inputs.size(); ++l) {
+                synapse * col = proj->synapses[k];
 
-                    // find if an edge of the input is hit
-                    if (col->weightUpdateType->inputs[l]->is_clicked(xGL, yGL, GLscale)) {
-                        //  add to selection list
-                        newlySelectedList.push_back(col->weightUpdateType->inputs[l]);
-                        // selection complete, move on
-                        return;
-                    }
+                for (unsigned int l = 0; l < col->weightUpdateType->inputs.size(); ++l) {
+                    genericInput * in = col->weightUpdateType->inputs[l];
+                    this->canvasIndex.insert(in, in->getBounds(), i, sequence++);
                 }
 
                 for (unsigned int l = 0; l < col->postsynapseType->inputs.size(); ++l) {
-                    // find if an edge of the input is hit
-                    if (col->postsynapseType->inputs[l]->is_clicked(xGL, yGL, GLscale)) {
-                        //  add to selection list
-                        newlySelectedList.push_back(col->postsynapseType->inputs[l]);
-                        // selection complete, move on
-                        return;
-                    }
+                    genericInput * in = col->postsynapseType->inputs[l];
+                    this->canvasIndex.insert(in, in->getBounds(), i, sequence++);
                 }
-            } // for loop checking projection inputs.
-        } // for-loop over projections
+            }
+        }
+
+        this->canvasIndex.insert(pop, QRectF(QPointF(pop->left, pop->bottom), QPointF(pop->right, pop->top)), i, sequence++);
+    }
+
+    this->canvasIndex.finishBuild();
+}
+
+void rootData::findSelection (float xGL, float yGL, float GLscale, vector<systemObject*>& newlySelectedList)
+{
+    // only objects whose bounds overlap the area under the cursor can be hit
+    this->updateSpatialIndex();
+    QRectF cursorRect(xGL-10.0/GLscale, yGL-10.0/GLscale, 20.0/GLscale, 20.0/GLscale);
+    vector <spatialIndex::entry *> candidates = this->canvasIndex.query(cursorRect);
 
+    // candidates are in the order of the model walk: inputs, then
+    // projections and their inputs, then the population itself
+    for (uint i = 0; i < candidates.size(); ++i) {
         // select if under the cursor - no two objects should overlap!
-        if (this->populations[i]->is_clicked(xGL, yGL, GLscale)) {
+        if (candidates[i]->obj->is_clicked(xGL, yGL, GLscale)) {
             //  add to selection list
-            newlySelectedList.push_back(this->populations[i]);
+            newlySelectedList.push_back(candidates[i]->obj);
             // selection complete, move on
             return;
         }
-    } // for-loop over populations
+    }
 }
 
 QColor rootData::getColor(QColor initCol)
@@ -979,6 +1119,9 @@ void rootData::addSpikeSource()
 
 void rootData::addBezierOrProjection(float xGL, float yGL)
 {
+    // a curve is added to the projection being drawn
+    spatialIndex::invalidate();
+
     if (this->selList.size() == 1) {
         if (this->selList[0]->type == projectionObject) {
 
@@ -1029,6 +1172,9 @@ void rootData::addBezierOrProjection(float xGL, float yGL)
 
 void rootData::startAddBezier(float xGL, float yGL)
 {
+    // the projection being drawn changes shape with the cursor
+    spatialIndex::invalidate();
+
     if (this->selList.size() == 1) {
         if (this->selList[0]->type == populationObject) {
 
@@ -1163,6 +1309,10 @@ void rootData::mouseMoveGL(float xGL, float yGL)
         yGL = round(yGL/source->gridScale)*source->gridScale;
     }
 
+    // redraw where the selection was and where it ends up - populations
+    // glide to their new location, and ask for more as they go
+    QRectF moved = this->getSelectionBounds();
+
     if (selList.size() > 1) {
         for (uint i = 0; i < selList.size(); ++i) {
             selList[i]->move(xGL, yGL);
@@ -1202,6 +1352,21 @@ void rootData::mouseMoveGL(float xGL, float yGL)
             ((genericInput*) selList[0])->moveSelectedControlPoint(xGL, yGL);
         }
     }
+
+    emit redrawGLregion(moved.united(this->getSelectionBounds()));
+}
+
+QRectF rootData::getSelectionBounds()
+{
+    QRectF bounds;
+    for (uint i = 0; i < this->selList.size(); ++i) {
+        if (this->selList[i]->type == populationObject) {
+            bounds = bounds.united(((population *) this->selList[i])->getAttachedBounds());
+        } else if (this->selList[i]->type == projectionObject || this->selList[i]->type == inputObject) {
+            bounds = bounds.united(((projection *) this->selList[i])->getBounds());
+        }
+    }
+    return bounds;
 }
 
 void rootData::updatePortMap(QString var)
@@ -1977,9 +2142,18 @@ void rootData::getNeuronLocationsSrc(vector<vector<loc> > *locations,vector <QCo
 
 systemObject * rootData::getObjectFromName(QString name)
 {
-    systemObject * currObject = (systemObject *)0;
+    if (!this->networkRegistry.isValid()) {
+        this->networkRegistry.rebuild(this->populations);
+    }
 
-    // find the pop / projection that is being displayed
+    // names can change without the network changing, so check the name still matches
+    systemObject * currObject = this->networkRegistry.objectNamed(name);
+    if (currObject && currObject->getName() == name) {
+        return currObject;
+    }
+    currObject = (systemObject *)0;
+
+    // not registered under that name - find the pop / projection that is being displayed
     for (uint i = 0; i < this->populations.size(); ++i) {
         if (this->populations[i]->getName() == name) {
             currObject = this->populations[i];
@@ -2000,71 +2174,23 @@ systemObject * rootData::getObjectFromName(QString name)
 // allow safe usage of systemObject pointers
 bool rootData::isValidPointer(systemObject * ptr)
 {
-    // find the pop / projection / input reference
-    for (uint i = 0; i < this->populations.size(); ++i) {
-
-        if (this->populations[i] == ptr) {
-            return true;
-        }
-
-        for (uint j = 0; j < this->populations[i]->neuronType->inputs.size(); ++j)
-            if (this->populations[i]->neuronType->inputs[j] == ptr) {
-                return true;
-            }
-
-        for (uint j = 0; j < this->populations[i]->projections.size(); ++j) {
-
-            if (this->populations[i]->projections[j] == ptr) {
-                return true;
-            }
-
-            for (uint k = 0; k < this->populations[i]->projections[j]->synapses.size(); ++k) {
-                if (this->populations[i]->projections[j]->synapses[k] == ptr) {
-                    return true;
-                }
-                for (uint l = 0; l < this->populations[i]->projections[j]->synapses[k]->weightUpdateType->inputs.size(); ++l) {
-                    if (this->populations[i]->projections[j]->synapses[k]->weightUpdateType->inputs[l] == ptr) {
-                        return true;
-                    }
-                }
-
-                for (uint l = 0; l < this->populations[i]->projections[j]->synapses[k]->postsynapseType->inputs.size(); ++l) {
-                    if (this->populations[i]->projections[j]->synapses[k]->postsynapseType->inputs[l] == ptr) {
-                        return true;
-                    }
-                }
-            }
-        }
+    // the registry is only rebuilt after the network has changed
+    if (!this->networkRegistry.isValid()) {
+        this->networkRegistry.rebuild(this->populations);
     }
 
-    // not found
-    return false;
+    return this->networkRegistry.contains(ptr);
 }
 
 // allow safe usage of NineMLComponentData pointers
 bool rootData::isValidPointer(NineMLComponentData * ptr)
 {
-    // find the reference
-    for (uint i = 0; i < this->populations.size(); ++i) {
-
-        if (this->populations[i]->neuronType == ptr) {
-            return true;
-        }
-
-        for (uint j = 0; j < this->populations[i]->projections.size(); ++j) {
-            for (uint k = 0; k < this->populations[i]->projections[j]->synapses.size(); ++k) {
-                if (this->populations[i]->projections[j]->synapses[k]->weightUpdateType == ptr) {
-                    return true;
-                }
-                if (this->populations[i]->projections[j]->synapses[k]->postsynapseType == ptr) {
-                        return true;
-                }
-            }
-        }
+    // the registry is only rebuilt after the network has changed
+    if (!this->networkRegistry.isValid()) {
+        this->networkRegistry.rebuild(this->populations);
     }
 
-    // not found
-    return false;
+    return this->networkRegistry.contains(ptr);
 }
 
 // allow safe usage of NineMLComponent pointers
@@ -36,6 +36,8 @@
 #include "glconnectionwidget.h"
 #include "systemobject.h"
 #include "valuelistdialog.h"
+#include "spatialindex.h"
+#include "objectregistry.h"
 
 struct selStruct {
     int type;
@@ -108,7 +110,7 @@ public:
     vector < loadedComponent > loadedComponents;
 
     // structure to hold selected items
-    vector <systemObject *> selList;
+    selectionList selList;
 
     cursorType cursor;
     int largestIndex;
@@ -126,12 +128,14 @@ signals:
     void updatePanel(rootData *);
     void updatePanelView2(QString);
     void redrawGLview();
+    void redrawGLregion(QRectF);
     void setCaption(QString);
     void setWindowTitle();
     void itemsSelected(QString);
 
 public slots:
     void saveImage(QString);
+    QImage renderNetworkImage(const vector <systemObject *> &list, float scale, float border, bool transparent);
     void reDrawAll(QPainter *, float, float, float, int, int, drawStyle style);
     void onLeftMouseDown(float xGL, float yGL, float GLscale, bool shiftDown);
 
@@ -289,6 +293,36 @@ private:
      */
     void deleteFromSelList (const vector<systemObject*>& objectList);
 
+    /*!
+     * \brief rebuild the canvas spatial index if anything has moved,
+     * been added or been removed since it was last built.
+     */
+    void updateSpatialIndex();
+
+    /*!
+     * \brief the area covered by the selected objects and anything
+     * drawn attached to them, in GL co-ordinates.
+     */
+    QRectF getSelectionBounds();
+
+    /*!
+     * \brief draw the projections as straight lines, one per pair of
+     * connected populations, for when the canvas is zoomed right out.
+     */
+    void drawBundles(QPainter *painter, vector <projection *> &projections, vector <genericInput *> &inputs, float GLscale, float viewX, float viewY, int width, int height);
+
+    /*!
+     * \brief spatial index of the objects on the network canvas, used
+     * for click and drag selection.
+     */
+    spatialIndex canvasIndex;
+
+    /*!
+     * \brief registry of the objects in the network, used for pointer
+     * checks and lookups by name.
+     */
+    objectRegistry networkRegistry;
+
     QString getUniquePopName(QString newName);
     // NB: This is unused. Refactor out.
     bool selChange;
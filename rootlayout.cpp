@@ -25,6 +25,7 @@
 #include "rootlayout.h"
 #include "projectobject.h"
 #include "filteroutundoredoevents.h"
+#include "diagnostics.h"
 
 /*
  Alex Cope 2012
@@ -1079,14 +1080,11 @@ void rootLayout::drawParamsLayout(rootData * data) {
                 type = "nrn";
                 // check if current component validates
                 ((NineMLComponentData *) type9ml)->component->validateComponent();
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                num_errs += settings.beginReadArray("warnings");
-                settings.endArray();
+                int num_errs = diagnostics::instance()->errorCount();
+                num_errs += diagnostics::instance()->warningCount();
 
-                settings.remove("errors");
-                settings.remove("warnings");
+                diagnostics::instance()->clearErrors();
+                diagnostics::instance()->clearWarnings();
 
                 // doesn't validate - warn and skip
                 if (num_errs != 0) {
@@ -1109,14 +1107,11 @@ void rootLayout::drawParamsLayout(rootData * data) {
                 type = "syn";
                 // check if current component validates
                 ((NineMLComponentData *) type9ml)->component->validateComponent();
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                num_errs += settings.beginReadArray("warnings");
-                settings.endArray();
+                int num_errs = diagnostics::instance()->errorCount();
+                num_errs += diagnostics::instance()->warningCount();
 
-                settings.remove("errors");
-                settings.remove("warnings");
+                diagnostics::instance()->clearErrors();
+                diagnostics::instance()->clearWarnings();
 
                 // doesn't validate - warn and skip
                 if (num_errs != 0) {
@@ -1132,14 +1127,11 @@ void rootLayout::drawParamsLayout(rootData * data) {
                 type = "psp";
                 // check if current component validates
                 ((NineMLComponentData *) type9ml)->component->validateComponent();
-                QSettings settings;
-                int num_errs = settings.beginReadArray("errors");
-                settings.endArray();
-                num_errs += settings.beginReadArray("warnings");
-                settings.endArray();
-
-                settings.remove("errors");
-                settings.remove("warnings");
+                int num_errs = diagnostics::instance()->errorCount();
+                num_errs += diagnostics::instance()->warningCount();
+
+                diagnostics::instance()->clearErrors();
+                diagnostics::instance()->clearWarnings();
 
                 // doesn't validate - warn and skip
                 if (num_errs != 0) {
@@ -156,94 +156,7 @@ void saveNetworkImageDialog::reDrawPreview() {
 QPixmap saveNetworkImageDialog::drawPixMap() {
 
     // what to draw
-    vector <systemObject *> list;
-    list = data->selList;
-
-    QRectF bounds = QRectF(100000,100000,-200000,-200000);
-
-    // work out bounding box
-    for (uint p = 0; p < list.size(); ++p) {
-
-        if (list[p]->type == populationObject) {
-            population * pop = (population * ) list[p];
-            if (-pop->bottomBound(pop->targy)> bounds.bottom())
-                bounds.setBottom(-pop->bottomBound(pop->targy));
-            if (-pop->topBound(pop->targy)< bounds.top())
-                bounds.setTop(-pop->topBound(pop->targy));
-            if (pop->leftBound(pop->targx)< bounds.left())
-                bounds.setLeft(pop->leftBound(pop->targx));
-            if (pop->rightBound(pop->targx)> bounds.right())
-                bounds.setRight(pop->rightBound(pop->targx));
-        }
-
-
-        if (list[p]->type == projectionObject) {
-
-            projection * proj = (projection * ) list[p];
-            for (uint c = 0; c < proj->curves.size(); ++c) {
-                bezierCurve * bz = &proj->curves[c];
-                if (-bz->C1.y() > bounds.bottom())
-                    bounds.setBottom(-bz->C1.y());
-                if (-bz->C1.y() < bounds.top())
-                    bounds.setTop(-bz->C1.y());
-                if (bz->C1.x() < bounds.left())
-                    bounds.setLeft(bz->C1.x());
-                if (bz->C1.x() > bounds.right())
-                    bounds.setRight(bz->C1.x());
-
-                if (-bz->C2.y() > bounds.bottom())
-                    bounds.setBottom(-bz->C2.y());
-                if (-bz->C2.y() < bounds.top())
-                    bounds.setTop(-bz->C2.y());
-                if (bz->C2.x() < bounds.left())
-                    bounds.setLeft(bz->C2.x());
-                if (bz->C2.x() > bounds.right())
-                    bounds.setRight(bz->C2.x());
-            }
-
-        }
-
-    }
-
-    bounds.setTopLeft(bounds.topLeft() - QPointF(border,border));
-    bounds.setBottomRight(bounds.bottomRight() + QPointF(border,border));
-
-    QPixmap outPix(bounds.width()*100*scale, bounds.height()*100*scale);
-
-    if (ui->checkBox->isChecked()) {
-        outPix.fill(Qt::transparent);
-    } else {
-        outPix.fill();// white
-    }
-
-    QPainter *painter = new QPainter(&outPix);
-
-    painter->setRenderHint(QPainter::HighQualityAntialiasing, true);
-    painter->setRenderHint(QPainter::Antialiasing,true);
-    painter->setRenderHint( QPainter::TextAntialiasing,true);
-    painter->setRenderHint(QPainter::SmoothPixmapTransform,true);
-
-    // setup the painter
-    QFont font("Monospace", 5.0f);
-    font.setStyleHint(QFont::TypeWriter);
-    painter->setFont(font);
-
-
-
-    // Just render selection:
-    for (unsigned int i = 0; i < list.size(); ++i) {
-
-            list[i]->draw(painter, 200.0*scale, -bounds.center().x(), -bounds.center().y(), bounds.width()*100*scale, bounds.height()*100*scale, data->popImage, microcircuitDrawStyle);
-
-    }
-
-    //QImage outIm = outPix->toImage();
-    //outIm.save("/home/alex/test_image.png","png");
-
-    painter->end();
-
-    delete painter;
-    return outPix;
+    return QPixmap::fromImage(data->renderNetworkImage(data->selList, scale, border, ui->checkBox->isChecked()));
 }
 
 QPixmap saveNetworkImageDialog::drawPixMapVis() {
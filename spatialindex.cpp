@@ -0,0 +1,192 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+#include "spatialindex.h"
+#include <algorithm>
+
+// grid cells an object may cover before it is checked on every query instead
+#define MAX_CELLS_PER_OBJECT 64
+
+int spatialIndex::generation = 0;
+
+selectionList &selectionList::operator=(const vector <systemObject *> &list)
+{
+    vector <systemObject *>::operator=(list);
+    this->rehash();
+    return *this;
+}
+
+void selectionList::push_back(systemObject * obj)
+{
+    vector <systemObject *>::push_back(obj);
+    this->members.insert(obj);
+}
+
+selectionList::iterator selectionList::erase(iterator pos)
+{
+    systemObject * obj = *pos;
+    iterator next = vector <systemObject *>::erase(pos);
+    // the same object can (rarely) be in the list twice
+    if (std::find(this->begin(), this->end(), obj) == this->end()) {
+        this->members.remove(obj);
+    }
+    return next;
+}
+
+selectionList::iterator selectionList::erase(iterator first, iterator last)
+{
+    int offset = first - this->begin();
+    vector <systemObject *>::erase(first, last);
+    this->rehash();
+    return this->begin() + offset;
+}
+
+void selectionList::clear()
+{
+    vector <systemObject *>::clear();
+    this->members.clear();
+}
+
+void selectionList::insert(iterator pos, vector <systemObject *>::const_iterator first, vector <systemObject *>::const_iterator last)
+{
+    vector <systemObject *>::insert(pos, first, last);
+    for (vector <systemObject *>::const_iterator i = first; i != last; ++i) {
+        this->members.insert(*i);
+    }
+}
+
+void selectionList::swap(vector <systemObject *> &list)
+{
+    vector <systemObject *>::swap(list);
+    this->rehash();
+}
+
+void selectionList::rehash()
+{
+    this->members.clear();
+    for (uint i = 0; i < this->size(); ++i) {
+        this->members.insert((*this)[i]);
+    }
+}
+
+spatialIndex::spatialIndex()
+{
+    this->cellSize = 2.0;
+    // start out of date
+    this->builtGeneration = spatialIndex::generation - 1;
+}
+
+void spatialIndex::clear()
+{
+    this->entries.clear();
+    this->cells.clear();
+    this->oversized.clear();
+    this->builtGeneration = spatialIndex::generation - 1;
+}
+
+spatialIndex::cellKey spatialIndex::cellOf(QPointF point) const
+{
+    return cellKey((int) floor(point.x()/this->cellSize), (int) floor(point.y()/this->cellSize));
+}
+
+void spatialIndex::insert(systemObject * obj, QRectF bounds, int group, int sequence)
+{
+    entry newEntry;
+    newEntry.obj = obj;
+    newEntry.bounds = bounds.normalized();
+    newEntry.group = group;
+    newEntry.sequence = sequence;
+
+    int index = this->entries.size();
+    this->entries.push_back(newEntry);
+
+    cellKey first = this->cellOf(newEntry.bounds.topLeft());
+    cellKey last = this->cellOf(newEntry.bounds.bottomRight());
+
+    if ((last.first - first.first + 1) * (last.second - first.second + 1) > MAX_CELLS_PER_OBJECT) {
+        this->oversized.push_back(index);
+        return;
+    }
+
+    for (int i = first.first; i <= last.first; ++i) {
+        for (int j = first.second; j <= last.second; ++j) {
+            this->cells[cellKey(i,j)].push_back(index);
+        }
+    }
+}
+
+void spatialIndex::finishBuild()
+{
+    this->builtGeneration = spatialIndex::generation;
+}
+
+static bool entrySequenceLessThan(const spatialIndex::entry * a, const spatialIndex::entry * b)
+{
+    return a->sequence < b->sequence;
+}
+
+vector <spatialIndex::entry *> spatialIndex::query(QRectF rect)
+{
+    rect = rect.normalized();
+
+    vector <int> found;
+
+    cellKey first = this->cellOf(rect.topLeft());
+    cellKey last = this->cellOf(rect.bottomRight());
+
+    // a very large query covers more cells than there are objects, so just test them all
+    if ((qint64) (last.first - first.first + 1) * (qint64) (last.second - first.second + 1) > (qint64) this->entries.size()) {
+        for (uint i = 0; i < this->entries.size(); ++i) {
+            found.push_back(i);
+        }
+    } else {
+        for (int i = first.first; i <= last.first; ++i) {
+            for (int j = first.second; j <= last.second; ++j) {
+                QHash <cellKey, vector <int> >::const_iterator cell = this->cells.constFind(cellKey(i,j));
+                if (cell != this->cells.constEnd()) {
+                    found.insert(found.end(), cell.value().begin(), cell.value().end());
+                }
+            }
+        }
+        found.insert(found.end(), this->oversized.begin(), this->oversized.end());
+        // objects covering several cells are found more than once
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+    }
+
+    vector <entry *> results;
+    for (uint i = 0; i < found.size(); ++i) {
+        entry * e = &(this->entries[found[i]]);
+        // QRectF::intersects() ignores empty rectangles, and a straight
+        // projection can have a bounding box with no height
+        if (e->bounds.left() <= rect.right() && e->bounds.right() >= rect.left() \
+                && e->bounds.top() <= rect.bottom() && e->bounds.bottom() >= rect.top()) {
+            results.push_back(e);
+        }
+    }
+
+    std::sort(results.begin(), results.end(), entrySequenceLessThan);
+
+    return results;
+}
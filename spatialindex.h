@@ -0,0 +1,137 @@
+/***************************************************************************
+**                                                                        **
+**  This file is part of SpineCreator, an easy to use GUI for             **
+**  describing spiking neural network models.                             **
+**  Copyright (C) 2013-2014 Alex Cope, Paul Richmond, Seb James           **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Alex Cope                                            **
+**  Website/Contact: http://bimpa.group.shef.ac.uk/                       **
+****************************************************************************/
+
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include "globalHeader.h"
+
+#include "systemobject.h"
+
+/*!
+ * \brief The selectionList class is the list of currently selected
+ * objects. It behaves as the vector it replaces (order is kept, so the
+ * first selected object is still selList[0]) but also keeps a hash set
+ * of its members so that membership tests do not walk the list.
+ *
+ * Only the modifying members of vector used on the selection are
+ * shadowed here - anything else that changes the list must go through
+ * one of these.
+ */
+class selectionList : public vector <systemObject *>
+{
+public:
+    selectionList() {}
+    selectionList(const vector <systemObject *> &list) : vector <systemObject *>(list) {this->rehash();}
+
+    selectionList &operator=(const vector <systemObject *> &list);
+
+    void push_back(systemObject * obj);
+    iterator erase(iterator pos);
+    iterator erase(iterator first, iterator last);
+    void clear();
+    void insert(iterator pos, vector <systemObject *>::const_iterator first, vector <systemObject *>::const_iterator last);
+    void swap(vector <systemObject *> &list);
+
+    /*!
+     * \brief contains returns true if obj is in the selection, in O(1).
+     */
+    bool contains(systemObject * obj) const {return this->members.contains(obj);}
+
+private:
+    void rehash();
+    QSet <systemObject *> members;
+};
+
+/*!
+ * \brief The spatialIndex class is a uniform grid over the network
+ * canvas used to find the objects near a point or inside a rectangle
+ * without testing every object in the model.
+ *
+ * Each object is stored with its bounding rectangle in GL co-ordinates.
+ * The index does not track the objects itself - anything that moves,
+ * adds or removes an object on the canvas calls the static invalidate()
+ * and the owner rebuilds the index the next time it is needed.
+ */
+class spatialIndex
+{
+public:
+    spatialIndex();
+
+    /*!
+     * \brief invalidate marks all spatial indices as out of date.
+     */
+    static void invalidate() {++spatialIndex::generation;}
+
+    /*!
+     * \brief isValid returns false if invalidate() has been called
+     * since the index was last built.
+     */
+    bool isValid() const {return this->builtGeneration == spatialIndex::generation;}
+
+    void clear();
+
+    /*!
+     * \brief insert adds an object to the index. group and sequence are
+     * stored so callers can recover the order in which they walked the
+     * model when querying.
+     */
+    void insert(systemObject * obj, QRectF bounds, int group, int sequence);
+
+    /*!
+     * \brief finishBuild marks the index as up to date.
+     */
+    void finishBuild();
+
+    struct entry {
+        systemObject * obj;
+        QRectF bounds;
+        int group;
+        int sequence;
+    };
+
+    /*!
+     * \brief query returns the entries whose bounds intersect rect,
+     * sorted by sequence.
+     */
+    vector <entry *> query(QRectF rect);
+
+    int size() const {return (int) this->entries.size();}
+
+private:
+    typedef QPair <int, int> cellKey;
+    cellKey cellOf(QPointF point) const;
+
+    // size of a grid cell in GL units (populations are 1.0 across by default)
+    float cellSize;
+    vector <entry> entries;
+    QHash <cellKey, vector <int> > cells;
+    // objects covering too many cells to be worth bucketing (e.g. long projections)
+    vector <int> oversized;
+    int builtGeneration;
+
+    static int generation;
+};
+
+#endif // SPATIALINDEX_H
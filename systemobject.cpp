@@ -23,6 +23,7 @@
 ****************************************************************************/
 
 #include "systemobject.h"
+#include "objectregistry.h"
 
 
 systemObject::systemObject()
@@ -31,4 +32,11 @@ systemObject::systemObject()
     connected = false;
     type = nullObject;
     tag = -1;
+    objectRegistry::invalidate();
+}
+
+systemObject::~systemObject()
+{
+    // may be part of a network
+    objectRegistry::invalidate();
 }
@@ -92,7 +92,7 @@ public:
     bool connected;
     bool isDeleted;
     systemObject();
-    virtual ~systemObject() {}
+    virtual ~systemObject();
 
     /*!
      * The offset between (probably) the mouse which is
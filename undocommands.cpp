@@ -31,6 +31,8 @@
 #include "mainwindow.h"
 #include "nineml_rootcomponentitem.h"
 #include "projectobject.h"
+#include "spatialindex.h"
+#include "objectregistry.h"
 
 // ######## DELETE SELECTION #################
 
@@ -147,6 +149,9 @@ void addPopulationCmd::undo()
     }
     // do children by calling parent class function:
     QUndoCommand::undo();
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
 }
 
 void addPopulationCmd::redo()
@@ -163,6 +168,9 @@ void addPopulationCmd::redo()
     }
     // do children by calling parent class function:
     QUndoCommand::redo();
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
 }
 
 // ######## DELETE POPULATION #################
@@ -260,6 +268,9 @@ void delPopulation::undo()
     }
     // do children by calling parent class function:
     QUndoCommand::undo();
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
 }
 
 void delPopulation::redo()
@@ -287,7 +298,9 @@ void delPopulation::redo()
     }
     pop->isDeleted = true;
     isDeleted = true;
-
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
 }
 
 // ######## MOVE POPULATION #################
@@ -379,11 +392,13 @@ void addProjection::undo()
     }
     // do children by calling parent class function:
     QUndoCommand::undo();
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
 }
 
 void addProjection::redo()
 {
-
     proj->connect();
     proj->isDeleted = false;
     isDeleted = false;
@@ -394,6 +409,9 @@ void addProjection::redo()
     }
     // do children by calling parent class function:
     QUndoCommand::redo();
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
 }
 
 // ######## DELETE PROJECTION #################
@@ -439,6 +457,9 @@ void delProjection::undo()
     }
     // do children by calling parent class function:
     QUndoCommand::undo();
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
 }
 
 void delProjection::redo()
@@ -460,7 +481,9 @@ void delProjection::redo()
             }
         }
     }
-
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
 }
 
 // ######## ADD SYNAPSE #################
@@ -486,6 +509,9 @@ void addSynapse::undo()
     isDeleted = true;
     syn->isDeleted = true;
     QUndoCommand::undo();
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
     data->reDrawAll();
 }
 
@@ -495,6 +521,9 @@ void addSynapse::redo()
     isDeleted = false;
     syn->isDeleted = false;
     QUndoCommand::redo();
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
     data->reDrawAll();
 }
 
@@ -597,6 +626,9 @@ void delSynapse::undo()
     isUndone = true;
     // do children by calling parent class function:
     QUndoCommand::undo();
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
     data->reDrawAll();
 }
 
@@ -614,8 +646,10 @@ void delSynapse::redo()
     }
     isUndone = false;
 
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
     data->reDrawAll();
-
 }
 
 
@@ -637,6 +671,9 @@ void addInput::undo()
     // delete input (must disconnect it first!)
     input->disconnect();
     isDeleted = true;
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
 }
 
 void addInput::redo()
@@ -644,6 +681,9 @@ void addInput::redo()
     // create new Synapse on projection
     input->connect();
     isDeleted = false;
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
 }
 
 // ######## DELETE GENERIC INPUT #################
@@ -677,6 +717,9 @@ void delInput::undo()
         data->cursor.x = -100000;
         data->cursor.y = -100000;
     }
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
 }
 
 void delInput::redo()
@@ -696,6 +739,9 @@ void delInput::redo()
     }
     input->isDeleted = true;
     isDeleted = true;
+    // the canvas and network contents have changed
+    spatialIndex::invalidate();
+    objectRegistry::invalidate();
 }
 
 // ######## CHANGE CONNECTION #################
@@ -973,6 +1019,9 @@ void setLoc3Undo::undo()
         ptr->loc3.y = oldValue;
     if (index == 2)
         ptr->loc3.z = oldValue;
+    if (data->main->viewVZ.OpenGLWidget != NULL) {
+        data->main->viewVZ.OpenGLWidget->populationMoved(ptr);
+    }
 }
 
 void setLoc3Undo::redo()
@@ -983,6 +1032,9 @@ void setLoc3Undo::redo()
         ptr->loc3.y = value;
     if (index == 2)
         ptr->loc3.z = value;
+    if (data->main->viewVZ.OpenGLWidget != NULL) {
+        data->main->viewVZ.OpenGLWidget->populationMoved(ptr);
+    }
 }
 
 // ######## SET CENTER SYNAPSE 3D #################
@@ -1078,6 +1130,7 @@ updateParUndo::updateParUndo(rootData * data, ParameterData * ptr, int index, fl
     QUndoCommand(parent)
 {
     this->value = value;
+    ptr->loadValues();
     this->oldValue = ptr->value[index];
     this->ptr = ptr;
     this->data = data;
@@ -1224,6 +1277,7 @@ updateParType::updateParType(rootData * data, ParameterData * ptr, QString newTy
     if (newType == "Undefined") {
         this->newType = Undefined;
     }
+    ptr->loadValues();
     this->oldValues = ptr->value;
     this->oldType = ptr->currType;
     this->ptr = ptr;
@@ -1271,12 +1325,14 @@ void updateTitle::undo()
 {
     // set name
     ptr->name = oldName;
+    objectRegistry::invalidate();
 }
 
 void updateTitle::redo()
 {
     // set name
     ptr->name = newName;
+    objectRegistry::invalidate();
 }
 
 
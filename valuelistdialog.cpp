@@ -31,6 +31,9 @@ valueListDialog::valueListDialog(ParameterData * par, NineMLComponent * /*comp*/
 {
     ui->setupUi(this);
 
+    // a large list may still be in its binary file
+    par->loadValues();
+
     ui->spinBox->setRange(0, 100000); // set max from the component
     ui->spinBox->setValue(par->value.size());
 
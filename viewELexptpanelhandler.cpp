@@ -34,12 +34,14 @@
 #include "experiment.h"
 #include "projectobject.h"
 #include "undocommands.h"
+#include "batchrunner.h"
 
 #define NEW_EXPERIMENT_VIEW11
 
 viewELExptPanelHandler::viewELExptPanelHandler(QObject *parent) :
     QObject(parent)
 {
+    this->batch = NULL;
 }
 
 viewELExptPanelHandler::viewELExptPanelHandler(viewELstruct * viewEL, rootData * data, QObject *parent) :
@@ -48,6 +50,7 @@ viewELExptPanelHandler::viewELExptPanelHandler(viewELstruct * viewEL, rootData *
 
     this->data = data;
     this->viewEL = viewEL;
+    this->batch = NULL;
     this->exptSetup = new QVBoxLayout;
     this->exptInputs = new QVBoxLayout;
     this->exptOutputs = new QVBoxLayout;
@@ -1678,24 +1681,20 @@ void viewELExptPanelHandler::run()
 
     settings.setValue("simulator_export_path",QDir::toNativeSeparators(wk_dir_string + "/model/"));
     settings.setValue("export_binary",settings.value("simulators/" + simName + "/binary").toBool());
+    settings.setValue("export_optimise_maths",settings.value("simulators/" + simName + "/optimise_maths").toBool());
 
-    // clear directory
-    QDir model_dir(QDir::toNativeSeparators(wk_dir_string + "/model/"));
-    QStringList files = model_dir.entryList(QDir::Files);
-    for (int i = 0; i < files.size(); ++i) {
-        model_dir.remove(files[i]);
-    }
-
-    // write out model
+    // write out model - files that have not changed since the last run are left in place, and stale ones removed
     if (!this->data->currProject->export_for_simulator(QDir::toNativeSeparators(wk_dir_string + "/model/"), data)) {
         settings.remove("simulator_export_path");
         settings.remove("export_binary");
+        settings.remove("export_optimise_maths");
         runButton->setEnabled(true);
         return;
     }
 
     settings.remove("simulator_export_path");
     settings.remove("export_binary");
+    settings.remove("export_optimise_maths");
 
     QProcess * simulator = new QProcess;
     if (!simulator) {
@@ -1734,6 +1733,17 @@ void viewELExptPanelHandler::run()
     connect(simulator, SIGNAL(readyReadStandardError()), this, SLOT(simulatorStandardError()));
 }
 
+void viewELExptPanelHandler::runBatch()
+{
+    // the batch window stays open and keeps running while the rest of the program is used
+    if (this->batch == NULL) {
+        this->batch = new batchRunner(this->data, this->data->main);
+    }
+    this->batch->refresh();
+    this->batch->show();
+    this->batch->raise();
+}
+
 void viewELExptPanelHandler::simulatorFinished(int, QProcess::ExitStatus status)
 {
     // update run button
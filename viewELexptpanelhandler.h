@@ -28,6 +28,7 @@
 #include "globalHeader.h"
 
 struct viewELstruct;
+class batchRunner;
 
 
 class viewELExptPanelHandler : public QObject
@@ -50,6 +51,7 @@ private:
     QVBoxLayout * exptChanges;
 
     QPushButton * runButton;
+    batchRunner * batch;
     QString simulatorStdOutText;
     QString simulatorStdErrText;
 
@@ -135,6 +137,7 @@ public slots:
     void redraw(double);
 
     void run();
+    void runBatch();
     void simulatorFinished(int, QProcess::ExitStatus);
     void simulatorStandardOutput();
     void simulatorStandardError();
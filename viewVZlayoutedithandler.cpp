@@ -28,6 +28,9 @@
 #include "filteroutundoredoevents.h"
 #include "projectobject.h"
 
+// log rows moved on each playback tick (every 30ms)
+#define PLAYBACK_STEP 100
+
 viewVZLayoutEditHandler::viewVZLayoutEditHandler(rootData * data, viewNLstruct * viewNL, viewVZstruct * viewVZ, QObject *parent) :
     QObject(parent)
 {
@@ -319,6 +322,49 @@ void viewVZLayoutEditHandler::initGlobal() {
 
     viewVZ->toolbar->layout()->addWidget(ortho);
 
+    // render timings
+
+    QPushButton * stats = new QPushButton(style.standardIcon(QStyle::SP_FileDialogDetailedView), "", data->main);
+    connect(stats, SIGNAL(toggled(bool)), this->viewVZ->OpenGLWidget, SLOT(setStatsOverlayShown(bool)));
+    stats->setCheckable("true");
+    stats->setToolTip("Hide / show the render timings");
+    stats->setMinimumHeight(28);
+    stats->setMaximumWidth(28);
+    stats->setFlat(true);
+    stats->setChecked(false);
+
+    viewVZ->toolbar->layout()->addWidget(stats);
+
+    QPushButton * exportStats = new QPushButton(style.standardIcon(QStyle::SP_DialogSaveButton), "", data->main);
+    connect(exportStats, SIGNAL(clicked()), this->viewVZ->OpenGLWidget, SLOT(exportRenderStats()));
+    exportStats->setToolTip("Export the render timings of recent frames as CSV");
+    exportStats->setMinimumHeight(28);
+    exportStats->setMaximumWidth(28);
+    exportStats->setFlat(true);
+
+    viewVZ->toolbar->layout()->addWidget(exportStats);
+
+    // how connections are shown, for projections too big to draw every one
+
+    QComboBox * connectionMode = new QComboBox(data->main);
+    connectionMode->addItem("All connections");
+    connectionMode->addItem("Sampled connections");
+    connectionMode->addItem("Connection density");
+    connectionMode->setToolTip("Draw every connection, a random sample of them, or bundles between regions of the populations");
+    connect(connectionMode, SIGNAL(currentIndexChanged(int)), this->viewVZ->OpenGLWidget, SLOT(setConnectionDisplayMode(int)));
+
+    viewVZ->toolbar->layout()->addWidget(connectionMode);
+
+    QComboBox * connectionQuality = new QComboBox(data->main);
+    connectionQuality->addItem("Low");
+    connectionQuality->addItem("Medium");
+    connectionQuality->addItem("High");
+    connectionQuality->setCurrentIndex(1);
+    connectionQuality->setToolTip("How many sampled connections, or how fine the density regions, are drawn");
+    connect(connectionQuality, SIGNAL(currentIndexChanged(int)), this->viewVZ->OpenGLWidget, SLOT(setConnectionQuality(int)));
+
+    viewVZ->toolbar->layout()->addWidget(connectionQuality);
+
     ((QHBoxLayout *)viewVZ->toolbar->layout())->addStretch();
 
 
@@ -800,14 +846,17 @@ void viewVZLayoutEditHandler::togglePlay() {
     if (playBack.isActive()) {
 
         playBack.stop();
+        viewVZ->OpenGLWidget->setLogPlayback(0);
         QPushButton * but = (QPushButton *) sender();
         QCommonStyle style;
         but->setIcon(style.standardIcon(QStyle::SP_MediaPlay));
 
     } else {
 
-        playBack.setInterval(15);
+        // step once per frame of the 3D view, so the rows it reads ahead are the ones shown
+        playBack.setInterval(30);
         playBack.start();
+        viewVZ->OpenGLWidget->setLogPlayback(PLAYBACK_STEP);
         QPushButton * but = (QPushButton *) sender();
         QCommonStyle style;
         but->setIcon(style.standardIcon(QStyle::SP_MediaPause));
@@ -819,10 +868,11 @@ void viewVZLayoutEditHandler::togglePlay() {
 void viewVZLayoutEditHandler::playBackTimeout() {
 
     if (timeSlider->value() < timeSlider->maximum()) {
-        timeSlider->setValue(timeSlider->value()+50);
+        timeSlider->setValue(timeSlider->value()+PLAYBACK_STEP);
         viewVZ->OpenGLWidget->updateLogDataTime(timeSlider->value());
     } else {
         playBack.stop();
+        viewVZ->OpenGLWidget->setLogPlayback(0);
         QCommonStyle style;
         playButton->setIcon(style.standardIcon(QStyle::SP_MediaPlay));
     }